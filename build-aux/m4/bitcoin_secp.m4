@@ -14,6 +14,38 @@ AC_COMPILE_IFELSE([AC_LANG_PROGRAM([[
 AC_MSG_RESULT([$has_64bit_asm])
 ])
 
+AC_DEFUN([SECP_AVX2_CHECK],[
+AC_MSG_CHECKING(for AVX2 intrinsics availability)
+AC_COMPILE_IFELSE([AC_LANG_PROGRAM([[
+  #include <immintrin.h>
+  __attribute__((target("avx2"))) static __m256i mul(__m256i a, __m256i b) { return _mm256_mul_epu32(a, b); }]],[[
+  __m256i a;
+  (void)mul;
+  (void)a;
+  ]])],[has_avx2_intrinsics=yes],[has_avx2_intrinsics=no])
+AC_MSG_RESULT([$has_avx2_intrinsics])
+])
+
+AC_DEFUN([SECP_AVX512IFMA_CHECK],[
+AC_MSG_CHECKING(for AVX-512 IFMA intrinsics availability)
+AC_COMPILE_IFELSE([AC_LANG_PROGRAM([[
+  #include <immintrin.h>
+  __attribute__((target("avx512f,avx512ifma"))) static __m512i mul(__m512i a, __m512i b) { return _mm512_madd52lo_epu64(a, a, b); }]],[[
+  (void)mul;
+  ]])],[has_avx512ifma_intrinsics=yes],[has_avx512ifma_intrinsics=no])
+AC_MSG_RESULT([$has_avx512ifma_intrinsics])
+])
+
+AC_DEFUN([SECP_SHANI_CHECK],[
+AC_MSG_CHECKING(for SHA-NI intrinsics availability)
+AC_COMPILE_IFELSE([AC_LANG_PROGRAM([[
+  #include <immintrin.h>
+  __attribute__((target("sha,sse4.1"))) static __m128i rnds(__m128i a, __m128i b, __m128i k) { return _mm_sha256rnds2_epu32(a, b, _mm_blend_epi16(k, a, 0xF0)); }]],[[
+  (void)rnds;
+  ]])],[has_shani_intrinsics=yes],[has_shani_intrinsics=no])
+AC_MSG_RESULT([$has_shani_intrinsics])
+])
+
 dnl
 AC_DEFUN([SECP_OPENSSL_CHECK],[
   has_libcrypto=no
@@ -63,3 +95,14 @@ if test x"$has_gmp" != x"yes"; then
   LIBS="$LIBS_TEMP"
 fi
 ])
+
+dnl
+AC_DEFUN([SECP_PTHREAD_CHECK],[
+has_pthread=no
+LIBS_TEMP="$LIBS"
+AC_CHECK_HEADER(pthread.h,[AC_SEARCH_LIBS(pthread_create, pthread,[has_pthread=yes])])
+if test x"$has_pthread" = x"yes" && test x"$ac_cv_search_pthread_create" != x"none required"; then
+  PTHREAD_LIBS="$ac_cv_search_pthread_create"
+fi
+LIBS="$LIBS_TEMP"
+])
@@ -0,0 +1,190 @@
+/**********************************************************************
+ * Copyright (c) 2016 libsecp256k1 contributors                       *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "executor_pthreads.h"
+
+typedef struct secp256k1_executor_pthreads_job_struct {
+    secp256k1_executor_task task;
+    void *arg;
+    /* The first item that was not handed out yet, and the end of the items. */
+    size_t next;
+    size_t n;
+    /* The number of items handed out at once. */
+    size_t step;
+    struct secp256k1_executor_pthreads_job_struct *link;
+} secp256k1_executor_pthreads_job;
+
+typedef struct {
+    pthread_mutex_t lock;
+    /* Signaled when jobs are queued, or the workers have to stop. */
+    pthread_cond_t work;
+    /* Signaled when all queued items have been processed. */
+    pthread_cond_t done;
+    secp256k1_executor_pthreads_job *head;
+    secp256k1_executor_pthreads_job *tail;
+    /* The number of queued or running items that were not processed yet. */
+    size_t busy;
+    int stop;
+    pthread_t *threads;
+    size_t nthreads;
+} secp256k1_executor_pthreads_pool;
+
+/* Hand out the next range of the oldest job. Must be called with the lock
+ * held, and with at least one job queued. */
+static void secp256k1_executor_pthreads_take(secp256k1_executor_pthreads_pool *pool, secp256k1_executor_pthreads_job *range) {
+    secp256k1_executor_pthreads_job *job = pool->head;
+    range->task = job->task;
+    range->arg = job->arg;
+    range->next = job->next;
+    range->n = job->n - job->next < job->step ? job->n : job->next + job->step;
+    job->next = range->n;
+    if (job->next == job->n) {
+        pool->head = job->link;
+        if (pool->head == NULL) {
+            pool->tail = NULL;
+        }
+        free(job);
+    }
+}
+
+/* Process a range taken with secp256k1_executor_pthreads_take. Must be called
+ * with the lock held, which is released while the range is processed. */
+static void secp256k1_executor_pthreads_run(secp256k1_executor_pthreads_pool *pool, const secp256k1_executor_pthreads_job *range) {
+    pthread_mutex_unlock(&pool->lock);
+    range->task(range->arg, range->next, range->n);
+    pthread_mutex_lock(&pool->lock);
+    pool->busy -= range->n - range->next;
+    if (pool->busy == 0) {
+        pthread_cond_broadcast(&pool->done);
+    }
+}
+
+static void *secp256k1_executor_pthreads_worker(void *data) {
+    secp256k1_executor_pthreads_pool *pool = (secp256k1_executor_pthreads_pool *)data;
+    secp256k1_executor_pthreads_job range;
+
+    pthread_mutex_lock(&pool->lock);
+    while (1) {
+        while (!pool->stop && pool->head == NULL) {
+            pthread_cond_wait(&pool->work, &pool->lock);
+        }
+        if (pool->head == NULL) {
+            break;
+        }
+        secp256k1_executor_pthreads_take(pool, &range);
+        secp256k1_executor_pthreads_run(pool, &range);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+static void secp256k1_executor_pthreads_parallel_for(void *data, secp256k1_executor_task task, void *arg, size_t n) {
+    secp256k1_executor_pthreads_pool *pool = (secp256k1_executor_pthreads_pool *)data;
+    secp256k1_executor_pthreads_job *job;
+
+    job = (secp256k1_executor_pthreads_job *)malloc(sizeof(secp256k1_executor_pthreads_job));
+    if (job == NULL) {
+        /* Without memory to queue the job, process it right away. */
+        task(arg, 0, n);
+        return;
+    }
+    job->task = task;
+    job->arg = arg;
+    job->next = 0;
+    job->n = n;
+    /* A few ranges per thread, so threads that finish early can take more. */
+    job->step = n / (4 * (pool->nthreads + 1));
+    if (job->step == 0) {
+        job->step = 1;
+    }
+    job->link = NULL;
+
+    pthread_mutex_lock(&pool->lock);
+    if (pool->tail != NULL) {
+        pool->tail->link = job;
+    } else {
+        pool->head = job;
+    }
+    pool->tail = job;
+    pool->busy += n;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static void secp256k1_executor_pthreads_join(void *data) {
+    secp256k1_executor_pthreads_pool *pool = (secp256k1_executor_pthreads_pool *)data;
+    secp256k1_executor_pthreads_job range;
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->busy > 0) {
+        if (pool->head != NULL) {
+            secp256k1_executor_pthreads_take(pool, &range);
+            secp256k1_executor_pthreads_run(pool, &range);
+        } else {
+            pthread_cond_wait(&pool->done, &pool->lock);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static void secp256k1_executor_pthreads_stop(secp256k1_executor_pthreads_pool *pool) {
+    size_t i;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+    for (i = 0; i < pool->nthreads; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->work);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->threads);
+    free(pool);
+}
+
+int secp256k1_executor_pthreads_init(secp256k1_executor *executor, size_t nthreads) {
+    secp256k1_executor_pthreads_pool *pool;
+
+    pool = (secp256k1_executor_pthreads_pool *)malloc(sizeof(secp256k1_executor_pthreads_pool));
+    if (pool == NULL) {
+        return 0;
+    }
+    pool->threads = (pthread_t *)malloc((nthreads > 0 ? nthreads : 1) * sizeof(pthread_t));
+    if (pool->threads == NULL) {
+        free(pool);
+        return 0;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pool->head = NULL;
+    pool->tail = NULL;
+    pool->busy = 0;
+    pool->stop = 0;
+    for (pool->nthreads = 0; pool->nthreads < nthreads; pool->nthreads++) {
+        if (pthread_create(&pool->threads[pool->nthreads], NULL, secp256k1_executor_pthreads_worker, pool) != 0) {
+            secp256k1_executor_pthreads_stop(pool);
+            return 0;
+        }
+    }
+
+    executor->parallel_for = secp256k1_executor_pthreads_parallel_for;
+    executor->join = secp256k1_executor_pthreads_join;
+    executor->data = pool;
+    return 1;
+}
+
+void secp256k1_executor_pthreads_clear(secp256k1_executor *executor) {
+    secp256k1_executor_pthreads_stop((secp256k1_executor_pthreads_pool *)executor->data);
+    executor->parallel_for = NULL;
+    executor->join = NULL;
+    executor->data = NULL;
+}
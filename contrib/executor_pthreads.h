@@ -0,0 +1,59 @@
+/**********************************************************************
+ * Copyright (c) 2016 libsecp256k1 contributors                       *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+/****
+ * Please do not link this file directly. It is not part of the libsecp256k1
+ * project and does not promise any stability in its API, functionality or
+ * presence. Projects which use this code should instead copy this header
+ * and its accompanying .c file directly into their codebase.
+ ****/
+
+/* This file defines a reference secp256k1_executor that runs batch
+ * operations on a fixed pool of POSIX threads.
+ *
+ * The library itself never creates threads. Applications that already have
+ * a thread pool should implement the two executor callbacks on top of it
+ * instead; this snippet shows what they need to do:
+ * - parallel_for splits the items into ranges and queues them.
+ * - join waits until every queued range has been processed. The joining
+ *   thread processes ranges itself while waiting, so the pool may even be
+ *   empty.
+ *
+ * A single executor may be shared between any number of contexts and
+ * threads; join then also waits for the ranges queued by other threads.
+ */
+
+#ifndef _SECP256K1_CONTRIB_EXECUTOR_PTHREADS_H_
+#define _SECP256K1_CONTRIB_EXECUTOR_PTHREADS_H_
+
+#include <secp256k1.h>
+
+# ifdef __cplusplus
+extern "C" {
+# endif
+
+/** Start a pool of worker threads, and set up an executor that uses it.
+ *
+ *  Returns: 1 if the executor was set up, 0 if threads could not be started.
+ *  Out:     executor: pointer to the executor to initialize. Pass it to
+ *                     secp256k1_context_set_executor.
+ *  In:      nthreads: the number of worker threads to start, besides the
+ *                     threads calling join.
+ */
+int secp256k1_executor_pthreads_init(secp256k1_executor *executor, size_t nthreads);
+
+/** Stop the worker threads of an executor set up with
+ *  secp256k1_executor_pthreads_init, and free its resources.
+ *
+ *  No context may be using the executor anymore.
+ */
+void secp256k1_executor_pthreads_clear(secp256k1_executor *executor);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -148,3 +148,20 @@ int ecdsa_signature_parse_der_lax(const secp256k1_context* ctx, secp256k1_ecdsa_
     return 1;
 }
 
+size_t ecdsa_signature_parse_der_lax_batch(const secp256k1_context* ctx, secp256k1_ecdsa_signature* sigs, unsigned char *valid, const unsigned char *input, const size_t *offsets, const size_t *lengths, size_t n) {
+    size_t i;
+    size_t count = 0;
+
+    if (valid != NULL) {
+        memset(valid, 0, n);
+    }
+    for (i = 0; i < n; i++) {
+        if (ecdsa_signature_parse_der_lax(ctx, &sigs[i], &input[offsets[i]], lengths[i])) {
+            if (valid != NULL) {
+                valid[i] = 1;
+            }
+            count++;
+        }
+    }
+    return count;
+}
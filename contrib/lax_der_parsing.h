@@ -84,6 +84,33 @@ int ecdsa_signature_parse_der_lax(
     size_t inputlen
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
 
+/** Parse a batch of signatures in "lax DER" format from a single buffer
+ *
+ *  Returns: the number of signatures that could be parsed.
+ *  Args: ctx:      a secp256k1 context object
+ *  Out:  sigs:     pointer to an array of n signature objects, set as by
+ *                  ecdsa_signature_parse_der_lax on each input signature.
+ *        valid:    pointer to an array of n bytes, receiving 1 for every
+ *                  signature that could be parsed and 0 for every other one
+ *                  (can be NULL).
+ *  In:   input:    pointer to the buffer holding the signatures.
+ *        offsets:  pointer to an array of n offsets into input, at which the
+ *                  signatures start.
+ *        lengths:  pointer to an array of the n signature lengths.
+ *        n:        the number of signatures to parse.
+ *
+ *  This is the lax counterpart of secp256k1_ecdsa_signature_parse_der_batch.
+ */
+size_t ecdsa_signature_parse_der_lax_batch(
+    const secp256k1_context* ctx,
+    secp256k1_ecdsa_signature* sigs,
+    unsigned char *valid,
+    const unsigned char *input,
+    const size_t *offsets,
+    const size_t *lengths,
+    size_t n
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(4) SECP256K1_ARG_NONNULL(5) SECP256K1_ARG_NONNULL(6);
+
 #ifdef __cplusplus
 }
 #endif
@@ -42,6 +42,22 @@ extern "C" {
  */
 typedef struct secp256k1_context_struct secp256k1_context;
 
+/** Opaque data structure that holds a precomputed table for multiplying one
+ *  fixed point by many scalars.
+ *
+ *  It is created for a given public key with secp256k1_point_table_create,
+ *  and, like a context, can safely be used from multiple threads once built.
+ */
+typedef struct secp256k1_point_table_struct secp256k1_point_table;
+
+/** Opaque data structure that holds an ECDSA verification in progress.
+ *
+ *  It lets a verification be done in small steps, interleaved with other
+ *  work on the same thread (see secp256k1_ecdsa_verify_start). A state can be
+ *  reused for any number of verifications, one at a time.
+ */
+typedef struct secp256k1_ecdsa_verify_state_struct secp256k1_ecdsa_verify_state;
+
 /** Opaque data structure that holds a parsed and valid public key.
  *
  *  The exact representation of data inside is implementation defined and not
@@ -169,6 +185,9 @@ typedef int (*secp256k1_nonce_function)(
  *
  *  Returns: a newly created context object.
  *  In:      flags: which parts of the context to initialize.
+ *
+ *  The first context created detects the instruction set extensions of the
+ *  CPU, which select the code paths of the whole process, not of the context.
  */
 SECP256K1_API secp256k1_context* secp256k1_context_create(
     unsigned int flags
@@ -240,6 +259,51 @@ SECP256K1_API void secp256k1_context_set_error_callback(
     const void* data
 ) SECP256K1_ARG_NONNULL(1);
 
+/** A pointer to a function that processes the items begin..end-1 of a job
+ *  started with an executor's parallel_for. arg is the pointer passed to
+ *  parallel_for along with it.
+ */
+typedef void (*secp256k1_executor_task)(void *arg, size_t begin, size_t end);
+
+/** Callbacks through which batch operations spread their work over threads.
+ *
+ *  The library never creates threads itself. Instead, batch operations split
+ *  their input into independent items, and hand them to the executor set on
+ *  the context (see secp256k1_context_set_executor).
+ *
+ *  parallel_for: a pointer to a function that must eventually call task(arg,
+ *                begin, end) for a set of nonempty ranges which together
+ *                cover 0..n-1 exactly once (n is at least 1). The calls may
+ *                happen concurrently, on any thread, and in any order, and
+ *                parallel_for may return before they complete.
+ *  join:         a pointer to a function that returns once all tasks started
+ *                through parallel_for with the same data pointer completed.
+ *                The library calls it right after every parallel_for.
+ *  data:         the opaque pointer to pass to both functions above.
+ *
+ *  A task never calls back into the executor.
+ */
+typedef struct {
+    void (*parallel_for)(void *data, secp256k1_executor_task task, void *arg, size_t n);
+    void (*join)(void *data);
+    void *data;
+} secp256k1_executor;
+
+/** Set the executor that batch operations on a context use.
+ *
+ *  By default, all work is done on the calling thread. The executor's
+ *  callbacks and data must stay valid while the context uses them, and are
+ *  copied by secp256k1_context_clone.
+ *
+ *  Args: ctx:      an existing context object (cannot be NULL)
+ *  In:   executor: pointer to the executor to use; its contents are copied
+ *                  (NULL restores the default, serial, executor).
+ */
+SECP256K1_API void secp256k1_context_set_executor(
+    secp256k1_context* ctx,
+    const secp256k1_executor* executor
+) SECP256K1_ARG_NONNULL(1);
+
 /** Parse a variable-length public key into the pubkey object.
  *
  *  Returns: 1 if the public key was fully valid.
@@ -284,6 +348,58 @@ SECP256K1_API int secp256k1_ec_pubkey_serialize(
     unsigned int flags
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
 
+/** Parse a batch of equally sized serialized public keys.
+ *
+ *  Returns: the number of public keys that were fully valid.
+ *  Args: ctx:      a secp256k1 context object.
+ *  Out:  pubkeys:  pointer to an array of n pubkey objects. Entry i is set to
+ *                  the parsed version of the i'th input key if it was valid,
+ *                  and cleared otherwise.
+ *        valid:    pointer to an array of n bytes, receiving 1 for every valid
+ *                  input key and 0 for every invalid one (can be NULL).
+ *  In:   input:    pointer to n serialized public keys of inputlen bytes each,
+ *                  stored back to back.
+ *        inputlen: the length of every individual serialized public key.
+ *        n:        the number of public keys to parse.
+ *
+ *  Every key is handled as by secp256k1_ec_pubkey_parse. An invalid key does
+ *  not stop the rest of the batch from being parsed. The work is split over
+ *  the context's executor (see secp256k1_context_set_executor).
+ */
+SECP256K1_API size_t secp256k1_ec_pubkey_parse_batch(
+    const secp256k1_context* ctx,
+    secp256k1_pubkey *pubkeys,
+    unsigned char *valid,
+    const unsigned char *input,
+    size_t inputlen,
+    size_t n
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(4);
+
+/** Serialize a batch of pubkey objects into a flat byte array.
+ *
+ *  Returns: 1 if all keys were serialized.
+ *           0 if any of the public keys was not initialized. The whole
+ *           output array is cleared in that case.
+ *  Args:   ctx:        a secp256k1 context object.
+ *  Out:    output:     a pointer to an array of n * 65 (if compressed==0) or
+ *                      n * 33 (if compressed==1) bytes, receiving the serialized
+ *                      keys back to back.
+ *  In:     pubkeys:    a pointer to an array of n initialized public keys.
+ *          n:          the number of public keys to serialize.
+ *          flags:      SECP256K1_EC_COMPRESSED if serialization should be in
+ *                      compressed format, otherwise SECP256K1_EC_UNCOMPRESSED.
+ *
+ *  The work is split over the context's executor (see
+ *  secp256k1_context_set_executor).
+ */
+SECP256K1_API int secp256k1_ec_pubkey_serialize_batch(
+    const secp256k1_context* ctx,
+    unsigned char *output,
+    const secp256k1_pubkey *pubkeys,
+    size_t n,
+    unsigned int flags
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
 /** Parse an ECDSA signature in compact (64 bytes) format.
  *
  *  Returns: 1 when the signature could be parsed, 0 otherwise.
@@ -327,6 +443,56 @@ SECP256K1_API int secp256k1_ecdsa_signature_parse_der(
     size_t inputlen
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
 
+/** Parse a batch of compact (64-byte) ECDSA signatures.
+ *
+ *  Returns: the number of signatures that could be parsed.
+ *  Args: ctx:      a secp256k1 context object
+ *  Out:  sigs:     pointer to an array of n signature objects. Entry i is set
+ *                  as by secp256k1_ecdsa_signature_parse_compact on the i'th
+ *                  input signature.
+ *        valid:    pointer to an array of n bytes, receiving 1 for every
+ *                  signature that could be parsed and 0 for every other one
+ *                  (can be NULL).
+ *  In:   input64s: pointer to n 64-byte signatures, stored back to back.
+ *        n:        the number of signatures to parse.
+ */
+SECP256K1_API size_t secp256k1_ecdsa_signature_parse_compact_batch(
+    const secp256k1_context* ctx,
+    secp256k1_ecdsa_signature* sigs,
+    unsigned char *valid,
+    const unsigned char *input64s,
+    size_t n
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(4);
+
+/** Parse a batch of DER ECDSA signatures from a single buffer.
+ *
+ *  Returns: the number of signatures that could be parsed.
+ *  Args: ctx:      a secp256k1 context object
+ *  Out:  sigs:     pointer to an array of n signature objects. Entry i is set
+ *                  as by secp256k1_ecdsa_signature_parse_der on the i'th
+ *                  input signature.
+ *        valid:    pointer to an array of n bytes, receiving 1 for every
+ *                  signature that could be parsed and 0 for every other one
+ *                  (can be NULL).
+ *  In:   input:    pointer to the buffer holding the signatures.
+ *        offsets:  pointer to an array of n offsets into input, at which the
+ *                  signatures start.
+ *        lengths:  pointer to an array of the n signature lengths.
+ *        n:        the number of signatures to parse.
+ *
+ *  The signatures are parsed where they are, so they may be spread over a
+ *  larger structure (such as a serialized block) without being copied out.
+ */
+SECP256K1_API size_t secp256k1_ecdsa_signature_parse_der_batch(
+    const secp256k1_context* ctx,
+    secp256k1_ecdsa_signature* sigs,
+    unsigned char *valid,
+    const unsigned char *input,
+    const size_t *offsets,
+    const size_t *lengths,
+    size_t n
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(4) SECP256K1_ARG_NONNULL(5) SECP256K1_ARG_NONNULL(6);
+
 /** Serialize an ECDSA signature in DER format.
  *
  *  Returns: 1 if enough space was available to serialize, 0 otherwise
@@ -385,6 +551,140 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdsa_verify(
     const secp256k1_pubkey *pubkey
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
 
+/** Parse, optionally normalize, and verify a DER ECDSA signature in one call.
+ *
+ *  Returns: 1: correct signature
+ *           0: incorrect or unparseable signature or public key
+ *  Args:    ctx:       a secp256k1 context object, initialized for verification.
+ *  In:      sig:       pointer to the DER signature (cannot be NULL)
+ *           siglen:    the length of the signature
+ *           msg32:     the 32-byte message hash being verified (cannot be NULL)
+ *           pubkey:    pointer to the serialized public key (cannot be NULL)
+ *           pubkeylen: the length of the public key
+ *           normalize: if nonzero, a signature with a high S value is
+ *                      verified in its lower-S form, as if it had been passed
+ *                      through secp256k1_ecdsa_signature_normalize. Otherwise
+ *                      it is rejected.
+ *
+ *  This gives the same result as secp256k1_ecdsa_signature_parse_der,
+ *  secp256k1_ecdsa_signature_normalize (when normalize is set),
+ *  secp256k1_ec_pubkey_parse and secp256k1_ecdsa_verify in sequence, without
+ *  converting to and from the signature and public key objects in between.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdsa_verify_der(
+    const secp256k1_context* ctx,
+    const unsigned char *sig,
+    size_t siglen,
+    const unsigned char *msg32,
+    const unsigned char *pubkey,
+    size_t pubkeylen,
+    int normalize
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(4) SECP256K1_ARG_NONNULL(5);
+
+/** Verify a batch of DER ECDSA signatures with serialized public keys, read
+ *  from a single buffer.
+ *
+ *  Returns: the number of correct signatures.
+ *  Args:    ctx:            a secp256k1 context object, initialized for verification.
+ *  Out:     valid:          pointer to an array of n bytes, receiving 1 for
+ *                           every correct signature and 0 for every other one
+ *                           (can be NULL).
+ *  In:      input:          pointer to the buffer holding the signatures and
+ *                           public keys (cannot be NULL).
+ *           sig_offsets:    pointer to the n offsets of the signatures in input.
+ *           sig_lengths:    pointer to the n lengths of the signatures.
+ *           pubkey_offsets: pointer to the n offsets of the public keys in input.
+ *           pubkey_lengths: pointer to the n lengths of the public keys.
+ *           msg32s:         pointer to n 32-byte message hashes, stored back to back.
+ *           n:              the number of signatures to verify.
+ *           normalize:      as for secp256k1_ecdsa_verify_der.
+ *
+ *  Every signature is checked as by secp256k1_ecdsa_verify_der. The work is
+ *  split over the context's executor (see secp256k1_context_set_executor).
+ */
+SECP256K1_API size_t secp256k1_ecdsa_verify_der_batch(
+    const secp256k1_context* ctx,
+    unsigned char *valid,
+    const unsigned char *input,
+    const size_t *sig_offsets,
+    const size_t *sig_lengths,
+    const size_t *pubkey_offsets,
+    const size_t *pubkey_lengths,
+    const unsigned char *msg32s,
+    size_t n,
+    int normalize
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4) SECP256K1_ARG_NONNULL(5) SECP256K1_ARG_NONNULL(6) SECP256K1_ARG_NONNULL(7) SECP256K1_ARG_NONNULL(8);
+
+/** Create a state object for verifying ECDSA signatures in steps.
+ *
+ *  Returns: a newly created state object.
+ *  Args:    ctx:   a secp256k1 context object.
+ */
+SECP256K1_API secp256k1_ecdsa_verify_state* secp256k1_ecdsa_verify_state_create(
+    const secp256k1_context* ctx
+) SECP256K1_ARG_NONNULL(1);
+
+/** Destroy a state object created with secp256k1_ecdsa_verify_state_create.
+ *
+ *  Args:    state: the state to destroy (can be NULL).
+ */
+SECP256K1_API void secp256k1_ecdsa_verify_state_destroy(
+    secp256k1_ecdsa_verify_state* state
+);
+
+/** Start verifying an ECDSA signature in steps.
+ *
+ *  Returns: 1 if the verification was started, 0 on illegal arguments.
+ *  Args:    ctx:       a secp256k1 context object, initialized for verification.
+ *  Out:     state:     the state object to hold the verification (cannot be
+ *                      NULL). Any verification it held before is abandoned.
+ *  In:      sig:       the signature being verified (cannot be NULL)
+ *           msg32:     the 32-byte message hash being verified (cannot be NULL)
+ *           pubkey:    pointer to an initialized public key to verify with (cannot be NULL)
+ *
+ *  No verification work is done yet; the arguments are copied into the state.
+ *  Call secp256k1_ecdsa_verify_continue until it returns 1 to get the result,
+ *  which is the same as that of secp256k1_ecdsa_verify.
+ */
+SECP256K1_API int secp256k1_ecdsa_verify_start(
+    const secp256k1_context* ctx,
+    secp256k1_ecdsa_verify_state* state,
+    const secp256k1_ecdsa_signature *sig,
+    const unsigned char *msg32,
+    const secp256k1_pubkey *pubkey
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4) SECP256K1_ARG_NONNULL(5);
+
+/** Do one step of an ECDSA verification started with secp256k1_ecdsa_verify_start.
+ *
+ *  Returns: 1: the verification is complete, and its result is in result.
+ *           0: more steps are needed.
+ *  Args:    ctx:        the context object the verification was started with.
+ *  In/Out:  state:      the state of the verification (cannot be NULL).
+ *  Out:     result:     set to 1 for a correct signature and to 0 for an
+ *                       incorrect one, once the verification is complete
+ *                       (cannot be NULL).
+ *  In:      iterations: the maximum number of iterations of the main
+ *                       multiplication loop to run in this step (must be at
+ *                       least 1).
+ *
+ *  A step is one of:
+ *  - loading the signature and public key, and inverting s,
+ *  - computing the wNAF representations of the two scalars,
+ *  - computing the table of multiples of the public key,
+ *  - up to iterations iterations of the main loop, each one point doubling
+ *    and a few point additions (there are 130 with the endomorphism
+ *    optimization, and 256 otherwise),
+ *  - checking the result.
+ *  A verification may complete early, for example for an invalid public key.
+ *  Once complete, further calls keep returning 1 and the same result.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdsa_verify_continue(
+    const secp256k1_context* ctx,
+    secp256k1_ecdsa_verify_state* state,
+    int *result,
+    unsigned int iterations
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
 /** Convert a signature to a normalized lower-S form.
  *
  *  Returns: 1 if sigin was not normalized, 0 if it already was.
@@ -491,6 +791,39 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_create(
     const unsigned char *seckey
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
 
+/** Compute the serialized public keys for a range of consecutive secret keys.
+ *
+ *  Returns: 1: all secret keys seckey, seckey+1, ..., seckey+n-1 were valid, and
+ *              their public keys were written to output.
+ *           0: seckey was invalid, or the range would reach the group order.
+ *              The contents of output are undefined in that case.
+ *  Args:   ctx:        pointer to a context object, initialized for signing (cannot be NULL)
+ *  Out:    output:     pointer to an array of n * 33 (if compressed) or n * 65
+ *                      (if uncompressed) bytes, receiving the serialized public
+ *                      keys back to back (cannot be NULL)
+ *  In:     seckey:     pointer to the 32-byte first secret key of the range (cannot be NULL)
+ *          n:          the number of consecutive keys to compute (must be at least 1)
+ *          flags:      SECP256K1_EC_COMPRESSED if serialization should be in
+ *                      compressed format, otherwise SECP256K1_EC_UNCOMPRESSED.
+ *
+ *  Only the first public key is computed with a full multiplication; every
+ *  following key is obtained by adding the generator to its predecessor, and
+ *  the results are converted to affine coordinates in batches sharing a single
+ *  field inversion.
+ *
+ *  This function is NOT constant time: its running time and memory access
+ *  patterns depend on the secret keys. Only use it to enumerate ranges whose
+ *  secret keys are not sensitive (for example when scanning public puzzles or
+ *  auditing known key spaces).
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_create_range(
+    const secp256k1_context* ctx,
+    unsigned char *output,
+    const unsigned char *seckey,
+    size_t n,
+    unsigned int flags
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
 /** Tweak a private key by adding tweak to it.
  * Returns: 0 if the tweak was out of range (chance of around 1 in 2^128 for
  *          uniformly random 32-byte arrays, or if the resulting private key
@@ -549,6 +882,73 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_tweak_mul(
     const unsigned char *tweak
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
 
+/** Create a table for multiplying a fixed public key by many scalars.
+ *
+ *  Returns: a newly created table object, or NULL on failure.
+ *  Args:    ctx:    pointer to a context object (cannot be NULL).
+ *  In:      point:  pointer to the public key to precompute multiples of
+ *                   (cannot be NULL).
+ *           seed32: pointer to a 32-byte random seed to blind the constant-time
+ *                   multiplication with (can be NULL).
+ *
+ *  Building the table costs about as much as ten multiplications. The table
+ *  has the same layout as the one the context uses for signing, so every
+ *  multiplication needs 64 point additions and no doublings. See
+ *  secp256k1_point_table_memory for its size.
+ */
+SECP256K1_API secp256k1_point_table* secp256k1_point_table_create(
+    const secp256k1_context* ctx,
+    const secp256k1_pubkey *point,
+    const unsigned char *seed32
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Destroy a table object created with secp256k1_point_table_create.
+ *
+ *  The table pointer may not be used afterwards.
+ *  Args:   table:  an existing table to destroy (cannot be NULL)
+ */
+SECP256K1_API void secp256k1_point_table_destroy(
+    secp256k1_point_table* table
+);
+
+/** Return the number of bytes of memory allocated for a table object.
+ *
+ *  Args:   table:  an existing table (cannot be NULL)
+ */
+SECP256K1_API size_t secp256k1_point_table_memory(
+    const secp256k1_point_table* table
+) SECP256K1_ARG_NONNULL(1);
+
+/** Multiply the point of a table by a scalar, in constant time.
+ *  Returns: 0 if the scalar was out of range or equal to zero. 1 otherwise.
+ *  Args:    ctx:       pointer to a context object (cannot be NULL).
+ *           table:     pointer to a table (cannot be NULL).
+ *  Out:     pubkey:    pointer to a public key object receiving the product
+ *                      (cannot be NULL).
+ *  In:      scalar:    pointer to a 32-byte secret scalar.
+ *
+ *  The result is the same as of secp256k1_ec_pubkey_tweak_mul applied to a
+ *  copy of the table's point.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_point_table_mul(
+    const secp256k1_context* ctx,
+    const secp256k1_point_table* table,
+    secp256k1_pubkey *pubkey,
+    const unsigned char *scalar
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
+
+/** Multiply the point of a table by a scalar, in variable time.
+ *
+ *  Same as secp256k1_point_table_mul, but considerably faster. Only use it
+ *  when the scalar is not secret.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_point_table_mul_var(
+    const secp256k1_context* ctx,
+    const secp256k1_point_table* table,
+    secp256k1_pubkey *pubkey,
+    const unsigned char *scalar
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
+
 /** Updates the context randomization.
  *  Returns: 1: randomization successfully updated
  *           0: error
@@ -576,6 +976,26 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_combine(
     size_t n
 ) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
 
+/** Add a number of public keys together, in variable time.
+ *  Returns: 1: the sum of the public keys is valid.
+ *           0: the sum of the public keys is not valid.
+ *  Args:   ctx:        pointer to a context object
+ *  Out:    out:        pointer to a public key object for placing the resulting public key
+ *                      (cannot be NULL)
+ *  In:     ins:        pointer to an array of n public keys (cannot be NULL)
+ *          n:          the number of public keys to add together (must be at least 1)
+ *
+ *  This computes the same result as secp256k1_ec_pubkey_combine, but is
+ *  considerably faster for large n. The time taken depends on the inputs, so
+ *  it must only be used when the public keys (and their sum) are not secret.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_combine_var(
+    const secp256k1_context* ctx,
+    secp256k1_pubkey *out,
+    const secp256k1_pubkey *ins,
+    size_t n
+) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
 # ifdef __cplusplus
 }
 # endif
@@ -24,6 +24,45 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdh(
   const unsigned char *privkey
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
 
+/** Scan a list of points for payments to a stealth address.
+ *
+ *  For every point P_i, this derives the key spendkey + H(ECDH(P_i, scankey))*G,
+ *  where H(ECDH(...)) is the secret secp256k1_ecdh would produce, interpreted
+ *  as a tweak like secp256k1_ec_pubkey_tweak_add does, and looks it up among
+ *  the output keys.
+ *
+ *  Returns: the number of points whose derived key is one of the outputs.
+ *           0 is also returned if scankey is invalid (zero or overflow).
+ *  Args:    ctx:        pointer to a context object, initialized for
+ *                       verification (cannot be NULL)
+ *  Out:     matches:    pointer to an array of n indices. Entry i is set to the
+ *                       index of the output matching the i'th point, or to
+ *                       noutputs if there is none (cannot be NULL)
+ *  In:      points:     pointer to an array of n public keys to scan (cannot be
+ *                       NULL)
+ *           n:          the number of points
+ *           scankey:    a 32-byte secret scalar to multiply the points with
+ *                       (cannot be NULL)
+ *           spendkey:   the public key that the tweaks are added to (cannot be
+ *                       NULL)
+ *           outputs:    pointer to an array of noutputs public keys to match
+ *                       against (cannot be NULL)
+ *           noutputs:   the number of output keys
+ *
+ *  The multiplications by scankey are constant time. If an output key occurs
+ *  more than once, any one of its indices may be reported.
+ */
+SECP256K1_API size_t secp256k1_ecdh_scan(
+  const secp256k1_context* ctx,
+  size_t *matches,
+  const secp256k1_pubkey *points,
+  size_t n,
+  const unsigned char *scankey,
+  const secp256k1_pubkey *spendkey,
+  const secp256k1_pubkey *outputs,
+  size_t noutputs
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(5) SECP256K1_ARG_NONNULL(6) SECP256K1_ARG_NONNULL(7);
+
 # ifdef __cplusplus
 }
 # endif
@@ -0,0 +1,214 @@
+#ifndef _SECP256K1_HASH_API_
+# define _SECP256K1_HASH_API_
+
+# include "secp256k1.h"
+
+# ifdef __cplusplus
+extern "C" {
+# endif
+
+/** The state of a SHA-256 computation.
+ *
+ *  The exact representation of data is internal. The structure may be copied
+ *  freely: a copy continues the computation independently of the original,
+ *  which is the cheapest way to reuse a common prefix within one process.
+ *  To store a prefix beyond that, use secp256k1_hash_sha256_get_midstate.
+ *
+ *  All hashing functions use the fastest SHA-256 code for the CPU the process
+ *  runs on. The choice is made once for the whole process, not per context.
+ */
+typedef struct {
+    unsigned char data[104];
+} secp256k1_hash_sha256;
+
+/** The state of an HMAC-SHA256 computation. Copyable like secp256k1_hash_sha256. */
+typedef struct {
+    unsigned char data[208];
+} secp256k1_hash_hmac_sha256;
+
+/** Start a SHA-256 computation.
+ *
+ *  Returns: 1 always.
+ *  Args:    ctx:       pointer to a context object (cannot be NULL)
+ *  Out:     hash:      pointer to the state to initialize (cannot be NULL)
+ */
+SECP256K1_API int secp256k1_hash_sha256_initialize(
+    const secp256k1_context* ctx,
+    secp256k1_hash_sha256 *hash
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Start a tagged hash, SHA256(SHA256(tag) || SHA256(tag) || ...).
+ *
+ *  The 64-byte prefix fills exactly one block, so the state after it is a
+ *  midstate: callers hashing many messages under one tag should compute it
+ *  once and copy it, or save it with secp256k1_hash_sha256_get_midstate.
+ *
+ *  Returns: 1 always.
+ *  Args:    ctx:       pointer to a context object (cannot be NULL)
+ *  Out:     hash:      pointer to the state to initialize (cannot be NULL)
+ *  In:      tag:       pointer to the tag (cannot be NULL unless taglen is 0)
+ *           taglen:    the length of the tag in bytes
+ */
+SECP256K1_API int secp256k1_hash_sha256_initialize_tagged(
+    const secp256k1_context* ctx,
+    secp256k1_hash_sha256 *hash,
+    const unsigned char *tag,
+    size_t taglen
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Add data to a SHA-256 computation.
+ *
+ *  Returns: 1 always.
+ *  Args:    ctx:       pointer to a context object (cannot be NULL)
+ *  In/Out:  hash:      pointer to the state (cannot be NULL)
+ *  In:      data:      pointer to the data (cannot be NULL unless len is 0)
+ *           len:       the length of the data in bytes
+ */
+SECP256K1_API int secp256k1_hash_sha256_write(
+    const secp256k1_context* ctx,
+    secp256k1_hash_sha256 *hash,
+    const unsigned char *data,
+    size_t len
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Finish a SHA-256 computation. The state must be initialized again before
+ *  it is reused.
+ *
+ *  Returns: 1 always.
+ *  Args:    ctx:       pointer to a context object (cannot be NULL)
+ *  In/Out:  hash:      pointer to the state (cannot be NULL)
+ *  Out:     out32:     pointer to a 32-byte array for the hash (cannot be NULL)
+ */
+SECP256K1_API int secp256k1_hash_sha256_finalize(
+    const secp256k1_context* ctx,
+    secp256k1_hash_sha256 *hash,
+    unsigned char *out32
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Export the midstate of a SHA-256 computation.
+ *
+ *  This is only possible after a multiple of 64 bytes has been written, when
+ *  the state consists of the eight chaining words alone.
+ *
+ *  Returns: 1 if the midstate was exported.
+ *           0 if the number of bytes written is not a multiple of 64.
+ *  Args:    ctx:        pointer to a context object (cannot be NULL)
+ *  Out:     midstate32: pointer to a 32-byte array for the chaining words,
+ *                       big endian (cannot be NULL)
+ *           bytes:      pointer to the number of bytes written so far
+ *                       (cannot be NULL)
+ *  In:      hash:       pointer to the state (cannot be NULL)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_hash_sha256_get_midstate(
+    const secp256k1_context* ctx,
+    unsigned char *midstate32,
+    size_t *bytes,
+    const secp256k1_hash_sha256 *hash
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
+
+/** Continue a SHA-256 computation from an exported midstate.
+ *
+ *  Returns: 1 if the state was set.
+ *           0 if bytes is not a multiple of 64.
+ *  Args:    ctx:        pointer to a context object (cannot be NULL)
+ *  Out:     hash:       pointer to the state to set (cannot be NULL)
+ *  In:      midstate32: pointer to the 32-byte midstate (cannot be NULL)
+ *           bytes:      the number of bytes hashed into the midstate
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_hash_sha256_set_midstate(
+    const secp256k1_context* ctx,
+    secp256k1_hash_sha256 *hash,
+    const unsigned char *midstate32,
+    size_t bytes
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Compute the double SHA-256 hash SHA256(SHA256(data)) of a message.
+ *
+ *  Returns: 1 always.
+ *  Args:    ctx:       pointer to a context object (cannot be NULL)
+ *  Out:     out32:     pointer to a 32-byte array for the hash (cannot be NULL)
+ *  In:      data:      pointer to the message (cannot be NULL unless len is 0)
+ *           len:       the length of the message in bytes
+ */
+SECP256K1_API int secp256k1_hash_sha256d(
+    const secp256k1_context* ctx,
+    unsigned char *out32,
+    const unsigned char *data,
+    size_t len
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Compute the SHA-256 hashes of an array of messages of equal length.
+ *
+ *  Several messages are hashed at once where the CPU allows it, which is
+ *  considerably faster than hashing them one by one when they are short.
+ *
+ *  Returns: 1 always.
+ *  Args:    ctx:       pointer to a context object (cannot be NULL)
+ *  Out:     out:       pointer to an array of 32*n bytes; hash i is written
+ *                      to out + 32*i (cannot be NULL unless n is 0)
+ *  In:      in:        pointer to the n messages of len bytes each, stored
+ *                      back to back (cannot be NULL unless n*len is 0)
+ *           len:       the length of each message in bytes
+ *           n:         the number of messages
+ *           doubled:   if nonzero, compute SHA256(SHA256(message)) instead
+ *
+ *  The output may not overlap the input.
+ */
+SECP256K1_API int secp256k1_hash_sha256_batch(
+    const secp256k1_context* ctx,
+    unsigned char *out,
+    const unsigned char *in,
+    size_t len,
+    size_t n,
+    int doubled
+) SECP256K1_ARG_NONNULL(1);
+
+/** Start an HMAC-SHA256 computation.
+ *
+ *  Returns: 1 always.
+ *  Args:    ctx:       pointer to a context object (cannot be NULL)
+ *  Out:     hash:      pointer to the state to initialize (cannot be NULL)
+ *  In:      key:       pointer to the key (cannot be NULL unless keylen is 0)
+ *           keylen:    the length of the key in bytes
+ */
+SECP256K1_API int secp256k1_hash_hmac_sha256_initialize(
+    const secp256k1_context* ctx,
+    secp256k1_hash_hmac_sha256 *hash,
+    const unsigned char *key,
+    size_t keylen
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Add data to an HMAC-SHA256 computation.
+ *
+ *  Returns: 1 always.
+ *  Args:    ctx:       pointer to a context object (cannot be NULL)
+ *  In/Out:  hash:      pointer to the state (cannot be NULL)
+ *  In:      data:      pointer to the data (cannot be NULL unless len is 0)
+ *           len:       the length of the data in bytes
+ */
+SECP256K1_API int secp256k1_hash_hmac_sha256_write(
+    const secp256k1_context* ctx,
+    secp256k1_hash_hmac_sha256 *hash,
+    const unsigned char *data,
+    size_t len
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Finish an HMAC-SHA256 computation. The state, which depends on the key,
+ *  is cleared.
+ *
+ *  Returns: 1 always.
+ *  Args:    ctx:       pointer to a context object (cannot be NULL)
+ *  In/Out:  hash:      pointer to the state (cannot be NULL)
+ *  Out:     out32:     pointer to a 32-byte array for the MAC (cannot be NULL)
+ */
+SECP256K1_API int secp256k1_hash_hmac_sha256_finalize(
+    const secp256k1_context* ctx,
+    secp256k1_hash_hmac_sha256 *hash,
+    unsigned char *out32
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+# ifdef __cplusplus
+}
+# endif
+
+#endif
@@ -103,6 +103,61 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdsa_recover(
     const unsigned char *msg32
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
 
+/** Recover the ECDSA public keys of a batch of signatures.
+ *
+ *  Returns: the number of public keys successfully recovered.
+ *  Args:    ctx:        pointer to a context object, initialized for verification (cannot be NULL)
+ *  Out:     pubkeys:    pointer to an array of n public keys. Entry i receives the key recovered
+ *                       from the i'th signature, or is cleared if recovery failed (cannot be NULL)
+ *           valid:      pointer to an array of n bytes, receiving 1 for every signature whose
+ *                       key was recovered and 0 otherwise (can be NULL)
+ *  In:      sigs:       pointer to an array of n signatures that support pubkey recovery (cannot be NULL)
+ *           msg32s:     pointer to n 32-byte message hashes, stored back to back (cannot be NULL)
+ *           n:          the number of signatures
+ *
+ *  Every entry gives the same result as secp256k1_ecdsa_recover, but the
+ *  modular inversions are shared across the batch.
+ */
+SECP256K1_API size_t secp256k1_ecdsa_recover_batch(
+    const secp256k1_context* ctx,
+    secp256k1_pubkey *pubkeys,
+    unsigned char *valid,
+    const secp256k1_ecdsa_recoverable_signature *sigs,
+    const unsigned char *msg32s,
+    size_t n
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(4) SECP256K1_ARG_NONNULL(5);
+
+/** Verify a list of ECDSA signatures against an ordered list of public keys,
+ *  in the manner of Bitcoin's OP_CHECKMULTISIG.
+ *
+ *  Returns: 1: every signature is valid (as in secp256k1_ecdsa_verify) for its
+ *              message under a different public key, and the keys used appear
+ *              in the same order as the signatures.
+ *           0: otherwise.
+ *  Args:    ctx:        pointer to a context object, initialized for verification (cannot be NULL)
+ *  Out:     matches:    pointer to an array of nsigs indices, receiving for every signature the
+ *                       index of the public key it was matched to (can be NULL). Only meaningful
+ *                       when 1 is returned.
+ *  In:      sigs:       pointer to an array of nsigs signatures (cannot be NULL)
+ *           msg32s:     pointer to nsigs 32-byte message hashes, stored back to back (cannot be NULL)
+ *           nsigs:      the number of signatures
+ *           pubkeys:    pointer to an array of npubkeys public keys (cannot be NULL)
+ *           npubkeys:   the number of public keys
+ *
+ *  Instead of trying every remaining key, the candidate signer keys of every
+ *  signature are reconstructed with the pubkey recovery equations, so the
+ *  cost is about one verification per signature regardless of npubkeys.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdsa_verify_multisig(
+    const secp256k1_context* ctx,
+    size_t *matches,
+    const secp256k1_ecdsa_signature *sigs,
+    const unsigned char *msg32s,
+    size_t nsigs,
+    const secp256k1_pubkey *pubkeys,
+    size_t npubkeys
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4) SECP256K1_ARG_NONNULL(6);
+
 # ifdef __cplusplus
 }
 # endif
@@ -68,6 +68,32 @@ SECP256K1_API int secp256k1_schnorr_recover(
   const unsigned char *msg32
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
 
+/** Recover the EC public keys of a batch of Schnorr signatures created using
+ *  secp256k1_schnorr_sign.
+ *  Returns: the number of public keys successfully recovered.
+ *  Args:    ctx:        pointer to a context object, initialized for
+ *                       verification (cannot be NULL)
+ *  Out:     pubkeys:    pointer to an array of n pubkeys. Entry i is set to
+ *                       the key recovered from the i'th signature, or cleared
+ *                       if recovery failed (cannot be NULL).
+ *           valid:      pointer to an array of n bytes, receiving 1 for every
+ *                       signature whose key was recovered and 0 otherwise
+ *                       (can be NULL).
+ *  In:      sig64s:     n signatures of 64 bytes each, stored back to back
+ *                       (cannot be NULL)
+ *           msg32s:     n 32-byte message hashes, stored back to back
+ *                       (cannot be NULL)
+ *           n:          the number of signatures
+ */
+SECP256K1_API size_t secp256k1_schnorr_recover_batch(
+  const secp256k1_context* ctx,
+  secp256k1_pubkey *pubkeys,
+  unsigned char *valid,
+  const unsigned char *sig64s,
+  const unsigned char *msg32s,
+  size_t n
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(4) SECP256K1_ARG_NONNULL(5);
+
 /** Generate a nonce pair deterministically for use with
  *  secp256k1_schnorr_partial_sign.
  *  Returns: 1: valid nonce pair was generated.
@@ -0,0 +1,102 @@
+#ifndef _SECP256K1_VERIFYQUEUE_
+# define _SECP256K1_VERIFYQUEUE_
+
+# include "secp256k1.h"
+
+# ifdef __cplusplus
+extern "C" {
+# endif
+
+/** Opaque data structure that holds a bounded queue of ECDSA verification jobs.
+ *
+ *  Any number of threads may push jobs into a queue and any number of threads
+ *  may process them, concurrently and without locks. The library never starts
+ *  threads itself: jobs are only processed by threads calling
+ *  secp256k1_verify_queue_work.
+ */
+typedef struct secp256k1_verify_queue_struct secp256k1_verify_queue;
+
+/** A pointer to a function that is called when a job has been processed.
+ *
+ *  It is called on the thread that processed the job, with the data pointer
+ *  passed to secp256k1_verify_queue_push and the result of the verification
+ *  (1 for a valid signature, 0 otherwise).
+ */
+typedef void (*secp256k1_verify_queue_callback)(void *data, int result);
+
+/** Value of a job's status word while the job has not been processed yet. */
+#define SECP256K1_VERIFY_QUEUE_PENDING (-1)
+
+/** Create a verification queue.
+ *
+ *  Returns: a newly created queue object, or NULL if capacity is invalid.
+ *  Args:    ctx:      pointer to a context object, initialized for
+ *                     verification (cannot be NULL). It must not be
+ *                     destroyed before the queue is.
+ *  In:      capacity: the maximum number of jobs waiting in the queue at
+ *                     any time. Must be a power of two, and at least 2.
+ *           callback: function to call for every processed job (can be NULL).
+ */
+SECP256K1_API secp256k1_verify_queue* secp256k1_verify_queue_create(
+    const secp256k1_context* ctx,
+    size_t capacity,
+    secp256k1_verify_queue_callback callback
+) SECP256K1_ARG_NONNULL(1);
+
+/** Destroy a verification queue.
+ *
+ *  No other thread may be using the queue. Jobs that were still waiting are
+ *  dropped without being processed.
+ *  Args:    queue:    the queue to destroy (can be NULL).
+ */
+SECP256K1_API void secp256k1_verify_queue_destroy(
+    secp256k1_verify_queue* queue
+);
+
+/** Add an ECDSA verification job to a queue.
+ *
+ *  Returns: 1: the job was queued.
+ *           0: the queue is full. The caller should process some jobs (or
+ *              wait for other threads to) and try again.
+ *  Args:    queue:    the queue (cannot be NULL).
+ *  In:      sig:      the signature being verified (cannot be NULL).
+ *           msg32:    the 32-byte message hash being verified (cannot be NULL).
+ *           pubkey:   pointer to an initialized public key to verify with
+ *                     (cannot be NULL).
+ *  Out:     status:   pointer to a status word (can be NULL). It is set to
+ *                     SECP256K1_VERIFY_QUEUE_PENDING when the job is queued,
+ *                     and to the result of secp256k1_ecdsa_verify once the job
+ *                     has been processed. Read it through a volatile pointer.
+ *  In:      data:     pointer passed to the queue's callback for this job.
+ *
+ *  The signature, message and public key are copied into the queue.
+ */
+SECP256K1_API int secp256k1_verify_queue_push(
+    secp256k1_verify_queue* queue,
+    const secp256k1_ecdsa_signature *sig,
+    const unsigned char *msg32,
+    const secp256k1_pubkey *pubkey,
+    int *status,
+    void *data
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
+
+/** Process jobs from a queue on the calling thread.
+ *
+ *  Returns: the number of jobs processed, which is less than max_jobs only if
+ *           the queue ran empty.
+ *  Args:    queue:    the queue (cannot be NULL).
+ *  In:      max_jobs: the maximum number of jobs to process.
+ *
+ *  Any number of threads may call this at the same time; idle threads take
+ *  over the jobs that would otherwise wait behind busy ones.
+ */
+SECP256K1_API size_t secp256k1_verify_queue_work(
+    secp256k1_verify_queue* queue,
+    size_t max_jobs
+) SECP256K1_ARG_NONNULL(1);
+
+# ifdef __cplusplus
+}
+# endif
+
+#endif
@@ -7,14 +7,173 @@
 #ifndef _SECP256K1_BENCH_H_
 #define _SECP256K1_BENCH_H_
 
+/* The monotonic clock, CPU pinning and hardware counters are POSIX and Linux
+ * interfaces that strict C89 mode hides, so this header has to be included
+ * before any system header. */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <math.h>
+#include <time.h>
 #include "sys/time.h"
 
+#if defined(__linux__)
+#include <sched.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+/* The harness is configured through the environment, so that every bench
+ * program behaves the same without parsing its own options:
+ *  SECP256K1_BENCH_FORMAT  "text" (default), "json" (one object per line) or "csv"
+ *  SECP256K1_BENCH_RUNS    number of timed runs per benchmark, if more than the program's default
+ *  SECP256K1_BENCH_CPU     index of the CPU to pin the process to (Linux only)
+ *  SECP256K1_BENCH_PERF    if set to 1, also count core cycles and instructions (Linux perf events)
+ *
+ * Every benchmark gets one untimed warmup run. Runs outside Tukey's fences
+ * (1.5 interquartile ranges beyond the quartiles) are left out of the mean and
+ * standard deviation, but not out of the min, max and percentiles. */
+
+#define BENCH_FORMAT_TEXT 0
+#define BENCH_FORMAT_JSON 1
+#define BENCH_FORMAT_CSV  2
+
+typedef struct {
+    int initialized;
+    int format;
+    int runs;
+    int csv_header;
+    int perf_fd;   /* group leader counting cycles, or -1 */
+    int perf_inst; /* member counting instructions, or -1 */
+} bench_harness;
+
+static bench_harness bench_state = {0, BENCH_FORMAT_TEXT, 0, 0, -1, -1};
+
 static double gettimedouble(void) {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return tv.tv_usec * 0.000001 + tv.tv_sec;
+#if defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0) {
+        return ts.tv_nsec * 0.000000001 + ts.tv_sec;
+    }
+#endif
+    {
+        struct timeval tv;
+        gettimeofday(&tv, NULL);
+        return tv.tv_usec * 0.000001 + tv.tv_sec;
+    }
+}
+
+/* The time stamp counter, which ticks at a constant reference rate, or 0 where there is none. */
+static unsigned long long bench_ticks(void) {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    unsigned int lo, hi;
+    __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((unsigned long long)hi << 32) | lo;
+#else
+    return 0;
+#endif
+}
+
+#if defined(__linux__)
+static int bench_perf_open(unsigned long long config, int group) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.disabled = group < 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+}
+#endif
+
+static void bench_init(void) {
+    const char *env;
+    if (bench_state.initialized) {
+        return;
+    }
+    bench_state.initialized = 1;
+    env = getenv("SECP256K1_BENCH_FORMAT");
+    if (env != NULL && strcmp(env, "json") == 0) {
+        bench_state.format = BENCH_FORMAT_JSON;
+    } else if (env != NULL && strcmp(env, "csv") == 0) {
+        bench_state.format = BENCH_FORMAT_CSV;
+    }
+    env = getenv("SECP256K1_BENCH_RUNS");
+    if (env != NULL) {
+        bench_state.runs = atoi(env);
+    }
+#if defined(__linux__)
+    env = getenv("SECP256K1_BENCH_CPU");
+    if (env != NULL) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(atoi(env), &set);
+        if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+            fprintf(stderr, "warning: could not pin to CPU %s\n", env);
+        }
+    }
+    env = getenv("SECP256K1_BENCH_PERF");
+    if (env != NULL && strcmp(env, "1") == 0) {
+        bench_state.perf_fd = bench_perf_open(PERF_COUNT_HW_CPU_CYCLES, -1);
+        if (bench_state.perf_fd >= 0) {
+            bench_state.perf_inst = bench_perf_open(PERF_COUNT_HW_INSTRUCTIONS, bench_state.perf_fd);
+        }
+        if (bench_state.perf_fd < 0 || bench_state.perf_inst < 0) {
+            fprintf(stderr, "warning: hardware counters are not available\n");
+        }
+    }
+#endif
+}
+
+/* Read the counter group into counts[0] (cycles) and counts[1] (instructions). */
+static int bench_perf_read(unsigned long long *counts) {
+#if defined(__linux__)
+    unsigned long long buf[3];
+    if (bench_state.perf_inst >= 0 && read(bench_state.perf_fd, buf, sizeof(buf)) == (ssize_t)sizeof(buf) && buf[0] == 2) {
+        counts[0] = buf[1];
+        counts[1] = buf[2];
+        return 1;
+    }
+#endif
+    (void)counts;
+    return 0;
+}
+
+static int bench_cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* The bench programs are not linked with libm, so the standard deviation uses Newton's method. */
+static double bench_sqrt(double x) {
+    double r = x > 1.0 ? x : 1.0;
+    int i;
+    if (x <= 0.0) {
+        return 0.0;
+    }
+    for (i = 0; i < 64; i++) {
+        r = 0.5 * (r + x / r);
+    }
+    return r;
+}
+
+/* The p'th percentile of n sorted values, interpolating between closest ranks. */
+static double bench_percentile(const double *sorted, int n, double p) {
+    double rank = p * (n - 1);
+    int lo = (int)rank;
+    if (lo >= n - 1) {
+        return sorted[n - 1];
+    }
+    return sorted[lo] + (rank - lo) * (sorted[lo + 1] - sorted[lo]);
 }
 
 void print_number(double x) {
@@ -31,36 +190,132 @@ void print_number(double x) {
 }
 
 void run_benchmark(char *name, void (*benchmark)(void*), void (*setup)(void*), void (*teardown)(void*), void* data, int count, int iter) {
-    int i;
-    double min = HUGE_VAL;
-    double sum = 0.0;
-    double max = 0.0;
-    for (i = 0; i < count; i++) {
+    double *us, *sorted, *ticks, *cycles, *insts;
+    double q1, q3, lo, hi, mean = 0.0, var = 0.0;
+    int i, kept = 0, perf = 1;
+
+    bench_init();
+    if (bench_state.runs > count) {
+        count = bench_state.runs;
+    }
+    us = (double *)malloc(5 * count * sizeof(double));
+    if (us == NULL) {
+        fprintf(stderr, "%s: out of memory\n", name);
+        return;
+    }
+    sorted = us + count;
+    ticks = us + 2 * count;
+    cycles = us + 3 * count;
+    insts = us + 4 * count;
+#if defined(__linux__)
+    if (bench_state.perf_inst >= 0) {
+        ioctl(bench_state.perf_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+
+    for (i = -1; i < count; i++) {
         double begin, total;
+        unsigned long long tsc, pc0[2] = {0, 0}, pc1[2] = {0, 0};
+        int have_perf;
         if (setup != NULL) {
             setup(data);
         }
+        have_perf = bench_perf_read(pc0);
+        tsc = bench_ticks();
         begin = gettimedouble();
         benchmark(data);
         total = gettimedouble() - begin;
+        tsc = bench_ticks() - tsc;
+        have_perf = have_perf && bench_perf_read(pc1);
         if (teardown != NULL) {
             teardown(data);
         }
-        if (total < min) {
-            min = total;
+        if (i < 0) {
+            /* The warmup run fills the caches and lets the clock settle. */
+            continue;
         }
-        if (total > max) {
-            max = total;
+        us[i] = total * 1000000.0 / iter;
+        ticks[i] = (double)tsc / iter;
+        if (have_perf) {
+            cycles[i] = (double)(pc1[0] - pc0[0]) / iter;
+            insts[i] = (double)(pc1[1] - pc0[1]) / iter;
+        } else {
+            perf = 0;
         }
-        sum += total;
-    }
-    printf("%s: min ", name);
-    print_number(min * 1000000.0 / iter);
-    printf("us / avg ");
-    print_number((sum / count) * 1000000.0 / iter);
-    printf("us / max ");
-    print_number(max * 1000000.0 / iter);
-    printf("us\n");
+    }
+
+    memcpy(sorted, us, count * sizeof(double));
+    qsort(sorted, count, sizeof(double), bench_cmp_double);
+    q1 = bench_percentile(sorted, count, 0.25);
+    q3 = bench_percentile(sorted, count, 0.75);
+    lo = q1 - 1.5 * (q3 - q1);
+    hi = q3 + 1.5 * (q3 - q1);
+    for (i = 0; i < count; i++) {
+        if (us[i] >= lo && us[i] <= hi) {
+            mean += us[i];
+            kept++;
+        }
+    }
+    mean /= kept;
+    for (i = 0; i < count; i++) {
+        if (us[i] >= lo && us[i] <= hi) {
+            var += (us[i] - mean) * (us[i] - mean);
+        }
+    }
+    var = kept > 1 ? var / (kept - 1) : 0.0;
+    /* The counters are reported for the median run. */
+    qsort(ticks, count, sizeof(double), bench_cmp_double);
+    if (perf) {
+        qsort(cycles, count, sizeof(double), bench_cmp_double);
+        qsort(insts, count, sizeof(double), bench_cmp_double);
+    }
+
+    if (bench_state.format == BENCH_FORMAT_JSON) {
+        printf("{\"name\": \"%s\", \"iters\": %d, \"runs\": %d, \"outliers\": %d, ", name, iter, count, count - kept);
+        printf("\"min_us\": %g, \"mean_us\": %g, \"stddev_us\": %g, \"p50_us\": %g, \"p99_us\": %g, \"max_us\": %g",
+               sorted[0], mean, bench_sqrt(var), bench_percentile(sorted, count, 0.5), bench_percentile(sorted, count, 0.99), sorted[count - 1]);
+        if (bench_ticks() != 0) {
+            printf(", \"ticks\": %g", bench_percentile(ticks, count, 0.5));
+        }
+        if (perf) {
+            printf(", \"cycles\": %g, \"instructions\": %g", bench_percentile(cycles, count, 0.5), bench_percentile(insts, count, 0.5));
+        }
+        printf("}\n");
+    } else if (bench_state.format == BENCH_FORMAT_CSV) {
+        if (!bench_state.csv_header) {
+            printf("name,iters,runs,outliers,min_us,mean_us,stddev_us,p50_us,p99_us,max_us,ticks,cycles,instructions\n");
+            bench_state.csv_header = 1;
+        }
+        printf("%s,%d,%d,%d,%g,%g,%g,%g,%g,%g,", name, iter, count, count - kept,
+               sorted[0], mean, bench_sqrt(var), bench_percentile(sorted, count, 0.5), bench_percentile(sorted, count, 0.99), sorted[count - 1]);
+        if (bench_ticks() != 0) {
+            printf("%g", bench_percentile(ticks, count, 0.5));
+        }
+        if (perf) {
+            printf(",%g,%g\n", bench_percentile(cycles, count, 0.5), bench_percentile(insts, count, 0.5));
+        } else {
+            printf(",,\n");
+        }
+    } else {
+        printf("%s: min ", name);
+        print_number(sorted[0]);
+        printf("us / avg ");
+        print_number(mean);
+        printf("us / max ");
+        print_number(sorted[count - 1]);
+        printf("us / p50 ");
+        print_number(bench_percentile(sorted, count, 0.5));
+        printf("us / p99 ");
+        print_number(bench_percentile(sorted, count, 0.99));
+        printf("us");
+        if (perf) {
+            printf(" / %.0f cycles / %.0f instructions", bench_percentile(cycles, count, 0.5), bench_percentile(insts, count, 0.5));
+        } else if (bench_ticks() != 0) {
+            printf(" / %.0f ticks", bench_percentile(ticks, count, 0.5));
+        }
+        printf("\n");
+    }
+    free(us);
 }
 
 #endif
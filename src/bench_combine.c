@@ -0,0 +1,79 @@
+/**********************************************************************
+ * Copyright (c) 2014-2015 Pieter Wuille                              *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "include/secp256k1.h"
+#include "util.h"
+
+#define MAX_KEYS 1000000
+
+typedef struct {
+    secp256k1_context *ctx;
+    secp256k1_pubkey *pubkeys;
+    const secp256k1_pubkey **pubkeyptrs;
+    size_t n;
+    int reps;
+} bench_combine_t;
+
+static void bench_combine(void* arg) {
+    int i;
+    bench_combine_t *data = (bench_combine_t*)arg;
+    secp256k1_pubkey sum;
+
+    for (i = 0; i < data->reps; i++) {
+        CHECK(secp256k1_ec_pubkey_combine(data->ctx, &sum, data->pubkeyptrs, data->n));
+    }
+}
+
+static void bench_combine_var(void* arg) {
+    int i;
+    bench_combine_t *data = (bench_combine_t*)arg;
+    secp256k1_pubkey sum;
+
+    for (i = 0; i < data->reps; i++) {
+        CHECK(secp256k1_ec_pubkey_combine_var(data->ctx, &sum, data->pubkeys, data->n));
+    }
+}
+
+int main(void) {
+    bench_combine_t data;
+    unsigned char seckey[32];
+    unsigned char *ser;
+    char name[64];
+    size_t i;
+
+    data.ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
+    data.pubkeys = (secp256k1_pubkey*)malloc(MAX_KEYS * sizeof(secp256k1_pubkey));
+    data.pubkeyptrs = (const secp256k1_pubkey**)malloc(MAX_KEYS * sizeof(secp256k1_pubkey*));
+    ser = (unsigned char*)malloc(MAX_KEYS * 33);
+    for (i = 0; i < 32; i++) {
+        seckey[i] = i + 1;
+    }
+    CHECK(secp256k1_ec_pubkey_create_range(data.ctx, ser, seckey, MAX_KEYS, SECP256K1_EC_COMPRESSED));
+    CHECK(secp256k1_ec_pubkey_parse_batch(data.ctx, data.pubkeys, NULL, ser, 33, MAX_KEYS) == MAX_KEYS);
+    for (i = 0; i < MAX_KEYS; i++) {
+        data.pubkeyptrs[i] = &data.pubkeys[i];
+    }
+    free(ser);
+
+    /* Every run adds up about a million keys in total; times are per call. */
+    for (data.n = 10; data.n <= MAX_KEYS; data.n *= 10) {
+        data.reps = MAX_KEYS / data.n;
+        sprintf(name, "ec_pubkey_combine_%lu", (unsigned long)data.n);
+        run_benchmark(name, bench_combine, NULL, NULL, &data, 10, data.reps);
+        sprintf(name, "ec_pubkey_combine_var_%lu", (unsigned long)data.n);
+        run_benchmark(name, bench_combine_var, NULL, NULL, &data, 10, data.reps);
+    }
+
+    free(data.pubkeyptrs);
+    free(data.pubkeys);
+    secp256k1_context_destroy(data.ctx);
+    return 0;
+}
@@ -4,12 +4,13 @@
  * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
  **********************************************************************/
 
+#include "bench.h"
+
 #include <string.h>
 
 #include "include/secp256k1.h"
 #include "include/secp256k1_ecdh.h"
 #include "util.h"
-#include "bench.h"
 
 typedef struct {
     secp256k1_context *ctx;
@@ -28,7 +29,7 @@ static void bench_ecdh_setup(void* arg) {
         0xa2, 0xba, 0xd1, 0x84, 0xf8, 0x83, 0xc6, 0x9f
     };
 
-    data->ctx = secp256k1_context_create(0);
+    data->ctx = secp256k1_context_create(SECP256K1_CONTEXT_NONE);
     for (i = 0; i < 32; i++) {
         data->scalar[i] = i + 1;
     }
@@ -45,9 +46,64 @@ static void bench_ecdh(void* arg) {
     }
 }
 
+#define SCAN_POINTS 20000
+
+typedef struct {
+    secp256k1_context *ctx;
+    secp256k1_pubkey points[SCAN_POINTS];
+    secp256k1_pubkey spendkey;
+    secp256k1_pubkey output;
+    unsigned char scankey[32];
+    size_t matches[SCAN_POINTS];
+} bench_ecdh_scan_t;
+
+static void bench_ecdh_scan_setup(void* arg) {
+    int i;
+    static unsigned char ser[SCAN_POINTS * 33];
+    bench_ecdh_scan_t *data = (bench_ecdh_scan_t*)arg;
+
+    data->ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY);
+    for (i = 0; i < 32; i++) {
+        data->scankey[i] = i + 1;
+        ser[i] = i + 33;
+    }
+    CHECK(secp256k1_ec_pubkey_create(data->ctx, &data->spendkey, ser) == 1);
+    CHECK(secp256k1_ec_pubkey_create(data->ctx, &data->output, data->scankey) == 1);
+    CHECK(secp256k1_ec_pubkey_create_range(data->ctx, ser, ser, SCAN_POINTS, SECP256K1_EC_COMPRESSED) == 1);
+    CHECK(secp256k1_ec_pubkey_parse_batch(data->ctx, data->points, NULL, ser, 33, SCAN_POINTS) == SCAN_POINTS);
+}
+
+static void bench_ecdh_scan_teardown(void* arg) {
+    bench_ecdh_scan_t *data = (bench_ecdh_scan_t*)arg;
+
+    secp256k1_context_destroy(data->ctx);
+}
+
+static void bench_ecdh_scan_separate(void* arg) {
+    int i;
+    unsigned char tweak[32];
+    bench_ecdh_scan_t *data = (bench_ecdh_scan_t*)arg;
+
+    for (i = 0; i < SCAN_POINTS; i++) {
+        secp256k1_pubkey derived = data->spendkey;
+        CHECK(secp256k1_ecdh(data->ctx, tweak, &data->points[i], data->scankey) == 1);
+        CHECK(secp256k1_ec_pubkey_tweak_add(data->ctx, &derived, tweak) == 1);
+        CHECK(memcmp(&derived, &data->output, sizeof(derived)) != 0);
+    }
+}
+
+static void bench_ecdh_scan(void* arg) {
+    bench_ecdh_scan_t *data = (bench_ecdh_scan_t*)arg;
+
+    CHECK(secp256k1_ecdh_scan(data->ctx, data->matches, data->points, SCAN_POINTS, data->scankey, &data->spendkey, &data->output, 1) == 0);
+}
+
 int main(void) {
     bench_ecdh_t data;
+    static bench_ecdh_scan_t scan_data;
 
     run_benchmark("ecdh", bench_ecdh, bench_ecdh_setup, NULL, &data, 10, 20000);
+    run_benchmark("ecdh_scan_separate", bench_ecdh_scan_separate, bench_ecdh_scan_setup, bench_ecdh_scan_teardown, &scan_data, 10, SCAN_POINTS);
+    run_benchmark("ecdh_scan", bench_ecdh_scan, bench_ecdh_scan_setup, bench_ecdh_scan_teardown, &scan_data, 10, SCAN_POINTS);
     return 0;
 }
@@ -3,6 +3,8 @@
  * Distributed under the MIT software license, see the accompanying   *
  * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
  **********************************************************************/
+#include "bench.h"
+
 #include <stdio.h>
 
 #include "include/secp256k1.h"
@@ -15,7 +17,6 @@
 #include "scalar_impl.h"
 #include "ecmult_const_impl.h"
 #include "ecmult_impl.h"
-#include "bench.h"
 #include "secp256k1.c"
 
 typedef struct {
@@ -24,7 +25,19 @@ typedef struct {
     secp256k1_ge ge_x, ge_y;
     secp256k1_gej gej_x, gej_y;
     unsigned char data[64];
+    unsigned char hashes[2][40 * 32];
     int wnaf[256];
+    secp256k1_ecmult_wnaf_digit wnaf_digits[ECMULT_WNAF_MAX_DIGITS(256, WINDOW_A)];
+    secp256k1_ecmult_state ecmult_state;
+#ifdef USE_AVX2
+    secp256k1_fe_x4 fe_x4_x, fe_x4_y;
+    secp256k1_ge_x4 ge_x4_y;
+    secp256k1_gej_x4 gej_x4_x;
+#endif
+#ifdef USE_AVX512IFMA
+    secp256k1_fe_x8 fe_x8_x, fe_x8_y;
+#endif
+    secp256k1_fe fe_batch[64];
 } bench_inv_t;
 
 void bench_setup(void* arg) {
@@ -54,6 +67,45 @@ void bench_setup(void* arg) {
     secp256k1_gej_set_ge(&data->gej_y, &data->ge_y);
     memcpy(data->data, init_x, 32);
     memcpy(data->data + 32, init_y, 32);
+    memset(data->hashes, 0x5a, sizeof(data->hashes));
+#ifdef USE_AVX2
+    if (secp256k1_cpu_has(SECP256K1_CPU_AVX2)) {
+        secp256k1_fe fe_x[4], fe_y[4];
+        secp256k1_ge ge_x[4], ge_y[4];
+        secp256k1_ge_x4 ge_x4_x;
+        int i;
+        for (i = 0; i < 4; i++) {
+            fe_x[i] = data->fe_x;
+            fe_y[i] = data->fe_y;
+            ge_x[i] = data->ge_x;
+            ge_y[i] = data->ge_y;
+        }
+        secp256k1_fe_x4_set_fe(&data->fe_x4_x, fe_x);
+        secp256k1_fe_x4_set_fe(&data->fe_x4_y, fe_y);
+        secp256k1_ge_x4_set_ge(&ge_x4_x, ge_x);
+        secp256k1_ge_x4_set_ge(&data->ge_x4_y, ge_y);
+        secp256k1_gej_x4_set_ge(&data->gej_x4_x, &ge_x4_x);
+    }
+#endif
+#ifdef USE_AVX512IFMA
+    if (secp256k1_cpu_has(SECP256K1_CPU_AVX512IFMA)) {
+        secp256k1_fe fe_x[8], fe_y[8];
+        int i;
+        for (i = 0; i < 8; i++) {
+            fe_x[i] = data->fe_x;
+            fe_y[i] = data->fe_y;
+        }
+        secp256k1_fe_x8_set_fe(&data->fe_x8_x, fe_x);
+        secp256k1_fe_x8_set_fe(&data->fe_x8_y, fe_y);
+    }
+#endif
+    {
+        int i;
+        data->fe_batch[0] = data->fe_x;
+        for (i = 1; i < 64; i++) {
+            secp256k1_fe_mul(&data->fe_batch[i], &data->fe_batch[i - 1], &data->fe_y);
+        }
+    }
 }
 
 void bench_scalar_add(void* arg) {
@@ -181,6 +233,20 @@ void bench_field_inverse_var(void* arg) {
     }
 }
 
+/* Reports the time per element of a batch of 64. */
+void bench_field_inverse_all_var(void* arg) {
+    int i;
+    bench_inv_t *data = (bench_inv_t*)arg;
+    secp256k1_fe r[64];
+
+    for (i = 0; i < 2000; i++) {
+        secp256k1_fe_inv_all_var(64, r, data->fe_batch);
+        secp256k1_fe_add(&data->fe_batch[i & 63], &r[i & 63]);
+        /* Keep the inputs at magnitude 1, as the multiplications require. */
+        secp256k1_fe_normalize_weak(&data->fe_batch[i & 63]);
+    }
+}
+
 void bench_field_sqrt_var(void* arg) {
     int i;
     bench_inv_t *data = (bench_inv_t*)arg;
@@ -191,6 +257,18 @@ void bench_field_sqrt_var(void* arg) {
     }
 }
 
+void bench_field_is_quad_var(void* arg) {
+    int i, j = 0;
+    bench_inv_t *data = (bench_inv_t*)arg;
+
+    for (i = 0; i < 20000; i++) {
+        j += secp256k1_fe_is_quad_var(&data->fe_x);
+        secp256k1_fe_add(&data->fe_x, &data->fe_y);
+        secp256k1_fe_normalize_var(&data->fe_x);
+    }
+    CHECK(j <= 20000);
+}
+
 void bench_group_double_var(void* arg) {
     int i;
     bench_inv_t *data = (bench_inv_t*)arg;
@@ -218,6 +296,18 @@ void bench_group_add_affine(void* arg) {
     }
 }
 
+void bench_group_add_affine_complete(void* arg) {
+    int i;
+    bench_inv_t *data = (bench_inv_t*)arg;
+    secp256k1_gep p;
+
+    secp256k1_gep_set_gej(&p, &data->gej_x);
+    for (i = 0; i < 200000; i++) {
+        secp256k1_gep_add_ge(&p, &p, &data->ge_y);
+    }
+    secp256k1_gej_set_gep(&data->gej_x, &p);
+}
+
 void bench_group_add_affine_var(void* arg) {
     int i;
     bench_inv_t *data = (bench_inv_t*)arg;
@@ -227,16 +317,144 @@ void bench_group_add_affine_var(void* arg) {
     }
 }
 
+void bench_ecmult_const(void* arg) {
+    int i;
+    bench_inv_t *data = (bench_inv_t*)arg;
+
+    for (i = 0; i < 2000; i++) {
+        secp256k1_ecmult_const(&data->gej_x, &data->ge_x, &data->scalar_x);
+        secp256k1_scalar_add(&data->scalar_x, &data->scalar_x, &data->scalar_y);
+    }
+}
+
+#ifdef USE_AVX2
+/* The four-lane benchmarks do a quarter of the iterations, so they report the time per lane. */
+void bench_field_mul_x4(void* arg) {
+    int i;
+    bench_inv_t *data = (bench_inv_t*)arg;
+
+    for (i = 0; i < 50000; i++) {
+        secp256k1_fe_x4_mul(&data->fe_x4_x, &data->fe_x4_x, &data->fe_x4_y);
+    }
+}
+
+void bench_field_sqr_x4(void* arg) {
+    int i;
+    bench_inv_t *data = (bench_inv_t*)arg;
+
+    for (i = 0; i < 50000; i++) {
+        secp256k1_fe_x4_sqr(&data->fe_x4_x, &data->fe_x4_x);
+    }
+}
+
+void bench_group_double_x4(void* arg) {
+    int i;
+    bench_inv_t *data = (bench_inv_t*)arg;
+
+    for (i = 0; i < 50000; i++) {
+        secp256k1_gej_x4_double_nonzero(&data->gej_x4_x, &data->gej_x4_x);
+    }
+}
+
+void bench_group_add_affine_x4(void* arg) {
+    int i;
+    bench_inv_t *data = (bench_inv_t*)arg;
+
+    for (i = 0; i < 50000; i++) {
+        secp256k1_gej_x4_add_ge(&data->gej_x4_x, &data->gej_x4_x, &data->ge_x4_y);
+    }
+}
+
+void bench_ecmult_const_x4(void* arg) {
+    int i, j;
+    bench_inv_t *data = (bench_inv_t*)arg;
+    secp256k1_ge a[4];
+    secp256k1_scalar q[4];
+    secp256k1_gej r[4];
+
+    for (j = 0; j < 4; j++) {
+        a[j] = data->ge_x;
+    }
+    for (i = 0; i < 500; i++) {
+        for (j = 0; j < 4; j++) {
+            q[j] = data->scalar_x;
+            secp256k1_scalar_add(&data->scalar_x, &data->scalar_x, &data->scalar_y);
+        }
+        secp256k1_ecmult_const_x4(r, a, q);
+    }
+    data->gej_x = r[0];
+}
+#endif
+
+#ifdef USE_AVX512IFMA
+/* Likewise an eighth of the iterations for the eight-lane one. */
+void bench_field_mul_x8(void* arg) {
+    int i;
+    bench_inv_t *data = (bench_inv_t*)arg;
+
+    for (i = 0; i < 25000; i++) {
+        secp256k1_fe_x8_mul(&data->fe_x8_x, &data->fe_x8_x, &data->fe_x8_y);
+    }
+}
+#endif
+
 void bench_ecmult_wnaf(void* arg) {
     int i;
     bench_inv_t *data = (bench_inv_t*)arg;
 
     for (i = 0; i < 20000; i++) {
-        secp256k1_ecmult_wnaf(data->wnaf, 256, &data->scalar_x, WINDOW_A);
+        secp256k1_ecmult_wnaf(data->wnaf_digits, 256, &data->scalar_x, WINDOW_A);
+        secp256k1_scalar_add(&data->scalar_x, &data->scalar_x, &data->scalar_y);
+    }
+}
+
+void bench_ecmult_recode(void* arg) {
+    int i;
+    bench_inv_t *data = (bench_inv_t*)arg;
+
+    for (i = 0; i < 20000; i++) {
+        secp256k1_ecmult_state_init(&data->ecmult_state, &data->scalar_x, &data->scalar_y);
         secp256k1_scalar_add(&data->scalar_x, &data->scalar_x, &data->scalar_y);
     }
 }
 
+/* Print the size of the table of multiples of A that secp256k1_ecmult builds, and the average
+ * number of additions its main loop does from it and from the G tables. */
+void print_ecmult_ops(bench_inv_t *data) {
+    int i;
+    double adds_a = 0.0, adds_g = 0.0;
+#ifdef USE_ECMULT_JSF
+    const int table_a = ECMULT_JSF_TABLE_SIZE;
+#elif defined(USE_ENDOMORPHISM)
+    const int table_a = 2 * ECMULT_TABLE_SIZE(WINDOW_A);
+#else
+    const int table_a = ECMULT_TABLE_SIZE(WINDOW_A);
+#endif
+
+    bench_setup(data);
+    for (i = 0; i < 1000; i++) {
+        secp256k1_ecmult_state_init(&data->ecmult_state, &data->scalar_x, &data->scalar_y);
+#ifdef USE_ENDOMORPHISM
+#ifdef USE_ECMULT_JSF
+        adds_a += data->ecmult_state.n_jsf_na;
+#else
+        adds_a += data->ecmult_state.n_na_1 + data->ecmult_state.n_na_lam;
+#endif
+        adds_g += data->ecmult_state.n_ng_1 + data->ecmult_state.n_ng_128;
+#else
+        adds_a += data->ecmult_state.n_na;
+        adds_g += data->ecmult_state.n_ng;
+#endif
+        secp256k1_scalar_add(&data->scalar_x, &data->scalar_x, &data->scalar_y);
+        secp256k1_scalar_mul(&data->scalar_y, &data->scalar_y, &data->scalar_x);
+    }
+    printf("ecmult_ops: %d-point A table / ", table_a);
+    print_number(adds_a / 1000);
+    printf(" A additions / ");
+    print_number(adds_g / 1000);
+    printf(" G additions\n");
+}
+
 void bench_wnaf_const(void* arg) {
     int i;
     bench_inv_t *data = (bench_inv_t*)arg;
@@ -260,6 +478,16 @@ void bench_sha256(void* arg) {
     }
 }
 
+void bench_sha256_batch(void* arg) {
+    int i;
+    bench_inv_t *data = (bench_inv_t*)arg;
+
+    /* 40 messages of 32 bytes per call, reported per message. */
+    for (i = 0; i < 500; i++) {
+        secp256k1_sha256_batch(data->hashes[~i & 1], data->hashes[i & 1], 32, 40);
+    }
+}
+
 void bench_hmac_sha256(void* arg) {
     int i;
     bench_inv_t *data = (bench_inv_t*)arg;
@@ -317,6 +545,8 @@ int have_flag(int argc, char** argv, char *flag) {
 
 int main(int argc, char **argv) {
     bench_inv_t data;
+    /* Use the same code paths as a context would. */
+    secp256k1_cpu_detect();
     if (have_flag(argc, argv, "scalar") || have_flag(argc, argv, "add")) run_benchmark("scalar_add", bench_scalar_add, bench_setup, NULL, &data, 10, 2000000);
     if (have_flag(argc, argv, "scalar") || have_flag(argc, argv, "negate")) run_benchmark("scalar_negate", bench_scalar_negate, bench_setup, NULL, &data, 10, 2000000);
     if (have_flag(argc, argv, "scalar") || have_flag(argc, argv, "sqr")) run_benchmark("scalar_sqr", bench_scalar_sqr, bench_setup, NULL, &data, 10, 200000);
@@ -333,17 +563,39 @@ int main(int argc, char **argv) {
     if (have_flag(argc, argv, "field") || have_flag(argc, argv, "mul")) run_benchmark("field_mul", bench_field_mul, bench_setup, NULL, &data, 10, 200000);
     if (have_flag(argc, argv, "field") || have_flag(argc, argv, "inverse")) run_benchmark("field_inverse", bench_field_inverse, bench_setup, NULL, &data, 10, 20000);
     if (have_flag(argc, argv, "field") || have_flag(argc, argv, "inverse")) run_benchmark("field_inverse_var", bench_field_inverse_var, bench_setup, NULL, &data, 10, 20000);
+    if (have_flag(argc, argv, "field") || have_flag(argc, argv, "inverse")) run_benchmark("field_inverse_all_var", bench_field_inverse_all_var, bench_setup, NULL, &data, 10, 128000);
     if (have_flag(argc, argv, "field") || have_flag(argc, argv, "sqrt")) run_benchmark("field_sqrt_var", bench_field_sqrt_var, bench_setup, NULL, &data, 10, 20000);
+    if (have_flag(argc, argv, "field") || have_flag(argc, argv, "quad")) run_benchmark("field_is_quad_var", bench_field_is_quad_var, bench_setup, NULL, &data, 10, 20000);
 
     if (have_flag(argc, argv, "group") || have_flag(argc, argv, "double")) run_benchmark("group_double_var", bench_group_double_var, bench_setup, NULL, &data, 10, 200000);
     if (have_flag(argc, argv, "group") || have_flag(argc, argv, "add")) run_benchmark("group_add_var", bench_group_add_var, bench_setup, NULL, &data, 10, 200000);
     if (have_flag(argc, argv, "group") || have_flag(argc, argv, "add")) run_benchmark("group_add_affine", bench_group_add_affine, bench_setup, NULL, &data, 10, 200000);
     if (have_flag(argc, argv, "group") || have_flag(argc, argv, "add")) run_benchmark("group_add_affine_var", bench_group_add_affine_var, bench_setup, NULL, &data, 10, 200000);
+    if (have_flag(argc, argv, "group") || have_flag(argc, argv, "add")) run_benchmark("group_add_affine_complete", bench_group_add_affine_complete, bench_setup, NULL, &data, 10, 200000);
 
     if (have_flag(argc, argv, "ecmult") || have_flag(argc, argv, "wnaf")) run_benchmark("wnaf_const", bench_wnaf_const, bench_setup, NULL, &data, 10, 20000);
     if (have_flag(argc, argv, "ecmult") || have_flag(argc, argv, "wnaf")) run_benchmark("ecmult_wnaf", bench_ecmult_wnaf, bench_setup, NULL, &data, 10, 20000);
+    if (have_flag(argc, argv, "ecmult") || have_flag(argc, argv, "recode")) run_benchmark("ecmult_recode", bench_ecmult_recode, bench_setup, NULL, &data, 10, 20000);
+    if (have_flag(argc, argv, "ecmult") || have_flag(argc, argv, "ops")) print_ecmult_ops(&data);
+    if (have_flag(argc, argv, "ecmult") || have_flag(argc, argv, "const")) run_benchmark("ecmult_const", bench_ecmult_const, bench_setup, NULL, &data, 10, 2000);
+
+#ifdef USE_AVX2
+    if (secp256k1_cpu_has(SECP256K1_CPU_AVX2)) {
+        if (have_flag(argc, argv, "x4") || have_flag(argc, argv, "field") || have_flag(argc, argv, "mul")) run_benchmark("field_mul_x4", bench_field_mul_x4, bench_setup, NULL, &data, 10, 200000);
+        if (have_flag(argc, argv, "x4") || have_flag(argc, argv, "field") || have_flag(argc, argv, "sqr")) run_benchmark("field_sqr_x4", bench_field_sqr_x4, bench_setup, NULL, &data, 10, 200000);
+        if (have_flag(argc, argv, "x4") || have_flag(argc, argv, "group") || have_flag(argc, argv, "double")) run_benchmark("group_double_x4", bench_group_double_x4, bench_setup, NULL, &data, 10, 200000);
+        if (have_flag(argc, argv, "x4") || have_flag(argc, argv, "group") || have_flag(argc, argv, "add")) run_benchmark("group_add_affine_x4", bench_group_add_affine_x4, bench_setup, NULL, &data, 10, 200000);
+        if (have_flag(argc, argv, "x4") || have_flag(argc, argv, "ecmult") || have_flag(argc, argv, "const")) run_benchmark("ecmult_const_x4", bench_ecmult_const_x4, bench_setup, NULL, &data, 10, 2000);
+    }
+#endif
+#ifdef USE_AVX512IFMA
+    if (secp256k1_cpu_has(SECP256K1_CPU_AVX512IFMA)) {
+        if (have_flag(argc, argv, "x8") || have_flag(argc, argv, "field") || have_flag(argc, argv, "mul")) run_benchmark("field_mul_x8", bench_field_mul_x8, bench_setup, NULL, &data, 10, 200000);
+    }
+#endif
 
     if (have_flag(argc, argv, "hash") || have_flag(argc, argv, "sha256")) run_benchmark("hash_sha256", bench_sha256, bench_setup, NULL, &data, 10, 20000);
+    if (have_flag(argc, argv, "hash") || have_flag(argc, argv, "sha256")) run_benchmark("hash_sha256_batch", bench_sha256_batch, bench_setup, NULL, &data, 10, 20000);
     if (have_flag(argc, argv, "hash") || have_flag(argc, argv, "hmac")) run_benchmark("hash_hmac_sha256", bench_hmac_sha256, bench_setup, NULL, &data, 10, 20000);
     if (have_flag(argc, argv, "hash") || have_flag(argc, argv, "rng6979")) run_benchmark("hash_rfc6979_hmac_sha256", bench_rfc6979_hmac_sha256, bench_setup, NULL, &data, 10, 20000);
 
@@ -4,15 +4,23 @@
  * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
  **********************************************************************/
 
+#include "bench.h"
+
+#include <string.h>
+
 #include "include/secp256k1.h"
 #include "include/secp256k1_recovery.h"
 #include "util.h"
-#include "bench.h"
+
+#define BATCH_SIGS 20000
 
 typedef struct {
     secp256k1_context *ctx;
     unsigned char msg[32];
     unsigned char sig[64];
+    secp256k1_ecdsa_recoverable_signature *sigs;
+    unsigned char *msgs;
+    secp256k1_pubkey *pubkeys;
 } bench_recover_t;
 
 void bench_recover(void* arg) {
@@ -48,13 +56,50 @@ void bench_recover_setup(void* arg) {
     }
 }
 
+void bench_recover_batch(void* arg) {
+    bench_recover_t *data = (bench_recover_t*)arg;
+
+    CHECK(secp256k1_ecdsa_recover_batch(data->ctx, data->pubkeys, NULL, data->sigs, data->msgs, BATCH_SIGS) == BATCH_SIGS);
+}
+
+void bench_recover_batch_setup(void* arg) {
+    int i;
+    bench_recover_t *data = (bench_recover_t*)arg;
+    secp256k1_pubkey pubkey;
+    unsigned char pubkeyc[33];
+
+    /* Generate the same chain of signatures as bench_recover does. */
+    bench_recover_setup(arg);
+    for (i = 0; i < BATCH_SIGS; i++) {
+        int j;
+        size_t pubkeylen = 33;
+        CHECK(secp256k1_ecdsa_recoverable_signature_parse_compact(data->ctx, &data->sigs[i], data->sig, i % 2));
+        memcpy(&data->msgs[i * 32], data->msg, 32);
+        CHECK(secp256k1_ecdsa_recover(data->ctx, &pubkey, &data->sigs[i], data->msg));
+        CHECK(secp256k1_ec_pubkey_serialize(data->ctx, pubkeyc, &pubkeylen, &pubkey, SECP256K1_EC_COMPRESSED));
+        for (j = 0; j < 32; j++) {
+            data->sig[j + 32] = data->msg[j];
+            data->msg[j] = data->sig[j];
+            data->sig[j] = pubkeyc[j + 1];
+        }
+    }
+}
+
 int main(void) {
     bench_recover_t data;
 
     data.ctx = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
+    data.sigs = (secp256k1_ecdsa_recoverable_signature*)malloc(BATCH_SIGS * sizeof(secp256k1_ecdsa_recoverable_signature));
+    data.msgs = (unsigned char*)malloc(BATCH_SIGS * 32);
+    data.pubkeys = (secp256k1_pubkey*)malloc(BATCH_SIGS * sizeof(secp256k1_pubkey));
 
     run_benchmark("ecdsa_recover", bench_recover, bench_recover_setup, NULL, &data, 10, 20000);
+    bench_recover_batch_setup(&data);
+    run_benchmark("ecdsa_recover_batch", bench_recover_batch, NULL, NULL, &data, 10, BATCH_SIGS);
 
+    free(data.pubkeys);
+    free(data.msgs);
+    free(data.sigs);
     secp256k1_context_destroy(data.ctx);
     return 0;
 }
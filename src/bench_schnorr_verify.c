@@ -4,13 +4,14 @@
  * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
  **********************************************************************/
 
+#include "bench.h"
+
 #include <stdio.h>
 #include <string.h>
 
 #include "include/secp256k1.h"
 #include "include/secp256k1_schnorr.h"
 #include "util.h"
-#include "bench.h"
 
 typedef struct {
     unsigned char key[32];
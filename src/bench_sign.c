@@ -4,9 +4,10 @@
  * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
  **********************************************************************/
 
+#include "bench.h"
+
 #include "include/secp256k1.h"
 #include "util.h"
-#include "bench.h"
 
 typedef struct {
     secp256k1_context* ctx;
@@ -4,12 +4,13 @@
  * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
  **********************************************************************/
 
+#include "bench.h"
+
 #include <stdio.h>
 #include <string.h>
 
 #include "include/secp256k1.h"
 #include "util.h"
-#include "bench.h"
 
 #ifdef ENABLE_OPENSSL_TESTS
 #include <openssl/bn.h>
@@ -49,6 +50,21 @@ static void benchmark_verify(void* arg) {
     }
 }
 
+static void benchmark_verify_der(void* arg) {
+    int i;
+    benchmark_verify_t* data = (benchmark_verify_t*)arg;
+
+    for (i = 0; i < 20000; i++) {
+        data->sig[data->siglen - 1] ^= (i & 0xFF);
+        data->sig[data->siglen - 2] ^= ((i >> 8) & 0xFF);
+        data->sig[data->siglen - 3] ^= ((i >> 16) & 0xFF);
+        CHECK(secp256k1_ecdsa_verify_der(data->ctx, data->sig, data->siglen, data->msg, data->pubkey, data->pubkeylen, 1) == (i == 0));
+        data->sig[data->siglen - 1] ^= (i & 0xFF);
+        data->sig[data->siglen - 2] ^= ((i >> 8) & 0xFF);
+        data->sig[data->siglen - 3] ^= ((i >> 16) & 0xFF);
+    }
+}
+
 #ifdef ENABLE_OPENSSL_TESTS
 static void benchmark_verify_openssl(void* arg) {
     int i;
@@ -101,6 +117,7 @@ int main(void) {
     CHECK(secp256k1_ec_pubkey_serialize(data.ctx, data.pubkey, &data.pubkeylen, &pubkey, SECP256K1_EC_COMPRESSED) == 1);
 
     run_benchmark("ecdsa_verify", benchmark_verify, NULL, NULL, &data, 10, 20000);
+    run_benchmark("ecdsa_verify_der", benchmark_verify_der, NULL, NULL, &data, 10, 20000);
 #ifdef ENABLE_OPENSSL_TESTS
     data.ec_group = EC_GROUP_new_by_curve_name(NID_secp256k1);
     run_benchmark("ecdsa_verify_openssl", benchmark_verify_openssl, NULL, NULL, &data, 10, 20000);
@@ -0,0 +1,33 @@
+/**********************************************************************
+ * Copyright (c) 2016 libsecp256k1 contributors                       *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_CPU_
+#define _SECP256K1_CPU_
+
+#if defined HAVE_CONFIG_H
+#include "libsecp256k1-config.h"
+#endif
+
+/* Instruction set extensions that code paths are selected by at runtime. */
+#define SECP256K1_CPU_BMI2 (1 << 0) /* mulx */
+#define SECP256K1_CPU_ADX  (1 << 1) /* adcx, adox */
+#define SECP256K1_CPU_AVX2 (1 << 2) /* 256-bit integer vectors, with OS support for the ymm state */
+#define SECP256K1_CPU_AVX512IFMA (1 << 3) /* AVX-512F and vpmadd52luq/huq, with OS support for the zmm state */
+#define SECP256K1_CPU_SHA  (1 << 4) /* sha256rnds2, sha256msg1/2, and the SSSE3 and SSE4.1 shuffles used around them */
+
+/** Detect the features of the CPU this is running on. This is called on
+ *  context creation, so a single binary picks the fastest code paths on
+ *  every machine it runs on. Only the first call detects anything: the
+ *  features, and with them the code paths, are shared by the whole process
+ *  rather than chosen per context. */
+static void secp256k1_cpu_detect(void);
+
+/** Check whether all of the given features were detected. Until
+ *  secp256k1_cpu_detect is called, no features are, so the code paths used
+ *  work on any CPU. */
+static int secp256k1_cpu_has(int features);
+
+#endif
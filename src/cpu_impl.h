@@ -0,0 +1,84 @@
+/**********************************************************************
+ * Copyright (c) 2016 libsecp256k1 contributors                       *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_CPU_IMPL_H_
+#define _SECP256K1_CPU_IMPL_H_
+
+#include "util.h"
+#include "cpu.h"
+
+/* The features found by secp256k1_cpu_detect, a combination of SECP256K1_CPU_* flags. */
+static int secp256k1_cpu_features = 0;
+
+#if defined(USE_ASM_X86_64)
+/* Whether secp256k1_cpu_detect has run, after which the features are only read. */
+static int secp256k1_cpu_detected = 0;
+
+static void secp256k1_cpuid(uint32_t leaf, uint32_t subleaf, uint32_t *a, uint32_t *b, uint32_t *c, uint32_t *d) {
+    __asm__ __volatile__("cpuid" : "=a"(*a), "=b"(*b), "=c"(*c), "=d"(*d) : "a"(leaf), "c"(subleaf));
+}
+
+/* Read extended control register 0, which tells which register state the OS saves. */
+static uint32_t secp256k1_xgetbv0(void) {
+    uint32_t a, d;
+    __asm__ __volatile__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+    return a;
+}
+#endif
+
+static void secp256k1_cpu_detect(void) {
+#if defined(USE_ASM_X86_64)
+    uint32_t a, b, c, d;
+    uint32_t max;
+    int ymm = 0, zmm = 0, sse41 = 0;
+    int features = 0;
+
+    if (secp256k1_cpu_detected) {
+        return;
+    }
+    secp256k1_cpuid(0, 0, &max, &b, &c, &d);
+    if (max >= 1) {
+        /* AVX code may only run if the OS saves the xmm and ymm state (OSXSAVE and AVX set, XCR0 bits 1 and 2),
+         * and AVX-512 code only if it saves the opmask and zmm state too (XCR0 bits 5 to 7). */
+        secp256k1_cpuid(1, 0, &a, &b, &c, &d);
+        sse41 = (c & (1UL << 9)) && (c & (1UL << 19));
+        if ((c & (1UL << 27)) && (c & (1UL << 28))) {
+            uint32_t xcr0 = secp256k1_xgetbv0();
+            ymm = (xcr0 & 6) == 6;
+            zmm = (xcr0 & 0xE6) == 0xE6;
+        }
+    }
+    if (max >= 7) {
+        /* Structured extended feature flags. */
+        secp256k1_cpuid(7, 0, &a, &b, &c, &d);
+        if (b & (1 << 8)) {
+            features |= SECP256K1_CPU_BMI2;
+        }
+        if (b & (1 << 19)) {
+            features |= SECP256K1_CPU_ADX;
+        }
+        if (ymm && (b & (1 << 5))) {
+            features |= SECP256K1_CPU_AVX2;
+        }
+        if (zmm && (b & (1UL << 16)) && (b & (1UL << 21))) {
+            features |= SECP256K1_CPU_AVX512IFMA;
+        }
+        if (sse41 && (b & (1UL << 29))) {
+            features |= SECP256K1_CPU_SHA;
+        }
+    }
+    /* Only concurrent first calls can get here together, and they all store
+     * the same value. */
+    secp256k1_cpu_features = features;
+    secp256k1_cpu_detected = 1;
+#endif
+}
+
+SECP256K1_INLINE static int secp256k1_cpu_has(int features) {
+    return (secp256k1_cpu_features & features) == features;
+}
+
+#endif
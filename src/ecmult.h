@@ -25,6 +25,90 @@ static void secp256k1_ecmult_context_clone(secp256k1_ecmult_context *dst,
 static void secp256k1_ecmult_context_clear(secp256k1_ecmult_context *ctx);
 static int secp256k1_ecmult_context_is_built(const secp256k1_ecmult_context *ctx);
 
+/* optimal for 128-bit and 256-bit exponents. */
+#define WINDOW_A 5
+
+/** larger numbers may result in slightly better performance, at the cost of
+    exponentially larger precomputed tables. */
+#ifdef USE_ENDOMORPHISM
+/** Two tables for window size 15: 1.375 MiB. */
+#define WINDOW_G 15
+#else
+/** One table for window size 16: 1.375 MiB. */
+#define WINDOW_G 16
+#endif
+
+/** The number of entries a table with precomputed multiples needs to have. */
+#define ECMULT_TABLE_SIZE(w) (1 << ((w)-2))
+
+/** A nonzero wNAF digit, and the bit position it is at. */
+typedef struct {
+    int pos;
+    int digit;
+} secp256k1_ecmult_wnaf_digit;
+
+/** The largest number of nonzero digits a wNAF of a len-bit number with window w can have. */
+#define ECMULT_WNAF_MAX_DIGITS(len, w) (((len) + (w) - 1) / (w))
+
+#ifdef USE_ECMULT_JSF
+#ifndef USE_ENDOMORPHISM
+#error "USE_ECMULT_JSF requires USE_ENDOMORPHISM"
+#endif
+/** With USE_ECMULT_JSF, na_1 and na_lam are recoded together in joint sparse form, whose
+ *  columns select from a table of A, lambda*A, A+lambda*A and A-lambda*A (and their
+ *  negations). This replaces the two WINDOW_A tables and wNAFs. */
+#define ECMULT_JSF_TABLE_SIZE 4
+#endif
+
+/** The state of a double multiply in progress, so it can be done in steps. The digits of each
+ *  wNAF are stored from the least significant one up, and the main loop consumes them from the
+ *  top, so n_* counts the digits still to be added. */
+typedef struct {
+#ifdef USE_ECMULT_JSF
+    secp256k1_ge pre_jsf[ECMULT_JSF_TABLE_SIZE];
+#else
+    secp256k1_ge pre_a[ECMULT_TABLE_SIZE(WINDOW_A)];
+#endif
+    secp256k1_fe Z;
+#ifdef USE_ENDOMORPHISM
+#ifdef USE_ECMULT_JSF
+    secp256k1_ecmult_wnaf_digit jsf_na[131];
+    int n_jsf_na;
+#else
+    secp256k1_ge pre_a_lam[ECMULT_TABLE_SIZE(WINDOW_A)];
+    secp256k1_ecmult_wnaf_digit wnaf_na_1[ECMULT_WNAF_MAX_DIGITS(130, WINDOW_A)];
+    secp256k1_ecmult_wnaf_digit wnaf_na_lam[ECMULT_WNAF_MAX_DIGITS(130, WINDOW_A)];
+    int n_na_1;
+    int n_na_lam;
+#endif
+    secp256k1_ecmult_wnaf_digit wnaf_ng_1[ECMULT_WNAF_MAX_DIGITS(129, WINDOW_G)];
+    int n_ng_1;
+    secp256k1_ecmult_wnaf_digit wnaf_ng_128[ECMULT_WNAF_MAX_DIGITS(129, WINDOW_G)];
+    int n_ng_128;
+#else
+    secp256k1_ecmult_wnaf_digit wnaf_na[ECMULT_WNAF_MAX_DIGITS(256, WINDOW_A)];
+    int n_na;
+    secp256k1_ecmult_wnaf_digit wnaf_ng[ECMULT_WNAF_MAX_DIGITS(256, WINDOW_G)];
+    int n_ng;
+#endif
+    /* The number of main loop iterations left, and the partial result. */
+    int bits;
+    secp256k1_gej r;
+} secp256k1_ecmult_state;
+
+/** Start a double multiply na*A + ng*G, by computing the wNAF representations of na and ng. */
+static void secp256k1_ecmult_state_init(secp256k1_ecmult_state *st, const secp256k1_scalar *na, const secp256k1_scalar *ng);
+
+/** Compute the table of odd multiples of A for a double multiply. */
+static void secp256k1_ecmult_state_table(secp256k1_ecmult_state *st, const secp256k1_gej *a);
+
+/** Run up to iterations iterations of the main loop of a double multiply.
+ *  Returns 1 when no iterations are left. */
+static int secp256k1_ecmult_state_run(const secp256k1_ecmult_context *ctx, secp256k1_ecmult_state *st, int iterations);
+
+/** Get the result of a double multiply whose main loop completed. */
+static void secp256k1_ecmult_state_finish(secp256k1_ecmult_state *st, secp256k1_gej *r);
+
 /** Double multiply: R = na*A + ng*G */
 static void secp256k1_ecmult(const secp256k1_ecmult_context *ctx, secp256k1_gej *r, const secp256k1_gej *a, const secp256k1_scalar *na, const secp256k1_scalar *ng);
 
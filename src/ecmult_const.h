@@ -9,7 +9,14 @@
 
 #include "scalar.h"
 #include "group.h"
+#include "group_x4.h"
 
 static void secp256k1_ecmult_const(secp256k1_gej *r, const secp256k1_ge *a, const secp256k1_scalar *q);
 
+#ifdef USE_AVX2
+/** Compute r[j] = q[j]*a[j] for j = 0..3 like secp256k1_ecmult_const, running
+ *  the four multiplications in lockstep on AVX2 lanes. */
+static SECP256K1_TARGET_AVX2 void secp256k1_ecmult_const_x4(secp256k1_gej *r, const secp256k1_ge *a, const secp256k1_scalar *q);
+#endif
+
 #endif
@@ -11,6 +11,7 @@
 #include "group.h"
 #include "ecmult_const.h"
 #include "ecmult_impl.h"
+#include "group_x4_impl.h"
 
 #ifdef USE_ENDOMORPHISM
     #define WNAF_BITS 128
@@ -122,23 +123,29 @@ static int secp256k1_wnaf_const(int *wnaf, secp256k1_scalar s, int w) {
 }
 
 
-static void secp256k1_ecmult_const(secp256k1_gej *r, const secp256k1_ge *a, const secp256k1_scalar *scalar) {
+/* The per-point state of a constant-time multiplication: the recoded scalar
+ * and the table of odd multiples, which share the denominator Z. */
+typedef struct {
     secp256k1_ge pre_a[ECMULT_TABLE_SIZE(WINDOW_A)];
-    secp256k1_ge tmpa;
     secp256k1_fe Z;
-
 #ifdef USE_ENDOMORPHISM
     secp256k1_ge pre_a_lam[ECMULT_TABLE_SIZE(WINDOW_A)];
     int wnaf_1[1 + WNAF_SIZE(WINDOW_A - 1)];
     int wnaf_lam[1 + WNAF_SIZE(WINDOW_A - 1)];
     int skew_1;
     int skew_lam;
-    secp256k1_scalar q_1, q_lam;
 #else
     int wnaf[1 + WNAF_SIZE(WINDOW_A - 1)];
+    int is_zero;
 #endif
+} secp256k1_ecmult_const_state;
 
+static void secp256k1_ecmult_const_prepare(secp256k1_ecmult_const_state *st, const secp256k1_ge *a, const secp256k1_scalar *scalar) {
+    secp256k1_gej aj;
     int i;
+#ifdef USE_ENDOMORPHISM
+    secp256k1_scalar q_1, q_lam;
+#endif
     secp256k1_scalar sc = *scalar;
 
     /* build wnaf representation for q. */
@@ -147,16 +154,16 @@ static void secp256k1_ecmult_const(secp256k1_gej *r, const secp256k1_ge *a, cons
     secp256k1_scalar_split_lambda(&q_1, &q_lam, &sc);
     /* no need for zero correction when using endomorphism since even
      * numbers have one added to them anyway */
-    skew_1   = secp256k1_wnaf_const(wnaf_1,   q_1,   WINDOW_A - 1);
-    skew_lam = secp256k1_wnaf_const(wnaf_lam, q_lam, WINDOW_A - 1);
+    st->skew_1   = secp256k1_wnaf_const(st->wnaf_1,   q_1,   WINDOW_A - 1);
+    st->skew_lam = secp256k1_wnaf_const(st->wnaf_lam, q_lam, WINDOW_A - 1);
 #else
-    int is_zero = secp256k1_scalar_is_zero(scalar);
+    st->is_zero = secp256k1_scalar_is_zero(scalar);
     /* the wNAF ladder cannot handle zero, so bump this to one .. we will
      * correct the result after the fact */
-    sc.d[0] += is_zero;
+    sc.d[0] += st->is_zero;
     VERIFY_CHECK(!secp256k1_scalar_is_zero(&sc));
 
-    secp256k1_wnaf_const(wnaf, sc, WINDOW_A - 1);
+    secp256k1_wnaf_const(st->wnaf, sc, WINDOW_A - 1);
 #endif
 
     /* Calculate odd multiples of a.
@@ -165,34 +172,83 @@ static void secp256k1_ecmult_const(secp256k1_gej *r, const secp256k1_ge *a, cons
      * that the Z coordinate was 1, use affine addition formulae, and correct
      * the Z coordinate of the result once at the end.
      */
-    secp256k1_gej_set_ge(r, a);
-    secp256k1_ecmult_odd_multiples_table_globalz_windowa(pre_a, &Z, r);
+    secp256k1_gej_set_ge(&aj, a);
+    secp256k1_ecmult_odd_multiples_table_globalz_windowa(st->pre_a, &st->Z, &aj);
     for (i = 0; i < ECMULT_TABLE_SIZE(WINDOW_A); i++) {
-        secp256k1_fe_normalize_weak(&pre_a[i].y);
+        secp256k1_fe_normalize_weak(&st->pre_a[i].y);
     }
 #ifdef USE_ENDOMORPHISM
     for (i = 0; i < ECMULT_TABLE_SIZE(WINDOW_A); i++) {
-        secp256k1_ge_mul_lambda(&pre_a_lam[i], &pre_a[i]);
+        secp256k1_ge_mul_lambda(&st->pre_a_lam[i], &st->pre_a[i]);
+    }
+#endif
+}
+
+/* Bring the result of the ladder back to the denominator of a and undo the
+ * adjustments the recoding made to the scalar. */
+static void secp256k1_ecmult_const_finish(secp256k1_gej *r, const secp256k1_ecmult_const_state *st, const secp256k1_ge *a) {
+    secp256k1_fe_mul(&r->z, &r->z, &st->Z);
+
+#ifdef USE_ENDOMORPHISM
+    {
+        /* Correct for wNAF skew */
+        secp256k1_ge correction = *a;
+        secp256k1_ge_storage correction_1_stor;
+        secp256k1_ge_storage correction_lam_stor;
+        secp256k1_ge_storage a2_stor;
+        secp256k1_gej tmpj;
+        secp256k1_gej_set_ge(&tmpj, &correction);
+        secp256k1_gej_double_var(&tmpj, &tmpj, NULL);
+        secp256k1_ge_set_gej(&correction, &tmpj);
+        secp256k1_ge_to_storage(&correction_1_stor, a);
+        secp256k1_ge_to_storage(&correction_lam_stor, a);
+        secp256k1_ge_to_storage(&a2_stor, &correction);
+
+        /* For odd numbers this is 2a (so replace it), for even ones a (so no-op) */
+        secp256k1_ge_storage_cmov(&correction_1_stor, &a2_stor, st->skew_1 == 2);
+        secp256k1_ge_storage_cmov(&correction_lam_stor, &a2_stor, st->skew_lam == 2);
+
+        /* Apply the correction */
+        secp256k1_ge_from_storage(&correction, &correction_1_stor);
+        secp256k1_ge_neg(&correction, &correction);
+        secp256k1_gej_add_ge(r, r, &correction);
+
+        secp256k1_ge_from_storage(&correction, &correction_lam_stor);
+        secp256k1_ge_neg(&correction, &correction);
+        secp256k1_ge_mul_lambda(&correction, &correction);
+        secp256k1_gej_add_ge(r, r, &correction);
     }
+#else
+    (void)a;
+    /* correct for zero */
+    r->infinity |= st->is_zero;
 #endif
+}
+
+static void secp256k1_ecmult_const(secp256k1_gej *r, const secp256k1_ge *a, const secp256k1_scalar *scalar) {
+    secp256k1_ecmult_const_state st;
+    secp256k1_ge tmpa;
+    int i;
+
+    secp256k1_ecmult_const_prepare(&st, a, scalar);
 
     /* first loop iteration (separated out so we can directly set r, rather
      * than having it start at infinity, get doubled several times, then have
      * its new value added to it) */
 #ifdef USE_ENDOMORPHISM
-    i = wnaf_1[WNAF_SIZE(WINDOW_A - 1)];
+    i = st.wnaf_1[WNAF_SIZE(WINDOW_A - 1)];
     VERIFY_CHECK(i != 0);
-    ECMULT_CONST_TABLE_GET_GE(&tmpa, pre_a, i, WINDOW_A);
+    ECMULT_CONST_TABLE_GET_GE(&tmpa, st.pre_a, i, WINDOW_A);
     secp256k1_gej_set_ge(r, &tmpa);
 
-    i = wnaf_lam[WNAF_SIZE(WINDOW_A - 1)];
+    i = st.wnaf_lam[WNAF_SIZE(WINDOW_A - 1)];
     VERIFY_CHECK(i != 0);
-    ECMULT_CONST_TABLE_GET_GE(&tmpa, pre_a_lam, i, WINDOW_A);
+    ECMULT_CONST_TABLE_GET_GE(&tmpa, st.pre_a_lam, i, WINDOW_A);
     secp256k1_gej_add_ge(r, r, &tmpa);
 #else
-    i = wnaf[WNAF_SIZE(WINDOW_A - 1)];
+    i = st.wnaf[WNAF_SIZE(WINDOW_A - 1)];
     VERIFY_CHECK(i != 0);
-    ECMULT_CONST_TABLE_GET_GE(&tmpa, pre_a, i, WINDOW_A);
+    ECMULT_CONST_TABLE_GET_GE(&tmpa, st.pre_a, i, WINDOW_A);
     secp256k1_gej_set_ge(r, &tmpa);
 #endif
     /* remaining loop iterations */
@@ -203,58 +259,132 @@ static void secp256k1_ecmult_const(secp256k1_gej *r, const secp256k1_ge *a, cons
             secp256k1_gej_double_nonzero(r, r, NULL);
         }
 #ifdef USE_ENDOMORPHISM
-        n = wnaf_1[i];
-        ECMULT_CONST_TABLE_GET_GE(&tmpa, pre_a, n, WINDOW_A);
+        n = st.wnaf_1[i];
+        ECMULT_CONST_TABLE_GET_GE(&tmpa, st.pre_a, n, WINDOW_A);
         VERIFY_CHECK(n != 0);
         secp256k1_gej_add_ge(r, r, &tmpa);
 
-        n = wnaf_lam[i];
-        ECMULT_CONST_TABLE_GET_GE(&tmpa, pre_a_lam, n, WINDOW_A);
+        n = st.wnaf_lam[i];
+        ECMULT_CONST_TABLE_GET_GE(&tmpa, st.pre_a_lam, n, WINDOW_A);
         VERIFY_CHECK(n != 0);
         secp256k1_gej_add_ge(r, r, &tmpa);
 #else
-        n = wnaf[i];
+        n = st.wnaf[i];
         VERIFY_CHECK(n != 0);
-        ECMULT_CONST_TABLE_GET_GE(&tmpa, pre_a, n, WINDOW_A);
+        ECMULT_CONST_TABLE_GET_GE(&tmpa, st.pre_a, n, WINDOW_A);
         secp256k1_gej_add_ge(r, r, &tmpa);
 #endif
     }
 
-    secp256k1_fe_mul(&r->z, &r->z, &Z);
+    secp256k1_ecmult_const_finish(r, &st, a);
+}
 
-#ifdef USE_ENDOMORPHISM
-    {
-        /* Correct for wNAF skew */
-        secp256k1_ge correction = *a;
-        secp256k1_ge_storage correction_1_stor;
-        secp256k1_ge_storage correction_lam_stor;
-        secp256k1_ge_storage a2_stor;
-        secp256k1_gej tmpj;
-        secp256k1_gej_set_ge(&tmpj, &correction);
-        secp256k1_gej_double_var(&tmpj, &tmpj, NULL);
-        secp256k1_ge_set_gej(&correction, &tmpj);
-        secp256k1_ge_to_storage(&correction_1_stor, a);
-        secp256k1_ge_to_storage(&correction_lam_stor, a);
-        secp256k1_ge_to_storage(&a2_stor, &correction);
+#ifdef USE_AVX2
+/* ECMULT_CONST_TABLE_GET_GE for four lanes: lane j of r is set to the odd
+ * multiple n[j] of the points in lane j of pre, in constant time. */
+static SECP256K1_TARGET_AVX2 void secp256k1_ecmult_const_table_get_ge_x4(secp256k1_ge_x4 *r, const secp256k1_ge_x4 *pre, const int *n) {
+    secp256k1_fe_x4 neg_y;
+    int idx_n[4];
+    int neg = 0;
+    int j, m;
+    for (j = 0; j < 4; j++) {
+        int abs_n = n[j] * ((n[j] > 0) * 2 - 1);
+        VERIFY_CHECK((n[j] & 1) == 1);
+        VERIFY_CHECK(n[j] >= -((1 << (WINDOW_A - 1)) - 1));
+        VERIFY_CHECK(n[j] <=  ((1 << (WINDOW_A - 1)) - 1));
+        idx_n[j] = abs_n / 2;
+        neg |= (n[j] != abs_n) << j;
+    }
+    *r = pre[0];
+    for (m = 1; m < ECMULT_TABLE_SIZE(WINDOW_A); m++) {
+        /* As in ECMULT_CONST_TABLE_GET_GE, every entry is read to avoid secret data in array indices. */
+        int flags = 0;
+        for (j = 0; j < 4; j++) {
+            flags |= (m == idx_n[j]) << j;
+        }
+        secp256k1_fe_x4_cmov(&r->x, &pre[m].x, flags);
+        secp256k1_fe_x4_cmov(&r->y, &pre[m].y, flags);
+    }
+    secp256k1_fe_x4_negate(&neg_y, &r->y, 1);
+    secp256k1_fe_x4_cmov(&r->y, &neg_y, neg);
+}
 
-        /* For odd numbers this is 2a (so replace it), for even ones a (so no-op) */
-        secp256k1_ge_storage_cmov(&correction_1_stor, &a2_stor, skew_1 == 2);
-        secp256k1_ge_storage_cmov(&correction_lam_stor, &a2_stor, skew_lam == 2);
+static SECP256K1_TARGET_AVX2 void secp256k1_ecmult_const_x4(secp256k1_gej *r, const secp256k1_ge *a, const secp256k1_scalar *scalar) {
+    secp256k1_ecmult_const_state st[4];
+    secp256k1_ge_x4 pre_a[ECMULT_TABLE_SIZE(WINDOW_A)];
+#ifdef USE_ENDOMORPHISM
+    secp256k1_ge_x4 pre_a_lam[ECMULT_TABLE_SIZE(WINDOW_A)];
+#endif
+    secp256k1_ge tmp[4];
+    secp256k1_ge_x4 tmpa;
+    secp256k1_gej_x4 rx;
+    int n[4];
+    int i, j;
 
-        /* Apply the correction */
-        secp256k1_ge_from_storage(&correction, &correction_1_stor);
-        secp256k1_ge_neg(&correction, &correction);
-        secp256k1_gej_add_ge(r, r, &correction);
+    for (j = 0; j < 4; j++) {
+        secp256k1_ecmult_const_prepare(&st[j], &a[j], &scalar[j]);
+    }
+    for (i = 0; i < ECMULT_TABLE_SIZE(WINDOW_A); i++) {
+        for (j = 0; j < 4; j++) {
+            tmp[j] = st[j].pre_a[i];
+        }
+        secp256k1_ge_x4_set_ge(&pre_a[i], tmp);
+#ifdef USE_ENDOMORPHISM
+        for (j = 0; j < 4; j++) {
+            tmp[j] = st[j].pre_a_lam[i];
+        }
+        secp256k1_ge_x4_set_ge(&pre_a_lam[i], tmp);
+#endif
+    }
 
-        secp256k1_ge_from_storage(&correction, &correction_lam_stor);
-        secp256k1_ge_neg(&correction, &correction);
-        secp256k1_ge_mul_lambda(&correction, &correction);
-        secp256k1_gej_add_ge(r, r, &correction);
+    /* The ladder of secp256k1_ecmult_const, with the four lanes in lockstep. */
+#ifdef USE_ENDOMORPHISM
+    for (j = 0; j < 4; j++) {
+        n[j] = st[j].wnaf_1[WNAF_SIZE(WINDOW_A - 1)];
+    }
+    secp256k1_ecmult_const_table_get_ge_x4(&tmpa, pre_a, n);
+    secp256k1_gej_x4_set_ge(&rx, &tmpa);
+    for (j = 0; j < 4; j++) {
+        n[j] = st[j].wnaf_lam[WNAF_SIZE(WINDOW_A - 1)];
     }
+    secp256k1_ecmult_const_table_get_ge_x4(&tmpa, pre_a_lam, n);
+    secp256k1_gej_x4_add_ge(&rx, &rx, &tmpa);
 #else
-    /* correct for zero */
-    r->infinity |= is_zero;
+    for (j = 0; j < 4; j++) {
+        n[j] = st[j].wnaf[WNAF_SIZE(WINDOW_A - 1)];
+    }
+    secp256k1_ecmult_const_table_get_ge_x4(&tmpa, pre_a, n);
+    secp256k1_gej_x4_set_ge(&rx, &tmpa);
 #endif
+    for (i = WNAF_SIZE(WINDOW_A - 1) - 1; i >= 0; i--) {
+        for (j = 0; j < WINDOW_A - 1; ++j) {
+            secp256k1_gej_x4_double_nonzero(&rx, &rx);
+        }
+#ifdef USE_ENDOMORPHISM
+        for (j = 0; j < 4; j++) {
+            n[j] = st[j].wnaf_1[i];
+        }
+        secp256k1_ecmult_const_table_get_ge_x4(&tmpa, pre_a, n);
+        secp256k1_gej_x4_add_ge(&rx, &rx, &tmpa);
+        for (j = 0; j < 4; j++) {
+            n[j] = st[j].wnaf_lam[i];
+        }
+        secp256k1_ecmult_const_table_get_ge_x4(&tmpa, pre_a_lam, n);
+        secp256k1_gej_x4_add_ge(&rx, &rx, &tmpa);
+#else
+        for (j = 0; j < 4; j++) {
+            n[j] = st[j].wnaf[i];
+        }
+        secp256k1_ecmult_const_table_get_ge_x4(&tmpa, pre_a, n);
+        secp256k1_gej_x4_add_ge(&rx, &rx, &tmpa);
+#endif
+    }
+
+    secp256k1_gej_x4_get_gej(r, &rx);
+    for (j = 0; j < 4; j++) {
+        secp256k1_ecmult_const_finish(&r[j], &st[j], &a[j]);
+    }
 }
+#endif
 
 #endif
@@ -40,4 +40,11 @@ static void secp256k1_ecmult_gen(const secp256k1_ecmult_gen_context* ctx, secp25
 
 static void secp256k1_ecmult_gen_blind(secp256k1_ecmult_gen_context *ctx, const unsigned char *seed32);
 
+/** Fill prec with the comb table (as used by secp256k1_ecmult_gen) for an arbitrary base point
+ *  instead of G. */
+static void secp256k1_ecmult_gen_prec_table_build(secp256k1_ge_storage (*prec)[64][16], const secp256k1_ge *base, const secp256k1_callback* cb);
+
+/** Setup the blinding values of a context whose table was built for base (see secp256k1_ecmult_gen_blind). */
+static void secp256k1_ecmult_gen_blind_base(secp256k1_ecmult_gen_context *ctx, const secp256k1_ge *base, const unsigned char *seed32);
+
 #endif
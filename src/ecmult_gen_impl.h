@@ -18,22 +18,15 @@ static void secp256k1_ecmult_gen_context_init(secp256k1_ecmult_gen_context *ctx)
     ctx->prec = NULL;
 }
 
-static void secp256k1_ecmult_gen_context_build(secp256k1_ecmult_gen_context *ctx, const secp256k1_callback* cb) {
-#ifndef USE_ECMULT_STATIC_PRECOMPUTATION
-    secp256k1_ge prec[1024];
+static void secp256k1_ecmult_gen_prec_table_build(secp256k1_ge_storage (*prec)[64][16], const secp256k1_ge *base, const secp256k1_callback* cb) {
+    secp256k1_ge *precg;
+    secp256k1_gej *precj; /* Jacobian versions of prec. */
     secp256k1_gej gj;
     secp256k1_gej nums_gej;
     int i, j;
-#endif
 
-    if (ctx->prec != NULL) {
-        return;
-    }
-#ifndef USE_ECMULT_STATIC_PRECOMPUTATION
-    ctx->prec = (secp256k1_ge_storage (*)[64][16])checked_malloc(cb, sizeof(*ctx->prec));
-
-    /* get the generator */
-    secp256k1_gej_set_ge(&gj, &secp256k1_ge_const_g);
+    /* get the base point */
+    secp256k1_gej_set_ge(&gj, base);
 
     /* Construct a group element with no known corresponding scalar (nothing up my sleeve). */
     {
@@ -53,11 +46,12 @@ static void secp256k1_ecmult_gen_context_build(secp256k1_ecmult_gen_context *ctx
     }
 
     /* compute prec. */
+    precg = (secp256k1_ge *)checked_malloc(cb, sizeof(secp256k1_ge) * 1024);
+    precj = (secp256k1_gej *)checked_malloc(cb, sizeof(secp256k1_gej) * 1024);
     {
-        secp256k1_gej precj[1024]; /* Jacobian versions of prec. */
         secp256k1_gej gbase;
         secp256k1_gej numsbase;
-        gbase = gj; /* 16^j * G */
+        gbase = gj; /* 16^j * base */
         numsbase = nums_gej; /* 2^j * nums. */
         for (j = 0; j < 64; j++) {
             /* Set precj[j*16 .. j*16+15] to (numsbase, numsbase + gbase, ..., numsbase + 15*gbase). */
@@ -77,13 +71,24 @@ static void secp256k1_ecmult_gen_context_build(secp256k1_ecmult_gen_context *ctx
                 secp256k1_gej_add_var(&numsbase, &numsbase, &nums_gej, NULL);
             }
         }
-        secp256k1_ge_set_all_gej_var(1024, prec, precj, cb);
+        secp256k1_ge_set_all_gej_var(1024, precg, precj, cb);
     }
     for (j = 0; j < 64; j++) {
         for (i = 0; i < 16; i++) {
-            secp256k1_ge_to_storage(&(*ctx->prec)[j][i], &prec[j*16 + i]);
+            secp256k1_ge_to_storage(&(*prec)[j][i], &precg[j*16 + i]);
         }
     }
+    free(precj);
+    free(precg);
+}
+
+static void secp256k1_ecmult_gen_context_build(secp256k1_ecmult_gen_context *ctx, const secp256k1_callback* cb) {
+    if (ctx->prec != NULL) {
+        return;
+    }
+#ifndef USE_ECMULT_STATIC_PRECOMPUTATION
+    ctx->prec = (secp256k1_ge_storage (*)[64][16])checked_malloc(cb, sizeof(*ctx->prec));
+    secp256k1_ecmult_gen_prec_table_build(ctx->prec, &secp256k1_ge_const_g, cb);
 #else
     (void)cb;
     ctx->prec = (secp256k1_ge_storage (*)[64][16])secp256k1_ecmult_static_context;
@@ -124,11 +129,14 @@ static void secp256k1_ecmult_gen_context_clear(secp256k1_ecmult_gen_context *ctx
 static void secp256k1_ecmult_gen(const secp256k1_ecmult_gen_context *ctx, secp256k1_gej *r, const secp256k1_scalar *gn) {
     secp256k1_ge add;
     secp256k1_ge_storage adds;
+    secp256k1_gep acc;
     secp256k1_scalar gnb;
     int bits;
     int i, j;
     memset(&adds, 0, sizeof(adds));
-    *r = ctx->initial;
+    /* Accumulate in projective coordinates, where the complete addition formulas are cheaper
+     * than the cmov-based jacobian ones. */
+    secp256k1_gep_set_gej(&acc, &ctx->initial);
     /* Blind scalar/point multiplication by computing (n-b)G + bG instead of nG. */
     secp256k1_scalar_add(&gnb, gn, &ctx->blind);
     add.infinity = 0;
@@ -148,15 +156,21 @@ static void secp256k1_ecmult_gen(const secp256k1_ecmult_gen_context *ctx, secp25
             secp256k1_ge_storage_cmov(&adds, &(*ctx->prec)[j][i], i == bits);
         }
         secp256k1_ge_from_storage(&add, &adds);
-        secp256k1_gej_add_ge(r, r, &add);
+        secp256k1_gep_add_ge(&acc, &acc, &add);
     }
+    secp256k1_gej_set_gep(r, &acc);
     bits = 0;
+    memset(&acc, 0, sizeof(acc));
     secp256k1_ge_clear(&add);
     secp256k1_scalar_clear(&gnb);
 }
 
-/* Setup blinding values for secp256k1_ecmult_gen. */
 static void secp256k1_ecmult_gen_blind(secp256k1_ecmult_gen_context *ctx, const unsigned char *seed32) {
+    secp256k1_ecmult_gen_blind_base(ctx, &secp256k1_ge_const_g, seed32);
+}
+
+/* Setup blinding values for secp256k1_ecmult_gen. */
+static void secp256k1_ecmult_gen_blind_base(secp256k1_ecmult_gen_context *ctx, const secp256k1_ge *base, const unsigned char *seed32) {
     secp256k1_scalar b;
     secp256k1_gej gb;
     secp256k1_fe s;
@@ -166,7 +180,7 @@ static void secp256k1_ecmult_gen_blind(secp256k1_ecmult_gen_context *ctx, const
     unsigned char keydata[64] = {0};
     if (seed32 == NULL) {
         /* When seed is NULL, reset the initial point and blinding value. */
-        secp256k1_gej_set_ge(&ctx->initial, &secp256k1_ge_const_g);
+        secp256k1_gej_set_ge(&ctx->initial, base);
         secp256k1_gej_neg(&ctx->initial, &ctx->initial);
         secp256k1_scalar_set_int(&ctx->blind, 1);
     }
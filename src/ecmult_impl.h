@@ -11,22 +11,6 @@
 #include "scalar.h"
 #include "ecmult.h"
 
-/* optimal for 128-bit and 256-bit exponents. */
-#define WINDOW_A 5
-
-/** larger numbers may result in slightly better performance, at the cost of
-    exponentially larger precomputed tables. */
-#ifdef USE_ENDOMORPHISM
-/** Two tables for window size 15: 1.375 MiB. */
-#define WINDOW_G 15
-#else
-/** One table for window size 16: 1.375 MiB. */
-#define WINDOW_G 16
-#endif
-
-/** The number of entries a table with precomputed multiples needs to have. */
-#define ECMULT_TABLE_SIZE(w) (1 << ((w)-2))
-
 /** Fill a table 'prej' with precomputed odd multiples of a. Prej will contain
  *  the values [1*a,3*a,...,(2*n-1)*a], so it space for n values. zr[0] will
  *  contain prej[0].z / a.z. The other zr[i] values = prej[i].z / prej[i-1].z.
@@ -34,37 +18,28 @@
  */
 static void secp256k1_ecmult_odd_multiples_table(int n, secp256k1_gej *prej, secp256k1_fe *zr, const secp256k1_gej *a) {
     secp256k1_gej d;
-    secp256k1_ge a_ge, d_ge;
+    secp256k1_ge d_ge;
     int i;
 
     VERIFY_CHECK(!a->infinity);
 
-    secp256k1_gej_double_var(&d, a, NULL);
+    secp256k1_gej_double_var(&d, a, &zr[0]);
 
     /*
-     * Perform the additions on an isomorphism where 'd' is affine: drop the z coordinate
-     * of 'd', and scale the 1P starting value's x/y coordinates without changing its z.
+     * Bring the 1P starting value to the Z coordinate of 'd', and keep the additions
+     * co-Z: each one returns 'd' over the Z coordinate of its sum, ready for the next.
      */
+    prej[0] = *a;
+    secp256k1_gej_rescale(&prej[0], &zr[0]);
     d_ge.x = d.x;
     d_ge.y = d.y;
+    secp256k1_fe_normalize_weak(&d_ge.x);
+    secp256k1_fe_normalize_weak(&d_ge.y);
     d_ge.infinity = 0;
 
-    secp256k1_ge_set_gej_zinv(&a_ge, a, &d.z);
-    prej[0].x = a_ge.x;
-    prej[0].y = a_ge.y;
-    prej[0].z = a->z;
-    prej[0].infinity = 0;
-
-    zr[0] = d.z;
     for (i = 1; i < n; i++) {
-        secp256k1_gej_add_ge_var(&prej[i], &prej[i-1], &d_ge, &zr[i]);
+        secp256k1_gej_add_coz(&prej[i], &d_ge, &prej[i-1], &zr[i]);
     }
-
-    /*
-     * Each point in 'prej' has a z coordinate too small by a factor of 'd.z'. Only
-     * the final point's z coordinate is actually used though, so just update that.
-     */
-    secp256k1_fe_mul(&prej[n-1].z, &prej[n-1].z, &d.z);
 }
 
 /** Fill a table 'pre' with precomputed odd multiples of a.
@@ -208,16 +183,26 @@ static void secp256k1_ecmult_context_clear(secp256k1_ecmult_context *ctx) {
     secp256k1_ecmult_context_init(ctx);
 }
 
-/** Convert a number to WNAF notation. The number becomes represented by sum(2^i * wnaf[i], i=0..bits),
- *  with the following guarantees:
- *  - each wnaf[i] is either 0, or an odd integer between -(1<<(w-1) - 1) and (1<<(w-1) - 1)
- *  - two non-zero entries in wnaf are separated by at least w-1 zeroes.
- *  - the number of set values in wnaf is returned. This number is at most 256, and at most one more
- *    than the number of bits in the (absolute value) of the input.
+/** Copy a scalar into 64-bit words, least significant first, followed by a zero word so
+ *  that windows running past the top can be read without a bounds check. */
+static void secp256k1_ecmult_scalar_words(uint64_t *words, const secp256k1_scalar *s) {
+    int i;
+    memset(words, 0, 5 * sizeof(words[0]));
+    for (i = 0; i < 16; i++) {
+        words[i >> 2] |= (uint64_t)secp256k1_scalar_get_bits(s, 16 * i, 16) << (16 * (i & 3));
+    }
+}
+
+/** Convert a number to WNAF notation. The number becomes represented by sum(2^wnaf[i].pos * wnaf[i].digit, i=0..n-1),
+ *  where n is the returned number of digits, with the following guarantees:
+ *  - each digit is an odd integer between -(1<<(w-1) - 1) and (1<<(w-1) - 1)
+ *  - the positions are increasing and below len, and two consecutive ones differ by at least w.
+ *  - n is at most ECMULT_WNAF_MAX_DIGITS(len, w).
  */
-static int secp256k1_ecmult_wnaf(int *wnaf, int len, const secp256k1_scalar *a, int w) {
+static int secp256k1_ecmult_wnaf(secp256k1_ecmult_wnaf_digit *wnaf, int len, const secp256k1_scalar *a, int w) {
     secp256k1_scalar s = *a;
-    int last_set_bit = -1;
+    uint64_t words[5];
+    int n = 0;
     int bit = 0;
     int sign = 1;
     int carry = 0;
@@ -227,33 +212,45 @@ static int secp256k1_ecmult_wnaf(int *wnaf, int len, const secp256k1_scalar *a,
     VERIFY_CHECK(a != NULL);
     VERIFY_CHECK(2 <= w && w <= 31);
 
-    memset(wnaf, 0, len * sizeof(wnaf[0]));
-
     if (secp256k1_scalar_get_bits(&s, 255, 1)) {
         secp256k1_scalar_negate(&s, &s);
         sign = -1;
     }
+    secp256k1_ecmult_scalar_words(words, &s);
 
     while (bit < len) {
         int now;
         int word;
-        if (secp256k1_scalar_get_bits(&s, bit, 1) == (unsigned int)carry) {
-            bit++;
+        uint64_t lo = words[bit >> 6];
+        uint64_t hi = words[(bit >> 6) + 1];
+        uint64_t x;
+
+        /* Bits equal to the carry produce zero digits, so skip to the next one that differs. */
+        x = (lo ^ -(uint64_t)carry) >> (bit & 63);
+        if (x == 0) {
+            bit = (bit | 63) + 1;
             continue;
         }
+        bit += secp256k1_ctz64_var(x);
+        if (bit >= len) {
+            break;
+        }
 
         now = w;
         if (now > len - bit) {
             now = len - bit;
         }
 
-        word = secp256k1_scalar_get_bits_var(&s, bit, now) + carry;
+        /* The skip stays within lo, but the window may continue into hi; the split shift avoids shifting by 64. */
+        x = (lo >> (bit & 63)) | ((hi << 1) << (63 - (bit & 63)));
+        word = (int)(x & ((((uint64_t)1) << now) - 1)) + carry;
 
         carry = (word >> (w-1)) & 1;
         word -= carry << w;
 
-        wnaf[bit] = sign * word;
-        last_set_bit = bit;
+        wnaf[n].pos = bit;
+        wnaf[n].digit = sign * word;
+        n++;
 
         bit += now;
     }
@@ -261,54 +258,175 @@ static int secp256k1_ecmult_wnaf(int *wnaf, int len, const secp256k1_scalar *a,
     CHECK(carry == 0);
     while (bit < 256) {
         CHECK(secp256k1_scalar_get_bits(&s, bit++, 1) == 0);
-    } 
+    }
 #endif
-    return last_set_bit + 1;
+    VERIFY_CHECK(n <= ECMULT_WNAF_MAX_DIGITS(len, w));
+    return n;
 }
 
-static void secp256k1_ecmult(const secp256k1_ecmult_context *ctx, secp256k1_gej *r, const secp256k1_gej *a, const secp256k1_scalar *na, const secp256k1_scalar *ng) {
-    secp256k1_ge pre_a[ECMULT_TABLE_SIZE(WINDOW_A)];
-    secp256k1_ge tmpa;
-    secp256k1_fe Z;
+#ifdef USE_ECMULT_JSF
+/** Convert a pair of numbers to joint sparse form (Solinas, "Low-weight binary representations
+ *  for pairs of integers", 2001). The pair becomes represented by sum(2^jsf[i].pos * (u0, u1), i=0..n-1),
+ *  where n is the returned number of nonzero columns, and jsf[i].digit is 1, 2, 3 or 4 for the
+ *  columns (1, 0), (0, 1), (1, 1) and (1, -1), and minus that for their negations. This is also
+ *  the index (plus one) of the matching secp256k1_ecmult_jsf_table entry. The guarantees are:
+ *  - of any three consecutive positions, at least one holds a zero column
+ *  - the positions are increasing and at most len, so n is at most len+1.
+ *  Both numbers must be less than 2^len in absolute value.
+ */
+static int secp256k1_ecmult_jsf(secp256k1_ecmult_wnaf_digit *jsf, int len, const secp256k1_scalar *a0, const secp256k1_scalar *a1) {
+    uint64_t words[2][5];
+    int sign[2];
+    int d[2];
+    int n = 0;
+    int pos;
+    int i;
+
+    VERIFY_CHECK(jsf != NULL);
+    VERIFY_CHECK(0 <= len && len <= 255);
+
+    for (i = 0; i < 2; i++) {
+        secp256k1_scalar s = i ? *a1 : *a0;
+        sign[i] = 1;
+        if (secp256k1_scalar_get_bits(&s, 255, 1)) {
+            secp256k1_scalar_negate(&s, &s);
+            sign[i] = -1;
+        }
+        secp256k1_ecmult_scalar_words(words[i], &s);
+        d[i] = 0;
+    }
+
+    for (pos = 0; pos <= len; pos++) {
+        int l[2], u[2];
+        for (i = 0; i < 2; i++) {
+            /* l = d + (k >> pos) mod 8, where k is the number and d the pending carry of its row. */
+            uint64_t x = (words[i][pos >> 6] >> (pos & 63)) | ((words[i][(pos >> 6) + 1] << 1) << (63 - (pos & 63)));
+            l[i] = (d[i] + (int)(x & 7)) & 7;
+        }
+        for (i = 0; i < 2; i++) {
+            u[i] = 0;
+            if (l[i] & 1) {
+                u[i] = (l[i] & 2) ? -1 : 1;
+                if ((l[i] == 3 || l[i] == 5) && (l[1 - i] & 3) == 2) {
+                    u[i] = -u[i];
+                }
+            }
+        }
+        for (i = 0; i < 2; i++) {
+            if (2 * d[i] == 1 + u[i]) {
+                d[i] = 1 - d[i];
+            }
+            u[i] *= sign[i];
+        }
+        if (u[0] != 0 || u[1] != 0) {
+            /* Map the column to a digit: the sign of its first nonzero entry times its table index. */
+            jsf[n].pos = pos;
+            if (u[0] == 0) {
+                jsf[n].digit = 2 * u[1];
+            } else {
+                jsf[n].digit = u[0] * (u[1] == 0 ? 1 : (u[1] == u[0] ? 3 : 4));
+            }
+            n++;
+        }
+    }
+    VERIFY_CHECK(d[0] == 0 && d[1] == 0);
+    return n;
+}
+
+/** Fill pre with A, lambda*A, A+lambda*A and A-lambda*A, on a common Z denominator which is
+ *  stored in globalz, as secp256k1_ecmult_odd_multiples_table_globalz_windowa does. */
+static void secp256k1_ecmult_jsf_table(secp256k1_ge *pre, secp256k1_fe *globalz, const secp256k1_gej *a) {
+    secp256k1_gej aj, sum, diff;
+    secp256k1_ge a_ge, lam;
+    secp256k1_fe h1, h2, t;
+
+    VERIFY_CHECK(!a->infinity);
+
+    /* Work on the isomorphism where a is affine, so lambda*A is (beta*x, y) there too. */
+    a_ge.x = a->x;
+    a_ge.y = a->y;
+    a_ge.infinity = 0;
+    secp256k1_ge_mul_lambda(&lam, &a_ge);
+    secp256k1_gej_set_ge(&aj, &a_ge);
+    secp256k1_gej_add_ge_var(&sum, &aj, &lam, &h1);
+    secp256k1_ge_neg(&lam, &lam);
+    secp256k1_gej_add_ge_var(&diff, &aj, &lam, &h2);
+
+    /* Bring all four to the Z coordinate h1*h2. */
+    secp256k1_fe_mul(&t, &h1, &h2);
+    secp256k1_gej_rescale(&aj, &t);
+    secp256k1_gej_rescale(&sum, &h2);
+    secp256k1_gej_rescale(&diff, &h1);
+    secp256k1_ge_set_xy(&pre[0], &aj.x, &aj.y);
+    secp256k1_ge_mul_lambda(&pre[1], &pre[0]);
+    secp256k1_ge_set_xy(&pre[2], &sum.x, &sum.y);
+    secp256k1_ge_set_xy(&pre[3], &diff.x, &diff.y);
+    secp256k1_fe_mul(globalz, &a->z, &t);
+}
+#endif
+
+/** The number of main loop iterations a wNAF with n digits needs. */
+static int secp256k1_ecmult_wnaf_bits(const secp256k1_ecmult_wnaf_digit *wnaf, int n) {
+    return n > 0 ? wnaf[n - 1].pos + 1 : 0;
+}
+
+static void secp256k1_ecmult_state_init(secp256k1_ecmult_state *st, const secp256k1_scalar *na, const secp256k1_scalar *ng) {
+    int bits;
 #ifdef USE_ENDOMORPHISM
-    secp256k1_ge pre_a_lam[ECMULT_TABLE_SIZE(WINDOW_A)];
     secp256k1_scalar na_1, na_lam;
     /* Splitted G factors. */
     secp256k1_scalar ng_1, ng_128;
-    int wnaf_na_1[130];
-    int wnaf_na_lam[130];
-    int bits_na_1;
-    int bits_na_lam;
-    int wnaf_ng_1[129];
-    int bits_ng_1;
-    int wnaf_ng_128[129];
-    int bits_ng_128;
-#else
-    int wnaf_na[256];
-    int bits_na;
-    int wnaf_ng[256];
-    int bits_ng;
-#endif
-    int i;
-    int bits;
 
-#ifdef USE_ENDOMORPHISM
     /* split na into na_1 and na_lam (where na = na_1 + na_lam*lambda, and na_1 and na_lam are ~128 bit) */
     secp256k1_scalar_split_lambda(&na_1, &na_lam, na);
 
+#ifdef USE_ECMULT_JSF
+    /* build the joint sparse form of na_1 and na_lam. */
+    st->n_jsf_na = secp256k1_ecmult_jsf(st->jsf_na, 130, &na_1, &na_lam);
+    st->bits = secp256k1_ecmult_wnaf_bits(st->jsf_na, st->n_jsf_na);
+#else
     /* build wnaf representation for na_1 and na_lam. */
-    bits_na_1   = secp256k1_ecmult_wnaf(wnaf_na_1,   130, &na_1,   WINDOW_A);
-    bits_na_lam = secp256k1_ecmult_wnaf(wnaf_na_lam, 130, &na_lam, WINDOW_A);
-    VERIFY_CHECK(bits_na_1 <= 130);
-    VERIFY_CHECK(bits_na_lam <= 130);
-    bits = bits_na_1;
-    if (bits_na_lam > bits) {
-        bits = bits_na_lam;
+    st->n_na_1   = secp256k1_ecmult_wnaf(st->wnaf_na_1,   130, &na_1,   WINDOW_A);
+    st->n_na_lam = secp256k1_ecmult_wnaf(st->wnaf_na_lam, 130, &na_lam, WINDOW_A);
+    st->bits = secp256k1_ecmult_wnaf_bits(st->wnaf_na_1, st->n_na_1);
+    bits = secp256k1_ecmult_wnaf_bits(st->wnaf_na_lam, st->n_na_lam);
+    if (bits > st->bits) {
+        st->bits = bits;
+    }
+#endif
+
+    /* split ng into ng_1 and ng_128 (where gn = gn_1 + gn_128*2^128, and gn_1 and gn_128 are ~128 bit) */
+    secp256k1_scalar_split_128(&ng_1, &ng_128, ng);
+
+    /* Build wnaf representation for ng_1 and ng_128 */
+    st->n_ng_1   = secp256k1_ecmult_wnaf(st->wnaf_ng_1,   129, &ng_1,   WINDOW_G);
+    st->n_ng_128 = secp256k1_ecmult_wnaf(st->wnaf_ng_128, 129, &ng_128, WINDOW_G);
+    bits = secp256k1_ecmult_wnaf_bits(st->wnaf_ng_1, st->n_ng_1);
+    if (bits > st->bits) {
+        st->bits = bits;
+    }
+    bits = secp256k1_ecmult_wnaf_bits(st->wnaf_ng_128, st->n_ng_128);
+    if (bits > st->bits) {
+        st->bits = bits;
     }
 #else
     /* build wnaf representation for na. */
-    bits_na     = secp256k1_ecmult_wnaf(wnaf_na,     256, na,      WINDOW_A);
-    bits = bits_na;
+    st->n_na     = secp256k1_ecmult_wnaf(st->wnaf_na,     256, na,      WINDOW_A);
+    st->bits = secp256k1_ecmult_wnaf_bits(st->wnaf_na, st->n_na);
+
+    st->n_ng     = secp256k1_ecmult_wnaf(st->wnaf_ng,     256, ng,      WINDOW_G);
+    bits = secp256k1_ecmult_wnaf_bits(st->wnaf_ng, st->n_ng);
+    if (bits > st->bits) {
+        st->bits = bits;
+    }
+#endif
+
+    secp256k1_gej_set_infinity(&st->r);
+}
+
+static void secp256k1_ecmult_state_table(secp256k1_ecmult_state *st, const secp256k1_gej *a) {
+#if defined(USE_ENDOMORPHISM) && !defined(USE_ECMULT_JSF)
+    int i;
 #endif
 
     /* Calculate odd multiples of a.
@@ -321,69 +439,95 @@ static void secp256k1_ecmult(const secp256k1_ecmult_context *ctx, secp256k1_gej
      * of 1/Z, so we can use secp256k1_gej_add_zinv_var, which uses the same
      * isomorphism to efficiently add with a known Z inverse.
      */
-    secp256k1_ecmult_odd_multiples_table_globalz_windowa(pre_a, &Z, a);
+#ifdef USE_ECMULT_JSF
+    secp256k1_ecmult_jsf_table(st->pre_jsf, &st->Z, a);
+#else
+    secp256k1_ecmult_odd_multiples_table_globalz_windowa(st->pre_a, &st->Z, a);
 
 #ifdef USE_ENDOMORPHISM
     for (i = 0; i < ECMULT_TABLE_SIZE(WINDOW_A); i++) {
-        secp256k1_ge_mul_lambda(&pre_a_lam[i], &pre_a[i]);
-    }
-
-    /* split ng into ng_1 and ng_128 (where gn = gn_1 + gn_128*2^128, and gn_1 and gn_128 are ~128 bit) */
-    secp256k1_scalar_split_128(&ng_1, &ng_128, ng);
-
-    /* Build wnaf representation for ng_1 and ng_128 */
-    bits_ng_1   = secp256k1_ecmult_wnaf(wnaf_ng_1,   129, &ng_1,   WINDOW_G);
-    bits_ng_128 = secp256k1_ecmult_wnaf(wnaf_ng_128, 129, &ng_128, WINDOW_G);
-    if (bits_ng_1 > bits) {
-        bits = bits_ng_1;
-    }
-    if (bits_ng_128 > bits) {
-        bits = bits_ng_128;
-    }
-#else
-    bits_ng     = secp256k1_ecmult_wnaf(wnaf_ng,     256, ng,      WINDOW_G);
-    if (bits_ng > bits) {
-        bits = bits_ng;
+        secp256k1_ge_mul_lambda(&st->pre_a_lam[i], &st->pre_a[i]);
     }
 #endif
+#endif
+}
 
-    secp256k1_gej_set_infinity(r);
+static int secp256k1_ecmult_state_run(const secp256k1_ecmult_context *ctx, secp256k1_ecmult_state *st, int iterations) {
+    secp256k1_ge tmpa;
+    int i;
+    int stop = st->bits - iterations;
 
-    for (i = bits - 1; i >= 0; i--) {
+    if (stop < 0) {
+        stop = 0;
+    }
+    for (i = st->bits - 1; i >= stop; i--) {
         int n;
-        secp256k1_gej_double_var(r, r, NULL);
+        secp256k1_gej_double_var(&st->r, &st->r, NULL);
 #ifdef USE_ENDOMORPHISM
-        if (i < bits_na_1 && (n = wnaf_na_1[i])) {
-            ECMULT_TABLE_GET_GE(&tmpa, pre_a, n, WINDOW_A);
-            secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+#ifdef USE_ECMULT_JSF
+        if (st->n_jsf_na > 0 && st->jsf_na[st->n_jsf_na - 1].pos == i) {
+            n = st->jsf_na[--st->n_jsf_na].digit;
+            if (n > 0) {
+                tmpa = st->pre_jsf[n - 1];
+            } else {
+                secp256k1_ge_neg(&tmpa, &st->pre_jsf[-n - 1]);
+            }
+            secp256k1_gej_add_ge_var(&st->r, &st->r, &tmpa, NULL);
         }
-        if (i < bits_na_lam && (n = wnaf_na_lam[i])) {
-            ECMULT_TABLE_GET_GE(&tmpa, pre_a_lam, n, WINDOW_A);
-            secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+#else
+        if (st->n_na_1 > 0 && st->wnaf_na_1[st->n_na_1 - 1].pos == i) {
+            n = st->wnaf_na_1[--st->n_na_1].digit;
+            ECMULT_TABLE_GET_GE(&tmpa, st->pre_a, n, WINDOW_A);
+            secp256k1_gej_add_ge_var(&st->r, &st->r, &tmpa, NULL);
         }
-        if (i < bits_ng_1 && (n = wnaf_ng_1[i])) {
+        if (st->n_na_lam > 0 && st->wnaf_na_lam[st->n_na_lam - 1].pos == i) {
+            n = st->wnaf_na_lam[--st->n_na_lam].digit;
+            ECMULT_TABLE_GET_GE(&tmpa, st->pre_a_lam, n, WINDOW_A);
+            secp256k1_gej_add_ge_var(&st->r, &st->r, &tmpa, NULL);
+        }
+#endif
+        if (st->n_ng_1 > 0 && st->wnaf_ng_1[st->n_ng_1 - 1].pos == i) {
+            n = st->wnaf_ng_1[--st->n_ng_1].digit;
             ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g, n, WINDOW_G);
-            secp256k1_gej_add_zinv_var(r, r, &tmpa, &Z);
+            secp256k1_gej_add_zinv_var(&st->r, &st->r, &tmpa, &st->Z);
         }
-        if (i < bits_ng_128 && (n = wnaf_ng_128[i])) {
+        if (st->n_ng_128 > 0 && st->wnaf_ng_128[st->n_ng_128 - 1].pos == i) {
+            n = st->wnaf_ng_128[--st->n_ng_128].digit;
             ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g_128, n, WINDOW_G);
-            secp256k1_gej_add_zinv_var(r, r, &tmpa, &Z);
+            secp256k1_gej_add_zinv_var(&st->r, &st->r, &tmpa, &st->Z);
         }
 #else
-        if (i < bits_na && (n = wnaf_na[i])) {
-            ECMULT_TABLE_GET_GE(&tmpa, pre_a, n, WINDOW_A);
-            secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+        if (st->n_na > 0 && st->wnaf_na[st->n_na - 1].pos == i) {
+            n = st->wnaf_na[--st->n_na].digit;
+            ECMULT_TABLE_GET_GE(&tmpa, st->pre_a, n, WINDOW_A);
+            secp256k1_gej_add_ge_var(&st->r, &st->r, &tmpa, NULL);
         }
-        if (i < bits_ng && (n = wnaf_ng[i])) {
+        if (st->n_ng > 0 && st->wnaf_ng[st->n_ng - 1].pos == i) {
+            n = st->wnaf_ng[--st->n_ng].digit;
             ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g, n, WINDOW_G);
-            secp256k1_gej_add_zinv_var(r, r, &tmpa, &Z);
+            secp256k1_gej_add_zinv_var(&st->r, &st->r, &tmpa, &st->Z);
         }
 #endif
     }
+    st->bits = stop;
+    return stop == 0;
+}
 
+static void secp256k1_ecmult_state_finish(secp256k1_ecmult_state *st, secp256k1_gej *r) {
+    VERIFY_CHECK(st->bits == 0);
+    *r = st->r;
     if (!r->infinity) {
-        secp256k1_fe_mul(&r->z, &r->z, &Z);
+        secp256k1_fe_mul(&r->z, &r->z, &st->Z);
     }
 }
 
+static void secp256k1_ecmult(const secp256k1_ecmult_context *ctx, secp256k1_gej *r, const secp256k1_gej *a, const secp256k1_scalar *na, const secp256k1_scalar *ng) {
+    secp256k1_ecmult_state st;
+
+    secp256k1_ecmult_state_init(&st, na, ng);
+    secp256k1_ecmult_state_table(&st, a);
+    secp256k1_ecmult_state_run(ctx, &st, st.bits);
+    secp256k1_ecmult_state_finish(&st, r);
+}
+
 #endif
@@ -33,6 +33,10 @@
 /** Normalize a field element. */
 static void secp256k1_fe_normalize(secp256k1_fe *r);
 
+/** Check that a field element has magnitude at most m. Only does something in VERIFY builds,
+ *  where it documents the bound a caller relies on instead of normalizing. */
+static void secp256k1_fe_verify_magnitude(const secp256k1_fe *a, int m);
+
 /** Weakly normalize a field element: reduce it magnitude to 1, but don't fully normalize. */
 static void secp256k1_fe_normalize_weak(secp256k1_fe *r);
 
@@ -94,6 +98,11 @@ static void secp256k1_fe_sqr(secp256k1_fe *r, const secp256k1_fe *a);
  *  itself. */
 static int secp256k1_fe_sqrt_var(secp256k1_fe *r, const secp256k1_fe *a);
 
+/** Checks whether a field element is a quadratic residue (zero counts as one), by computing its
+ *  Jacobi symbol. Gives the same answer as secp256k1_fe_sqrt_var, but is several times faster. The
+ *  input's magnitude can be at most 8. */
+static int secp256k1_fe_is_quad_var(const secp256k1_fe *a);
+
 /** Sets a field element to be the (modular) inverse of another. Requires the input's magnitude to be
  *  at most 8. The output magnitude is 1 (but not guaranteed to be normalized). */
 static void secp256k1_fe_inv(secp256k1_fe *r, const secp256k1_fe *a);
@@ -106,6 +115,10 @@ static void secp256k1_fe_inv_var(secp256k1_fe *r, const secp256k1_fe *a);
  *  outputs must not overlap in memory. */
 static void secp256k1_fe_inv_all_var(size_t len, secp256k1_fe *r, const secp256k1_fe *a);
 
+/** Constant-time version of secp256k1_fe_inv_all_var. The running time only depends on len, and
+ *  all inputs must be nonzero. */
+static void secp256k1_fe_inv_all(size_t len, secp256k1_fe *r, const secp256k1_fe *a);
+
 /** Convert a field element to the storage type. */
 static void secp256k1_fe_to_storage(secp256k1_fe_storage *r, const secp256k1_fe *a);
 
@@ -0,0 +1,476 @@
+/**********************************************************************
+ * Copyright (c) 2016 libsecp256k1 contributors                       *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+/**
+ * Variants of secp256k1_fe_mul_inner and secp256k1_fe_sqr_inner from
+ * field_5x52_asm_impl.h for CPUs with BMI2, which are selected at runtime.
+ * They compute the same steps, but with mulx, which takes one factor from rdx
+ * and writes the product to any two registers. Products no longer pass
+ * through rdx:rax, so fewer moves are needed.
+ *
+ * The accumulators are only two limbs wide, so every addition into them
+ * starts a new carry chain with add. adcx/adox would serialize the products
+ * on a single flag instead, which is why they are only used for the wider
+ * accumulators of the scalar code.
+ */
+
+#ifndef _SECP256K1_FIELD_INNER5X52_MULX_IMPL_H_
+#define _SECP256K1_FIELD_INNER5X52_MULX_IMPL_H_
+
+SECP256K1_INLINE static void secp256k1_fe_mul_inner_mulx(uint64_t *r, const uint64_t *a, const uint64_t * SECP256K1_RESTRICT b) {
+/**
+ * Registers: rax,rsi = product (low, high)
+ *            rdx     = factor from b, or constant
+ *            r9:r8   = c
+ *            r15:rcx = d
+ *            r10-r14 = a0-a4
+ *            rbx     = b
+ *            rdi     = r
+ */
+  uint64_t tmp1, tmp2, tmp3;
+__asm__ __volatile__(
+    "movq 0(%%rsi),%%r10\n"
+    "movq 8(%%rsi),%%r11\n"
+    "movq 16(%%rsi),%%r12\n"
+    "movq 24(%%rsi),%%r13\n"
+    "movq 32(%%rsi),%%r14\n"
+
+    /* d = a0 * b3 */
+    "movq 24(%%rbx),%%rdx\n"
+    "mulxq %%r10,%%rcx,%%r15\n"
+    /* c = a4 * b4 */
+    "movq 32(%%rbx),%%rdx\n"
+    "mulxq %%r14,%%r8,%%r9\n"
+    /* d += a1 * b2 */
+    "movq 16(%%rbx),%%rdx\n"
+    "mulxq %%r11,%%rax,%%rsi\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rsi,%%r15\n"
+    /* d += a2 * b1 */
+    "movq 8(%%rbx),%%rdx\n"
+    "mulxq %%r12,%%rax,%%rsi\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rsi,%%r15\n"
+    /* d += a3 * b0 */
+    "movq 0(%%rbx),%%rdx\n"
+    "mulxq %%r13,%%rax,%%rsi\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rsi,%%r15\n"
+    /* d += (c & M) * R */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%r8,%%rax\n"
+    "movq $0x1000003d10,%%rdx\n"
+    "mulxq %%rax,%%rax,%%rsi\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rsi,%%r15\n"
+    /* c >>= 52 (%%r8 only) */
+    "shrdq $52,%%r9,%%r8\n"
+    /* t3 (tmp1) = d & M */
+    "movq $0xfffffffffffff,%%rsi\n"
+    "andq %%rcx,%%rsi\n"
+    "movq %%rsi,%q1\n"
+    /* d >>= 52 */
+    "shrdq $52,%%r15,%%rcx\n"
+    "xorq %%r15,%%r15\n"
+    /* d += a0 * b4 */
+    "movq 32(%%rbx),%%rdx\n"
+    "mulxq %%r10,%%rax,%%rsi\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rsi,%%r15\n"
+    /* d += a1 * b3 */
+    "movq 24(%%rbx),%%rdx\n"
+    "mulxq %%r11,%%rax,%%rsi\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rsi,%%r15\n"
+    /* d += a2 * b2 */
+    "movq 16(%%rbx),%%rdx\n"
+    "mulxq %%r12,%%rax,%%rsi\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rsi,%%r15\n"
+    /* d += a3 * b1 */
+    "movq 8(%%rbx),%%rdx\n"
+    "mulxq %%r13,%%rax,%%rsi\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rsi,%%r15\n"
+    /* d += a4 * b0 */
+    "movq 0(%%rbx),%%rdx\n"
+    "mulxq %%r14,%%rax,%%rsi\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rsi,%%r15\n"
+    /* d += c * R */
+    "movq $0x1000003d10,%%rdx\n"
+    "mulxq %%r8,%%rax,%%rsi\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rsi,%%r15\n"
+    /* t4 = d & M (%%rsi) */
+    "movq $0xfffffffffffff,%%rsi\n"
+    "andq %%rcx,%%rsi\n"
+    /* d >>= 52 */
+    "shrdq $52,%%r15,%%rcx\n"
+    "xorq %%r15,%%r15\n"
+    /* tx = t4 >> 48 (tmp3) */
+    "movq %%rsi,%%rax\n"
+    "shrq $48,%%rax\n"
+    "movq %%rax,%q3\n"
+    /* t4 &= (M >> 4) (tmp2) */
+    "movq $0xffffffffffff,%%rax\n"
+    "andq %%rax,%%rsi\n"
+    "movq %%rsi,%q2\n"
+    /* c = a0 * b0 */
+    "movq 0(%%rbx),%%rdx\n"
+    "mulxq %%r10,%%r8,%%r9\n"
+    /* d += a1 * b4 */
+    "movq 32(%%rbx),%%rdx\n"
+    "mulxq %%r11,%%rax,%%rsi\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rsi,%%r15\n"
+    /* d += a2 * b3 */
+    "movq 24(%%rbx),%%rdx\n"
+    "mulxq %%r12,%%rax,%%rsi\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rsi,%%r15\n"
+    /* d += a3 * b2 */
+    "movq 16(%%rbx),%%rdx\n"
+    "mulxq %%r13,%%rax,%%rsi\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rsi,%%r15\n"
+    /* d += a4 * b1 */
+    "movq 8(%%rbx),%%rdx\n"
+    "mulxq %%r14,%%rax,%%rsi\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rsi,%%r15\n"
+    /* u0 = d & M (%%rsi) */
+    "movq $0xfffffffffffff,%%rsi\n"
+    "andq %%rcx,%%rsi\n"
+    /* d >>= 52 */
+    "shrdq $52,%%r15,%%rcx\n"
+    "xorq %%r15,%%r15\n"
+    /* u0 = (u0 << 4) | tx (%%rsi) */
+    "shlq $4,%%rsi\n"
+    "orq %q3,%%rsi\n"
+    /* c += u0 * (R >> 4) */
+    "movq $0x1000003d1,%%rdx\n"
+    "mulxq %%rsi,%%rax,%%rsi\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rsi,%%r9\n"
+    /* r[0] = c & M */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%r8,%%rax\n"
+    "movq %%rax,0(%%rdi)\n"
+    /* c >>= 52 */
+    "shrdq $52,%%r9,%%r8\n"
+    "xorq %%r9,%%r9\n"
+    /* c += a1 * b0 */
+    "movq 0(%%rbx),%%rdx\n"
+    "mulxq %%r11,%%rax,%%rsi\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rsi,%%r9\n"
+    /* d += a2 * b4 */
+    "movq 32(%%rbx),%%rdx\n"
+    "mulxq %%r12,%%rax,%%rsi\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rsi,%%r15\n"
+    /* c += a0 * b1 */
+    "movq 8(%%rbx),%%rdx\n"
+    "mulxq %%r10,%%rax,%%rsi\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rsi,%%r9\n"
+    /* d += a3 * b3 */
+    "movq 24(%%rbx),%%rdx\n"
+    "mulxq %%r13,%%rax,%%rsi\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rsi,%%r15\n"
+    /* d += a4 * b2 */
+    "movq 16(%%rbx),%%rdx\n"
+    "mulxq %%r14,%%rax,%%rsi\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rsi,%%r15\n"
+    /* c += (d & M) * R */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%rcx,%%rax\n"
+    "movq $0x1000003d10,%%rdx\n"
+    "mulxq %%rax,%%rax,%%rsi\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rsi,%%r9\n"
+    /* d >>= 52 */
+    "shrdq $52,%%r15,%%rcx\n"
+    "xorq %%r15,%%r15\n"
+    /* r[1] = c & M */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%r8,%%rax\n"
+    "movq %%rax,8(%%rdi)\n"
+    /* c >>= 52 */
+    "shrdq $52,%%r9,%%r8\n"
+    "xorq %%r9,%%r9\n"
+    /* c += a2 * b0 */
+    "movq 0(%%rbx),%%rdx\n"
+    "mulxq %%r12,%%rax,%%rsi\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rsi,%%r9\n"
+    /* d += a3 * b4 */
+    "movq 32(%%rbx),%%rdx\n"
+    "mulxq %%r13,%%rax,%%rsi\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rsi,%%r15\n"
+    /* c += a1 * b1 */
+    "movq 8(%%rbx),%%rdx\n"
+    "mulxq %%r11,%%rax,%%rsi\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rsi,%%r9\n"
+    /* d += a4 * b3 */
+    "movq 24(%%rbx),%%rdx\n"
+    "mulxq %%r14,%%rax,%%rsi\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rsi,%%r15\n"
+    /* c += a0 * b2 */
+    "movq 16(%%rbx),%%rdx\n"
+    "mulxq %%r10,%%rax,%%rsi\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rsi,%%r9\n"
+    /* c += (d & M) * R */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%rcx,%%rax\n"
+    "movq $0x1000003d10,%%rdx\n"
+    "mulxq %%rax,%%rax,%%rsi\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rsi,%%r9\n"
+    /* d >>= 52 (%%rcx only) */
+    "shrdq $52,%%r15,%%rcx\n"
+    /* r[2] = c & M */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%r8,%%rax\n"
+    "movq %%rax,16(%%rdi)\n"
+    /* c >>= 52 */
+    "shrdq $52,%%r9,%%r8\n"
+    "xorq %%r9,%%r9\n"
+    /* c += t3 */
+    "addq %q1,%%r8\n"
+    /* c += d * R */
+    "movq $0x1000003d10,%%rdx\n"
+    "mulxq %%rcx,%%rax,%%rsi\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rsi,%%r9\n"
+    /* r[3] = c & M */
+    "movq $0xfffffffffffff,%%rax\n"
+    "andq %%r8,%%rax\n"
+    "movq %%rax,24(%%rdi)\n"
+    /* c >>= 52 (%%r8 only) */
+    "shrdq $52,%%r9,%%r8\n"
+    /* c += t4 (%%r8 only) */
+    "addq %q2,%%r8\n"
+    /* r[4] = c */
+    "movq %%r8,32(%%rdi)\n"
+: "+S"(a), "=m"(tmp1), "=m"(tmp2), "=m"(tmp3)
+: "b"(b), "D"(r)
+: "%rax", "%rcx", "%rdx", "%r8", "%r9", "%r10", "%r11", "%r12", "%r13", "%r14", "%r15", "cc", "memory"
+);
+}
+
+SECP256K1_INLINE static void secp256k1_fe_sqr_inner_mulx(uint64_t *r, const uint64_t *a) {
+/**
+ * Registers: rax,rsi = product (low, high)
+ *            rdx     = factor, or constant
+ *            r9:r8   = c
+ *            rcx:rbx = d
+ *            r10-r14 = a0-a4
+ *            r15     = M (0xfffffffffffff)
+ *            rdi     = r
+ */
+  uint64_t tmp1, tmp2, tmp3;
+__asm__ __volatile__(
+    "movq 0(%%rsi),%%r10\n"
+    "movq 8(%%rsi),%%r11\n"
+    "movq 16(%%rsi),%%r12\n"
+    "movq 24(%%rsi),%%r13\n"
+    "movq 32(%%rsi),%%r14\n"
+    "movq $0xfffffffffffff,%%r15\n"
+
+    /* d = (a0*2) * a3 */
+    "leaq (%%r10,%%r10,1),%%rdx\n"
+    "mulxq %%r13,%%rbx,%%rcx\n"
+    /* c = a4 * a4 */
+    "movq %%r14,%%rdx\n"
+    "mulxq %%r14,%%r8,%%r9\n"
+    /* d += (a1*2) * a2 */
+    "leaq (%%r11,%%r11,1),%%rdx\n"
+    "mulxq %%r12,%%rax,%%rsi\n"
+    "addq %%rax,%%rbx\n"
+    "adcq %%rsi,%%rcx\n"
+    /* d += (c & M) * R */
+    "movq %%r8,%%rax\n"
+    "andq %%r15,%%rax\n"
+    "movq $0x1000003d10,%%rdx\n"
+    "mulxq %%rax,%%rax,%%rsi\n"
+    "addq %%rax,%%rbx\n"
+    "adcq %%rsi,%%rcx\n"
+    /* c >>= 52 (%%r8 only) */
+    "shrdq $52,%%r9,%%r8\n"
+    /* t3 (tmp1) = d & M */
+    "movq %%rbx,%%rsi\n"
+    "andq %%r15,%%rsi\n"
+    "movq %%rsi,%q1\n"
+    /* d >>= 52 */
+    "shrdq $52,%%rcx,%%rbx\n"
+    /* a4 *= 2 */
+    "leaq (%%r14,%%r14,1),%%r14\n"
+    "xorq %%rcx,%%rcx\n"
+    /* d += a0 * a4 */
+    "movq %%r10,%%rdx\n"
+    "mulxq %%r14,%%rax,%%rsi\n"
+    "addq %%rax,%%rbx\n"
+    "adcq %%rsi,%%rcx\n"
+    /* d += (a1*2) * a3 */
+    "leaq (%%r11,%%r11,1),%%rdx\n"
+    "mulxq %%r13,%%rax,%%rsi\n"
+    "addq %%rax,%%rbx\n"
+    "adcq %%rsi,%%rcx\n"
+    /* d += a2 * a2 */
+    "movq %%r12,%%rdx\n"
+    "mulxq %%r12,%%rax,%%rsi\n"
+    "addq %%rax,%%rbx\n"
+    "adcq %%rsi,%%rcx\n"
+    /* d += c * R */
+    "movq $0x1000003d10,%%rdx\n"
+    "mulxq %%r8,%%rax,%%rsi\n"
+    "addq %%rax,%%rbx\n"
+    "adcq %%rsi,%%rcx\n"
+    /* t4 = d & M (%%rsi) */
+    "movq %%rbx,%%rsi\n"
+    "andq %%r15,%%rsi\n"
+    /* d >>= 52 */
+    "shrdq $52,%%rcx,%%rbx\n"
+    "xorq %%rcx,%%rcx\n"
+    /* tx = t4 >> 48 (tmp3) */
+    "movq %%rsi,%%rax\n"
+    "shrq $48,%%rax\n"
+    "movq %%rax,%q3\n"
+    /* t4 &= (M >> 4) (tmp2) */
+    "movq $0xffffffffffff,%%rax\n"
+    "andq %%rax,%%rsi\n"
+    "movq %%rsi,%q2\n"
+    /* c = a0 * a0 */
+    "movq %%r10,%%rdx\n"
+    "mulxq %%r10,%%r8,%%r9\n"
+    /* d += a1 * a4 */
+    "movq %%r11,%%rdx\n"
+    "mulxq %%r14,%%rax,%%rsi\n"
+    "addq %%rax,%%rbx\n"
+    "adcq %%rsi,%%rcx\n"
+    /* d += (a2*2) * a3 */
+    "leaq (%%r12,%%r12,1),%%rdx\n"
+    "mulxq %%r13,%%rax,%%rsi\n"
+    "addq %%rax,%%rbx\n"
+    "adcq %%rsi,%%rcx\n"
+    /* u0 = d & M (%%rsi) */
+    "movq %%rbx,%%rsi\n"
+    "andq %%r15,%%rsi\n"
+    /* d >>= 52 */
+    "shrdq $52,%%rcx,%%rbx\n"
+    "xorq %%rcx,%%rcx\n"
+    /* u0 = (u0 << 4) | tx (%%rsi) */
+    "shlq $4,%%rsi\n"
+    "orq %q3,%%rsi\n"
+    /* c += u0 * (R >> 4) */
+    "movq $0x1000003d1,%%rdx\n"
+    "mulxq %%rsi,%%rax,%%rsi\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rsi,%%r9\n"
+    /* r[0] = c & M */
+    "movq %%r8,%%rax\n"
+    "andq %%r15,%%rax\n"
+    "movq %%rax,0(%%rdi)\n"
+    /* c >>= 52 */
+    "shrdq $52,%%r9,%%r8\n"
+    /* a0 *= 2 */
+    "leaq (%%r10,%%r10,1),%%r10\n"
+    "xorq %%r9,%%r9\n"
+    /* c += a0 * a1 */
+    "movq %%r10,%%rdx\n"
+    "mulxq %%r11,%%rax,%%rsi\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rsi,%%r9\n"
+    /* d += a2 * a4 */
+    "movq %%r12,%%rdx\n"
+    "mulxq %%r14,%%rax,%%rsi\n"
+    "addq %%rax,%%rbx\n"
+    "adcq %%rsi,%%rcx\n"
+    /* d += a3 * a3 */
+    "movq %%r13,%%rdx\n"
+    "mulxq %%r13,%%rax,%%rsi\n"
+    "addq %%rax,%%rbx\n"
+    "adcq %%rsi,%%rcx\n"
+    /* c += (d & M) * R */
+    "movq %%rbx,%%rax\n"
+    "andq %%r15,%%rax\n"
+    "movq $0x1000003d10,%%rdx\n"
+    "mulxq %%rax,%%rax,%%rsi\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rsi,%%r9\n"
+    /* d >>= 52 */
+    "shrdq $52,%%rcx,%%rbx\n"
+    "xorq %%rcx,%%rcx\n"
+    /* r[1] = c & M */
+    "movq %%r8,%%rax\n"
+    "andq %%r15,%%rax\n"
+    "movq %%rax,8(%%rdi)\n"
+    /* c >>= 52 */
+    "shrdq $52,%%r9,%%r8\n"
+    "xorq %%r9,%%r9\n"
+    /* c += a0 * a2 */
+    "movq %%r10,%%rdx\n"
+    "mulxq %%r12,%%rax,%%rsi\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rsi,%%r9\n"
+    /* d += a3 * a4 */
+    "movq %%r13,%%rdx\n"
+    "mulxq %%r14,%%rax,%%rsi\n"
+    "addq %%rax,%%rbx\n"
+    "adcq %%rsi,%%rcx\n"
+    /* c += a1 * a1 */
+    "movq %%r11,%%rdx\n"
+    "mulxq %%r11,%%rax,%%rsi\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rsi,%%r9\n"
+    /* c += (d & M) * R */
+    "movq %%rbx,%%rax\n"
+    "andq %%r15,%%rax\n"
+    "movq $0x1000003d10,%%rdx\n"
+    "mulxq %%rax,%%rax,%%rsi\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rsi,%%r9\n"
+    /* d >>= 52 (%%rbx only) */
+    "shrdq $52,%%rcx,%%rbx\n"
+    /* r[2] = c & M */
+    "movq %%r8,%%rax\n"
+    "andq %%r15,%%rax\n"
+    "movq %%rax,16(%%rdi)\n"
+    /* c >>= 52 */
+    "shrdq $52,%%r9,%%r8\n"
+    "xorq %%r9,%%r9\n"
+    /* c += t3 */
+    "addq %q1,%%r8\n"
+    /* c += d * R */
+    "movq $0x1000003d10,%%rdx\n"
+    "mulxq %%rbx,%%rax,%%rsi\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rsi,%%r9\n"
+    /* r[3] = c & M */
+    "movq %%r8,%%rax\n"
+    "andq %%r15,%%rax\n"
+    "movq %%rax,24(%%rdi)\n"
+    /* c >>= 52 (%%r8 only) */
+    "shrdq $52,%%r9,%%r8\n"
+    /* c += t4 (%%r8 only) */
+    "addq %q2,%%r8\n"
+    /* r[4] = c */
+    "movq %%r8,32(%%rdi)\n"
+: "+S"(a), "=m"(tmp1), "=m"(tmp2), "=m"(tmp3)
+: "D"(r)
+: "%rax", "%rbx", "%rcx", "%rdx", "%r8", "%r9", "%r10", "%r11", "%r12", "%r13", "%r14", "%r15", "cc", "memory"
+);
+}
+
+#endif
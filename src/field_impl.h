@@ -21,6 +21,18 @@
 #error "Please select field implementation"
 #endif
 
+#include "cpu_impl.h"
+#include "field_x8_impl.h"
+
+SECP256K1_INLINE static void secp256k1_fe_verify_magnitude(const secp256k1_fe *a, int m) {
+#ifdef VERIFY
+    VERIFY_CHECK(a->magnitude <= m);
+#else
+    (void)a;
+    (void)m;
+#endif
+}
+
 SECP256K1_INLINE static int secp256k1_fe_equal_var(const secp256k1_fe *a, const secp256k1_fe *b) {
     secp256k1_fe na;
     secp256k1_fe_negate(&na, a, 1);
@@ -126,139 +138,127 @@ static int secp256k1_fe_sqrt_var(secp256k1_fe *r, const secp256k1_fe *a) {
     return secp256k1_fe_equal_var(&t1, a);
 }
 
-static void secp256k1_fe_inv(secp256k1_fe *r, const secp256k1_fe *a) {
-    secp256k1_fe x2, x3, x6, x9, x11, x22, x44, x88, x176, x220, x223, t1;
+#ifdef USE_AVX512IFMA
+/* Below this many elements, the lane version gains too little over the plain chain. */
+#define SECP256K1_FE_INV_ALL_X8_MIN 32
+
+/** Montgomery's trick on eight interleaved chains: lane j multiplies up the elements
+ *  j, j+8, j+16, ..., so every step does eight independent multiplications at once.
+ *  Only the eight lane totals are inverted, with secp256k1_fe_inv_all(_var). The
+ *  running time only depends on len, and the tail of the last group is padded with
+ *  ones. Requires len >= 16. */
+static SECP256K1_TARGET_AVX512IFMA void secp256k1_fe_inv_all_x8(size_t len, secp256k1_fe *r, const secp256k1_fe *a, int var) {
+    secp256k1_fe t[8], ti[8];
+    secp256k1_fe_x8 u, v;
+    size_t groups = (len + 7) / 8, tail = len - 8 * (groups - 1);
+    size_t i;
     int j;
 
-    /** The binary representation of (p - 2) has 5 blocks of 1s, with lengths in
-     *  { 1, 2, 22, 223 }. Use an addition chain to calculate 2^n - 1 for each block:
-     *  [1], [2], 3, 6, 9, 11, [22], 44, 88, 176, 220, [223]
-     */
-
-    secp256k1_fe_sqr(&x2, a);
-    secp256k1_fe_mul(&x2, &x2, a);
-
-    secp256k1_fe_sqr(&x3, &x2);
-    secp256k1_fe_mul(&x3, &x3, a);
+    VERIFY_CHECK(len >= 16);
+    VERIFY_CHECK((r + len <= a) || (a + len <= r));
 
-    x6 = x3;
-    for (j=0; j<3; j++) {
-        secp256k1_fe_sqr(&x6, &x6);
+    /* Group i of r receives the lane prefix products up to group i. */
+    for (j = 0; j < 8; j++) {
+        r[j] = a[j];
+        secp256k1_fe_set_int(&t[j], 1);
     }
-    secp256k1_fe_mul(&x6, &x6, &x3);
-
-    x9 = x6;
-    for (j=0; j<3; j++) {
-        secp256k1_fe_sqr(&x9, &x9);
+    secp256k1_fe_x8_set_fe(&u, a);
+    for (i = 1; i < groups; i++) {
+        if (i < groups - 1) {
+            secp256k1_fe_x8_set_fe(&v, &a[8 * i]);
+            secp256k1_fe_x8_mul(&u, &u, &v);
+            secp256k1_fe_x8_get_fe(&r[8 * i], &u);
+        } else {
+            for (j = 0; j < (int)tail; j++) {
+                t[j] = a[8 * i + j];
+            }
+            secp256k1_fe_x8_set_fe(&v, t);
+            secp256k1_fe_x8_mul(&u, &u, &v);
+            secp256k1_fe_x8_get_fe(t, &u);
+            for (j = 0; j < (int)tail; j++) {
+                r[8 * i + j] = t[j];
+            }
+        }
     }
-    secp256k1_fe_mul(&x9, &x9, &x3);
 
-    x11 = x9;
-    for (j=0; j<2; j++) {
-        secp256k1_fe_sqr(&x11, &x11);
+    secp256k1_fe_x8_get_fe(t, &u);
+    if (var) {
+        secp256k1_fe_inv_all_var(8, ti, t);
+    } else {
+        secp256k1_fe_inv_all(8, ti, t);
     }
-    secp256k1_fe_mul(&x11, &x11, &x2);
-
-    x22 = x11;
-    for (j=0; j<11; j++) {
-        secp256k1_fe_sqr(&x22, &x22);
+    secp256k1_fe_x8_set_fe(&u, ti);
+
+    /* Walk back: group i of r becomes the prefix of group i-1 times the inverse
+     * of the prefix of group i, and u drops group i from its totals. */
+    for (i = groups - 1; i > 0; i--) {
+        secp256k1_fe_x8_set_fe(&v, &r[8 * (i - 1)]);
+        secp256k1_fe_x8_mul(&v, &v, &u);
+        if (i < groups - 1) {
+            secp256k1_fe_x8_get_fe(&r[8 * i], &v);
+            secp256k1_fe_x8_set_fe(&v, &a[8 * i]);
+        } else {
+            secp256k1_fe_x8_get_fe(t, &v);
+            for (j = 0; j < (int)tail; j++) {
+                r[8 * i + j] = t[j];
+                t[j] = a[8 * i + j];
+            }
+            for (; j < 8; j++) {
+                secp256k1_fe_set_int(&t[j], 1);
+            }
+            secp256k1_fe_x8_set_fe(&v, t);
+        }
+        secp256k1_fe_x8_mul(&u, &u, &v);
     }
-    secp256k1_fe_mul(&x22, &x22, &x11);
+    secp256k1_fe_x8_get_fe(r, &u);
+}
+#endif
 
-    x44 = x22;
-    for (j=0; j<22; j++) {
-        secp256k1_fe_sqr(&x44, &x44);
+static void secp256k1_fe_inv_all_var(size_t len, secp256k1_fe *r, const secp256k1_fe *a) {
+    secp256k1_fe u;
+    size_t i;
+    if (len < 1) {
+        return;
     }
-    secp256k1_fe_mul(&x44, &x44, &x22);
-
-    x88 = x44;
-    for (j=0; j<44; j++) {
-        secp256k1_fe_sqr(&x88, &x88);
+#ifdef USE_AVX512IFMA
+    if (len >= SECP256K1_FE_INV_ALL_X8_MIN && secp256k1_cpu_has(SECP256K1_CPU_AVX512IFMA)) {
+        secp256k1_fe_inv_all_x8(len, r, a, 1);
+        return;
     }
-    secp256k1_fe_mul(&x88, &x88, &x44);
+#endif
 
-    x176 = x88;
-    for (j=0; j<88; j++) {
-        secp256k1_fe_sqr(&x176, &x176);
-    }
-    secp256k1_fe_mul(&x176, &x176, &x88);
+    VERIFY_CHECK((r + len <= a) || (a + len <= r));
 
-    x220 = x176;
-    for (j=0; j<44; j++) {
-        secp256k1_fe_sqr(&x220, &x220);
-    }
-    secp256k1_fe_mul(&x220, &x220, &x44);
+    r[0] = a[0];
 
-    x223 = x220;
-    for (j=0; j<3; j++) {
-        secp256k1_fe_sqr(&x223, &x223);
+    i = 0;
+    while (++i < len) {
+        secp256k1_fe_mul(&r[i], &r[i - 1], &a[i]);
     }
-    secp256k1_fe_mul(&x223, &x223, &x3);
 
-    /* The final result is then assembled using a sliding window over the blocks. */
+    secp256k1_fe_inv_var(&u, &r[--i]);
 
-    t1 = x223;
-    for (j=0; j<23; j++) {
-        secp256k1_fe_sqr(&t1, &t1);
-    }
-    secp256k1_fe_mul(&t1, &t1, &x22);
-    for (j=0; j<5; j++) {
-        secp256k1_fe_sqr(&t1, &t1);
-    }
-    secp256k1_fe_mul(&t1, &t1, a);
-    for (j=0; j<3; j++) {
-        secp256k1_fe_sqr(&t1, &t1);
-    }
-    secp256k1_fe_mul(&t1, &t1, &x2);
-    for (j=0; j<2; j++) {
-        secp256k1_fe_sqr(&t1, &t1);
+    while (i > 0) {
+        size_t j = i--;
+        secp256k1_fe_mul(&r[j], &r[i], &u);
+        secp256k1_fe_mul(&u, &u, &a[j]);
     }
-    secp256k1_fe_mul(r, a, &t1);
-}
 
-static void secp256k1_fe_inv_var(secp256k1_fe *r, const secp256k1_fe *a) {
-#if defined(USE_FIELD_INV_BUILTIN)
-    secp256k1_fe_inv(r, a);
-#elif defined(USE_FIELD_INV_NUM)
-    secp256k1_num n, m;
-    static const secp256k1_fe negone = SECP256K1_FE_CONST(
-        0xFFFFFFFFUL, 0xFFFFFFFFUL, 0xFFFFFFFFUL, 0xFFFFFFFFUL,
-        0xFFFFFFFFUL, 0xFFFFFFFFUL, 0xFFFFFFFEUL, 0xFFFFFC2EUL
-    );
-    /* secp256k1 field prime, value p defined in "Standards for Efficient Cryptography" (SEC2) 2.7.1. */
-    static const unsigned char prime[32] = {
-        0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
-        0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
-        0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
-        0xFF,0xFF,0xFF,0xFE,0xFF,0xFF,0xFC,0x2F
-    };
-    unsigned char b[32];
-    int res;
-    secp256k1_fe c = *a;
-    secp256k1_fe_normalize_var(&c);
-    secp256k1_fe_get_b32(b, &c);
-    secp256k1_num_set_bin(&n, b, 32);
-    secp256k1_num_set_bin(&m, prime, 32);
-    secp256k1_num_mod_inverse(&n, &n, &m);
-    secp256k1_num_get_bin(b, 32, &n);
-    res = secp256k1_fe_set_b32(r, b);
-    (void)res;
-    VERIFY_CHECK(res);
-    /* Verify the result is the (unique) valid inverse using non-GMP code. */
-    secp256k1_fe_mul(&c, &c, r);
-    secp256k1_fe_add(&c, &negone);
-    CHECK(secp256k1_fe_normalizes_to_zero_var(&c));
-#else
-#error "Please select field inverse implementation"
-#endif
+    r[0] = u;
 }
 
-static void secp256k1_fe_inv_all_var(size_t len, secp256k1_fe *r, const secp256k1_fe *a) {
+static void secp256k1_fe_inv_all(size_t len, secp256k1_fe *r, const secp256k1_fe *a) {
     secp256k1_fe u;
     size_t i;
     if (len < 1) {
         return;
     }
+#ifdef USE_AVX512IFMA
+    if (len >= SECP256K1_FE_INV_ALL_X8_MIN && secp256k1_cpu_has(SECP256K1_CPU_AVX512IFMA)) {
+        secp256k1_fe_inv_all_x8(len, r, a, 0);
+        return;
+    }
+#endif
 
     VERIFY_CHECK((r + len <= a) || (a + len <= r));
 
@@ -269,7 +269,7 @@ static void secp256k1_fe_inv_all_var(size_t len, secp256k1_fe *r, const secp256k
         secp256k1_fe_mul(&r[i], &r[i - 1], &a[i]);
     }
 
-    secp256k1_fe_inv_var(&u, &r[--i]);
+    secp256k1_fe_inv(&u, &r[--i]);
 
     while (i > 0) {
         size_t j = i--;
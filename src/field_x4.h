@@ -0,0 +1,78 @@
+/**********************************************************************
+ * Copyright (c) 2016 libsecp256k1 contributors                       *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_FIELD_X4_
+#define _SECP256K1_FIELD_X4_
+
+/** Four-lane field arithmetic.
+ *
+ *  A secp256k1_fe_x4 holds four independent field elements, which every
+ *  operation processes in lockstep using AVX2. The lanes use the 10x26
+ *  representation of field_10x26.h in structure-of-arrays layout, so one
+ *  256-bit vector holds the same limb of all four elements, each in the low
+ *  half of a 64-bit slot where _mm256_mul_epu32 picks up its operands. The
+ *  magnitude rules are those of field.h and hold for all lanes together.
+ *
+ *  Functions that take or return lane flags use bit j for lane j.
+ *
+ *  Only compiled in when USE_AVX2 is defined; callers must also check
+ *  secp256k1_cpu_has(SECP256K1_CPU_AVX2) before using any of this.
+ */
+
+#if defined HAVE_CONFIG_H
+#include "libsecp256k1-config.h"
+#endif
+
+#include "field.h"
+
+#ifdef USE_AVX2
+
+#define SECP256K1_TARGET_AVX2 __attribute__((target("avx2")))
+
+typedef struct {
+    /* Limb i of lane j is n[4*i+j]; lane j is sum(i=0..9, n[4*i+j] << (i*26)). */
+    uint64_t n[40];
+#ifdef VERIFY
+    int magnitude;
+#endif
+} secp256k1_fe_x4;
+
+/** Set the lanes of r to the four field elements a[0..3]. The result has magnitude 1. */
+static SECP256K1_TARGET_AVX2 void secp256k1_fe_x4_set_fe(secp256k1_fe_x4 *r, const secp256k1_fe *a);
+
+/** Store the lanes of a in r[0..3], keeping their magnitude. */
+static SECP256K1_TARGET_AVX2 void secp256k1_fe_x4_get_fe(secp256k1_fe *r, const secp256k1_fe_x4 *a);
+
+/** Set all lanes to a small integer. The result has magnitude 1. */
+static SECP256K1_TARGET_AVX2 void secp256k1_fe_x4_set_int(secp256k1_fe_x4 *r, int a);
+
+/** Weakly normalize all lanes, reducing the magnitude to 1. */
+static SECP256K1_TARGET_AVX2 void secp256k1_fe_x4_normalize_weak(secp256k1_fe_x4 *r);
+
+/** Return the flags of the lanes that normalize to zero. Constant time. */
+static SECP256K1_TARGET_AVX2 int secp256k1_fe_x4_normalizes_to_zero(const secp256k1_fe_x4 *r);
+
+/** Set r to the negation of a, which has magnitude at most m. The result has magnitude m+1. */
+static SECP256K1_TARGET_AVX2 void secp256k1_fe_x4_negate(secp256k1_fe_x4 *r, const secp256k1_fe_x4 *a, int m);
+
+/** Multiply all lanes by a small integer. The magnitude is multiplied by a too. */
+static SECP256K1_TARGET_AVX2 void secp256k1_fe_x4_mul_int(secp256k1_fe_x4 *r, int a);
+
+/** Add a to r. The magnitude of the result is the sum of both. */
+static SECP256K1_TARGET_AVX2 void secp256k1_fe_x4_add(secp256k1_fe_x4 *r, const secp256k1_fe_x4 *a);
+
+/** Multiply two sets of lanes. Both inputs must have magnitude at most 8; the result has magnitude 1. */
+static SECP256K1_TARGET_AVX2 void secp256k1_fe_x4_mul(secp256k1_fe_x4 *r, const secp256k1_fe_x4 *a, const secp256k1_fe_x4 *b);
+
+/** Square all lanes. The input must have magnitude at most 8; the result has magnitude 1. */
+static SECP256K1_TARGET_AVX2 void secp256k1_fe_x4_sqr(secp256k1_fe_x4 *r, const secp256k1_fe_x4 *a);
+
+/** Replace the lanes of r selected by flags with those of a. Constant time. */
+static SECP256K1_TARGET_AVX2 void secp256k1_fe_x4_cmov(secp256k1_fe_x4 *r, const secp256k1_fe_x4 *a, int flags);
+
+#endif
+
+#endif
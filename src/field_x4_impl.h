@@ -0,0 +1,574 @@
+/**********************************************************************
+ * Copyright (c) 2016 libsecp256k1 contributors                       *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_FIELD_X4_IMPL_H_
+#define _SECP256K1_FIELD_X4_IMPL_H_
+
+#if defined HAVE_CONFIG_H
+#include "libsecp256k1-config.h"
+#endif
+
+#include "util.h"
+#include "field_x4.h"
+
+#ifdef USE_AVX2
+
+#include <immintrin.h>
+
+#ifdef VERIFY
+static void secp256k1_fe_x4_verify(const secp256k1_fe_x4 *a) {
+    uint64_t m = 2 * a->magnitude;
+    int i, r = 1;
+    for (i = 0; i < 40; i++) {
+        r &= (a->n[i] <= (i < 36 ? 0x3FFFFFFULL : 0x03FFFFFULL) * m);
+    }
+    r &= (a->magnitude >= 0);
+    r &= (a->magnitude <= 32);
+    VERIFY_CHECK(r == 1);
+}
+#else
+static void secp256k1_fe_x4_verify(const secp256k1_fe_x4 *a) {
+    (void)a;
+}
+#endif
+
+static SECP256K1_TARGET_AVX2 SECP256K1_INLINE __m256i secp256k1_fe_x4_load(const secp256k1_fe_x4 *a, int i) {
+    return _mm256_loadu_si256((const __m256i *)&a->n[4 * i]);
+}
+
+static SECP256K1_TARGET_AVX2 SECP256K1_INLINE void secp256k1_fe_x4_store(secp256k1_fe_x4 *r, int i, __m256i x) {
+    _mm256_storeu_si256((__m256i *)&r->n[4 * i], x);
+}
+
+/* Expand lane flags into a mask with all bits of the selected lanes set. */
+static SECP256K1_TARGET_AVX2 SECP256K1_INLINE __m256i secp256k1_fe_x4_mask(int flags) {
+    return _mm256_set_epi64x(-(int64_t)((flags >> 3) & 1), -(int64_t)((flags >> 2) & 1), -(int64_t)((flags >> 1) & 1), -(int64_t)(flags & 1));
+}
+
+static SECP256K1_TARGET_AVX2 void secp256k1_fe_x4_set_fe(secp256k1_fe_x4 *r, const secp256k1_fe *a) {
+    int i, j;
+    for (j = 0; j < 4; j++) {
+        secp256k1_fe t = a[j];
+        secp256k1_fe_normalize(&t);
+#if defined(USE_FIELD_10X26)
+        for (i = 0; i < 10; i++) {
+            r->n[4 * i + j] = t.n[i];
+        }
+#else
+        for (i = 0; i < 5; i++) {
+            r->n[8 * i + j] = t.n[i] & 0x3FFFFFFULL;
+            r->n[8 * i + 4 + j] = t.n[i] >> 26;
+        }
+#endif
+    }
+#ifdef VERIFY
+    r->magnitude = 1;
+#endif
+    secp256k1_fe_x4_verify(r);
+}
+
+static SECP256K1_TARGET_AVX2 void secp256k1_fe_x4_get_fe(secp256k1_fe *r, const secp256k1_fe_x4 *a) {
+    int i, j;
+    secp256k1_fe_x4_verify(a);
+    for (j = 0; j < 4; j++) {
+#if defined(USE_FIELD_10X26)
+        for (i = 0; i < 10; i++) {
+            r[j].n[i] = a->n[4 * i + j];
+        }
+#else
+        /* A limb pair of magnitude m fits a 5x52 limb of magnitude m. */
+        for (i = 0; i < 5; i++) {
+            r[j].n[i] = a->n[8 * i + j] + (a->n[8 * i + 4 + j] << 26);
+        }
+#endif
+#ifdef VERIFY
+        r[j].magnitude = a->magnitude;
+        r[j].normalized = 0;
+        secp256k1_fe_verify(&r[j]);
+#endif
+    }
+}
+
+static SECP256K1_TARGET_AVX2 void secp256k1_fe_x4_set_int(secp256k1_fe_x4 *r, int a) {
+    int i;
+    secp256k1_fe_x4_store(r, 0, _mm256_set1_epi64x(a));
+    for (i = 1; i < 10; i++) {
+        secp256k1_fe_x4_store(r, i, _mm256_setzero_si256());
+    }
+#ifdef VERIFY
+    r->magnitude = 1;
+#endif
+    secp256k1_fe_x4_verify(r);
+}
+
+#define SECP256K1_FE_X4_CARRY(lo, hi) do { \
+    hi = _mm256_add_epi64(hi, _mm256_srli_epi64(lo, 26)); \
+    lo = _mm256_and_si256(lo, _mm256_set1_epi64x(0x3FFFFFFULL)); \
+} while(0)
+
+static SECP256K1_TARGET_AVX2 void secp256k1_fe_x4_normalize_weak(secp256k1_fe_x4 *r) {
+    __m256i t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, x;
+    t0 = secp256k1_fe_x4_load(r, 0);
+    t1 = secp256k1_fe_x4_load(r, 1);
+    t2 = secp256k1_fe_x4_load(r, 2);
+    t3 = secp256k1_fe_x4_load(r, 3);
+    t4 = secp256k1_fe_x4_load(r, 4);
+    t5 = secp256k1_fe_x4_load(r, 5);
+    t6 = secp256k1_fe_x4_load(r, 6);
+    t7 = secp256k1_fe_x4_load(r, 7);
+    t8 = secp256k1_fe_x4_load(r, 8);
+    t9 = secp256k1_fe_x4_load(r, 9);
+
+    /* Reduce t9 at the start so there will be at most a single carry from the first pass */
+    x = _mm256_srli_epi64(t9, 22);
+    t9 = _mm256_and_si256(t9, _mm256_set1_epi64x(0x03FFFFFULL));
+
+    /* The first pass ensures the magnitude is 1, ... */
+    t0 = _mm256_add_epi64(t0, _mm256_mul_epu32(x, _mm256_set1_epi64x(0x3D1ULL)));
+    t1 = _mm256_add_epi64(t1, _mm256_slli_epi64(x, 6));
+    SECP256K1_FE_X4_CARRY(t0, t1);
+    SECP256K1_FE_X4_CARRY(t1, t2);
+    SECP256K1_FE_X4_CARRY(t2, t3);
+    SECP256K1_FE_X4_CARRY(t3, t4);
+    SECP256K1_FE_X4_CARRY(t4, t5);
+    SECP256K1_FE_X4_CARRY(t5, t6);
+    SECP256K1_FE_X4_CARRY(t6, t7);
+    SECP256K1_FE_X4_CARRY(t7, t8);
+    SECP256K1_FE_X4_CARRY(t8, t9);
+
+    /* ... except for a possible carry at bit 22 of t9 (i.e. bit 256 of the field element) */
+    secp256k1_fe_x4_store(r, 0, t0);
+    secp256k1_fe_x4_store(r, 1, t1);
+    secp256k1_fe_x4_store(r, 2, t2);
+    secp256k1_fe_x4_store(r, 3, t3);
+    secp256k1_fe_x4_store(r, 4, t4);
+    secp256k1_fe_x4_store(r, 5, t5);
+    secp256k1_fe_x4_store(r, 6, t6);
+    secp256k1_fe_x4_store(r, 7, t7);
+    secp256k1_fe_x4_store(r, 8, t8);
+    secp256k1_fe_x4_store(r, 9, t9);
+#ifdef VERIFY
+    r->magnitude = 1;
+#endif
+    secp256k1_fe_x4_verify(r);
+}
+
+static SECP256K1_TARGET_AVX2 int secp256k1_fe_x4_normalizes_to_zero(const secp256k1_fe_x4 *r) {
+    const __m256i m26 = _mm256_set1_epi64x(0x3FFFFFFULL);
+    __m256i t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, x, z0, z1;
+    t0 = secp256k1_fe_x4_load(r, 0);
+    t1 = secp256k1_fe_x4_load(r, 1);
+    t2 = secp256k1_fe_x4_load(r, 2);
+    t3 = secp256k1_fe_x4_load(r, 3);
+    t4 = secp256k1_fe_x4_load(r, 4);
+    t5 = secp256k1_fe_x4_load(r, 5);
+    t6 = secp256k1_fe_x4_load(r, 6);
+    t7 = secp256k1_fe_x4_load(r, 7);
+    t8 = secp256k1_fe_x4_load(r, 8);
+    t9 = secp256k1_fe_x4_load(r, 9);
+
+    /* Reduce t9 at the start so there will be at most a single carry from the first pass */
+    x = _mm256_srli_epi64(t9, 22);
+    t9 = _mm256_and_si256(t9, _mm256_set1_epi64x(0x03FFFFFULL));
+
+    /* The first pass ensures the magnitude is 1, ... */
+    t0 = _mm256_add_epi64(t0, _mm256_mul_epu32(x, _mm256_set1_epi64x(0x3D1ULL)));
+    t1 = _mm256_add_epi64(t1, _mm256_slli_epi64(x, 6));
+    SECP256K1_FE_X4_CARRY(t0, t1);
+    SECP256K1_FE_X4_CARRY(t1, t2);
+    SECP256K1_FE_X4_CARRY(t2, t3);
+    SECP256K1_FE_X4_CARRY(t3, t4);
+    SECP256K1_FE_X4_CARRY(t4, t5);
+    SECP256K1_FE_X4_CARRY(t5, t6);
+    SECP256K1_FE_X4_CARRY(t6, t7);
+    SECP256K1_FE_X4_CARRY(t7, t8);
+    SECP256K1_FE_X4_CARRY(t8, t9);
+
+    /* z0 tracks a possible raw value of 0, z1 tracks a possible raw value of P */
+    z0 = _mm256_or_si256(t0, t1);
+    z1 = _mm256_and_si256(_mm256_xor_si256(t0, _mm256_set1_epi64x(0x3D0ULL)), _mm256_xor_si256(t1, _mm256_set1_epi64x(0x40ULL)));
+    z0 = _mm256_or_si256(z0, _mm256_or_si256(_mm256_or_si256(t2, t3), _mm256_or_si256(t4, t5)));
+    z1 = _mm256_and_si256(z1, _mm256_and_si256(_mm256_and_si256(t2, t3), _mm256_and_si256(t4, t5)));
+    z0 = _mm256_or_si256(z0, _mm256_or_si256(_mm256_or_si256(t6, t7), _mm256_or_si256(t8, t9)));
+    z1 = _mm256_and_si256(z1, _mm256_and_si256(_mm256_and_si256(t6, t7), _mm256_and_si256(t8, _mm256_xor_si256(t9, _mm256_set1_epi64x(0x3C00000ULL)))));
+
+    /* ... except for a possible carry at bit 22 of t9 (i.e. bit 256 of the field element) */
+    x = _mm256_or_si256(_mm256_cmpeq_epi64(z0, _mm256_setzero_si256()), _mm256_cmpeq_epi64(z1, m26));
+    return _mm256_movemask_pd(_mm256_castsi256_pd(x));
+}
+
+static SECP256K1_TARGET_AVX2 void secp256k1_fe_x4_negate(secp256k1_fe_x4 *r, const secp256k1_fe_x4 *a, int m) {
+    uint64_t k = 2 * (m + 1);
+    int i;
+#ifdef VERIFY
+    VERIFY_CHECK(a->magnitude <= m);
+    secp256k1_fe_x4_verify(a);
+#endif
+    secp256k1_fe_x4_store(r, 0, _mm256_sub_epi64(_mm256_set1_epi64x(0x3FFFC2FULL * k), secp256k1_fe_x4_load(a, 0)));
+    secp256k1_fe_x4_store(r, 1, _mm256_sub_epi64(_mm256_set1_epi64x(0x3FFFFBFULL * k), secp256k1_fe_x4_load(a, 1)));
+    for (i = 2; i < 9; i++) {
+        secp256k1_fe_x4_store(r, i, _mm256_sub_epi64(_mm256_set1_epi64x(0x3FFFFFFULL * k), secp256k1_fe_x4_load(a, i)));
+    }
+    secp256k1_fe_x4_store(r, 9, _mm256_sub_epi64(_mm256_set1_epi64x(0x03FFFFFULL * k), secp256k1_fe_x4_load(a, 9)));
+#ifdef VERIFY
+    r->magnitude = m + 1;
+    secp256k1_fe_x4_verify(r);
+#endif
+}
+
+static SECP256K1_TARGET_AVX2 void secp256k1_fe_x4_mul_int(secp256k1_fe_x4 *r, int a) {
+    const __m256i k = _mm256_set1_epi64x(a);
+    int i;
+    for (i = 0; i < 10; i++) {
+        secp256k1_fe_x4_store(r, i, _mm256_mul_epu32(secp256k1_fe_x4_load(r, i), k));
+    }
+#ifdef VERIFY
+    r->magnitude *= a;
+    secp256k1_fe_x4_verify(r);
+#endif
+}
+
+static SECP256K1_TARGET_AVX2 void secp256k1_fe_x4_add(secp256k1_fe_x4 *r, const secp256k1_fe_x4 *a) {
+    int i;
+#ifdef VERIFY
+    secp256k1_fe_x4_verify(a);
+#endif
+    for (i = 0; i < 10; i++) {
+        secp256k1_fe_x4_store(r, i, _mm256_add_epi64(secp256k1_fe_x4_load(r, i), secp256k1_fe_x4_load(a, i)));
+    }
+#ifdef VERIFY
+    r->magnitude += a->magnitude;
+    secp256k1_fe_x4_verify(r);
+#endif
+}
+
+/* Reduce the 19 product columns t0..t18, each below 2^64, to a result of magnitude 1 in r. */
+#define SECP256K1_FE_X4_REDUCE(r) do { \
+    const __m256i r0 = _mm256_set1_epi64x(0x3D10ULL); \
+    __m256i t19, c; \
+    /* Bring every column down to 26 bits; t19 receives the bits from 2^494 up, \
+     * which is less than 2^26 as the inputs have magnitude at most 8. */ \
+    SECP256K1_FE_X4_CARRY(t0, t1); \
+    SECP256K1_FE_X4_CARRY(t1, t2); \
+    SECP256K1_FE_X4_CARRY(t2, t3); \
+    SECP256K1_FE_X4_CARRY(t3, t4); \
+    SECP256K1_FE_X4_CARRY(t4, t5); \
+    SECP256K1_FE_X4_CARRY(t5, t6); \
+    SECP256K1_FE_X4_CARRY(t6, t7); \
+    SECP256K1_FE_X4_CARRY(t7, t8); \
+    SECP256K1_FE_X4_CARRY(t8, t9); \
+    SECP256K1_FE_X4_CARRY(t9, t10); \
+    SECP256K1_FE_X4_CARRY(t10, t11); \
+    SECP256K1_FE_X4_CARRY(t11, t12); \
+    SECP256K1_FE_X4_CARRY(t12, t13); \
+    SECP256K1_FE_X4_CARRY(t13, t14); \
+    SECP256K1_FE_X4_CARRY(t14, t15); \
+    SECP256K1_FE_X4_CARRY(t15, t16); \
+    SECP256K1_FE_X4_CARRY(t16, t17); \
+    SECP256K1_FE_X4_CARRY(t17, t18); \
+    t19 = _mm256_srli_epi64(t18, 26); \
+    t18 = _mm256_and_si256(t18, _mm256_set1_epi64x(0x3FFFFFFULL)); \
+    /* 2^260 = 0x1000003D10 = 0x400 * 2^26 + 0x3D10 (mod p), so column i >= 10 \
+     * folds into columns i-10 and i-9. Column 19 goes first and column 10 is \
+     * carried again, so the columns multiplied below all fit in 32 bits. */ \
+    t9 = _mm256_add_epi64(t9, _mm256_mul_epu32(t19, r0)); \
+    t10 = _mm256_add_epi64(t10, _mm256_slli_epi64(t19, 10)); \
+    SECP256K1_FE_X4_CARRY(t10, t11); \
+    t0 = _mm256_add_epi64(t0, _mm256_mul_epu32(t10, r0)); \
+    t1 = _mm256_add_epi64(t1, _mm256_slli_epi64(t10, 10)); \
+    t1 = _mm256_add_epi64(t1, _mm256_mul_epu32(t11, r0)); \
+    t2 = _mm256_add_epi64(t2, _mm256_slli_epi64(t11, 10)); \
+    t2 = _mm256_add_epi64(t2, _mm256_mul_epu32(t12, r0)); \
+    t3 = _mm256_add_epi64(t3, _mm256_slli_epi64(t12, 10)); \
+    t3 = _mm256_add_epi64(t3, _mm256_mul_epu32(t13, r0)); \
+    t4 = _mm256_add_epi64(t4, _mm256_slli_epi64(t13, 10)); \
+    t4 = _mm256_add_epi64(t4, _mm256_mul_epu32(t14, r0)); \
+    t5 = _mm256_add_epi64(t5, _mm256_slli_epi64(t14, 10)); \
+    t5 = _mm256_add_epi64(t5, _mm256_mul_epu32(t15, r0)); \
+    t6 = _mm256_add_epi64(t6, _mm256_slli_epi64(t15, 10)); \
+    t6 = _mm256_add_epi64(t6, _mm256_mul_epu32(t16, r0)); \
+    t7 = _mm256_add_epi64(t7, _mm256_slli_epi64(t16, 10)); \
+    t7 = _mm256_add_epi64(t7, _mm256_mul_epu32(t17, r0)); \
+    t8 = _mm256_add_epi64(t8, _mm256_slli_epi64(t17, 10)); \
+    t8 = _mm256_add_epi64(t8, _mm256_mul_epu32(t18, r0)); \
+    t9 = _mm256_add_epi64(t9, _mm256_slli_epi64(t18, 10)); \
+    /* Carry the low columns, and fold the bits of t9 from 2^256 up back in \
+     * with 2^256 = 0x1000003D1 (mod p). */ \
+    SECP256K1_FE_X4_CARRY(t0, t1); \
+    SECP256K1_FE_X4_CARRY(t1, t2); \
+    SECP256K1_FE_X4_CARRY(t2, t3); \
+    SECP256K1_FE_X4_CARRY(t3, t4); \
+    SECP256K1_FE_X4_CARRY(t4, t5); \
+    SECP256K1_FE_X4_CARRY(t5, t6); \
+    SECP256K1_FE_X4_CARRY(t6, t7); \
+    SECP256K1_FE_X4_CARRY(t7, t8); \
+    SECP256K1_FE_X4_CARRY(t8, t9); \
+    c = _mm256_srli_epi64(t9, 22); \
+    t9 = _mm256_and_si256(t9, _mm256_set1_epi64x(0x03FFFFFULL)); \
+    t0 = _mm256_add_epi64(t0, _mm256_mul_epu32(c, _mm256_set1_epi64x(0x3D1ULL))); \
+    t1 = _mm256_add_epi64(t1, _mm256_slli_epi64(c, 6)); \
+    SECP256K1_FE_X4_CARRY(t0, t1); \
+    SECP256K1_FE_X4_CARRY(t1, t2); \
+    secp256k1_fe_x4_store(r, 0, t0); \
+    secp256k1_fe_x4_store(r, 1, t1); \
+    secp256k1_fe_x4_store(r, 2, t2); \
+    secp256k1_fe_x4_store(r, 3, t3); \
+    secp256k1_fe_x4_store(r, 4, t4); \
+    secp256k1_fe_x4_store(r, 5, t5); \
+    secp256k1_fe_x4_store(r, 6, t6); \
+    secp256k1_fe_x4_store(r, 7, t7); \
+    secp256k1_fe_x4_store(r, 8, t8); \
+    secp256k1_fe_x4_store(r, 9, t9); \
+} while(0)
+
+static SECP256K1_TARGET_AVX2 void secp256k1_fe_x4_mul(secp256k1_fe_x4 *r, const secp256k1_fe_x4 *a, const secp256k1_fe_x4 *b) {
+    __m256i a0, a1, a2, a3, a4, a5, a6, a7, a8, a9;
+    __m256i b0, b1, b2, b3, b4, b5, b6, b7, b8, b9;
+    __m256i t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13, t14, t15, t16, t17, t18;
+#ifdef VERIFY
+    VERIFY_CHECK(a->magnitude <= 8);
+    VERIFY_CHECK(b->magnitude <= 8);
+    secp256k1_fe_x4_verify(a);
+    secp256k1_fe_x4_verify(b);
+#endif
+    a0 = secp256k1_fe_x4_load(a, 0);
+    a1 = secp256k1_fe_x4_load(a, 1);
+    a2 = secp256k1_fe_x4_load(a, 2);
+    a3 = secp256k1_fe_x4_load(a, 3);
+    a4 = secp256k1_fe_x4_load(a, 4);
+    a5 = secp256k1_fe_x4_load(a, 5);
+    a6 = secp256k1_fe_x4_load(a, 6);
+    a7 = secp256k1_fe_x4_load(a, 7);
+    a8 = secp256k1_fe_x4_load(a, 8);
+    a9 = secp256k1_fe_x4_load(a, 9);
+    b0 = secp256k1_fe_x4_load(b, 0);
+    b1 = secp256k1_fe_x4_load(b, 1);
+    b2 = secp256k1_fe_x4_load(b, 2);
+    b3 = secp256k1_fe_x4_load(b, 3);
+    b4 = secp256k1_fe_x4_load(b, 4);
+    b5 = secp256k1_fe_x4_load(b, 5);
+    b6 = secp256k1_fe_x4_load(b, 6);
+    b7 = secp256k1_fe_x4_load(b, 7);
+    b8 = secp256k1_fe_x4_load(b, 8);
+    b9 = secp256k1_fe_x4_load(b, 9);
+
+    /* Column i sums at most 10 products of limbs below 2^30, so it stays below 2^64. */
+    t0 = _mm256_mul_epu32(a0, b0);
+    t1 = _mm256_mul_epu32(a0, b1);
+    t1 = _mm256_add_epi64(t1, _mm256_mul_epu32(a1, b0));
+    t2 = _mm256_mul_epu32(a0, b2);
+    t2 = _mm256_add_epi64(t2, _mm256_mul_epu32(a1, b1));
+    t2 = _mm256_add_epi64(t2, _mm256_mul_epu32(a2, b0));
+    t3 = _mm256_mul_epu32(a0, b3);
+    t3 = _mm256_add_epi64(t3, _mm256_mul_epu32(a1, b2));
+    t3 = _mm256_add_epi64(t3, _mm256_mul_epu32(a2, b1));
+    t3 = _mm256_add_epi64(t3, _mm256_mul_epu32(a3, b0));
+    t4 = _mm256_mul_epu32(a0, b4);
+    t4 = _mm256_add_epi64(t4, _mm256_mul_epu32(a1, b3));
+    t4 = _mm256_add_epi64(t4, _mm256_mul_epu32(a2, b2));
+    t4 = _mm256_add_epi64(t4, _mm256_mul_epu32(a3, b1));
+    t4 = _mm256_add_epi64(t4, _mm256_mul_epu32(a4, b0));
+    t5 = _mm256_mul_epu32(a0, b5);
+    t5 = _mm256_add_epi64(t5, _mm256_mul_epu32(a1, b4));
+    t5 = _mm256_add_epi64(t5, _mm256_mul_epu32(a2, b3));
+    t5 = _mm256_add_epi64(t5, _mm256_mul_epu32(a3, b2));
+    t5 = _mm256_add_epi64(t5, _mm256_mul_epu32(a4, b1));
+    t5 = _mm256_add_epi64(t5, _mm256_mul_epu32(a5, b0));
+    t6 = _mm256_mul_epu32(a0, b6);
+    t6 = _mm256_add_epi64(t6, _mm256_mul_epu32(a1, b5));
+    t6 = _mm256_add_epi64(t6, _mm256_mul_epu32(a2, b4));
+    t6 = _mm256_add_epi64(t6, _mm256_mul_epu32(a3, b3));
+    t6 = _mm256_add_epi64(t6, _mm256_mul_epu32(a4, b2));
+    t6 = _mm256_add_epi64(t6, _mm256_mul_epu32(a5, b1));
+    t6 = _mm256_add_epi64(t6, _mm256_mul_epu32(a6, b0));
+    t7 = _mm256_mul_epu32(a0, b7);
+    t7 = _mm256_add_epi64(t7, _mm256_mul_epu32(a1, b6));
+    t7 = _mm256_add_epi64(t7, _mm256_mul_epu32(a2, b5));
+    t7 = _mm256_add_epi64(t7, _mm256_mul_epu32(a3, b4));
+    t7 = _mm256_add_epi64(t7, _mm256_mul_epu32(a4, b3));
+    t7 = _mm256_add_epi64(t7, _mm256_mul_epu32(a5, b2));
+    t7 = _mm256_add_epi64(t7, _mm256_mul_epu32(a6, b1));
+    t7 = _mm256_add_epi64(t7, _mm256_mul_epu32(a7, b0));
+    t8 = _mm256_mul_epu32(a0, b8);
+    t8 = _mm256_add_epi64(t8, _mm256_mul_epu32(a1, b7));
+    t8 = _mm256_add_epi64(t8, _mm256_mul_epu32(a2, b6));
+    t8 = _mm256_add_epi64(t8, _mm256_mul_epu32(a3, b5));
+    t8 = _mm256_add_epi64(t8, _mm256_mul_epu32(a4, b4));
+    t8 = _mm256_add_epi64(t8, _mm256_mul_epu32(a5, b3));
+    t8 = _mm256_add_epi64(t8, _mm256_mul_epu32(a6, b2));
+    t8 = _mm256_add_epi64(t8, _mm256_mul_epu32(a7, b1));
+    t8 = _mm256_add_epi64(t8, _mm256_mul_epu32(a8, b0));
+    t9 = _mm256_mul_epu32(a0, b9);
+    t9 = _mm256_add_epi64(t9, _mm256_mul_epu32(a1, b8));
+    t9 = _mm256_add_epi64(t9, _mm256_mul_epu32(a2, b7));
+    t9 = _mm256_add_epi64(t9, _mm256_mul_epu32(a3, b6));
+    t9 = _mm256_add_epi64(t9, _mm256_mul_epu32(a4, b5));
+    t9 = _mm256_add_epi64(t9, _mm256_mul_epu32(a5, b4));
+    t9 = _mm256_add_epi64(t9, _mm256_mul_epu32(a6, b3));
+    t9 = _mm256_add_epi64(t9, _mm256_mul_epu32(a7, b2));
+    t9 = _mm256_add_epi64(t9, _mm256_mul_epu32(a8, b1));
+    t9 = _mm256_add_epi64(t9, _mm256_mul_epu32(a9, b0));
+    t10 = _mm256_mul_epu32(a1, b9);
+    t10 = _mm256_add_epi64(t10, _mm256_mul_epu32(a2, b8));
+    t10 = _mm256_add_epi64(t10, _mm256_mul_epu32(a3, b7));
+    t10 = _mm256_add_epi64(t10, _mm256_mul_epu32(a4, b6));
+    t10 = _mm256_add_epi64(t10, _mm256_mul_epu32(a5, b5));
+    t10 = _mm256_add_epi64(t10, _mm256_mul_epu32(a6, b4));
+    t10 = _mm256_add_epi64(t10, _mm256_mul_epu32(a7, b3));
+    t10 = _mm256_add_epi64(t10, _mm256_mul_epu32(a8, b2));
+    t10 = _mm256_add_epi64(t10, _mm256_mul_epu32(a9, b1));
+    t11 = _mm256_mul_epu32(a2, b9);
+    t11 = _mm256_add_epi64(t11, _mm256_mul_epu32(a3, b8));
+    t11 = _mm256_add_epi64(t11, _mm256_mul_epu32(a4, b7));
+    t11 = _mm256_add_epi64(t11, _mm256_mul_epu32(a5, b6));
+    t11 = _mm256_add_epi64(t11, _mm256_mul_epu32(a6, b5));
+    t11 = _mm256_add_epi64(t11, _mm256_mul_epu32(a7, b4));
+    t11 = _mm256_add_epi64(t11, _mm256_mul_epu32(a8, b3));
+    t11 = _mm256_add_epi64(t11, _mm256_mul_epu32(a9, b2));
+    t12 = _mm256_mul_epu32(a3, b9);
+    t12 = _mm256_add_epi64(t12, _mm256_mul_epu32(a4, b8));
+    t12 = _mm256_add_epi64(t12, _mm256_mul_epu32(a5, b7));
+    t12 = _mm256_add_epi64(t12, _mm256_mul_epu32(a6, b6));
+    t12 = _mm256_add_epi64(t12, _mm256_mul_epu32(a7, b5));
+    t12 = _mm256_add_epi64(t12, _mm256_mul_epu32(a8, b4));
+    t12 = _mm256_add_epi64(t12, _mm256_mul_epu32(a9, b3));
+    t13 = _mm256_mul_epu32(a4, b9);
+    t13 = _mm256_add_epi64(t13, _mm256_mul_epu32(a5, b8));
+    t13 = _mm256_add_epi64(t13, _mm256_mul_epu32(a6, b7));
+    t13 = _mm256_add_epi64(t13, _mm256_mul_epu32(a7, b6));
+    t13 = _mm256_add_epi64(t13, _mm256_mul_epu32(a8, b5));
+    t13 = _mm256_add_epi64(t13, _mm256_mul_epu32(a9, b4));
+    t14 = _mm256_mul_epu32(a5, b9);
+    t14 = _mm256_add_epi64(t14, _mm256_mul_epu32(a6, b8));
+    t14 = _mm256_add_epi64(t14, _mm256_mul_epu32(a7, b7));
+    t14 = _mm256_add_epi64(t14, _mm256_mul_epu32(a8, b6));
+    t14 = _mm256_add_epi64(t14, _mm256_mul_epu32(a9, b5));
+    t15 = _mm256_mul_epu32(a6, b9);
+    t15 = _mm256_add_epi64(t15, _mm256_mul_epu32(a7, b8));
+    t15 = _mm256_add_epi64(t15, _mm256_mul_epu32(a8, b7));
+    t15 = _mm256_add_epi64(t15, _mm256_mul_epu32(a9, b6));
+    t16 = _mm256_mul_epu32(a7, b9);
+    t16 = _mm256_add_epi64(t16, _mm256_mul_epu32(a8, b8));
+    t16 = _mm256_add_epi64(t16, _mm256_mul_epu32(a9, b7));
+    t17 = _mm256_mul_epu32(a8, b9);
+    t17 = _mm256_add_epi64(t17, _mm256_mul_epu32(a9, b8));
+    t18 = _mm256_mul_epu32(a9, b9);
+
+    SECP256K1_FE_X4_REDUCE(r);
+#ifdef VERIFY
+    r->magnitude = 1;
+#endif
+    secp256k1_fe_x4_verify(r);
+}
+
+static SECP256K1_TARGET_AVX2 void secp256k1_fe_x4_sqr(secp256k1_fe_x4 *r, const secp256k1_fe_x4 *a) {
+    __m256i a0, a1, a2, a3, a4, a5, a6, a7, a8, a9;
+    __m256i d0, d1, d2, d3, d4, d5, d6, d7, d8;
+    __m256i t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13, t14, t15, t16, t17, t18;
+#ifdef VERIFY
+    VERIFY_CHECK(a->magnitude <= 8);
+    secp256k1_fe_x4_verify(a);
+#endif
+    a0 = secp256k1_fe_x4_load(a, 0);
+    a1 = secp256k1_fe_x4_load(a, 1);
+    a2 = secp256k1_fe_x4_load(a, 2);
+    a3 = secp256k1_fe_x4_load(a, 3);
+    a4 = secp256k1_fe_x4_load(a, 4);
+    a5 = secp256k1_fe_x4_load(a, 5);
+    a6 = secp256k1_fe_x4_load(a, 6);
+    a7 = secp256k1_fe_x4_load(a, 7);
+    a8 = secp256k1_fe_x4_load(a, 8);
+    a9 = secp256k1_fe_x4_load(a, 9);
+    d0 = _mm256_add_epi64(a0, a0);
+    d1 = _mm256_add_epi64(a1, a1);
+    d2 = _mm256_add_epi64(a2, a2);
+    d3 = _mm256_add_epi64(a3, a3);
+    d4 = _mm256_add_epi64(a4, a4);
+    d5 = _mm256_add_epi64(a5, a5);
+    d6 = _mm256_add_epi64(a6, a6);
+    d7 = _mm256_add_epi64(a7, a7);
+    d8 = _mm256_add_epi64(a8, a8);
+
+    /* Each cross product appears twice in its column, so it is taken once against a doubled limb d. */
+    t0 = _mm256_mul_epu32(a0, a0);
+    t1 = _mm256_mul_epu32(d0, a1);
+    t2 = _mm256_mul_epu32(d0, a2);
+    t2 = _mm256_add_epi64(t2, _mm256_mul_epu32(a1, a1));
+    t3 = _mm256_mul_epu32(d0, a3);
+    t3 = _mm256_add_epi64(t3, _mm256_mul_epu32(d1, a2));
+    t4 = _mm256_mul_epu32(d0, a4);
+    t4 = _mm256_add_epi64(t4, _mm256_mul_epu32(d1, a3));
+    t4 = _mm256_add_epi64(t4, _mm256_mul_epu32(a2, a2));
+    t5 = _mm256_mul_epu32(d0, a5);
+    t5 = _mm256_add_epi64(t5, _mm256_mul_epu32(d1, a4));
+    t5 = _mm256_add_epi64(t5, _mm256_mul_epu32(d2, a3));
+    t6 = _mm256_mul_epu32(d0, a6);
+    t6 = _mm256_add_epi64(t6, _mm256_mul_epu32(d1, a5));
+    t6 = _mm256_add_epi64(t6, _mm256_mul_epu32(d2, a4));
+    t6 = _mm256_add_epi64(t6, _mm256_mul_epu32(a3, a3));
+    t7 = _mm256_mul_epu32(d0, a7);
+    t7 = _mm256_add_epi64(t7, _mm256_mul_epu32(d1, a6));
+    t7 = _mm256_add_epi64(t7, _mm256_mul_epu32(d2, a5));
+    t7 = _mm256_add_epi64(t7, _mm256_mul_epu32(d3, a4));
+    t8 = _mm256_mul_epu32(d0, a8);
+    t8 = _mm256_add_epi64(t8, _mm256_mul_epu32(d1, a7));
+    t8 = _mm256_add_epi64(t8, _mm256_mul_epu32(d2, a6));
+    t8 = _mm256_add_epi64(t8, _mm256_mul_epu32(d3, a5));
+    t8 = _mm256_add_epi64(t8, _mm256_mul_epu32(a4, a4));
+    t9 = _mm256_mul_epu32(d0, a9);
+    t9 = _mm256_add_epi64(t9, _mm256_mul_epu32(d1, a8));
+    t9 = _mm256_add_epi64(t9, _mm256_mul_epu32(d2, a7));
+    t9 = _mm256_add_epi64(t9, _mm256_mul_epu32(d3, a6));
+    t9 = _mm256_add_epi64(t9, _mm256_mul_epu32(d4, a5));
+    t10 = _mm256_mul_epu32(d1, a9);
+    t10 = _mm256_add_epi64(t10, _mm256_mul_epu32(d2, a8));
+    t10 = _mm256_add_epi64(t10, _mm256_mul_epu32(d3, a7));
+    t10 = _mm256_add_epi64(t10, _mm256_mul_epu32(d4, a6));
+    t10 = _mm256_add_epi64(t10, _mm256_mul_epu32(a5, a5));
+    t11 = _mm256_mul_epu32(d2, a9);
+    t11 = _mm256_add_epi64(t11, _mm256_mul_epu32(d3, a8));
+    t11 = _mm256_add_epi64(t11, _mm256_mul_epu32(d4, a7));
+    t11 = _mm256_add_epi64(t11, _mm256_mul_epu32(d5, a6));
+    t12 = _mm256_mul_epu32(d3, a9);
+    t12 = _mm256_add_epi64(t12, _mm256_mul_epu32(d4, a8));
+    t12 = _mm256_add_epi64(t12, _mm256_mul_epu32(d5, a7));
+    t12 = _mm256_add_epi64(t12, _mm256_mul_epu32(a6, a6));
+    t13 = _mm256_mul_epu32(d4, a9);
+    t13 = _mm256_add_epi64(t13, _mm256_mul_epu32(d5, a8));
+    t13 = _mm256_add_epi64(t13, _mm256_mul_epu32(d6, a7));
+    t14 = _mm256_mul_epu32(d5, a9);
+    t14 = _mm256_add_epi64(t14, _mm256_mul_epu32(d6, a8));
+    t14 = _mm256_add_epi64(t14, _mm256_mul_epu32(a7, a7));
+    t15 = _mm256_mul_epu32(d6, a9);
+    t15 = _mm256_add_epi64(t15, _mm256_mul_epu32(d7, a8));
+    t16 = _mm256_mul_epu32(d7, a9);
+    t16 = _mm256_add_epi64(t16, _mm256_mul_epu32(a8, a8));
+    t17 = _mm256_mul_epu32(d8, a9);
+    t18 = _mm256_mul_epu32(a9, a9);
+
+    SECP256K1_FE_X4_REDUCE(r);
+#ifdef VERIFY
+    r->magnitude = 1;
+#endif
+    secp256k1_fe_x4_verify(r);
+}
+
+static SECP256K1_TARGET_AVX2 void secp256k1_fe_x4_cmov(secp256k1_fe_x4 *r, const secp256k1_fe_x4 *a, int flags) {
+    const __m256i mask = secp256k1_fe_x4_mask(flags);
+    int i;
+    for (i = 0; i < 10; i++) {
+        secp256k1_fe_x4_store(r, i, _mm256_blendv_epi8(secp256k1_fe_x4_load(r, i), secp256k1_fe_x4_load(a, i), mask));
+    }
+#ifdef VERIFY
+    if (a->magnitude > r->magnitude) {
+        r->magnitude = a->magnitude;
+    }
+#endif
+}
+
+#endif
+
+#endif
@@ -0,0 +1,49 @@
+/**********************************************************************
+ * Copyright (c) 2016 libsecp256k1 contributors                       *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_FIELD_X8_
+#define _SECP256K1_FIELD_X8_
+
+/** Eight-lane field multiplication.
+ *
+ *  A secp256k1_fe_x8 holds eight independent field elements in the 5x52
+ *  representation of field_5x52.h, in structure-of-arrays layout, so one
+ *  512-bit vector holds the same limb of all eight elements. Products of
+ *  52-bit limbs are accumulated with the AVX-512 IFMA instructions
+ *  (vpmadd52luq/vpmadd52huq), which is why every limb is kept below 2^52:
+ *  all values are weakly normalized, and there is no magnitude to track.
+ *
+ *  Only compiled in when USE_AVX512IFMA is defined; callers must also check
+ *  secp256k1_cpu_has(SECP256K1_CPU_AVX512IFMA) before using any of this.
+ */
+
+#if defined HAVE_CONFIG_H
+#include "libsecp256k1-config.h"
+#endif
+
+#include "field.h"
+
+#ifdef USE_AVX512IFMA
+
+#define SECP256K1_TARGET_AVX512IFMA __attribute__((target("avx512f,avx512ifma")))
+
+typedef struct {
+    /* Limb i of lane j is n[8*i+j]; lane j is sum(i=0..4, n[8*i+j] << (i*52)). */
+    uint64_t n[40];
+} secp256k1_fe_x8;
+
+/** Set the lanes of r to the eight field elements a[0..7], which must have magnitude at most 32. */
+static SECP256K1_TARGET_AVX512IFMA void secp256k1_fe_x8_set_fe(secp256k1_fe_x8 *r, const secp256k1_fe *a);
+
+/** Store the lanes of a in r[0..7]. The results have magnitude 1. */
+static SECP256K1_TARGET_AVX512IFMA void secp256k1_fe_x8_get_fe(secp256k1_fe *r, const secp256k1_fe_x8 *a);
+
+/** Multiply two sets of lanes. r may alias a or b. */
+static SECP256K1_TARGET_AVX512IFMA void secp256k1_fe_x8_mul(secp256k1_fe_x8 *r, const secp256k1_fe_x8 *a, const secp256k1_fe_x8 *b);
+
+#endif
+
+#endif
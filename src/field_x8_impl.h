@@ -0,0 +1,202 @@
+/**********************************************************************
+ * Copyright (c) 2016 libsecp256k1 contributors                       *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_FIELD_X8_IMPL_H_
+#define _SECP256K1_FIELD_X8_IMPL_H_
+
+#if defined HAVE_CONFIG_H
+#include "libsecp256k1-config.h"
+#endif
+
+#include "util.h"
+#include "field_x8.h"
+
+#ifdef USE_AVX512IFMA
+
+#include <immintrin.h>
+
+#ifdef VERIFY
+static void secp256k1_fe_x8_verify(const secp256k1_fe_x8 *a) {
+    int i, r = 1;
+    for (i = 0; i < 40; i++) {
+        r &= (a->n[i] < (i < 32 ? 0x10000000000000ULL : 0x2000000000000ULL));
+    }
+    VERIFY_CHECK(r == 1);
+}
+#else
+static void secp256k1_fe_x8_verify(const secp256k1_fe_x8 *a) {
+    (void)a;
+}
+#endif
+
+static SECP256K1_TARGET_AVX512IFMA void secp256k1_fe_x8_set_fe(secp256k1_fe_x8 *r, const secp256k1_fe *a) {
+    int i, j;
+    for (j = 0; j < 8; j++) {
+        secp256k1_fe t = a[j];
+        secp256k1_fe_normalize_weak(&t);
+#if defined(USE_FIELD_10X26)
+        for (i = 0; i < 5; i++) {
+            r->n[8 * i + j] = t.n[2 * i] | ((uint64_t)t.n[2 * i + 1] << 26);
+        }
+#else
+        for (i = 0; i < 5; i++) {
+            r->n[8 * i + j] = t.n[i];
+        }
+#endif
+    }
+    secp256k1_fe_x8_verify(r);
+}
+
+static SECP256K1_TARGET_AVX512IFMA void secp256k1_fe_x8_get_fe(secp256k1_fe *r, const secp256k1_fe_x8 *a) {
+    int i, j;
+    secp256k1_fe_x8_verify(a);
+    for (j = 0; j < 8; j++) {
+#if defined(USE_FIELD_10X26)
+        for (i = 0; i < 5; i++) {
+            r[j].n[2 * i] = a->n[8 * i + j] & 0x3FFFFFFUL;
+            r[j].n[2 * i + 1] = a->n[8 * i + j] >> 26;
+        }
+#else
+        for (i = 0; i < 5; i++) {
+            r[j].n[i] = a->n[8 * i + j];
+        }
+#endif
+#ifdef VERIFY
+        r[j].magnitude = 1;
+        r[j].normalized = 0;
+        secp256k1_fe_verify(&r[j]);
+#endif
+    }
+}
+
+#define SECP256K1_FE_X8_CARRY(lo, hi) do { \
+    hi = _mm512_add_epi64(hi, _mm512_srli_epi64(lo, 52)); \
+    lo = _mm512_and_si512(lo, _mm512_set1_epi64(0xFFFFFFFFFFFFFULL)); \
+} while(0)
+
+static SECP256K1_TARGET_AVX512IFMA void secp256k1_fe_x8_mul(secp256k1_fe_x8 *r, const secp256k1_fe_x8 *a, const secp256k1_fe_x8 *b) {
+    __m512i a0, a1, a2, a3, a4, b0, b1, b2, b3, b4;
+    __m512i c0, c1, c2, c3, c4, c5, c6, c7, c8, c9, h;
+    const __m512i R = _mm512_set1_epi64(0x1000003D10ULL);
+    secp256k1_fe_x8_verify(a);
+    secp256k1_fe_x8_verify(b);
+
+    a0 = _mm512_loadu_si512(&a->n[0]);
+    a1 = _mm512_loadu_si512(&a->n[8]);
+    a2 = _mm512_loadu_si512(&a->n[16]);
+    a3 = _mm512_loadu_si512(&a->n[24]);
+    a4 = _mm512_loadu_si512(&a->n[32]);
+    b0 = _mm512_loadu_si512(&b->n[0]);
+    b1 = _mm512_loadu_si512(&b->n[8]);
+    b2 = _mm512_loadu_si512(&b->n[16]);
+    b3 = _mm512_loadu_si512(&b->n[24]);
+    b4 = _mm512_loadu_si512(&b->n[32]);
+    c0 = c1 = c2 = c3 = c4 = c5 = c6 = c7 = c8 = c9 = _mm512_setzero_si512();
+
+    /* Column k collects the low halves of the limb products a[i]*b[k-i] and
+     * the high halves of a[i]*b[k-1-i], at most ten values below 2^52 each. */
+    c0 = _mm512_madd52lo_epu64(c0, a0, b0);
+    c1 = _mm512_madd52hi_epu64(c1, a0, b0);
+    c1 = _mm512_madd52lo_epu64(c1, a0, b1);
+    c2 = _mm512_madd52hi_epu64(c2, a0, b1);
+    c1 = _mm512_madd52lo_epu64(c1, a1, b0);
+    c2 = _mm512_madd52hi_epu64(c2, a1, b0);
+    c2 = _mm512_madd52lo_epu64(c2, a0, b2);
+    c3 = _mm512_madd52hi_epu64(c3, a0, b2);
+    c2 = _mm512_madd52lo_epu64(c2, a1, b1);
+    c3 = _mm512_madd52hi_epu64(c3, a1, b1);
+    c2 = _mm512_madd52lo_epu64(c2, a2, b0);
+    c3 = _mm512_madd52hi_epu64(c3, a2, b0);
+    c3 = _mm512_madd52lo_epu64(c3, a0, b3);
+    c4 = _mm512_madd52hi_epu64(c4, a0, b3);
+    c3 = _mm512_madd52lo_epu64(c3, a1, b2);
+    c4 = _mm512_madd52hi_epu64(c4, a1, b2);
+    c3 = _mm512_madd52lo_epu64(c3, a2, b1);
+    c4 = _mm512_madd52hi_epu64(c4, a2, b1);
+    c3 = _mm512_madd52lo_epu64(c3, a3, b0);
+    c4 = _mm512_madd52hi_epu64(c4, a3, b0);
+    c4 = _mm512_madd52lo_epu64(c4, a0, b4);
+    c5 = _mm512_madd52hi_epu64(c5, a0, b4);
+    c4 = _mm512_madd52lo_epu64(c4, a1, b3);
+    c5 = _mm512_madd52hi_epu64(c5, a1, b3);
+    c4 = _mm512_madd52lo_epu64(c4, a2, b2);
+    c5 = _mm512_madd52hi_epu64(c5, a2, b2);
+    c4 = _mm512_madd52lo_epu64(c4, a3, b1);
+    c5 = _mm512_madd52hi_epu64(c5, a3, b1);
+    c4 = _mm512_madd52lo_epu64(c4, a4, b0);
+    c5 = _mm512_madd52hi_epu64(c5, a4, b0);
+    c5 = _mm512_madd52lo_epu64(c5, a1, b4);
+    c6 = _mm512_madd52hi_epu64(c6, a1, b4);
+    c5 = _mm512_madd52lo_epu64(c5, a2, b3);
+    c6 = _mm512_madd52hi_epu64(c6, a2, b3);
+    c5 = _mm512_madd52lo_epu64(c5, a3, b2);
+    c6 = _mm512_madd52hi_epu64(c6, a3, b2);
+    c5 = _mm512_madd52lo_epu64(c5, a4, b1);
+    c6 = _mm512_madd52hi_epu64(c6, a4, b1);
+    c6 = _mm512_madd52lo_epu64(c6, a2, b4);
+    c7 = _mm512_madd52hi_epu64(c7, a2, b4);
+    c6 = _mm512_madd52lo_epu64(c6, a3, b3);
+    c7 = _mm512_madd52hi_epu64(c7, a3, b3);
+    c6 = _mm512_madd52lo_epu64(c6, a4, b2);
+    c7 = _mm512_madd52hi_epu64(c7, a4, b2);
+    c7 = _mm512_madd52lo_epu64(c7, a3, b4);
+    c8 = _mm512_madd52hi_epu64(c8, a3, b4);
+    c7 = _mm512_madd52lo_epu64(c7, a4, b3);
+    c8 = _mm512_madd52hi_epu64(c8, a4, b3);
+    c8 = _mm512_madd52lo_epu64(c8, a4, b4);
+    c9 = _mm512_madd52hi_epu64(c9, a4, b4);
+
+    /* Carry the upper columns into 52-bit limbs. As both inputs are below
+     * 2^257, the product is below 2^514, which leaves c9 below 2^46. */
+    SECP256K1_FE_X8_CARRY(c4, c5);
+    SECP256K1_FE_X8_CARRY(c5, c6);
+    SECP256K1_FE_X8_CARRY(c6, c7);
+    SECP256K1_FE_X8_CARRY(c7, c8);
+    SECP256K1_FE_X8_CARRY(c8, c9);
+
+    /* Fold them down using 2^260 = R (mod p), with R = 0x1000003D10. The high
+     * half of c9*R is below 2^31 and sits at 2^260 itself, so it is folded
+     * once more into c0 and c1. */
+    c0 = _mm512_madd52lo_epu64(c0, c5, R);
+    c1 = _mm512_madd52hi_epu64(c1, c5, R);
+    c1 = _mm512_madd52lo_epu64(c1, c6, R);
+    c2 = _mm512_madd52hi_epu64(c2, c6, R);
+    c2 = _mm512_madd52lo_epu64(c2, c7, R);
+    c3 = _mm512_madd52hi_epu64(c3, c7, R);
+    c3 = _mm512_madd52lo_epu64(c3, c8, R);
+    c4 = _mm512_madd52hi_epu64(c4, c8, R);
+    c4 = _mm512_madd52lo_epu64(c4, c9, R);
+    h = _mm512_madd52hi_epu64(_mm512_setzero_si512(), c9, R);
+    c0 = _mm512_madd52lo_epu64(c0, h, R);
+    c1 = _mm512_madd52hi_epu64(c1, h, R);
+
+    SECP256K1_FE_X8_CARRY(c0, c1);
+    SECP256K1_FE_X8_CARRY(c1, c2);
+    SECP256K1_FE_X8_CARRY(c2, c3);
+    SECP256K1_FE_X8_CARRY(c3, c4);
+
+    /* Fold the bits of c4 above 2^48 into c0, using 2^256 = 0x1000003D1 (mod p),
+     * and carry once more so every limb fits in 52 bits again. */
+    h = _mm512_srli_epi64(c4, 48);
+    c4 = _mm512_and_si512(c4, _mm512_set1_epi64(0xFFFFFFFFFFFFULL));
+    c0 = _mm512_add_epi64(c0, _mm512_slli_epi64(h, 32));
+    c0 = _mm512_add_epi64(c0, _mm512_mul_epu32(h, _mm512_set1_epi64(0x3D1ULL)));
+    SECP256K1_FE_X8_CARRY(c0, c1);
+    SECP256K1_FE_X8_CARRY(c1, c2);
+    SECP256K1_FE_X8_CARRY(c2, c3);
+    SECP256K1_FE_X8_CARRY(c3, c4);
+
+    _mm512_storeu_si512(&r->n[0], c0);
+    _mm512_storeu_si512(&r->n[8], c1);
+    _mm512_storeu_si512(&r->n[16], c2);
+    _mm512_storeu_si512(&r->n[24], c3);
+    _mm512_storeu_si512(&r->n[32], c4);
+    secp256k1_fe_x8_verify(r);
+}
+
+#endif
+
+#endif
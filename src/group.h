@@ -28,9 +28,25 @@ typedef struct {
     int infinity; /* whether this represents the point at infinity */
 } secp256k1_gej;
 
+/** The largest magnitudes the coordinates of a secp256k1_gej may have. The functions below
+ *  that return one stay within them, so the ones that take one can rely on them instead of
+ *  normalizing their inputs first. VERIFY builds check them on the way in and out. */
+#define SECP256K1_GEJ_X_MAGNITUDE_MAX 6
+#define SECP256K1_GEJ_Y_MAGNITUDE_MAX 4
+#define SECP256K1_GEJ_Z_MAGNITUDE_MAX 2
+
 #define SECP256K1_GEJ_CONST(a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p) {SECP256K1_FE_CONST((a),(b),(c),(d),(e),(f),(g),(h)), SECP256K1_FE_CONST((i),(j),(k),(l),(m),(n),(o),(p)), SECP256K1_FE_CONST(0, 0, 0, 0, 0, 0, 0, 1), 0}
 #define SECP256K1_GEJ_CONST_INFINITY {SECP256K1_FE_CONST(0, 0, 0, 0, 0, 0, 0, 0), SECP256K1_FE_CONST(0, 0, 0, 0, 0, 0, 0, 0), SECP256K1_FE_CONST(0, 0, 0, 0, 0, 0, 0, 0), 1}
 
+/** A group element of the secp256k1 curve, in homogeneous projective coordinates. Every point,
+ *  including infinity, has a representation, so the complete addition formulas below need no
+ *  special cases. All coordinates have magnitude 1. */
+typedef struct {
+    secp256k1_fe x; /* actual X: x/z */
+    secp256k1_fe y; /* actual Y: y/z */
+    secp256k1_fe z; /* zero for the point at infinity, which is (0:1:0) */
+} secp256k1_gep;
+
 typedef struct {
     secp256k1_fe_storage x;
     secp256k1_fe_storage y;
@@ -115,6 +131,22 @@ static void secp256k1_gej_add_ge_var(secp256k1_gej *r, const secp256k1_gej *a, c
 /** Set r equal to the sum of a and b (with the inverse of b's Z coordinate passed as bzinv). */
 static void secp256k1_gej_add_zinv_var(secp256k1_gej *r, const secp256k1_gej *a, const secp256k1_ge *b, const secp256k1_fe *bzinv);
 
+/** Set r equal to the sum of a and b, where b holds the X and Y coordinates of a point with the
+ *  same Z coordinate as a. b is replaced by the X and Y coordinates of the same point over r's Z
+ *  coordinate, and r->z = a->z * *rzr. a and b may not be infinity, equal or opposite. Constant time. */
+static void secp256k1_gej_add_coz(secp256k1_gej *r, secp256k1_ge *b, const secp256k1_gej *a, secp256k1_fe *rzr);
+
+/** Convert a jacobian group element to projective coordinates. Constant time. */
+static void secp256k1_gep_set_gej(secp256k1_gep *r, const secp256k1_gej *a);
+
+/** Convert a projective group element to jacobian coordinates. Constant time. */
+static void secp256k1_gej_set_gep(secp256k1_gej *r, const secp256k1_gep *a);
+
+/** Set r equal to the sum of a and b (with b given in affine coordinates of magnitude at most 4, and
+ *  not infinity), using complete formulas: a may be infinity, equal to b or its negation. r may alias a.
+ *  Constant time. */
+static void secp256k1_gep_add_ge(secp256k1_gep *r, const secp256k1_gep *a, const secp256k1_ge *b);
+
 #ifdef USE_ENDOMORPHISM
 /** Set r to be equal to lambda times a, where lambda is chosen in a way such that this is very fast. */
 static void secp256k1_ge_mul_lambda(secp256k1_ge *r, const secp256k1_ge *a);
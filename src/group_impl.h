@@ -23,6 +23,14 @@ static const secp256k1_ge secp256k1_ge_const_g = SECP256K1_GE_CONST(
     0xFD17B448UL, 0xA6855419UL, 0x9C47D08FUL, 0xFB10D4B8UL
 );
 
+/* Check the magnitude bounds of a jacobian group element (only in VERIFY builds). */
+static void secp256k1_gej_verify(const secp256k1_gej *a) {
+    secp256k1_fe_verify_magnitude(&a->x, SECP256K1_GEJ_X_MAGNITUDE_MAX);
+    secp256k1_fe_verify_magnitude(&a->y, SECP256K1_GEJ_Y_MAGNITUDE_MAX);
+    secp256k1_fe_verify_magnitude(&a->z, SECP256K1_GEJ_Z_MAGNITUDE_MAX);
+    VERIFY_CHECK(a->infinity == 0 || a->infinity == 1);
+}
+
 static void secp256k1_ge_set_gej_zinv(secp256k1_ge *r, const secp256k1_gej *a, const secp256k1_fe *zi) {
     secp256k1_fe zi2; 
     secp256k1_fe zi3;
@@ -83,7 +91,17 @@ static void secp256k1_ge_set_all_gej_var(size_t len, secp256k1_ge *r, const secp
     secp256k1_fe *azi;
     size_t i;
     size_t count = 0;
-    az = (secp256k1_fe *)checked_malloc(cb, sizeof(secp256k1_fe) * len);
+    for (i = 0; i < len; i++) {
+        r[i].infinity = a[i].infinity;
+        count += !a[i].infinity;
+    }
+    if (count == 0) {
+        /* Nothing to invert; avoid zero-length allocations. */
+        return;
+    }
+
+    az = (secp256k1_fe *)checked_malloc(cb, sizeof(secp256k1_fe) * count);
+    count = 0;
     for (i = 0; i < len; i++) {
         if (!a[i].infinity) {
             az[count++] = a[i].z;
@@ -96,7 +114,6 @@ static void secp256k1_ge_set_all_gej_var(size_t len, secp256k1_ge *r, const secp
 
     count = 0;
     for (i = 0; i < len; i++) {
-        r[i].infinity = a[i].infinity;
         if (!a[i].infinity) {
             secp256k1_ge_set_gej_zinv(&r[i], &a[i], &azi[count++]);
         }
@@ -193,14 +210,17 @@ static void secp256k1_gej_set_ge(secp256k1_gej *r, const secp256k1_ge *a) {
    r->x = a->x;
    r->y = a->y;
    secp256k1_fe_set_int(&r->z, 1);
+   secp256k1_gej_verify(r);
 }
 
 static int secp256k1_gej_eq_x_var(const secp256k1_fe *x, const secp256k1_gej *a) {
-    secp256k1_fe r, r2;
+    secp256k1_fe r;
     VERIFY_CHECK(!a->infinity);
+    secp256k1_gej_verify(a);
     secp256k1_fe_sqr(&r, &a->z); secp256k1_fe_mul(&r, &r, x);
-    r2 = a->x; secp256k1_fe_normalize_weak(&r2);
-    return secp256k1_fe_equal_var(&r, &r2);
+    secp256k1_fe_negate(&r, &r, 1);
+    secp256k1_fe_add(&r, &a->x);
+    return secp256k1_fe_normalizes_to_zero_var(&r);
 }
 
 static void secp256k1_gej_neg(secp256k1_gej *r, const secp256k1_gej *a) {
@@ -210,6 +230,7 @@ static void secp256k1_gej_neg(secp256k1_gej *r, const secp256k1_gej *a) {
     r->z = a->z;
     secp256k1_fe_normalize_weak(&r->y);
     secp256k1_fe_negate(&r->y, &r->y, 1);
+    secp256k1_gej_verify(r);
 }
 
 static int secp256k1_gej_is_infinity(const secp256k1_gej *a) {
@@ -263,6 +284,7 @@ static void secp256k1_gej_double_var(secp256k1_gej *r, const secp256k1_gej *a, s
      *  the infinity flag even though the point doubles to infinity, and the result
      *  point will be gibberish (z = 0 but infinity = 0).
      */
+    secp256k1_gej_verify(a);
     r->infinity = a->infinity;
     if (r->infinity) {
         if (rzr != NULL) {
@@ -273,8 +295,7 @@ static void secp256k1_gej_double_var(secp256k1_gej *r, const secp256k1_gej *a, s
 
     if (rzr != NULL) {
         *rzr = a->y;
-        secp256k1_fe_normalize_weak(rzr);
-        secp256k1_fe_mul_int(rzr, 2);
+        secp256k1_fe_mul_int(rzr, 2);         /* Z'/Z = 2*Y (8) */
     }
 
     secp256k1_fe_mul(&r->z, &a->z, &a->y);
@@ -297,6 +318,7 @@ static void secp256k1_gej_double_var(secp256k1_gej *r, const secp256k1_gej *a, s
     secp256k1_fe_mul(&r->y, &t1, &t3);    /* Y' = 36*X^3*Y^2 - 27*X^6 (1) */
     secp256k1_fe_negate(&t2, &t4, 2);     /* T2 = -8*Y^4 (3) */
     secp256k1_fe_add(&r->y, &t2);         /* Y' = 36*X^3*Y^2 - 27*X^6 - 8*Y^4 (4) */
+    secp256k1_gej_verify(r);
 }
 
 static SECP256K1_INLINE void secp256k1_gej_double_nonzero(secp256k1_gej *r, const secp256k1_gej *a, secp256k1_fe *rzr) {
@@ -307,6 +329,8 @@ static SECP256K1_INLINE void secp256k1_gej_double_nonzero(secp256k1_gej *r, cons
 static void secp256k1_gej_add_var(secp256k1_gej *r, const secp256k1_gej *a, const secp256k1_gej *b, secp256k1_fe *rzr) {
     /* Operations: 12 mul, 4 sqr, 2 normalize, 12 mul_int/add/negate */
     secp256k1_fe z22, z12, u1, u2, s1, s2, h, i, i2, h2, h3, t;
+    secp256k1_gej_verify(a);
+    secp256k1_gej_verify(b);
 
     if (a->infinity) {
         VERIFY_CHECK(rzr == NULL);
@@ -355,11 +379,13 @@ static void secp256k1_gej_add_var(secp256k1_gej *r, const secp256k1_gej *a, cons
     secp256k1_fe_negate(&r->y, &r->x, 5); secp256k1_fe_add(&r->y, &t); secp256k1_fe_mul(&r->y, &r->y, &i);
     secp256k1_fe_mul(&h3, &h3, &s1); secp256k1_fe_negate(&h3, &h3, 1);
     secp256k1_fe_add(&r->y, &h3);
+    secp256k1_gej_verify(r);
 }
 
 static void secp256k1_gej_add_ge_var(secp256k1_gej *r, const secp256k1_gej *a, const secp256k1_ge *b, secp256k1_fe *rzr) {
-    /* 8 mul, 3 sqr, 4 normalize, 12 mul_int/add/negate */
-    secp256k1_fe z12, u1, u2, s1, s2, h, i, i2, h2, h3, t;
+    /* 8 mul, 3 sqr, 2 normalize, 12 mul_int/add/negate */
+    secp256k1_fe z12, u2, s2, h, i, i2, h2, h3, t;
+    secp256k1_gej_verify(a);
     if (a->infinity) {
         VERIFY_CHECK(rzr == NULL);
         secp256k1_gej_set_ge(r, b);
@@ -374,13 +400,12 @@ static void secp256k1_gej_add_ge_var(secp256k1_gej *r, const secp256k1_gej *a, c
     }
     r->infinity = 0;
 
+    /* U1 = X1 and S1 = Y1 are used as they are, within the gej magnitude bounds. */
     secp256k1_fe_sqr(&z12, &a->z);
-    u1 = a->x; secp256k1_fe_normalize_weak(&u1);
     secp256k1_fe_mul(&u2, &b->x, &z12);
-    s1 = a->y; secp256k1_fe_normalize_weak(&s1);
     secp256k1_fe_mul(&s2, &b->y, &z12); secp256k1_fe_mul(&s2, &s2, &a->z);
-    secp256k1_fe_negate(&h, &u1, 1); secp256k1_fe_add(&h, &u2);
-    secp256k1_fe_negate(&i, &s1, 1); secp256k1_fe_add(&i, &s2);
+    secp256k1_fe_negate(&h, &a->x, SECP256K1_GEJ_X_MAGNITUDE_MAX); secp256k1_fe_add(&h, &u2);
+    secp256k1_fe_negate(&i, &a->y, SECP256K1_GEJ_Y_MAGNITUDE_MAX); secp256k1_fe_add(&i, &s2);
     if (secp256k1_fe_normalizes_to_zero_var(&h)) {
         if (secp256k1_fe_normalizes_to_zero_var(&i)) {
             secp256k1_gej_double_var(r, a, rzr);
@@ -399,16 +424,19 @@ static void secp256k1_gej_add_ge_var(secp256k1_gej *r, const secp256k1_gej *a, c
         *rzr = h;
     }
     secp256k1_fe_mul(&r->z, &a->z, &h);
-    secp256k1_fe_mul(&t, &u1, &h2);
+    /* r may be a, so X1 and Y1 are read before r->x and r->y are written. */
+    secp256k1_fe_mul(&t, &a->x, &h2);
+    secp256k1_fe_mul(&h2, &h3, &a->y); secp256k1_fe_negate(&h2, &h2, 1);
     r->x = t; secp256k1_fe_mul_int(&r->x, 2); secp256k1_fe_add(&r->x, &h3); secp256k1_fe_negate(&r->x, &r->x, 3); secp256k1_fe_add(&r->x, &i2);
     secp256k1_fe_negate(&r->y, &r->x, 5); secp256k1_fe_add(&r->y, &t); secp256k1_fe_mul(&r->y, &r->y, &i);
-    secp256k1_fe_mul(&h3, &h3, &s1); secp256k1_fe_negate(&h3, &h3, 1);
-    secp256k1_fe_add(&r->y, &h3);
+    secp256k1_fe_add(&r->y, &h2);
+    secp256k1_gej_verify(r);
 }
 
 static void secp256k1_gej_add_zinv_var(secp256k1_gej *r, const secp256k1_gej *a, const secp256k1_ge *b, const secp256k1_fe *bzinv) {
-    /* 9 mul, 3 sqr, 4 normalize, 12 mul_int/add/negate */
-    secp256k1_fe az, z12, u1, u2, s1, s2, h, i, i2, h2, h3, t;
+    /* 9 mul, 3 sqr, 2 normalize, 12 mul_int/add/negate */
+    secp256k1_fe az, z12, u2, s2, h, i, i2, h2, h3, t;
+    secp256k1_gej_verify(a);
 
     if (b->infinity) {
         *r = *a;
@@ -436,13 +464,12 @@ static void secp256k1_gej_add_zinv_var(secp256k1_gej *r, const secp256k1_gej *a,
      */
     secp256k1_fe_mul(&az, &a->z, bzinv);
 
+    /* U1 = X1 and S1 = Y1 are used as they are, within the gej magnitude bounds. */
     secp256k1_fe_sqr(&z12, &az);
-    u1 = a->x; secp256k1_fe_normalize_weak(&u1);
     secp256k1_fe_mul(&u2, &b->x, &z12);
-    s1 = a->y; secp256k1_fe_normalize_weak(&s1);
     secp256k1_fe_mul(&s2, &b->y, &z12); secp256k1_fe_mul(&s2, &s2, &az);
-    secp256k1_fe_negate(&h, &u1, 1); secp256k1_fe_add(&h, &u2);
-    secp256k1_fe_negate(&i, &s1, 1); secp256k1_fe_add(&i, &s2);
+    secp256k1_fe_negate(&h, &a->x, SECP256K1_GEJ_X_MAGNITUDE_MAX); secp256k1_fe_add(&h, &u2);
+    secp256k1_fe_negate(&i, &a->y, SECP256K1_GEJ_Y_MAGNITUDE_MAX); secp256k1_fe_add(&i, &s2);
     if (secp256k1_fe_normalizes_to_zero_var(&h)) {
         if (secp256k1_fe_normalizes_to_zero_var(&i)) {
             secp256k1_gej_double_var(r, a, NULL);
@@ -455,22 +482,24 @@ static void secp256k1_gej_add_zinv_var(secp256k1_gej *r, const secp256k1_gej *a,
     secp256k1_fe_sqr(&h2, &h);
     secp256k1_fe_mul(&h3, &h, &h2);
     r->z = a->z; secp256k1_fe_mul(&r->z, &r->z, &h);
-    secp256k1_fe_mul(&t, &u1, &h2);
+    /* r may be a, so X1 and Y1 are read before r->x and r->y are written. */
+    secp256k1_fe_mul(&t, &a->x, &h2);
+    secp256k1_fe_mul(&h2, &h3, &a->y); secp256k1_fe_negate(&h2, &h2, 1);
     r->x = t; secp256k1_fe_mul_int(&r->x, 2); secp256k1_fe_add(&r->x, &h3); secp256k1_fe_negate(&r->x, &r->x, 3); secp256k1_fe_add(&r->x, &i2);
     secp256k1_fe_negate(&r->y, &r->x, 5); secp256k1_fe_add(&r->y, &t); secp256k1_fe_mul(&r->y, &r->y, &i);
-    secp256k1_fe_mul(&h3, &h3, &s1); secp256k1_fe_negate(&h3, &h3, 1);
-    secp256k1_fe_add(&r->y, &h3);
+    secp256k1_fe_add(&r->y, &h2);
+    secp256k1_gej_verify(r);
 }
 
 
 static void secp256k1_gej_add_ge(secp256k1_gej *r, const secp256k1_gej *a, const secp256k1_ge *b) {
-    /* Operations: 7 mul, 5 sqr, 4 normalize, 21 mul_int/add/negate/cmov */
+    /* Operations: 7 mul, 5 sqr, 2 normalize, 21 mul_int/add/negate/cmov */
     static const secp256k1_fe fe_1 = SECP256K1_FE_CONST(0, 0, 0, 0, 0, 0, 0, 1);
     secp256k1_fe zz, u1, u2, s1, s2, t, tt, m, n, q, rr;
     secp256k1_fe m_alt, rr_alt;
     int infinity, degenerate;
     VERIFY_CHECK(!b->infinity);
-    VERIFY_CHECK(a->infinity == 0 || a->infinity == 1);
+    secp256k1_gej_verify(a);
 
     /** In:
      *    Eric Brier and Marc Joye, Weierstrass Elliptic Curves and Side-Channel Attacks.
@@ -523,17 +552,17 @@ static void secp256k1_gej_add_ge(secp256k1_gej *r, const secp256k1_gej *a, const
      */
 
     secp256k1_fe_sqr(&zz, &a->z);                       /* z = Z1^2 */
-    u1 = a->x; secp256k1_fe_normalize_weak(&u1);        /* u1 = U1 = X1*Z2^2 (1) */
+    u1 = a->x;                                          /* u1 = U1 = X1*Z2^2 (6) */
     secp256k1_fe_mul(&u2, &b->x, &zz);                  /* u2 = U2 = X2*Z1^2 (1) */
-    s1 = a->y; secp256k1_fe_normalize_weak(&s1);        /* s1 = S1 = Y1*Z2^3 (1) */
+    s1 = a->y;                                          /* s1 = S1 = Y1*Z2^3 (4) */
     secp256k1_fe_mul(&s2, &b->y, &zz);                  /* s2 = Y2*Z1^2 (1) */
     secp256k1_fe_mul(&s2, &s2, &a->z);                  /* s2 = S2 = Y2*Z1^3 (1) */
-    t = u1; secp256k1_fe_add(&t, &u2);                  /* t = T = U1+U2 (2) */
-    m = s1; secp256k1_fe_add(&m, &s2);                  /* m = M = S1+S2 (2) */
+    t = u1; secp256k1_fe_add(&t, &u2);                  /* t = T = U1+U2 (7) */
+    m = s1; secp256k1_fe_add(&m, &s2);                  /* m = M = S1+S2 (5) */
     secp256k1_fe_sqr(&rr, &t);                          /* rr = T^2 (1) */
-    secp256k1_fe_negate(&m_alt, &u2, 1);                /* Malt = -X2*Z1^2 */
-    secp256k1_fe_mul(&tt, &u1, &m_alt);                 /* tt = -U1*U2 (2) */
-    secp256k1_fe_add(&rr, &tt);                         /* rr = R = T^2-U1*U2 (3) */
+    secp256k1_fe_negate(&m_alt, &u2, 1);                /* Malt = -X2*Z1^2 (2) */
+    secp256k1_fe_mul(&tt, &u1, &m_alt);                 /* tt = -U1*U2 (1) */
+    secp256k1_fe_add(&rr, &tt);                         /* rr = R = T^2-U1*U2 (2) */
     /** If lambda = R/M = 0/0 we have a problem (except in the "trivial"
      *  case that Z = z1z2 = 0, and this is special-cased later on). */
     degenerate = secp256k1_fe_normalizes_to_zero(&m) &
@@ -544,8 +573,8 @@ static void secp256k1_gej_add_ge(secp256k1_gej *r, const secp256k1_gej *a, const
      * non-indeterminate expression for lambda is (y1 - y2)/(x1 - x2),
      * so we set R/M equal to this. */
     rr_alt = s1;
-    secp256k1_fe_mul_int(&rr_alt, 2);       /* rr = Y1*Z2^3 - Y2*Z1^3 (2) */
-    secp256k1_fe_add(&m_alt, &u1);          /* Malt = X1*Z2^2 - X2*Z1^2 */
+    secp256k1_fe_mul_int(&rr_alt, 2);       /* rr = Y1*Z2^3 - Y2*Z1^3 (8) */
+    secp256k1_fe_add(&m_alt, &u1);          /* Malt = X1*Z2^2 - X2*Z1^2 (8) */
 
     secp256k1_fe_cmov(&rr_alt, &rr, !degenerate);
     secp256k1_fe_cmov(&m_alt, &m, !degenerate);
@@ -560,7 +589,7 @@ static void secp256k1_gej_add_ge(secp256k1_gej *r, const secp256k1_gej *a, const
      * zero (which is "computed" by cmov). So the cost is one squaring
      * versus two multiplications. */
     secp256k1_fe_sqr(&n, &n);
-    secp256k1_fe_cmov(&n, &m, degenerate);              /* n = M^3 * Malt (2) */
+    secp256k1_fe_cmov(&n, &m, degenerate);              /* n = M^3 * Malt (5) */
     secp256k1_fe_sqr(&t, &rr_alt);                      /* t = Ralt^2 (1) */
     secp256k1_fe_mul(&r->z, &a->z, &m_alt);             /* r->z = Malt*Z (1) */
     infinity = secp256k1_fe_normalizes_to_zero(&r->z) * (1 - a->infinity);
@@ -572,8 +601,8 @@ static void secp256k1_gej_add_ge(secp256k1_gej *r, const secp256k1_gej *a, const
     secp256k1_fe_mul_int(&t, 2);                        /* t = 2*x3 (2) */
     secp256k1_fe_add(&t, &q);                           /* t = 2*x3 - Q: (4) */
     secp256k1_fe_mul(&t, &t, &rr_alt);                  /* t = Ralt*(2*x3 - Q) (1) */
-    secp256k1_fe_add(&t, &n);                           /* t = Ralt*(2*x3 - Q) + M^3*Malt (3) */
-    secp256k1_fe_negate(&r->y, &t, 3);                  /* r->y = Ralt*(Q - 2x3) - M^3*Malt (4) */
+    secp256k1_fe_add(&t, &n);                           /* t = Ralt*(2*x3 - Q) + M^3*Malt (6) */
+    secp256k1_fe_negate(&r->y, &t, 6);                  /* r->y = Ralt*(Q - 2x3) - M^3*Malt (7) */
     secp256k1_fe_normalize_weak(&r->y);
     secp256k1_fe_mul_int(&r->x, 4);                     /* r->x = X3 = 4*(Ralt^2-Q) */
     secp256k1_fe_mul_int(&r->y, 4);                     /* r->y = Y3 = 4*Ralt*(Q - 2x3) - 4*M^3*Malt (4) */
@@ -583,17 +612,126 @@ static void secp256k1_gej_add_ge(secp256k1_gej *r, const secp256k1_gej *a, const
     secp256k1_fe_cmov(&r->y, &b->y, a->infinity);
     secp256k1_fe_cmov(&r->z, &fe_1, a->infinity);
     r->infinity = infinity;
+    secp256k1_gej_verify(r);
+}
+
+static void secp256k1_gej_add_coz(secp256k1_gej *r, secp256k1_ge *b, const secp256k1_gej *a, secp256k1_fe *rzr) {
+    /* Operations: 5 mul, 2 sqr, 0 normalize, 9 add/negate */
+    secp256k1_fe h, i, h2, i2, u1, u2, t;
+    secp256k1_gej_verify(a);
+    VERIFY_CHECK(!a->infinity);
+    secp256k1_fe_verify_magnitude(&b->x, 1);
+    secp256k1_fe_verify_magnitude(&b->y, 1);
+
+    /** Meloni's co-Z addition with update (ZADDU), from:
+     *    Nicolas Meloni, New Point Addition Formulae for ECC Applications.
+     *    In C. Carlet and B. Sunar, Eds., Arithmetic of Finite Fields, vol. 4547 of Lecture Notes in Computer Science, pages 189-201. Springer-Verlag, 2007.
+     *  As both points share Z, the sum needs no Z^2 or Z^3 factors, and the products
+     *  X2*h^2 and Y2*h^3 it computes along the way are b over the new Z coordinate Z*h.
+     */
+    secp256k1_fe_negate(&h, &a->x, SECP256K1_GEJ_X_MAGNITUDE_MAX); secp256k1_fe_add(&h, &b->x); /* h = X2-X1 (8) */
+    secp256k1_fe_negate(&i, &a->y, SECP256K1_GEJ_Y_MAGNITUDE_MAX); secp256k1_fe_add(&i, &b->y); /* i = Y2-Y1 (6) */
+    VERIFY_CHECK(!secp256k1_fe_normalizes_to_zero_var(&h));
+    secp256k1_fe_sqr(&h2, &h);
+    secp256k1_fe_mul(&u1, &a->x, &h2);                   /* u1 = X1*h^2 (1) */
+    secp256k1_fe_mul(&u2, &b->x, &h2);                   /* u2 = X2*h^2 (1) */
+    secp256k1_fe_sqr(&i2, &i);
+    secp256k1_fe_mul(&r->z, &a->z, &h);                  /* Z3 = Z*h (1) */
+    *rzr = h;
+    secp256k1_fe_negate(&t, &u1, 1); secp256k1_fe_add(&t, &u2);
+    secp256k1_fe_mul(&b->y, &b->y, &t);                  /* b->y = Y2*h^3 (1) */
+    t = u1; secp256k1_fe_add(&t, &u2); secp256k1_fe_negate(&t, &t, 2);
+    r->x = i2; secp256k1_fe_add(&r->x, &t);              /* X3 = i^2-X1*h^2-X2*h^2 (4) */
+    secp256k1_fe_negate(&t, &r->x, 4); secp256k1_fe_add(&t, &u2);
+    secp256k1_fe_mul(&r->y, &t, &i);
+    secp256k1_fe_negate(&t, &b->y, 1); secp256k1_fe_add(&r->y, &t); /* Y3 = i*(X2*h^2-X3)-Y2*h^3 (3) */
+    b->x = u2;
+    r->infinity = 0;
+    secp256k1_gej_verify(r);
+}
+
+static void secp256k1_gep_set_gej(secp256k1_gep *r, const secp256k1_gej *a) {
+    /* Operations: 2 mul, 1 sqr, 1 normalize, 3 cmov */
+    static const secp256k1_fe fe_0 = SECP256K1_FE_CONST(0, 0, 0, 0, 0, 0, 0, 0);
+    static const secp256k1_fe fe_1 = SECP256K1_FE_CONST(0, 0, 0, 0, 0, 0, 0, 1);
+    secp256k1_fe zz;
+    secp256k1_gej_verify(a);
+    secp256k1_fe_mul(&r->x, &a->x, &a->z);               /* x = X*Z */
+    r->y = a->y; secp256k1_fe_normalize_weak(&r->y);     /* y = Y */
+    secp256k1_fe_sqr(&zz, &a->z);
+    secp256k1_fe_mul(&r->z, &zz, &a->z);                 /* z = Z^3 */
+    secp256k1_fe_cmov(&r->x, &fe_0, a->infinity);
+    secp256k1_fe_cmov(&r->y, &fe_1, a->infinity);
+    secp256k1_fe_cmov(&r->z, &fe_0, a->infinity);
+}
+
+static void secp256k1_gej_set_gep(secp256k1_gej *r, const secp256k1_gep *a) {
+    /* Operations: 2 mul, 1 sqr */
+    secp256k1_fe zz;
+    secp256k1_fe_mul(&r->x, &a->x, &a->z);               /* X = x*z */
+    secp256k1_fe_sqr(&zz, &a->z);
+    secp256k1_fe_mul(&r->y, &a->y, &zz);                 /* Y = y*z^2 */
+    r->z = a->z;
+    r->infinity = secp256k1_fe_normalizes_to_zero(&r->z);
+    secp256k1_gej_verify(r);
+}
+
+static void secp256k1_gep_add_ge(secp256k1_gep *r, const secp256k1_gep *a, const secp256k1_ge *b) {
+    /* Operations: 11 mul, 0 sqr, 4 normalize, 16 mul_int/add/negate */
+    secp256k1_fe t0, t1, t2, t3, t4, x3, y3, z3;
+    VERIFY_CHECK(!b->infinity);
+    secp256k1_fe_verify_magnitude(&b->x, 4);
+    secp256k1_fe_verify_magnitude(&b->y, 4);
+    secp256k1_fe_verify_magnitude(&a->x, 1);
+    secp256k1_fe_verify_magnitude(&a->y, 1);
+    secp256k1_fe_verify_magnitude(&a->z, 1);
+
+    /** Algorithm 8 (mixed addition for a = 0) of:
+     *    Joost Renes, Craig Costello and Lejla Batina, Complete addition formulas for prime order elliptic curves.
+     *    In M. Fischlin and J.-S. Coron, Eds., Advances in Cryptology - EUROCRYPT 2016, vol. 9665 of Lecture Notes in Computer Science, pages 403-428. Springer-Verlag, 2016.
+     *  with b3 = 3*7 = 21. The formulas are correct for every a, so unlike secp256k1_gej_add_ge
+     *  there is nothing to select with cmovs afterwards.
+     */
+    secp256k1_fe_mul(&t0, &a->x, &b->x);                 /* t0 = X1*X2 (1) */
+    secp256k1_fe_mul(&t1, &a->y, &b->y);                 /* t1 = Y1*Y2 (1) */
+    t3 = b->x; secp256k1_fe_add(&t3, &b->y);
+    t4 = a->x; secp256k1_fe_add(&t4, &a->y);
+    secp256k1_fe_mul(&t3, &t3, &t4);
+    t4 = t0; secp256k1_fe_add(&t4, &t1); secp256k1_fe_negate(&t4, &t4, 2);
+    secp256k1_fe_add(&t3, &t4);                          /* t3 = X1*Y2+X2*Y1 (4) */
+    secp256k1_fe_mul(&t4, &b->y, &a->z); secp256k1_fe_add(&t4, &a->y); /* t4 = Y1+Y2*Z1 (2) */
+    secp256k1_fe_mul(&y3, &b->x, &a->z); secp256k1_fe_add(&y3, &a->x); /* y3 = X1+X2*Z1 (2) */
+    secp256k1_fe_mul_int(&t0, 3);                        /* t0 = 3*X1*X2 (3) */
+    t2 = a->z; secp256k1_fe_mul_int(&t2, 21); secp256k1_fe_normalize_weak(&t2); /* t2 = b3*Z1 (1) */
+    z3 = t1; secp256k1_fe_add(&z3, &t2);                 /* z3 = Y1*Y2+b3*Z1 (2) */
+    secp256k1_fe_negate(&t2, &t2, 1); secp256k1_fe_add(&t1, &t2); /* t1 = Y1*Y2-b3*Z1 (3) */
+    secp256k1_fe_mul(&x3, &t4, &y3); secp256k1_fe_mul_int(&x3, 21); secp256k1_fe_negate(&x3, &x3, 21);
+    secp256k1_fe_mul(&t2, &t3, &t1); secp256k1_fe_add(&x3, &t2);
+    secp256k1_fe_normalize_weak(&x3);                    /* X3 = t3*t1-b3*t4*y3 (1) */
+    secp256k1_fe_mul(&y3, &y3, &t0); secp256k1_fe_mul_int(&y3, 21);
+    secp256k1_fe_mul(&t1, &t1, &z3); secp256k1_fe_add(&y3, &t1);
+    secp256k1_fe_normalize_weak(&y3);                    /* Y3 = t1*z3+b3*y3*t0 (1) */
+    secp256k1_fe_mul(&t0, &t0, &t3);
+    secp256k1_fe_mul(&z3, &z3, &t4); secp256k1_fe_add(&z3, &t0);
+    secp256k1_fe_normalize_weak(&z3);                    /* Z3 = z3*t4+t0*t3 (1) */
+    r->x = x3;
+    r->y = y3;
+    r->z = z3;
 }
 
 static void secp256k1_gej_rescale(secp256k1_gej *r, const secp256k1_fe *s) {
     /* Operations: 4 mul, 1 sqr */
     secp256k1_fe zz;
-    VERIFY_CHECK(!secp256k1_fe_is_zero(s));
+#ifdef VERIFY
+    zz = *s;
+    VERIFY_CHECK(!secp256k1_fe_normalizes_to_zero_var(&zz));
+#endif
     secp256k1_fe_sqr(&zz, s);
     secp256k1_fe_mul(&r->x, &r->x, &zz);                /* r->x *= s^2 */
     secp256k1_fe_mul(&r->y, &r->y, &zz);
     secp256k1_fe_mul(&r->y, &r->y, s);                  /* r->y *= s^3 */
     secp256k1_fe_mul(&r->z, &r->z, s);                  /* r->z *= s   */
+    secp256k1_gej_verify(r);
 }
 
 static void secp256k1_ge_to_storage(secp256k1_ge_storage *r, const secp256k1_ge *a) {
@@ -0,0 +1,46 @@
+/**********************************************************************
+ * Copyright (c) 2016 libsecp256k1 contributors                       *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_GROUP_X4_
+#define _SECP256K1_GROUP_X4_
+
+#include "group.h"
+#include "field_x4.h"
+
+#ifdef USE_AVX2
+
+/** Four group elements in affine coordinates, none of them infinity. */
+typedef struct {
+    secp256k1_fe_x4 x;
+    secp256k1_fe_x4 y;
+} secp256k1_ge_x4;
+
+/** Four group elements in jacobian coordinates. */
+typedef struct {
+    secp256k1_fe_x4 x;
+    secp256k1_fe_x4 y;
+    secp256k1_fe_x4 z;
+    int infinity; /* lane flags of the points at infinity */
+} secp256k1_gej_x4;
+
+/** Set the lanes of r to the four points a[0..3], none of which may be infinity. */
+static SECP256K1_TARGET_AVX2 void secp256k1_ge_x4_set_ge(secp256k1_ge_x4 *r, const secp256k1_ge *a);
+
+/** Set a jacobian group element equal to another which is given in affine coordinates. */
+static SECP256K1_TARGET_AVX2 void secp256k1_gej_x4_set_ge(secp256k1_gej_x4 *r, const secp256k1_ge_x4 *a);
+
+/** Store the lanes of a in r[0..3]. */
+static SECP256K1_TARGET_AVX2 void secp256k1_gej_x4_get_gej(secp256k1_gej *r, const secp256k1_gej_x4 *a);
+
+/** Set r equal to the double of a, as secp256k1_gej_double_nonzero does for each lane. No lane of a may be infinity. */
+static SECP256K1_TARGET_AVX2 void secp256k1_gej_x4_double_nonzero(secp256k1_gej_x4 *r, const secp256k1_gej_x4 *a);
+
+/** Set r equal to the sum of a and b, as secp256k1_gej_add_ge does for each lane. Constant time. */
+static SECP256K1_TARGET_AVX2 void secp256k1_gej_x4_add_ge(secp256k1_gej_x4 *r, const secp256k1_gej_x4 *a, const secp256k1_ge_x4 *b);
+
+#endif
+
+#endif
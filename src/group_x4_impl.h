@@ -0,0 +1,136 @@
+/**********************************************************************
+ * Copyright (c) 2016 libsecp256k1 contributors                       *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_GROUP_X4_IMPL_H_
+#define _SECP256K1_GROUP_X4_IMPL_H_
+
+#include "field_x4_impl.h"
+#include "group_x4.h"
+
+#ifdef USE_AVX2
+
+static SECP256K1_TARGET_AVX2 void secp256k1_ge_x4_set_ge(secp256k1_ge_x4 *r, const secp256k1_ge *a) {
+    secp256k1_fe x[4], y[4];
+    int j;
+    for (j = 0; j < 4; j++) {
+        VERIFY_CHECK(!a[j].infinity);
+        x[j] = a[j].x;
+        y[j] = a[j].y;
+    }
+    secp256k1_fe_x4_set_fe(&r->x, x);
+    secp256k1_fe_x4_set_fe(&r->y, y);
+}
+
+static SECP256K1_TARGET_AVX2 void secp256k1_gej_x4_set_ge(secp256k1_gej_x4 *r, const secp256k1_ge_x4 *a) {
+    r->infinity = 0;
+    r->x = a->x;
+    r->y = a->y;
+    secp256k1_fe_x4_set_int(&r->z, 1);
+}
+
+static SECP256K1_TARGET_AVX2 void secp256k1_gej_x4_get_gej(secp256k1_gej *r, const secp256k1_gej_x4 *a) {
+    secp256k1_fe x[4], y[4], z[4];
+    int j;
+    secp256k1_fe_x4_get_fe(x, &a->x);
+    secp256k1_fe_x4_get_fe(y, &a->y);
+    secp256k1_fe_x4_get_fe(z, &a->z);
+    for (j = 0; j < 4; j++) {
+        r[j].x = x[j];
+        r[j].y = y[j];
+        r[j].z = z[j];
+        r[j].infinity = (a->infinity >> j) & 1;
+    }
+}
+
+static SECP256K1_TARGET_AVX2 void secp256k1_gej_x4_double_nonzero(secp256k1_gej_x4 *r, const secp256k1_gej_x4 *a) {
+    /* Operations: 3 mul, 4 sqr, 0 normalize, 12 mul_int/add/negate; the formulas of secp256k1_gej_double_var */
+    secp256k1_fe_x4 t1, t2, t3, t4;
+    VERIFY_CHECK(a->infinity == 0);
+    r->infinity = 0;
+
+    secp256k1_fe_x4_mul(&r->z, &a->z, &a->y);
+    secp256k1_fe_x4_mul_int(&r->z, 2);       /* Z' = 2*Y*Z (2) */
+    secp256k1_fe_x4_sqr(&t1, &a->x);
+    secp256k1_fe_x4_mul_int(&t1, 3);         /* T1 = 3*X^2 (3) */
+    secp256k1_fe_x4_sqr(&t2, &t1);           /* T2 = 9*X^4 (1) */
+    secp256k1_fe_x4_sqr(&t3, &a->y);
+    secp256k1_fe_x4_mul_int(&t3, 2);         /* T3 = 2*Y^2 (2) */
+    secp256k1_fe_x4_sqr(&t4, &t3);
+    secp256k1_fe_x4_mul_int(&t4, 2);         /* T4 = 8*Y^4 (2) */
+    secp256k1_fe_x4_mul(&t3, &t3, &a->x);    /* T3 = 2*X*Y^2 (1) */
+    r->x = t3;
+    secp256k1_fe_x4_mul_int(&r->x, 4);       /* X' = 8*X*Y^2 (4) */
+    secp256k1_fe_x4_negate(&r->x, &r->x, 4); /* X' = -8*X*Y^2 (5) */
+    secp256k1_fe_x4_add(&r->x, &t2);         /* X' = 9*X^4 - 8*X*Y^2 (6) */
+    secp256k1_fe_x4_negate(&t2, &t2, 1);     /* T2 = -9*X^4 (2) */
+    secp256k1_fe_x4_mul_int(&t3, 6);         /* T3 = 12*X*Y^2 (6) */
+    secp256k1_fe_x4_add(&t3, &t2);           /* T3 = 12*X*Y^2 - 9*X^4 (8) */
+    secp256k1_fe_x4_mul(&r->y, &t1, &t3);    /* Y' = 36*X^3*Y^2 - 27*X^6 (1) */
+    secp256k1_fe_x4_negate(&t2, &t4, 2);     /* T2 = -8*Y^4 (3) */
+    secp256k1_fe_x4_add(&r->y, &t2);         /* Y' = 36*X^3*Y^2 - 27*X^6 - 8*Y^4 (4) */
+}
+
+static SECP256K1_TARGET_AVX2 void secp256k1_gej_x4_add_ge(secp256k1_gej_x4 *r, const secp256k1_gej_x4 *a, const secp256k1_ge_x4 *b) {
+    /* Operations: 7 mul, 5 sqr, 2 normalize, 21 mul_int/add/negate/cmov; see secp256k1_gej_add_ge for the derivation */
+    secp256k1_fe_x4 fe_1;
+    secp256k1_fe_x4 zz, u1, u2, s1, s2, t, tt, m, n, q, rr;
+    secp256k1_fe_x4 m_alt, rr_alt;
+    int infinity, degenerate;
+    VERIFY_CHECK((a->infinity & ~15) == 0);
+
+    secp256k1_fe_x4_set_int(&fe_1, 1);
+    secp256k1_fe_x4_sqr(&zz, &a->z);                       /* z = Z1^2 */
+    u1 = a->x;                                             /* u1 = U1 = X1*Z2^2 (6) */
+    secp256k1_fe_x4_mul(&u2, &b->x, &zz);                  /* u2 = U2 = X2*Z1^2 (1) */
+    s1 = a->y;                                             /* s1 = S1 = Y1*Z2^3 (4) */
+    secp256k1_fe_x4_mul(&s2, &b->y, &zz);                  /* s2 = Y2*Z1^2 (1) */
+    secp256k1_fe_x4_mul(&s2, &s2, &a->z);                  /* s2 = S2 = Y2*Z1^3 (1) */
+    t = u1; secp256k1_fe_x4_add(&t, &u2);                  /* t = T = U1+U2 (7) */
+    m = s1; secp256k1_fe_x4_add(&m, &s2);                  /* m = M = S1+S2 (5) */
+    secp256k1_fe_x4_sqr(&rr, &t);                          /* rr = T^2 (1) */
+    secp256k1_fe_x4_negate(&m_alt, &u2, 1);                /* Malt = -X2*Z1^2 (2) */
+    secp256k1_fe_x4_mul(&tt, &u1, &m_alt);                 /* tt = -U1*U2 (1) */
+    secp256k1_fe_x4_add(&rr, &tt);                         /* rr = R = T^2-U1*U2 (2) */
+    /* Lanes where lambda = R/M = 0/0 use the alternate expression (y1 - y2)/(x1 - x2). */
+    degenerate = secp256k1_fe_x4_normalizes_to_zero(&m) &
+                 secp256k1_fe_x4_normalizes_to_zero(&rr);
+    rr_alt = s1;
+    secp256k1_fe_x4_mul_int(&rr_alt, 2);       /* rr = Y1*Z2^3 - Y2*Z1^3 (8) */
+    secp256k1_fe_x4_add(&m_alt, &u1);          /* Malt = X1*Z2^2 - X2*Z1^2 (8) */
+
+    secp256k1_fe_x4_cmov(&rr_alt, &rr, ~degenerate & 15);
+    secp256k1_fe_x4_cmov(&m_alt, &m, ~degenerate & 15);
+    secp256k1_fe_x4_sqr(&n, &m_alt);                       /* n = Malt^2 (1) */
+    secp256k1_fe_x4_mul(&q, &n, &t);                       /* q = Q = T*Malt^2 (1) */
+    secp256k1_fe_x4_sqr(&n, &n);
+    secp256k1_fe_x4_cmov(&n, &m, degenerate);              /* n = M^3 * Malt (5) */
+    secp256k1_fe_x4_sqr(&t, &rr_alt);                      /* t = Ralt^2 (1) */
+    secp256k1_fe_x4_mul(&r->z, &a->z, &m_alt);             /* r->z = Malt*Z (1) */
+    infinity = secp256k1_fe_x4_normalizes_to_zero(&r->z) & ~a->infinity;
+    secp256k1_fe_x4_mul_int(&r->z, 2);                     /* r->z = Z3 = 2*Malt*Z (2) */
+    secp256k1_fe_x4_negate(&q, &q, 1);                     /* q = -Q (2) */
+    secp256k1_fe_x4_add(&t, &q);                           /* t = Ralt^2-Q (3) */
+    secp256k1_fe_x4_normalize_weak(&t);
+    r->x = t;                                              /* r->x = Ralt^2-Q (1) */
+    secp256k1_fe_x4_mul_int(&t, 2);                        /* t = 2*x3 (2) */
+    secp256k1_fe_x4_add(&t, &q);                           /* t = 2*x3 - Q: (4) */
+    secp256k1_fe_x4_mul(&t, &t, &rr_alt);                  /* t = Ralt*(2*x3 - Q) (1) */
+    secp256k1_fe_x4_add(&t, &n);                           /* t = Ralt*(2*x3 - Q) + M^3*Malt (6) */
+    secp256k1_fe_x4_negate(&r->y, &t, 6);                  /* r->y = Ralt*(Q - 2x3) - M^3*Malt (7) */
+    secp256k1_fe_x4_normalize_weak(&r->y);
+    secp256k1_fe_x4_mul_int(&r->x, 4);                     /* r->x = X3 = 4*(Ralt^2-Q) */
+    secp256k1_fe_x4_mul_int(&r->y, 4);                     /* r->y = Y3 = 4*Ralt*(Q - 2x3) - 4*M^3*Malt (4) */
+
+    /* Lanes where a is infinity become (b->x, b->y, 1). */
+    secp256k1_fe_x4_cmov(&r->x, &b->x, a->infinity);
+    secp256k1_fe_x4_cmov(&r->y, &b->y, a->infinity);
+    secp256k1_fe_x4_cmov(&r->z, &fe_1, a->infinity);
+    r->infinity = infinity;
+}
+
+#endif
+
+#endif
@@ -20,6 +20,11 @@ static void secp256k1_sha256_initialize(secp256k1_sha256_t *hash);
 static void secp256k1_sha256_write(secp256k1_sha256_t *hash, const unsigned char *data, size_t size);
 static void secp256k1_sha256_finalize(secp256k1_sha256_t *hash, unsigned char *out32);
 
+/** Compute the SHA-256 hashes of n messages of len bytes each, stored back to
+ *  back starting at in. Hash i is written to out + 32*i. Independent messages
+ *  are hashed several at a time where the CPU allows it. */
+static void secp256k1_sha256_batch(unsigned char *out, const unsigned char *in, size_t len, size_t n);
+
 typedef struct {
     secp256k1_sha256_t inner, outer;
 } secp256k1_hmac_sha256_t;
@@ -0,0 +1,95 @@
+/**********************************************************************
+ * Copyright (c) 2016 libsecp256k1 contributors                       *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_HASH_SHANI_IMPL_H_
+#define _SECP256K1_HASH_SHANI_IMPL_H_
+
+#if defined HAVE_CONFIG_H
+#include "libsecp256k1-config.h"
+#endif
+
+#include <stdint.h>
+
+/* SHA-256 compression using the SHA extensions. Only compiled in when
+ * USE_SHANI is defined; callers must also check
+ * secp256k1_cpu_has(SECP256K1_CPU_SHA). */
+
+#ifdef USE_SHANI
+
+#include <immintrin.h>
+
+#define SECP256K1_TARGET_SHA __attribute__((target("sha,sse4.1")))
+
+static const uint32_t secp256k1_sha256_shani_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/* Four rounds: sha256rnds2 does two, taking its message words plus round
+ * constants from the low half of the third operand. */
+#define SHA256_SHANI_ROUNDS(m, i) do { \
+    __m128i wk = _mm_add_epi32((m), _mm_loadu_si128((const __m128i*)&secp256k1_sha256_shani_k[(i)])); \
+    cdgh = _mm_sha256rnds2_epu32(cdgh, abef, wk); \
+    abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(wk, 0x0E)); \
+} while(0)
+
+/* Replace m0 = W[t-16..t-13] by W[t..t+3], given m1 = W[t-12..t-9], m2 = W[t-8..t-5] and m3 = W[t-4..t-1]. */
+#define SHA256_SHANI_SCHEDULE(m0, m1, m2, m3) \
+    (m0) = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32((m0), (m1)), _mm_alignr_epi8((m3), (m2), 4)), (m3))
+
+/** Perform one SHA-256 transformation, as secp256k1_sha256_transform does. */
+static SECP256K1_TARGET_SHA void secp256k1_sha256_transform_shani(uint32_t* s, const uint32_t* chunk) {
+    const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i abef, cdgh, abef_save, cdgh_save, tmp, m0, m1, m2, m3;
+    int i;
+
+    /* The instructions keep the state as (A, B, E, F) and (C, D, G, H), in that order from the top lane down. */
+    tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&s[0]), 0xB1);  /* C D A B */
+    cdgh = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&s[4]), 0x1B); /* E F G H */
+    abef = _mm_alignr_epi8(tmp, cdgh, 8);
+    cdgh = _mm_blend_epi16(cdgh, tmp, 0xF0);
+    abef_save = abef;
+    cdgh_save = cdgh;
+
+    m0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)&chunk[0]), bswap);
+    m1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)&chunk[4]), bswap);
+    m2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)&chunk[8]), bswap);
+    m3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)&chunk[12]), bswap);
+    SHA256_SHANI_ROUNDS(m0, 0);
+    SHA256_SHANI_ROUNDS(m1, 4);
+    SHA256_SHANI_ROUNDS(m2, 8);
+    SHA256_SHANI_ROUNDS(m3, 12);
+    for (i = 16; i < 64; i += 16) {
+        SHA256_SHANI_SCHEDULE(m0, m1, m2, m3);
+        SHA256_SHANI_ROUNDS(m0, i);
+        SHA256_SHANI_SCHEDULE(m1, m2, m3, m0);
+        SHA256_SHANI_ROUNDS(m1, i + 4);
+        SHA256_SHANI_SCHEDULE(m2, m3, m0, m1);
+        SHA256_SHANI_ROUNDS(m2, i + 8);
+        SHA256_SHANI_SCHEDULE(m3, m0, m1, m2);
+        SHA256_SHANI_ROUNDS(m3, i + 12);
+    }
+
+    abef = _mm_add_epi32(abef, abef_save);
+    cdgh = _mm_add_epi32(cdgh, cdgh_save);
+    tmp = _mm_shuffle_epi32(abef, 0x1B);  /* F E B A */
+    cdgh = _mm_shuffle_epi32(cdgh, 0xB1); /* D C H G */
+    _mm_storeu_si128((__m128i*)&s[0], _mm_blend_epi16(tmp, cdgh, 0xF0));
+    _mm_storeu_si128((__m128i*)&s[4], _mm_alignr_epi8(cdgh, tmp, 8));
+}
+
+#undef SHA256_SHANI_SCHEDULE
+#undef SHA256_SHANI_ROUNDS
+
+#endif
+
+#endif
@@ -0,0 +1,45 @@
+/**********************************************************************
+ * Copyright (c) 2016 libsecp256k1 contributors                       *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_HASH_X8_
+#define _SECP256K1_HASH_X8_
+
+/** Eight-lane SHA-256.
+ *
+ *  Hashes eight independent messages at once, the state and message words
+ *  of lane j sitting in lane j of 256-bit AVX2 vectors. This only pays off
+ *  when a caller has many short messages to hash together, such as the
+ *  shared secrets of a batch of ECDH computations.
+ *
+ *  Only compiled in when USE_AVX2 is defined; callers must also check
+ *  secp256k1_cpu_has(SECP256K1_CPU_AVX2) before using any of this.
+ */
+
+#if defined HAVE_CONFIG_H
+#include "libsecp256k1-config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifdef USE_AVX2
+
+#ifndef SECP256K1_TARGET_AVX2
+#define SECP256K1_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+/** Perform one SHA-256 transformation on each of eight states. Word i of the
+ *  state of lane j is s[8*i+j], and word i of the block of lane j, already
+ *  converted from big endian, is w[8*i+j]. */
+static SECP256K1_TARGET_AVX2 void secp256k1_sha256_x8_transform(uint32_t *s, const uint32_t *w);
+
+/** Compute the SHA-256 hashes of eight messages of len bytes each, stored
+ *  back to back starting at in. Hash j is written to out + 32*j. */
+static SECP256K1_TARGET_AVX2 void secp256k1_sha256_x8(unsigned char *out, const unsigned char *in, size_t len);
+
+#endif
+
+#endif
@@ -0,0 +1,214 @@
+/**********************************************************************
+ * Copyright (c) 2016 libsecp256k1 contributors                       *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_HASH_X8_IMPL_H_
+#define _SECP256K1_HASH_X8_IMPL_H_
+
+#include <string.h>
+
+#include "hash_x8.h"
+
+#ifdef USE_AVX2
+
+#include <immintrin.h>
+
+/* The macros of hash_impl.h, on eight lanes at once. AVX2 has no rotate, so each one is two shifts. */
+#define SHA256_X8_ROR(x, n) _mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+#define SHA256_X8_ADD4(a, b, c, d) _mm256_add_epi32(_mm256_add_epi32((a), (b)), _mm256_add_epi32((c), (d)))
+#define SHA256_X8_LOAD(w, i) _mm256_loadu_si256((const __m256i*)&(w)[8 * (i)])
+#define SHA256_X8_Ch(x,y,z) _mm256_xor_si256((z), _mm256_and_si256((x), _mm256_xor_si256((y), (z))))
+#define SHA256_X8_Maj(x,y,z) _mm256_or_si256(_mm256_and_si256((x), (y)), _mm256_and_si256((z), _mm256_or_si256((x), (y))))
+#define SHA256_X8_Sigma0(x) _mm256_xor_si256(_mm256_xor_si256(SHA256_X8_ROR((x), 2), SHA256_X8_ROR((x), 13)), SHA256_X8_ROR((x), 22))
+#define SHA256_X8_Sigma1(x) _mm256_xor_si256(_mm256_xor_si256(SHA256_X8_ROR((x), 6), SHA256_X8_ROR((x), 11)), SHA256_X8_ROR((x), 25))
+#define SHA256_X8_sigma0(x) _mm256_xor_si256(_mm256_xor_si256(SHA256_X8_ROR((x), 7), SHA256_X8_ROR((x), 18)), _mm256_srli_epi32((x), 3))
+#define SHA256_X8_sigma1(x) _mm256_xor_si256(_mm256_xor_si256(SHA256_X8_ROR((x), 17), SHA256_X8_ROR((x), 19)), _mm256_srli_epi32((x), 10))
+
+#define SHA256_X8_ROUND(a,b,c,d,e,f,g,h,k,w) do { \
+    __m256i t1 = SHA256_X8_ADD4((h), SHA256_X8_Sigma1(e), SHA256_X8_Ch((e), (f), (g)), _mm256_add_epi32(_mm256_set1_epi32((int)(k)), (w))); \
+    __m256i t2 = _mm256_add_epi32(SHA256_X8_Sigma0(a), SHA256_X8_Maj((a), (b), (c))); \
+    (d) = _mm256_add_epi32((d), t1); \
+    (h) = _mm256_add_epi32(t1, t2); \
+} while(0)
+
+static SECP256K1_TARGET_AVX2 void secp256k1_sha256_x8_transform(uint32_t *s, const uint32_t *w) {
+    __m256i a = SHA256_X8_LOAD(s, 0), b = SHA256_X8_LOAD(s, 1), c = SHA256_X8_LOAD(s, 2), d = SHA256_X8_LOAD(s, 3);
+    __m256i e = SHA256_X8_LOAD(s, 4), f = SHA256_X8_LOAD(s, 5), g = SHA256_X8_LOAD(s, 6), h = SHA256_X8_LOAD(s, 7);
+    __m256i w0, w1, w2, w3, w4, w5, w6, w7, w8, w9, w10, w11, w12, w13, w14, w15;
+
+    SHA256_X8_ROUND(a, b, c, d, e, f, g, h, 0x428a2f98, w0 = SHA256_X8_LOAD(w, 0));
+    SHA256_X8_ROUND(h, a, b, c, d, e, f, g, 0x71374491, w1 = SHA256_X8_LOAD(w, 1));
+    SHA256_X8_ROUND(g, h, a, b, c, d, e, f, 0xb5c0fbcf, w2 = SHA256_X8_LOAD(w, 2));
+    SHA256_X8_ROUND(f, g, h, a, b, c, d, e, 0xe9b5dba5, w3 = SHA256_X8_LOAD(w, 3));
+    SHA256_X8_ROUND(e, f, g, h, a, b, c, d, 0x3956c25b, w4 = SHA256_X8_LOAD(w, 4));
+    SHA256_X8_ROUND(d, e, f, g, h, a, b, c, 0x59f111f1, w5 = SHA256_X8_LOAD(w, 5));
+    SHA256_X8_ROUND(c, d, e, f, g, h, a, b, 0x923f82a4, w6 = SHA256_X8_LOAD(w, 6));
+    SHA256_X8_ROUND(b, c, d, e, f, g, h, a, 0xab1c5ed5, w7 = SHA256_X8_LOAD(w, 7));
+    SHA256_X8_ROUND(a, b, c, d, e, f, g, h, 0xd807aa98, w8 = SHA256_X8_LOAD(w, 8));
+    SHA256_X8_ROUND(h, a, b, c, d, e, f, g, 0x12835b01, w9 = SHA256_X8_LOAD(w, 9));
+    SHA256_X8_ROUND(g, h, a, b, c, d, e, f, 0x243185be, w10 = SHA256_X8_LOAD(w, 10));
+    SHA256_X8_ROUND(f, g, h, a, b, c, d, e, 0x550c7dc3, w11 = SHA256_X8_LOAD(w, 11));
+    SHA256_X8_ROUND(e, f, g, h, a, b, c, d, 0x72be5d74, w12 = SHA256_X8_LOAD(w, 12));
+    SHA256_X8_ROUND(d, e, f, g, h, a, b, c, 0x80deb1fe, w13 = SHA256_X8_LOAD(w, 13));
+    SHA256_X8_ROUND(c, d, e, f, g, h, a, b, 0x9bdc06a7, w14 = SHA256_X8_LOAD(w, 14));
+    SHA256_X8_ROUND(b, c, d, e, f, g, h, a, 0xc19bf174, w15 = SHA256_X8_LOAD(w, 15));
+
+    SHA256_X8_ROUND(a, b, c, d, e, f, g, h, 0xe49b69c1, w0 = SHA256_X8_ADD4(w0, SHA256_X8_sigma1(w14), w9, SHA256_X8_sigma0(w1)));
+    SHA256_X8_ROUND(h, a, b, c, d, e, f, g, 0xefbe4786, w1 = SHA256_X8_ADD4(w1, SHA256_X8_sigma1(w15), w10, SHA256_X8_sigma0(w2)));
+    SHA256_X8_ROUND(g, h, a, b, c, d, e, f, 0x0fc19dc6, w2 = SHA256_X8_ADD4(w2, SHA256_X8_sigma1(w0), w11, SHA256_X8_sigma0(w3)));
+    SHA256_X8_ROUND(f, g, h, a, b, c, d, e, 0x240ca1cc, w3 = SHA256_X8_ADD4(w3, SHA256_X8_sigma1(w1), w12, SHA256_X8_sigma0(w4)));
+    SHA256_X8_ROUND(e, f, g, h, a, b, c, d, 0x2de92c6f, w4 = SHA256_X8_ADD4(w4, SHA256_X8_sigma1(w2), w13, SHA256_X8_sigma0(w5)));
+    SHA256_X8_ROUND(d, e, f, g, h, a, b, c, 0x4a7484aa, w5 = SHA256_X8_ADD4(w5, SHA256_X8_sigma1(w3), w14, SHA256_X8_sigma0(w6)));
+    SHA256_X8_ROUND(c, d, e, f, g, h, a, b, 0x5cb0a9dc, w6 = SHA256_X8_ADD4(w6, SHA256_X8_sigma1(w4), w15, SHA256_X8_sigma0(w7)));
+    SHA256_X8_ROUND(b, c, d, e, f, g, h, a, 0x76f988da, w7 = SHA256_X8_ADD4(w7, SHA256_X8_sigma1(w5), w0, SHA256_X8_sigma0(w8)));
+    SHA256_X8_ROUND(a, b, c, d, e, f, g, h, 0x983e5152, w8 = SHA256_X8_ADD4(w8, SHA256_X8_sigma1(w6), w1, SHA256_X8_sigma0(w9)));
+    SHA256_X8_ROUND(h, a, b, c, d, e, f, g, 0xa831c66d, w9 = SHA256_X8_ADD4(w9, SHA256_X8_sigma1(w7), w2, SHA256_X8_sigma0(w10)));
+    SHA256_X8_ROUND(g, h, a, b, c, d, e, f, 0xb00327c8, w10 = SHA256_X8_ADD4(w10, SHA256_X8_sigma1(w8), w3, SHA256_X8_sigma0(w11)));
+    SHA256_X8_ROUND(f, g, h, a, b, c, d, e, 0xbf597fc7, w11 = SHA256_X8_ADD4(w11, SHA256_X8_sigma1(w9), w4, SHA256_X8_sigma0(w12)));
+    SHA256_X8_ROUND(e, f, g, h, a, b, c, d, 0xc6e00bf3, w12 = SHA256_X8_ADD4(w12, SHA256_X8_sigma1(w10), w5, SHA256_X8_sigma0(w13)));
+    SHA256_X8_ROUND(d, e, f, g, h, a, b, c, 0xd5a79147, w13 = SHA256_X8_ADD4(w13, SHA256_X8_sigma1(w11), w6, SHA256_X8_sigma0(w14)));
+    SHA256_X8_ROUND(c, d, e, f, g, h, a, b, 0x06ca6351, w14 = SHA256_X8_ADD4(w14, SHA256_X8_sigma1(w12), w7, SHA256_X8_sigma0(w15)));
+    SHA256_X8_ROUND(b, c, d, e, f, g, h, a, 0x14292967, w15 = SHA256_X8_ADD4(w15, SHA256_X8_sigma1(w13), w8, SHA256_X8_sigma0(w0)));
+
+    SHA256_X8_ROUND(a, b, c, d, e, f, g, h, 0x27b70a85, w0 = SHA256_X8_ADD4(w0, SHA256_X8_sigma1(w14), w9, SHA256_X8_sigma0(w1)));
+    SHA256_X8_ROUND(h, a, b, c, d, e, f, g, 0x2e1b2138, w1 = SHA256_X8_ADD4(w1, SHA256_X8_sigma1(w15), w10, SHA256_X8_sigma0(w2)));
+    SHA256_X8_ROUND(g, h, a, b, c, d, e, f, 0x4d2c6dfc, w2 = SHA256_X8_ADD4(w2, SHA256_X8_sigma1(w0), w11, SHA256_X8_sigma0(w3)));
+    SHA256_X8_ROUND(f, g, h, a, b, c, d, e, 0x53380d13, w3 = SHA256_X8_ADD4(w3, SHA256_X8_sigma1(w1), w12, SHA256_X8_sigma0(w4)));
+    SHA256_X8_ROUND(e, f, g, h, a, b, c, d, 0x650a7354, w4 = SHA256_X8_ADD4(w4, SHA256_X8_sigma1(w2), w13, SHA256_X8_sigma0(w5)));
+    SHA256_X8_ROUND(d, e, f, g, h, a, b, c, 0x766a0abb, w5 = SHA256_X8_ADD4(w5, SHA256_X8_sigma1(w3), w14, SHA256_X8_sigma0(w6)));
+    SHA256_X8_ROUND(c, d, e, f, g, h, a, b, 0x81c2c92e, w6 = SHA256_X8_ADD4(w6, SHA256_X8_sigma1(w4), w15, SHA256_X8_sigma0(w7)));
+    SHA256_X8_ROUND(b, c, d, e, f, g, h, a, 0x92722c85, w7 = SHA256_X8_ADD4(w7, SHA256_X8_sigma1(w5), w0, SHA256_X8_sigma0(w8)));
+    SHA256_X8_ROUND(a, b, c, d, e, f, g, h, 0xa2bfe8a1, w8 = SHA256_X8_ADD4(w8, SHA256_X8_sigma1(w6), w1, SHA256_X8_sigma0(w9)));
+    SHA256_X8_ROUND(h, a, b, c, d, e, f, g, 0xa81a664b, w9 = SHA256_X8_ADD4(w9, SHA256_X8_sigma1(w7), w2, SHA256_X8_sigma0(w10)));
+    SHA256_X8_ROUND(g, h, a, b, c, d, e, f, 0xc24b8b70, w10 = SHA256_X8_ADD4(w10, SHA256_X8_sigma1(w8), w3, SHA256_X8_sigma0(w11)));
+    SHA256_X8_ROUND(f, g, h, a, b, c, d, e, 0xc76c51a3, w11 = SHA256_X8_ADD4(w11, SHA256_X8_sigma1(w9), w4, SHA256_X8_sigma0(w12)));
+    SHA256_X8_ROUND(e, f, g, h, a, b, c, d, 0xd192e819, w12 = SHA256_X8_ADD4(w12, SHA256_X8_sigma1(w10), w5, SHA256_X8_sigma0(w13)));
+    SHA256_X8_ROUND(d, e, f, g, h, a, b, c, 0xd6990624, w13 = SHA256_X8_ADD4(w13, SHA256_X8_sigma1(w11), w6, SHA256_X8_sigma0(w14)));
+    SHA256_X8_ROUND(c, d, e, f, g, h, a, b, 0xf40e3585, w14 = SHA256_X8_ADD4(w14, SHA256_X8_sigma1(w12), w7, SHA256_X8_sigma0(w15)));
+    SHA256_X8_ROUND(b, c, d, e, f, g, h, a, 0x106aa070, w15 = SHA256_X8_ADD4(w15, SHA256_X8_sigma1(w13), w8, SHA256_X8_sigma0(w0)));
+
+    SHA256_X8_ROUND(a, b, c, d, e, f, g, h, 0x19a4c116, w0 = SHA256_X8_ADD4(w0, SHA256_X8_sigma1(w14), w9, SHA256_X8_sigma0(w1)));
+    SHA256_X8_ROUND(h, a, b, c, d, e, f, g, 0x1e376c08, w1 = SHA256_X8_ADD4(w1, SHA256_X8_sigma1(w15), w10, SHA256_X8_sigma0(w2)));
+    SHA256_X8_ROUND(g, h, a, b, c, d, e, f, 0x2748774c, w2 = SHA256_X8_ADD4(w2, SHA256_X8_sigma1(w0), w11, SHA256_X8_sigma0(w3)));
+    SHA256_X8_ROUND(f, g, h, a, b, c, d, e, 0x34b0bcb5, w3 = SHA256_X8_ADD4(w3, SHA256_X8_sigma1(w1), w12, SHA256_X8_sigma0(w4)));
+    SHA256_X8_ROUND(e, f, g, h, a, b, c, d, 0x391c0cb3, w4 = SHA256_X8_ADD4(w4, SHA256_X8_sigma1(w2), w13, SHA256_X8_sigma0(w5)));
+    SHA256_X8_ROUND(d, e, f, g, h, a, b, c, 0x4ed8aa4a, w5 = SHA256_X8_ADD4(w5, SHA256_X8_sigma1(w3), w14, SHA256_X8_sigma0(w6)));
+    SHA256_X8_ROUND(c, d, e, f, g, h, a, b, 0x5b9cca4f, w6 = SHA256_X8_ADD4(w6, SHA256_X8_sigma1(w4), w15, SHA256_X8_sigma0(w7)));
+    SHA256_X8_ROUND(b, c, d, e, f, g, h, a, 0x682e6ff3, w7 = SHA256_X8_ADD4(w7, SHA256_X8_sigma1(w5), w0, SHA256_X8_sigma0(w8)));
+    SHA256_X8_ROUND(a, b, c, d, e, f, g, h, 0x748f82ee, w8 = SHA256_X8_ADD4(w8, SHA256_X8_sigma1(w6), w1, SHA256_X8_sigma0(w9)));
+    SHA256_X8_ROUND(h, a, b, c, d, e, f, g, 0x78a5636f, w9 = SHA256_X8_ADD4(w9, SHA256_X8_sigma1(w7), w2, SHA256_X8_sigma0(w10)));
+    SHA256_X8_ROUND(g, h, a, b, c, d, e, f, 0x84c87814, w10 = SHA256_X8_ADD4(w10, SHA256_X8_sigma1(w8), w3, SHA256_X8_sigma0(w11)));
+    SHA256_X8_ROUND(f, g, h, a, b, c, d, e, 0x8cc70208, w11 = SHA256_X8_ADD4(w11, SHA256_X8_sigma1(w9), w4, SHA256_X8_sigma0(w12)));
+    SHA256_X8_ROUND(e, f, g, h, a, b, c, d, 0x90befffa, w12 = SHA256_X8_ADD4(w12, SHA256_X8_sigma1(w10), w5, SHA256_X8_sigma0(w13)));
+    SHA256_X8_ROUND(d, e, f, g, h, a, b, c, 0xa4506ceb, w13 = SHA256_X8_ADD4(w13, SHA256_X8_sigma1(w11), w6, SHA256_X8_sigma0(w14)));
+    SHA256_X8_ROUND(c, d, e, f, g, h, a, b, 0xbef9a3f7, SHA256_X8_ADD4(w14, SHA256_X8_sigma1(w12), w7, SHA256_X8_sigma0(w15)));
+    SHA256_X8_ROUND(b, c, d, e, f, g, h, a, 0xc67178f2, SHA256_X8_ADD4(w15, SHA256_X8_sigma1(w13), w8, SHA256_X8_sigma0(w0)));
+
+    _mm256_storeu_si256((__m256i*)&s[0], _mm256_add_epi32(SHA256_X8_LOAD(s, 0), a));
+    _mm256_storeu_si256((__m256i*)&s[8], _mm256_add_epi32(SHA256_X8_LOAD(s, 1), b));
+    _mm256_storeu_si256((__m256i*)&s[16], _mm256_add_epi32(SHA256_X8_LOAD(s, 2), c));
+    _mm256_storeu_si256((__m256i*)&s[24], _mm256_add_epi32(SHA256_X8_LOAD(s, 3), d));
+    _mm256_storeu_si256((__m256i*)&s[32], _mm256_add_epi32(SHA256_X8_LOAD(s, 4), e));
+    _mm256_storeu_si256((__m256i*)&s[40], _mm256_add_epi32(SHA256_X8_LOAD(s, 5), f));
+    _mm256_storeu_si256((__m256i*)&s[48], _mm256_add_epi32(SHA256_X8_LOAD(s, 6), g));
+    _mm256_storeu_si256((__m256i*)&s[56], _mm256_add_epi32(SHA256_X8_LOAD(s, 7), h));
+}
+
+#undef SHA256_X8_ROUND
+#undef SHA256_X8_sigma1
+#undef SHA256_X8_sigma0
+#undef SHA256_X8_Sigma1
+#undef SHA256_X8_Sigma0
+#undef SHA256_X8_Maj
+#undef SHA256_X8_Ch
+#undef SHA256_X8_LOAD
+#undef SHA256_X8_ADD4
+#undef SHA256_X8_ROR
+
+/* Transpose the 8x8 matrix of 32-bit words whose rows are v[0..7]. */
+static SECP256K1_TARGET_AVX2 void secp256k1_sha256_x8_transpose(__m256i *v) {
+    __m256i t0 = _mm256_unpacklo_epi32(v[0], v[1]), t1 = _mm256_unpackhi_epi32(v[0], v[1]);
+    __m256i t2 = _mm256_unpacklo_epi32(v[2], v[3]), t3 = _mm256_unpackhi_epi32(v[2], v[3]);
+    __m256i t4 = _mm256_unpacklo_epi32(v[4], v[5]), t5 = _mm256_unpackhi_epi32(v[4], v[5]);
+    __m256i t6 = _mm256_unpacklo_epi32(v[6], v[7]), t7 = _mm256_unpackhi_epi32(v[6], v[7]);
+    __m256i u0 = _mm256_unpacklo_epi64(t0, t2), u1 = _mm256_unpackhi_epi64(t0, t2);
+    __m256i u2 = _mm256_unpacklo_epi64(t1, t3), u3 = _mm256_unpackhi_epi64(t1, t3);
+    __m256i u4 = _mm256_unpacklo_epi64(t4, t6), u5 = _mm256_unpackhi_epi64(t4, t6);
+    __m256i u6 = _mm256_unpacklo_epi64(t5, t7), u7 = _mm256_unpackhi_epi64(t5, t7);
+    v[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+    v[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+    v[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+    v[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+    v[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+    v[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+    v[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+    v[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+}
+
+static SECP256K1_TARGET_AVX2 void secp256k1_sha256_x8(unsigned char *out, const unsigned char *in, size_t len) {
+    static const uint32_t init[8] = {
+        0x6a09e667ul, 0xbb67ae85ul, 0x3c6ef372ul, 0xa54ff53aul, 0x510e527ful, 0x9b05688cul, 0x1f83d9abul, 0x5be0cd19ul
+    };
+    const __m256i bswap = _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+                                          12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+    uint32_t s[64], w[128];
+    unsigned char pad[8][64];
+    __m256i v[8];
+    size_t nblocks = (len + 8) / 64 + 1;
+    size_t blk, off;
+    int i, j, h;
+
+    for (i = 0; i < 8; i++) {
+        _mm256_storeu_si256((__m256i*)&s[8 * i], _mm256_set1_epi32((int)init[i]));
+    }
+    for (blk = 0, off = 0; blk < nblocks; blk++, off += 64) {
+        const unsigned char *p[8];
+        for (j = 0; j < 8; j++) {
+            p[j] = in + len * j;
+            if (off + 64 <= len) {
+                p[j] += off;
+            } else {
+                /* The block holding the 0x80 padding byte, the one after it, or the final one with the bit length. */
+                size_t rem = off < len ? len - off : 0;
+                memset(pad[j], 0, 64);
+                if (rem) {
+                    memcpy(pad[j], p[j] + off, rem);
+                }
+                if (off <= len) {
+                    pad[j][rem] = 0x80;
+                }
+                if (blk == nblocks - 1) {
+                    uint64_t bits = (uint64_t)len << 3;
+                    for (i = 0; i < 8; i++) {
+                        pad[j][63 - i] = bits >> (8 * i);
+                    }
+                }
+                p[j] = pad[j];
+            }
+        }
+        /* Each half block of the eight lanes is an 8x8 matrix of big endian words; its transpose is what the rounds take. */
+        for (h = 0; h < 2; h++) {
+            for (j = 0; j < 8; j++) {
+                v[j] = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(p[j] + 32 * h)), bswap);
+            }
+            secp256k1_sha256_x8_transpose(v);
+            for (i = 0; i < 8; i++) {
+                _mm256_storeu_si256((__m256i*)&w[64 * h + 8 * i], v[i]);
+            }
+        }
+        secp256k1_sha256_x8_transform(s, w);
+    }
+    for (i = 0; i < 8; i++) {
+        v[i] = _mm256_loadu_si256((const __m256i*)&s[8 * i]);
+    }
+    secp256k1_sha256_x8_transpose(v);
+    for (j = 0; j < 8; j++) {
+        _mm256_storeu_si256((__m256i*)(out + 32 * j), _mm256_shuffle_epi8(v[j], bswap));
+    }
+}
+
+#endif
+
+#endif
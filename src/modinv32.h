@@ -0,0 +1,56 @@
+/**********************************************************************
+ * Copyright (c) 2020 Peter Dettman                                   *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+/* Imported from the safegcd implementation in bitcoin-core/secp256k1
+ * (https://github.com/bitcoin-core/secp256k1, src/modinv32.h), adapted to
+ * this tree's include guards and C89 style. */
+
+#ifndef _SECP256K1_MODINV32_H_
+#define _SECP256K1_MODINV32_H_
+
+#if defined HAVE_CONFIG_H
+#include "libsecp256k1-config.h"
+#endif
+
+#include "util.h"
+
+/* A signed 30-bit limb representation of integers.
+ *
+ * Its value is sum(v[i] * 2^(30*i), i=0..8). */
+typedef struct {
+    int32_t v[9];
+} secp256k1_modinv32_signed30;
+
+typedef struct {
+    /* The modulus in signed30 notation, must be odd and in [3, 2^256]. */
+    secp256k1_modinv32_signed30 modulus;
+
+    /* modulus^{-1} mod 2^30 */
+    uint32_t modulus_inv30;
+} secp256k1_modinv32_modinfo;
+
+/* Replace x with its modular inverse mod modinfo->modulus. x must be in range [0, modulus).
+ * If x is zero, the result will be zero as well. If not, the inverse must exist (i.e., the gcd of
+ * x and modulus must be 1). These rules are automatically satisfied if the modulus is prime.
+ *
+ * On output, all of x's limbs will be in [0, 2^30).
+ */
+static void secp256k1_modinv32_var(secp256k1_modinv32_signed30 *x, const secp256k1_modinv32_modinfo *modinfo);
+
+/* Same as secp256k1_modinv32_var, but constant time in x (not in the modulus). */
+static void secp256k1_modinv32(secp256k1_modinv32_signed30 *x, const secp256k1_modinv32_modinfo *modinfo);
+
+/* The number of rounds of 30 posdivsteps secp256k1_jacobi32_maybe_var does before giving up. Random
+ * inputs converge after about 26 of them. */
+#define SECP256K1_JACOBI32_ITERATIONS 50
+
+/* Compute the Jacobi symbol (x | modinfo->modulus) in variable time. x must be in range
+ * [1, modulus), and the gcd of x and modulus must be 1. Returns 1 or -1, or 0 if the symbol could
+ * not be determined within SECP256K1_JACOBI32_ITERATIONS rounds, in which case the caller must
+ * fall back to another method. */
+static int secp256k1_jacobi32_maybe_var(const secp256k1_modinv32_signed30 *x, const secp256k1_modinv32_modinfo *modinfo);
+
+#endif
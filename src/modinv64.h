@@ -0,0 +1,60 @@
+/**********************************************************************
+ * Copyright (c) 2020 Peter Dettman                                   *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+/* Imported from the safegcd implementation in bitcoin-core/secp256k1
+ * (https://github.com/bitcoin-core/secp256k1, src/modinv64.h), adapted to
+ * this tree's include guards and C89 style. */
+
+#ifndef _SECP256K1_MODINV64_H_
+#define _SECP256K1_MODINV64_H_
+
+#if defined HAVE_CONFIG_H
+#include "libsecp256k1-config.h"
+#endif
+
+#include "util.h"
+
+#ifndef HAVE___INT128
+#error "modinv64 requires 128-bit wide multiplication support"
+#endif
+
+/* A signed 62-bit limb representation of integers.
+ *
+ * Its value is sum(v[i] * 2^(62*i), i=0..4). */
+typedef struct {
+    int64_t v[5];
+} secp256k1_modinv64_signed62;
+
+typedef struct {
+    /* The modulus in signed62 notation, must be odd and in [3, 2^256]. */
+    secp256k1_modinv64_signed62 modulus;
+
+    /* modulus^{-1} mod 2^62 */
+    uint64_t modulus_inv62;
+} secp256k1_modinv64_modinfo;
+
+/* Replace x with its modular inverse mod modinfo->modulus. x must be in range [0, modulus).
+ * If x is zero, the result will be zero as well. If not, the inverse must exist (i.e., the gcd of
+ * x and modulus must be 1). These rules are automatically satisfied if the modulus is prime.
+ *
+ * On output, all of x's limbs will be in [0, 2^62).
+ */
+static void secp256k1_modinv64_var(secp256k1_modinv64_signed62 *x, const secp256k1_modinv64_modinfo *modinfo);
+
+/* Same as secp256k1_modinv64_var, but constant time in x (not in the modulus). */
+static void secp256k1_modinv64(secp256k1_modinv64_signed62 *x, const secp256k1_modinv64_modinfo *modinfo);
+
+/* The number of rounds of 62 posdivsteps secp256k1_jacobi64_maybe_var does before giving up. Random
+ * inputs converge after about 13 of them. */
+#define SECP256K1_JACOBI64_ITERATIONS 25
+
+/* Compute the Jacobi symbol (x | modinfo->modulus) in variable time. x must be in range
+ * [1, modulus), and the gcd of x and modulus must be 1. Returns 1 or -1, or 0 if the symbol could
+ * not be determined within SECP256K1_JACOBI64_ITERATIONS rounds, in which case the caller must
+ * fall back to another method. */
+static int secp256k1_jacobi64_maybe_var(const secp256k1_modinv64_signed62 *x, const secp256k1_modinv64_modinfo *modinfo);
+
+#endif
@@ -10,6 +10,28 @@
 #include "include/secp256k1_ecdh.h"
 #include "ecmult_const_impl.h"
 
+/* Serialize a secret point in compressed form. Note we cannot use
+ * secp256k1_eckey_pubkey_serialize here since it does not expect its output
+ * to be secret and has a timing sidechannel. */
+static void secp256k1_ecdh_serialize_point(unsigned char *out33, secp256k1_ge *pt) {
+    secp256k1_fe_normalize(&pt->x);
+    secp256k1_fe_normalize(&pt->y);
+    out33[0] = 0x02 | secp256k1_fe_is_odd(&pt->y);
+    secp256k1_fe_get_b32(out33 + 1, &pt->x);
+}
+
+/* Hash a secret point in compressed form. */
+static void secp256k1_ecdh_hash_point(unsigned char *result, secp256k1_ge *pt) {
+    unsigned char ser[33];
+    secp256k1_sha256_t sha;
+
+    secp256k1_ecdh_serialize_point(ser, pt);
+    secp256k1_sha256_initialize(&sha);
+    secp256k1_sha256_write(&sha, ser, sizeof(ser));
+    secp256k1_sha256_finalize(&sha, result);
+    memset(ser, 0, sizeof(ser));
+}
+
 int secp256k1_ecdh(const secp256k1_context* ctx, unsigned char *result, const secp256k1_pubkey *point, const unsigned char *scalar) {
     int ret = 0;
     int overflow = 0;
@@ -26,24 +48,9 @@ int secp256k1_ecdh(const secp256k1_context* ctx, unsigned char *result, const se
     if (overflow || secp256k1_scalar_is_zero(&s)) {
         ret = 0;
     } else {
-        unsigned char x[32];
-        unsigned char y[1];
-        secp256k1_sha256_t sha;
-
         secp256k1_ecmult_const(&res, &pt, &s);
         secp256k1_ge_set_gej(&pt, &res);
-        /* Compute a hash of the point in compressed form
-         * Note we cannot use secp256k1_eckey_pubkey_serialize here since it does not
-         * expect its output to be secret and has a timing sidechannel. */
-        secp256k1_fe_normalize(&pt.x);
-        secp256k1_fe_normalize(&pt.y);
-        secp256k1_fe_get_b32(x, &pt.x);
-        y[0] = 0x02 | secp256k1_fe_is_odd(&pt.y);
-
-        secp256k1_sha256_initialize(&sha);
-        secp256k1_sha256_write(&sha, y, sizeof(y));
-        secp256k1_sha256_write(&sha, x, sizeof(x));
-        secp256k1_sha256_finalize(&sha, result);
+        secp256k1_ecdh_hash_point(result, &pt);
         ret = 1;
     }
 
@@ -51,4 +58,198 @@ int secp256k1_ecdh(const secp256k1_context* ctx, unsigned char *result, const se
     return ret;
 }
 
+typedef struct {
+    secp256k1_pubkey key;
+    size_t index;
+} secp256k1_ecdh_scan_output;
+
+static int secp256k1_ecdh_scan_output_cmp(const void *a, const void *b) {
+    return memcmp(&((const secp256k1_ecdh_scan_output *)a)->key, &((const secp256k1_ecdh_scan_output *)b)->key, sizeof(secp256k1_pubkey));
+}
+
+/* Number of items whose shared secrets and derived keys share one inversion. */
+#define ECDH_SCAN_BATCH 256
+
+typedef struct {
+    const secp256k1_context *ctx;
+    size_t *matches;
+    const secp256k1_pubkey *points;
+    const secp256k1_scalar *scankey;
+    const secp256k1_gej *spendj;
+    const secp256k1_ecdh_scan_output *table;
+    size_t noutputs;
+} secp256k1_ecdh_scan_job;
+
+/* Scan the points begin..end-1, and return how many of them matched. */
+static size_t secp256k1_ecdh_scan_fn(void *arg, size_t begin, size_t end) {
+    static const secp256k1_scalar one = SECP256K1_SCALAR_CONST(0, 0, 0, 0, 0, 0, 0, 1);
+    const secp256k1_ecdh_scan_job *job = (const secp256k1_ecdh_scan_job *)arg;
+    const secp256k1_context *ctx = job->ctx;
+    secp256k1_gej *resj;
+    secp256k1_fe *zs;
+    secp256k1_fe *zis;
+    secp256k1_ge *res;
+    unsigned char *secrets;
+    unsigned char *tweaks;
+    size_t *idx;
+    size_t batch = end - begin;
+    size_t count = 0;
+    size_t i, k;
+    int overflow;
+
+    /* Chunks are never empty, but this lets the compiler see that the
+     * buffers below are always written before they are read. */
+    if (batch == 0) {
+        return 0;
+    }
+    resj = (secp256k1_gej *)checked_malloc(&ctx->error_callback, batch * sizeof(secp256k1_gej));
+    zs = (secp256k1_fe *)checked_malloc(&ctx->error_callback, batch * sizeof(secp256k1_fe));
+    zis = (secp256k1_fe *)checked_malloc(&ctx->error_callback, batch * sizeof(secp256k1_fe));
+    res = (secp256k1_ge *)checked_malloc(&ctx->error_callback, batch * sizeof(secp256k1_ge));
+    idx = (size_t *)checked_malloc(&ctx->error_callback, batch * sizeof(size_t));
+    secrets = (unsigned char *)checked_malloc(&ctx->error_callback, batch * 33);
+    tweaks = (unsigned char *)checked_malloc(&ctx->error_callback, batch * 32);
+
+    /* Shared secrets: the multiplication by the scan key and the
+     * inversion are constant time. The points have prime order and the
+     * scalar is nonzero, so no result is infinity. */
+    i = 0;
+#ifdef USE_AVX2
+    if (secp256k1_cpu_has(SECP256K1_CPU_AVX2)) {
+        secp256k1_scalar sc[4];
+        for (k = 0; k < 4; k++) {
+            sc[k] = *job->scankey;
+        }
+        for (; i + 4 <= batch; i += 4) {
+            secp256k1_ge pt[4];
+            for (k = 0; k < 4; k++) {
+                secp256k1_pubkey_load(ctx, &pt[k], &job->points[begin + i + k]);
+            }
+            secp256k1_ecmult_const_x4(&resj[i], pt, sc);
+        }
+        for (k = 0; k < 4; k++) {
+            secp256k1_scalar_clear(&sc[k]);
+        }
+    }
+#endif
+    for (; i < batch; i++) {
+        secp256k1_ge pt;
+        secp256k1_pubkey_load(ctx, &pt, &job->points[begin + i]);
+        secp256k1_ecmult_const(&resj[i], &pt, job->scankey);
+    }
+    for (i = 0; i < batch; i++) {
+        zs[i] = resj[i].z;
+    }
+    secp256k1_fe_inv_all(batch, zis, zs);
+
+    /* The secrets are hashed all at once, so that the multi-buffer
+     * SHA-256 code can process several of them together. */
+    for (i = 0; i < batch; i++) {
+        secp256k1_ge_set_gej_zinv(&res[i], &resj[i], &zis[i]);
+        secp256k1_ecdh_serialize_point(secrets + 33 * i, &res[i]);
+    }
+    secp256k1_sha256_batch(tweaks, secrets, 33, batch);
+
+    /* Derived keys: spend + hash(secret)*G. The tweak is only used to
+     * derive a public key, as in secp256k1_ec_pubkey_tweak_add, so the
+     * variable-time multiplication is used. */
+    k = 0;
+    for (i = 0; i < batch; i++) {
+        secp256k1_scalar t;
+        secp256k1_scalar_set_b32(&t, tweaks + 32 * i, &overflow);
+        if (!overflow) {
+            secp256k1_ecmult(&ctx->ecmult_ctx, &resj[k], job->spendj, &one, &t);
+            idx[k] = begin + i;
+            k++;
+        }
+    }
+    secp256k1_ge_set_all_gej_var(k, res, resj, &ctx->error_callback);
+
+    for (i = 0; i < k; i++) {
+        secp256k1_ecdh_scan_output key;
+        const secp256k1_ecdh_scan_output *match;
+        if (res[i].infinity) {
+            continue;
+        }
+        secp256k1_pubkey_save(&key.key, &res[i]);
+        match = (const secp256k1_ecdh_scan_output *)bsearch(&key, job->table, job->noutputs, sizeof(secp256k1_ecdh_scan_output), secp256k1_ecdh_scan_output_cmp);
+        if (match != NULL) {
+            job->matches[idx[i]] = match->index;
+            count++;
+        }
+    }
+
+    memset(secrets, 0, batch * 33);
+    memset(tweaks, 0, batch * 32);
+    free(tweaks);
+    free(secrets);
+    free(idx);
+    free(res);
+    free(zis);
+    free(zs);
+    free(resj);
+    return count;
+}
+
+size_t secp256k1_ecdh_scan(const secp256k1_context* ctx, size_t *matches, const secp256k1_pubkey *points, size_t n, const unsigned char *scankey, const secp256k1_pubkey *spendkey, const secp256k1_pubkey *outputs, size_t noutputs) {
+    secp256k1_ecdh_scan_job job;
+    secp256k1_ecdh_scan_output *table;
+    secp256k1_scalar s;
+    secp256k1_ge spend;
+    secp256k1_gej spendj;
+    size_t i;
+    size_t count;
+    int overflow = 0;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(matches != NULL);
+    for (i = 0; i < n; i++) {
+        matches[i] = noutputs;
+    }
+    ARG_CHECK(points != NULL);
+    ARG_CHECK(scankey != NULL);
+    ARG_CHECK(spendkey != NULL);
+    ARG_CHECK(outputs != NULL);
+    if (!secp256k1_pubkey_load(ctx, &spend, spendkey)) {
+        return 0;
+    }
+    for (i = 0; i < n; i++) {
+        secp256k1_ge pt;
+        if (!secp256k1_pubkey_load(ctx, &pt, &points[i])) {
+            return 0;
+        }
+    }
+    if (n == 0 || noutputs == 0) {
+        return 0;
+    }
+    secp256k1_scalar_set_b32(&s, scankey, &overflow);
+    if (overflow || secp256k1_scalar_is_zero(&s)) {
+        secp256k1_scalar_clear(&s);
+        return 0;
+    }
+    secp256k1_gej_set_ge(&spendj, &spend);
+
+    /* Sort the outputs once, so each derived key is found by binary search. */
+    table = (secp256k1_ecdh_scan_output *)checked_malloc(&ctx->error_callback, noutputs * sizeof(secp256k1_ecdh_scan_output));
+    for (i = 0; i < noutputs; i++) {
+        table[i].key = outputs[i];
+        table[i].index = i;
+    }
+    qsort(table, noutputs, sizeof(secp256k1_ecdh_scan_output), secp256k1_ecdh_scan_output_cmp);
+
+    job.ctx = ctx;
+    job.matches = matches;
+    job.points = points;
+    job.scankey = &s;
+    job.spendj = &spendj;
+    job.table = table;
+    job.noutputs = noutputs;
+    count = secp256k1_batch_run(ctx, n, ECDH_SCAN_BATCH, secp256k1_ecdh_scan_fn, &job);
+
+    free(table);
+    secp256k1_scalar_clear(&s);
+    return count;
+}
+
 #endif
@@ -67,9 +67,116 @@ void test_bad_scalar(void) {
     CHECK(secp256k1_ecdh(ctx, output, &point, s_overflow) == 1);
 }
 
+void test_ecdh_scan(size_t n) {
+    unsigned char scankey[32];
+    unsigned char key[32];
+    secp256k1_pubkey spendkey;
+    secp256k1_pubkey *points;
+    secp256k1_pubkey *derived;
+    secp256k1_pubkey *outputs;
+    size_t *matches;
+    size_t noutputs = 0;
+    size_t nmatches;
+    size_t i, j;
+    secp256k1_scalar sc;
+
+    points = (secp256k1_pubkey *)malloc(n * sizeof(secp256k1_pubkey));
+    derived = (secp256k1_pubkey *)malloc(n * sizeof(secp256k1_pubkey));
+    outputs = (secp256k1_pubkey *)malloc(2 * n * sizeof(secp256k1_pubkey));
+    matches = (size_t *)malloc(n * sizeof(size_t));
+    memset(outputs, 0, 2 * n * sizeof(secp256k1_pubkey));
+
+    random_scalar_order(&sc);
+    secp256k1_scalar_get_b32(scankey, &sc);
+    random_scalar_order(&sc);
+    secp256k1_scalar_get_b32(key, &sc);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &spendkey, key) == 1);
+
+    /* Compute the derived keys with the individual calls, and make a random
+     * subset of them (and some unrelated keys) the outputs. */
+    for (i = 0; i < n; i++) {
+        unsigned char tweak[32];
+        random_scalar_order(&sc);
+        secp256k1_scalar_get_b32(key, &sc);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &points[i], key) == 1);
+        CHECK(secp256k1_ecdh(ctx, tweak, &points[i], scankey) == 1);
+        derived[i] = spendkey;
+        CHECK(secp256k1_ec_pubkey_tweak_add(ctx, &derived[i], tweak) == 1);
+        if (secp256k1_rand_bits(1)) {
+            outputs[noutputs++] = derived[i];
+        }
+        if (secp256k1_rand_bits(1)) {
+            outputs[noutputs++] = points[i];
+        }
+    }
+    for (i = noutputs; i > 1; i--) {
+        secp256k1_pubkey t;
+        j = secp256k1_rand_int(i);
+        t = outputs[i - 1];
+        outputs[i - 1] = outputs[j];
+        outputs[j] = t;
+    }
+
+    nmatches = secp256k1_ecdh_scan(ctx, matches, points, n, scankey, &spendkey, outputs, noutputs);
+    for (i = 0; i < n; i++) {
+        int found = 0;
+        for (j = 0; j < noutputs; j++) {
+            found |= memcmp(&outputs[j], &derived[i], sizeof(secp256k1_pubkey)) == 0;
+        }
+        if (found) {
+            CHECK(matches[i] < noutputs);
+            CHECK(memcmp(&outputs[matches[i]], &derived[i], sizeof(secp256k1_pubkey)) == 0);
+            nmatches--;
+        } else {
+            CHECK(matches[i] == noutputs);
+        }
+    }
+    CHECK(nmatches == 0);
+
+    free(matches);
+    free(outputs);
+    free(derived);
+    free(points);
+}
+
+void test_ecdh_scan_api(void) {
+    unsigned char s_zero[32] = { 0 };
+    unsigned char s_one[32] = { 0 };
+    secp256k1_pubkey point;
+    size_t match = 0;
+    int32_t ecount = 0;
+
+    s_one[31] = 1;
+    CHECK(secp256k1_ec_pubkey_create(ctx, &point, s_one) == 1);
+    CHECK(secp256k1_ecdh_scan(ctx, &match, &point, 1, s_zero, &point, &point, 1) == 0);
+    CHECK(match == 1);
+    /* 2*G is not G. */
+    CHECK(secp256k1_ecdh_scan(ctx, &match, &point, 1, s_one, &point, &point, 1) == 0);
+    CHECK(match == 1);
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_ecdh_scan(ctx, &match, NULL, 1, s_one, &point, &point, 1) == 0);
+    CHECK(ecount == 1);
+    memset(&point, 0, sizeof(point));
+    CHECK(secp256k1_ecdh_scan(ctx, &match, &point, 1, s_one, &point, &point, 1) == 0);
+    CHECK(ecount == 2);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+}
+
 void run_ecdh_tests(void) {
+    int i;
     test_ecdh_generator_basepoint();
     test_bad_scalar();
+    test_ecdh_scan_api();
+    for (i = 0; i < count; i++) {
+        test_ecdh_scan(1 + secp256k1_rand_int(16));
+    }
+    /* Spans several internal batches, the last one shorter than the others:
+     * one task processes all of them without an executor, and the test
+     * executor splits them into ranges processed out of order. */
+    test_ecdh_scan(2 * ECDH_SCAN_BATCH + 37);
+    secp256k1_context_set_executor(ctx, &test_executor);
+    test_ecdh_scan(2 * ECDH_SCAN_BATCH + 37);
+    secp256k1_context_set_executor(ctx, NULL);
 }
 
 #endif
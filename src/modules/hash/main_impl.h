@@ -0,0 +1,203 @@
+/**********************************************************************
+ * Copyright (c) 2016 libsecp256k1 contributors                       *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_MODULE_HASH_MAIN_
+#define _SECP256K1_MODULE_HASH_MAIN_
+
+#include "include/secp256k1_hash.h"
+#include "hash_impl.h"
+
+/* A secp256k1_hash_sha256 holds the eight chaining words and the block buffer
+ * of a secp256k1_sha256_t in native byte order, followed by the byte count. */
+static void secp256k1_hash_sha256_load(secp256k1_sha256_t *sha, const unsigned char *data) {
+    memcpy(sha->s, &data[0], 32);
+    memcpy(sha->buf, &data[32], 64);
+    memcpy(&sha->bytes, &data[96], sizeof(sha->bytes));
+}
+
+static void secp256k1_hash_sha256_save(unsigned char *data, const secp256k1_sha256_t *sha) {
+    memcpy(&data[0], sha->s, 32);
+    memcpy(&data[32], sha->buf, 64);
+    memcpy(&data[96], &sha->bytes, sizeof(sha->bytes));
+}
+
+int secp256k1_hash_sha256_initialize(const secp256k1_context* ctx, secp256k1_hash_sha256 *hash) {
+    secp256k1_sha256_t sha;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(hash != NULL);
+
+    memset(hash->data, 0, sizeof(hash->data));
+    secp256k1_sha256_initialize(&sha);
+    secp256k1_hash_sha256_save(hash->data, &sha);
+    return 1;
+}
+
+int secp256k1_hash_sha256_initialize_tagged(const secp256k1_context* ctx, secp256k1_hash_sha256 *hash, const unsigned char *tag, size_t taglen) {
+    secp256k1_sha256_t sha;
+    unsigned char taghash[32];
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(hash != NULL);
+    ARG_CHECK(tag != NULL || taglen == 0);
+
+    secp256k1_sha256_initialize(&sha);
+    secp256k1_sha256_write(&sha, tag, taglen);
+    secp256k1_sha256_finalize(&sha, taghash);
+    memset(hash->data, 0, sizeof(hash->data));
+    secp256k1_sha256_initialize(&sha);
+    secp256k1_sha256_write(&sha, taghash, 32);
+    secp256k1_sha256_write(&sha, taghash, 32);
+    secp256k1_hash_sha256_save(hash->data, &sha);
+    return 1;
+}
+
+int secp256k1_hash_sha256_write(const secp256k1_context* ctx, secp256k1_hash_sha256 *hash, const unsigned char *data, size_t len) {
+    secp256k1_sha256_t sha;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(hash != NULL);
+    ARG_CHECK(data != NULL || len == 0);
+
+    secp256k1_hash_sha256_load(&sha, hash->data);
+    secp256k1_sha256_write(&sha, data, len);
+    secp256k1_hash_sha256_save(hash->data, &sha);
+    return 1;
+}
+
+int secp256k1_hash_sha256_finalize(const secp256k1_context* ctx, secp256k1_hash_sha256 *hash, unsigned char *out32) {
+    secp256k1_sha256_t sha;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(hash != NULL);
+    ARG_CHECK(out32 != NULL);
+
+    secp256k1_hash_sha256_load(&sha, hash->data);
+    secp256k1_sha256_finalize(&sha, out32);
+    memset(hash->data, 0, sizeof(hash->data));
+    return 1;
+}
+
+int secp256k1_hash_sha256_get_midstate(const secp256k1_context* ctx, unsigned char *midstate32, size_t *bytes, const secp256k1_hash_sha256 *hash) {
+    secp256k1_sha256_t sha;
+    int i;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(midstate32 != NULL);
+    ARG_CHECK(bytes != NULL);
+    ARG_CHECK(hash != NULL);
+
+    secp256k1_hash_sha256_load(&sha, hash->data);
+    if (sha.bytes & 0x3F) {
+        return 0;
+    }
+    for (i = 0; i < 8; i++) {
+        midstate32[4 * i] = sha.s[i] >> 24;
+        midstate32[4 * i + 1] = sha.s[i] >> 16;
+        midstate32[4 * i + 2] = sha.s[i] >> 8;
+        midstate32[4 * i + 3] = sha.s[i];
+    }
+    *bytes = sha.bytes;
+    return 1;
+}
+
+int secp256k1_hash_sha256_set_midstate(const secp256k1_context* ctx, secp256k1_hash_sha256 *hash, const unsigned char *midstate32, size_t bytes) {
+    secp256k1_sha256_t sha;
+    int i;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(hash != NULL);
+    ARG_CHECK(midstate32 != NULL);
+
+    if (bytes & 0x3F) {
+        return 0;
+    }
+    memset(&sha, 0, sizeof(sha));
+    for (i = 0; i < 8; i++) {
+        sha.s[i] = (uint32_t)midstate32[4 * i] << 24 | (uint32_t)midstate32[4 * i + 1] << 16 |
+                   (uint32_t)midstate32[4 * i + 2] << 8 | midstate32[4 * i + 3];
+    }
+    sha.bytes = bytes;
+    memset(hash->data, 0, sizeof(hash->data));
+    secp256k1_hash_sha256_save(hash->data, &sha);
+    return 1;
+}
+
+int secp256k1_hash_sha256d(const secp256k1_context* ctx, unsigned char *out32, const unsigned char *data, size_t len) {
+    secp256k1_sha256_t sha;
+    unsigned char inner[32];
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(out32 != NULL);
+    ARG_CHECK(data != NULL || len == 0);
+
+    secp256k1_sha256_initialize(&sha);
+    secp256k1_sha256_write(&sha, data, len);
+    secp256k1_sha256_finalize(&sha, inner);
+    secp256k1_sha256_initialize(&sha);
+    secp256k1_sha256_write(&sha, inner, 32);
+    secp256k1_sha256_finalize(&sha, out32);
+    return 1;
+}
+
+/* Number of messages whose first hashes secp256k1_hash_sha256_batch keeps on the stack. */
+#define HASH_SHA256D_BATCH 64
+
+int secp256k1_hash_sha256_batch(const secp256k1_context* ctx, unsigned char *out, const unsigned char *in, size_t len, size_t n, int doubled) {
+    unsigned char inner[32 * HASH_SHA256D_BATCH];
+    size_t done, m;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(out != NULL || n == 0);
+    ARG_CHECK(in != NULL || n == 0 || len == 0);
+
+    if (!doubled) {
+        secp256k1_sha256_batch(out, in, len, n);
+        return 1;
+    }
+    for (done = 0; done < n; done += m) {
+        m = n - done < HASH_SHA256D_BATCH ? n - done : HASH_SHA256D_BATCH;
+        secp256k1_sha256_batch(inner, in + len * done, len, m);
+        secp256k1_sha256_batch(out + 32 * done, inner, 32, m);
+    }
+    return 1;
+}
+
+int secp256k1_hash_hmac_sha256_initialize(const secp256k1_context* ctx, secp256k1_hash_hmac_sha256 *hash, const unsigned char *key, size_t keylen) {
+    secp256k1_hmac_sha256_t hmac;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(hash != NULL);
+    ARG_CHECK(key != NULL || keylen == 0);
+
+    memset(hash->data, 0, sizeof(hash->data));
+    secp256k1_hmac_sha256_initialize(&hmac, key, keylen);
+    secp256k1_hash_sha256_save(&hash->data[0], &hmac.inner);
+    secp256k1_hash_sha256_save(&hash->data[104], &hmac.outer);
+    memset(&hmac, 0, sizeof(hmac));
+    return 1;
+}
+
+int secp256k1_hash_hmac_sha256_write(const secp256k1_context* ctx, secp256k1_hash_hmac_sha256 *hash, const unsigned char *data, size_t len) {
+    secp256k1_sha256_t sha;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(hash != NULL);
+    ARG_CHECK(data != NULL || len == 0);
+
+    /* Only the inner hash sees the data. */
+    secp256k1_hash_sha256_load(&sha, &hash->data[0]);
+    secp256k1_sha256_write(&sha, data, len);
+    secp256k1_hash_sha256_save(&hash->data[0], &sha);
+    memset(&sha, 0, sizeof(sha));
+    return 1;
+}
+
+int secp256k1_hash_hmac_sha256_finalize(const secp256k1_context* ctx, secp256k1_hash_hmac_sha256 *hash, unsigned char *out32) {
+    secp256k1_hmac_sha256_t hmac;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(hash != NULL);
+    ARG_CHECK(out32 != NULL);
+
+    secp256k1_hash_sha256_load(&hmac.inner, &hash->data[0]);
+    secp256k1_hash_sha256_load(&hmac.outer, &hash->data[104]);
+    secp256k1_hmac_sha256_finalize(&hmac, out32);
+    memset(&hmac, 0, sizeof(hmac));
+    memset(hash->data, 0, sizeof(hash->data));
+    return 1;
+}
+
+#endif
@@ -0,0 +1,156 @@
+/**********************************************************************
+ * Copyright (c) 2016 libsecp256k1 contributors                       *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_MODULE_HASH_TESTS_
+#define _SECP256K1_MODULE_HASH_TESTS_
+
+#include "include/secp256k1_hash.h"
+
+void test_hash_api(void) {
+    secp256k1_context *none = secp256k1_context_create(SECP256K1_CONTEXT_NONE);
+    secp256k1_hash_sha256 hash;
+    secp256k1_hash_hmac_sha256 hmac;
+    unsigned char buf[64] = {0};
+    unsigned char out[32];
+    size_t bytes;
+    int32_t ecount = 0;
+
+    secp256k1_context_set_illegal_callback(none, counting_illegal_callback_fn, &ecount);
+
+    /* Any context will do. */
+    CHECK(secp256k1_hash_sha256_initialize(none, &hash) == 1);
+    CHECK(secp256k1_hash_sha256_initialize(none, NULL) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_hash_sha256_initialize_tagged(none, &hash, NULL, 0) == 1);
+    CHECK(secp256k1_hash_sha256_initialize_tagged(none, &hash, NULL, 1) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_hash_sha256_write(none, &hash, NULL, 0) == 1);
+    CHECK(secp256k1_hash_sha256_write(none, &hash, NULL, 1) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_hash_sha256_write(none, NULL, buf, 1) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_hash_sha256_finalize(none, &hash, NULL) == 0);
+    CHECK(ecount == 5);
+    CHECK(secp256k1_hash_sha256_finalize(none, &hash, out) == 1);
+
+    /* Midstates exist at block boundaries only. */
+    CHECK(secp256k1_hash_sha256_initialize(none, &hash) == 1);
+    CHECK(secp256k1_hash_sha256_write(none, &hash, buf, 63) == 1);
+    CHECK(secp256k1_hash_sha256_get_midstate(none, out, &bytes, &hash) == 0);
+    CHECK(secp256k1_hash_sha256_write(none, &hash, buf, 1) == 1);
+    CHECK(secp256k1_hash_sha256_get_midstate(none, out, &bytes, &hash) == 1);
+    CHECK(bytes == 64);
+    CHECK(secp256k1_hash_sha256_get_midstate(none, out, NULL, &hash) == 0);
+    CHECK(ecount == 6);
+    CHECK(secp256k1_hash_sha256_set_midstate(none, &hash, out, 64) == 1);
+    CHECK(secp256k1_hash_sha256_set_midstate(none, &hash, out, 65) == 0);
+    CHECK(secp256k1_hash_sha256_set_midstate(none, &hash, NULL, 64) == 0);
+    CHECK(ecount == 7);
+
+    CHECK(secp256k1_hash_sha256d(none, out, NULL, 0) == 1);
+    CHECK(secp256k1_hash_sha256d(none, NULL, buf, 1) == 0);
+    CHECK(ecount == 8);
+    CHECK(secp256k1_hash_sha256_batch(none, NULL, NULL, 32, 0, 1) == 1);
+    CHECK(secp256k1_hash_sha256_batch(none, out, NULL, 0, 1, 0) == 1);
+    CHECK(secp256k1_hash_sha256_batch(none, out, NULL, 32, 1, 0) == 0);
+    CHECK(ecount == 9);
+
+    CHECK(secp256k1_hash_hmac_sha256_initialize(none, &hmac, NULL, 0) == 1);
+    CHECK(secp256k1_hash_hmac_sha256_initialize(none, &hmac, NULL, 1) == 0);
+    CHECK(ecount == 10);
+    CHECK(secp256k1_hash_hmac_sha256_write(none, &hmac, NULL, 1) == 0);
+    CHECK(ecount == 11);
+    CHECK(secp256k1_hash_hmac_sha256_finalize(none, &hmac, NULL) == 0);
+    CHECK(ecount == 12);
+    CHECK(secp256k1_hash_hmac_sha256_finalize(none, &hmac, out) == 1);
+
+    secp256k1_context_destroy(none);
+}
+
+void test_hash_vectors(void) {
+    static const unsigned char abc_sha256d[32] = {
+        0x4f, 0x8b, 0x42, 0xc2, 0x2d, 0xd3, 0x72, 0x9b, 0x51, 0x9b, 0xa6, 0xf6, 0x8d, 0x2d, 0xa7, 0xcc,
+        0x5b, 0x2d, 0x60, 0x6d, 0x05, 0xda, 0xed, 0x5a, 0xd5, 0x12, 0x8c, 0xc0, 0x3e, 0x6c, 0x63, 0x58
+    };
+    /* The BIP340-style tagged hash of "abc" under the tag "BIP0340/challenge". */
+    static const unsigned char abc_tagged[32] = {
+        0x77, 0x0a, 0x5b, 0x7e, 0x7c, 0x30, 0x4b, 0xbc, 0xc3, 0xea, 0x10, 0x73, 0x43, 0xff, 0x95, 0x1d,
+        0xd4, 0x04, 0x31, 0x2e, 0xf4, 0x18, 0xdb, 0x0c, 0x3b, 0x94, 0xe2, 0xeb, 0xfb, 0xb5, 0x00, 0x87
+    };
+    /* RFC 4231 test case 2. */
+    static const unsigned char jefe_hmac[32] = {
+        0x5b, 0xdc, 0xc1, 0x46, 0xbf, 0x60, 0x75, 0x4e, 0x6a, 0x04, 0x24, 0x26, 0x08, 0x95, 0x75, 0xc7,
+        0x5a, 0x00, 0x3f, 0x08, 0x9d, 0x27, 0x39, 0x83, 0x9d, 0xec, 0x58, 0xb9, 0x64, 0xec, 0x38, 0x43
+    };
+    static const char *tag = "BIP0340/challenge";
+    static const char *data = "what do ya want for nothing?";
+    secp256k1_hash_sha256 hash, copy;
+    secp256k1_hash_hmac_sha256 hmac;
+    unsigned char midstate[32];
+    unsigned char out[32], out2[32];
+    size_t bytes;
+
+    CHECK(secp256k1_hash_sha256d(ctx, out, (const unsigned char *)"abc", 3) == 1);
+    CHECK(memcmp(out, abc_sha256d, 32) == 0);
+
+    /* The tagged prefix, continued from a copy and from an exported midstate. */
+    CHECK(secp256k1_hash_sha256_initialize_tagged(ctx, &hash, (const unsigned char *)tag, strlen(tag)) == 1);
+    copy = hash;
+    CHECK(secp256k1_hash_sha256_write(ctx, &hash, (const unsigned char *)"abc", 3) == 1);
+    CHECK(secp256k1_hash_sha256_finalize(ctx, &hash, out) == 1);
+    CHECK(memcmp(out, abc_tagged, 32) == 0);
+    CHECK(secp256k1_hash_sha256_get_midstate(ctx, midstate, &bytes, &copy) == 1);
+    CHECK(bytes == 64);
+    CHECK(secp256k1_hash_sha256_set_midstate(ctx, &hash, midstate, bytes) == 1);
+    CHECK(secp256k1_hash_sha256_write(ctx, &hash, (const unsigned char *)"ab", 2) == 1);
+    CHECK(secp256k1_hash_sha256_write(ctx, &hash, (const unsigned char *)"c", 1) == 1);
+    CHECK(secp256k1_hash_sha256_finalize(ctx, &hash, out) == 1);
+    CHECK(memcmp(out, abc_tagged, 32) == 0);
+    CHECK(secp256k1_hash_sha256_write(ctx, &copy, (const unsigned char *)"abc", 3) == 1);
+    CHECK(secp256k1_hash_sha256_finalize(ctx, &copy, out2) == 1);
+    CHECK(memcmp(out2, abc_tagged, 32) == 0);
+
+    CHECK(secp256k1_hash_hmac_sha256_initialize(ctx, &hmac, (const unsigned char *)"Jefe", 4) == 1);
+    CHECK(secp256k1_hash_hmac_sha256_write(ctx, &hmac, (const unsigned char *)data, 10) == 1);
+    CHECK(secp256k1_hash_hmac_sha256_write(ctx, &hmac, (const unsigned char *)data + 10, strlen(data) - 10) == 1);
+    CHECK(secp256k1_hash_hmac_sha256_finalize(ctx, &hmac, out) == 1);
+    CHECK(memcmp(out, jefe_hmac, 32) == 0);
+}
+
+void test_hash_batch(void) {
+    unsigned char in[70 * 80];
+    unsigned char out[70 * 32];
+    int i;
+
+    for (i = 0; i < count; i++) {
+        size_t len = secp256k1_rand_int(81);
+        size_t n = secp256k1_rand_int(71);
+        size_t k;
+        int doubled = secp256k1_rand_bits(1);
+        secp256k1_rand_bytes_test(in, n * len);
+        CHECK(secp256k1_hash_sha256_batch(ctx, out, in, len, n, doubled) == 1);
+        for (k = 0; k < n; k++) {
+            unsigned char ref[32];
+            if (doubled) {
+                CHECK(secp256k1_hash_sha256d(ctx, ref, in + len * k, len) == 1);
+            } else {
+                secp256k1_hash_sha256 hash;
+                CHECK(secp256k1_hash_sha256_initialize(ctx, &hash) == 1);
+                CHECK(secp256k1_hash_sha256_write(ctx, &hash, in + len * k, len) == 1);
+                CHECK(secp256k1_hash_sha256_finalize(ctx, &hash, ref) == 1);
+            }
+            CHECK(memcmp(out + 32 * k, ref, 32) == 0);
+        }
+    }
+}
+
+void run_hash_tests(void) {
+    test_hash_api();
+    test_hash_vectors();
+    test_hash_batch();
+}
+
+#endif
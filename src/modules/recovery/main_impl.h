@@ -84,19 +84,11 @@ int secp256k1_ecdsa_recoverable_signature_convert(const secp256k1_context* ctx,
     return 1;
 }
 
-static int secp256k1_ecdsa_sig_recover(const secp256k1_ecmult_context *ctx, const secp256k1_scalar *sigr, const secp256k1_scalar* sigs, secp256k1_ge *pubkey, const secp256k1_scalar *message, int recid) {
+static int secp256k1_ecdsa_sig_recover_x(secp256k1_ge *x, const secp256k1_scalar *sigr, int recid) {
     unsigned char brx[32];
     secp256k1_fe fx;
-    secp256k1_ge x;
-    secp256k1_gej xj;
-    secp256k1_scalar rn, u1, u2;
-    secp256k1_gej qj;
     int r;
 
-    if (secp256k1_scalar_is_zero(sigr) || secp256k1_scalar_is_zero(sigs)) {
-        return 0;
-    }
-
     secp256k1_scalar_get_b32(brx, sigr);
     r = secp256k1_fe_set_b32(&fx, brx);
     (void)r;
@@ -107,7 +99,20 @@ static int secp256k1_ecdsa_sig_recover(const secp256k1_ecmult_context *ctx, cons
         }
         secp256k1_fe_add(&fx, &secp256k1_ecdsa_const_order_as_fe);
     }
-    if (!secp256k1_ge_set_xo_var(&x, &fx, recid & 1)) {
+    return secp256k1_ge_set_xo_var(x, &fx, recid & 1);
+}
+
+static int secp256k1_ecdsa_sig_recover(const secp256k1_ecmult_context *ctx, const secp256k1_scalar *sigr, const secp256k1_scalar* sigs, secp256k1_ge *pubkey, const secp256k1_scalar *message, int recid) {
+    secp256k1_ge x;
+    secp256k1_gej xj;
+    secp256k1_scalar rn, u1, u2;
+    secp256k1_gej qj;
+
+    if (secp256k1_scalar_is_zero(sigr) || secp256k1_scalar_is_zero(sigs)) {
+        return 0;
+    }
+
+    if (!secp256k1_ecdsa_sig_recover_x(&x, sigr, recid)) {
         return 0;
     }
     secp256k1_gej_set_ge(&xj, &x);
@@ -190,4 +195,210 @@ int secp256k1_ecdsa_recover(const secp256k1_context* ctx, secp256k1_pubkey *pubk
     }
 }
 
+/* Number of signatures whose r values and results share one inversion. */
+#define ECDSA_RECOVER_BATCH 256
+
+typedef struct {
+    const secp256k1_context *ctx;
+    secp256k1_pubkey *pubkeys;
+    unsigned char *valid;
+    const secp256k1_ecdsa_recoverable_signature *sigs;
+    const unsigned char *msg32s;
+} secp256k1_ecdsa_recover_batch_job;
+
+/* Recover the keys of the signatures begin..end-1, and return how many were recovered. */
+static size_t secp256k1_ecdsa_recover_batch_fn(void *arg, size_t begin, size_t end) {
+    const secp256k1_ecdsa_recover_batch_job *job = (const secp256k1_ecdsa_recover_batch_job *)arg;
+    const secp256k1_context *ctx = job->ctx;
+    secp256k1_scalar *rs;
+    secp256k1_scalar *rns;
+    secp256k1_ge *ps;
+    secp256k1_gej *qjs;
+    size_t *idx;
+    secp256k1_scalar r, s;
+    int recid;
+    size_t batch = end - begin;
+    size_t count = 0;
+    size_t i, k;
+
+    rs = (secp256k1_scalar *)checked_malloc(&ctx->error_callback, batch * sizeof(secp256k1_scalar));
+    rns = (secp256k1_scalar *)checked_malloc(&ctx->error_callback, batch * sizeof(secp256k1_scalar));
+    ps = (secp256k1_ge *)checked_malloc(&ctx->error_callback, batch * sizeof(secp256k1_ge));
+    qjs = (secp256k1_gej *)checked_malloc(&ctx->error_callback, batch * sizeof(secp256k1_gej));
+    idx = (size_t *)checked_malloc(&ctx->error_callback, batch * sizeof(size_t));
+
+    /* Decompress the R points, collecting the r values to invert. */
+    k = 0;
+    for (i = begin; i < end; i++) {
+        secp256k1_ecdsa_recoverable_signature_load(ctx, &r, &s, &recid, &job->sigs[i]);
+        if (!secp256k1_scalar_is_zero(&r) && !secp256k1_scalar_is_zero(&s) &&
+            secp256k1_ecdsa_sig_recover_x(&ps[k], &r, recid)) {
+            rs[k] = r;
+            idx[k] = i;
+            k++;
+        }
+    }
+    if (k > 0) {
+        secp256k1_scalar_inverse_all_var(k, rns, rs);
+
+        for (i = 0; i < k; i++) {
+            secp256k1_gej xj;
+            secp256k1_scalar m, u1, u2;
+            secp256k1_ecdsa_recoverable_signature_load(ctx, &r, &s, &recid, &job->sigs[idx[i]]);
+            secp256k1_scalar_set_b32(&m, &job->msg32s[idx[i] * 32], NULL);
+            secp256k1_gej_set_ge(&xj, &ps[i]);
+            secp256k1_scalar_mul(&u1, &rns[i], &m);
+            secp256k1_scalar_negate(&u1, &u1);
+            secp256k1_scalar_mul(&u2, &rns[i], &s);
+            secp256k1_ecmult(&ctx->ecmult_ctx, &qjs[i], &xj, &u2, &u1);
+        }
+
+        /* Convert all results to affine coordinates with a single inversion. */
+        secp256k1_ge_set_all_gej_var(k, ps, qjs, &ctx->error_callback);
+        for (i = 0; i < k; i++) {
+            if (!ps[i].infinity) {
+                secp256k1_pubkey_save(&job->pubkeys[idx[i]], &ps[i]);
+                if (job->valid != NULL) {
+                    job->valid[idx[i]] = 1;
+                }
+                count++;
+            }
+        }
+    }
+
+    free(idx);
+    free(qjs);
+    free(ps);
+    free(rns);
+    free(rs);
+    return count;
+}
+
+size_t secp256k1_ecdsa_recover_batch(const secp256k1_context* ctx, secp256k1_pubkey *pubkeys, unsigned char *valid, const secp256k1_ecdsa_recoverable_signature *sigs, const unsigned char *msg32s, size_t n) {
+    secp256k1_ecdsa_recover_batch_job job;
+    secp256k1_scalar r, s;
+    int recid;
+    size_t i;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(pubkeys != NULL);
+    memset(pubkeys, 0, n * sizeof(*pubkeys));
+    if (valid != NULL) {
+        memset(valid, 0, n);
+    }
+    ARG_CHECK(sigs != NULL);
+    ARG_CHECK(msg32s != NULL);
+    for (i = 0; i < n; i++) {
+        secp256k1_ecdsa_recoverable_signature_load(ctx, &r, &s, &recid, &sigs[i]);
+        ARG_CHECK(recid >= 0 && recid < 4);
+    }
+
+    job.ctx = ctx;
+    job.pubkeys = pubkeys;
+    job.valid = valid;
+    job.sigs = sigs;
+    job.msg32s = msg32s;
+    return secp256k1_batch_run(ctx, n, ECDSA_RECOVER_BATCH, secp256k1_ecdsa_recover_batch_fn, &job);
+}
+
+/* Compute every public key for which (sigr, sigs) is a valid signature of
+ * message, i.e. the keys recovered with each recid. Returns the number of
+ * candidates written to cands (0, 2 or 4); some may be infinity.
+ *
+ * With R the point of even Y for a given X coordinate, the keys are
+ * r^-1*(s*R - m*G) = A - B and r^-1*(s*(-R) - m*G) = -A - B, so B is shared
+ * between all candidates and A between both parities. */
+static int secp256k1_ecdsa_sig_recover_candidates(const secp256k1_ecmult_context *ctx, secp256k1_gej *cands, const secp256k1_scalar *sigr, const secp256k1_scalar *sigs, const secp256k1_scalar *message) {
+    static const secp256k1_scalar zero = SECP256K1_SCALAR_CONST(0, 0, 0, 0, 0, 0, 0, 0);
+    secp256k1_scalar rn, u1, u2;
+    secp256k1_gej gj, bj, aj, xj;
+    secp256k1_ge x;
+    int recid;
+    int n = 0;
+
+    secp256k1_scalar_inverse_var(&rn, sigr);
+    secp256k1_scalar_mul(&u1, &rn, message);
+    secp256k1_scalar_mul(&u2, &rn, sigs);
+    secp256k1_gej_set_ge(&gj, &secp256k1_ge_const_g);
+    secp256k1_ecmult(ctx, &bj, &gj, &zero, &u1);
+    secp256k1_gej_neg(&bj, &bj);
+    for (recid = 0; recid < 4; recid += 2) {
+        if (!secp256k1_ecdsa_sig_recover_x(&x, sigr, recid)) {
+            continue;
+        }
+        secp256k1_gej_set_ge(&xj, &x);
+        secp256k1_ecmult(ctx, &aj, &xj, &u2, &zero);
+        secp256k1_gej_add_var(&cands[n++], &aj, &bj, NULL);
+        secp256k1_gej_neg(&aj, &aj);
+        secp256k1_gej_add_var(&cands[n++], &aj, &bj, NULL);
+    }
+    return n;
+}
+
+int secp256k1_ecdsa_verify_multisig(const secp256k1_context* ctx, size_t *matches, const secp256k1_ecdsa_signature *sigs, const unsigned char *msg32s, size_t nsigs, const secp256k1_pubkey *pubkeys, size_t npubkeys) {
+    secp256k1_gej cands[4];
+    secp256k1_fe z2[4], z3[4];
+    secp256k1_scalar r, s, m;
+    secp256k1_ge q;
+    size_t pos = 0;
+    size_t i;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(sigs != NULL);
+    ARG_CHECK(msg32s != NULL);
+    ARG_CHECK(pubkeys != NULL);
+
+    for (i = 0; i < nsigs; i++) {
+        int ncands, c;
+        int found = 0;
+
+        /* Every remaining signature needs a distinct remaining key. */
+        if (npubkeys - pos < nsigs - i) {
+            return 0;
+        }
+        secp256k1_ecdsa_signature_load(ctx, &r, &s, &sigs[i]);
+        if (secp256k1_scalar_is_high(&s) || secp256k1_scalar_is_zero(&r) || secp256k1_scalar_is_zero(&s)) {
+            return 0;
+        }
+        secp256k1_scalar_set_b32(&m, &msg32s[i * 32], NULL);
+        ncands = secp256k1_ecdsa_sig_recover_candidates(&ctx->ecmult_ctx, cands, &r, &s, &m);
+        for (c = 0; c < ncands; c++) {
+            if (!cands[c].infinity) {
+                secp256k1_fe_sqr(&z2[c], &cands[c].z);
+                secp256k1_fe_mul(&z3[c], &z2[c], &cands[c].z);
+                secp256k1_fe_normalize_weak(&cands[c].x);
+                secp256k1_fe_normalize_weak(&cands[c].y);
+            }
+        }
+
+        /* The keys must be used in order, so scan forward from the key after
+         * the previous match. Candidates stay in Jacobian coordinates; every
+         * comparison costs two multiplications instead of an inversion. */
+        for (; pos < npubkeys && !found; pos++) {
+            if (!secp256k1_pubkey_load(ctx, &q, &pubkeys[pos])) {
+                return 0;
+            }
+            for (c = 0; c < ncands && !found; c++) {
+                secp256k1_fe t;
+                if (cands[c].infinity) {
+                    continue;
+                }
+                secp256k1_fe_mul(&t, &q.x, &z2[c]);
+                if (!secp256k1_fe_equal_var(&t, &cands[c].x)) {
+                    continue;
+                }
+                secp256k1_fe_mul(&t, &q.y, &z3[c]);
+                found = secp256k1_fe_equal_var(&t, &cands[c].y);
+            }
+            if (found && matches != NULL) {
+                matches[i] = pos;
+            }
+        }
+        if (!found) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
 #endif
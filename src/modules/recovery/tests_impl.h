@@ -239,12 +239,203 @@ void test_ecdsa_recovery_edge_cases(void) {
     }
 }
 
+void test_ecdsa_recovery_batch(size_t n) {
+    secp256k1_ecdsa_recoverable_signature *rsigs;
+    secp256k1_pubkey *pubkeys;
+    unsigned char *msgs;
+    unsigned char *valid;
+    size_t nvalid;
+    size_t i;
+
+    rsigs = (secp256k1_ecdsa_recoverable_signature *)malloc(n * sizeof(*rsigs));
+    pubkeys = (secp256k1_pubkey *)malloc(n * sizeof(*pubkeys));
+    msgs = (unsigned char *)malloc(n * 32);
+    valid = (unsigned char *)malloc(n);
+    memset(rsigs, 0, n * sizeof(*rsigs));
+    memset(msgs, 0, n * 32);
+    for (i = 0; i < n; i++) {
+        unsigned char privkey[32];
+        unsigned char sig[64];
+        secp256k1_scalar key;
+        random_scalar_order_test(&key);
+        secp256k1_scalar_get_b32(privkey, &key);
+        secp256k1_rand256_test(&msgs[i * 32]);
+        switch (secp256k1_rand_bits(3)) {
+        case 0:
+            /* Random garbage, with any recid. */
+            secp256k1_rand256_test(sig);
+            secp256k1_rand256_test(sig + 32);
+            if (!secp256k1_ecdsa_recoverable_signature_parse_compact(ctx, &rsigs[i], sig, secp256k1_rand_bits(2))) {
+                memset(sig, 0, 64);
+                CHECK(secp256k1_ecdsa_recoverable_signature_parse_compact(ctx, &rsigs[i], sig, 0) == 1);
+            }
+            break;
+        case 1:
+            /* A valid signature for a different message. */
+            CHECK(secp256k1_ecdsa_sign_recoverable(ctx, &rsigs[i], &msgs[i * 32], privkey, NULL, NULL) == 1);
+            secp256k1_rand256_test(&msgs[i * 32]);
+            break;
+        default:
+            CHECK(secp256k1_ecdsa_sign_recoverable(ctx, &rsigs[i], &msgs[i * 32], privkey, NULL, NULL) == 1);
+        }
+    }
+
+    nvalid = secp256k1_ecdsa_recover_batch(ctx, pubkeys, valid, rsigs, msgs, n);
+    for (i = 0; i < n; i++) {
+        secp256k1_pubkey pubkey;
+        int ret = secp256k1_ecdsa_recover(ctx, &pubkey, &rsigs[i], &msgs[i * 32]);
+        CHECK(valid[i] == ret);
+        CHECK(memcmp(&pubkey, &pubkeys[i], sizeof(pubkey)) == 0);
+        nvalid -= ret;
+    }
+    CHECK(nvalid == 0);
+
+    free(valid);
+    free(msgs);
+    free(pubkeys);
+    free(rsigs);
+}
+
+void test_ecdsa_recovery_batch_api(void) {
+    secp256k1_ecdsa_recoverable_signature rsig;
+    secp256k1_pubkey pubkey;
+    unsigned char msg[32] = {0};
+    unsigned char valid = 0xaa;
+    secp256k1_context *sign = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
+    int32_t ecount = 0;
+
+    secp256k1_context_set_illegal_callback(sign, counting_illegal_callback_fn, &ecount);
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_ecdsa_recover_batch(ctx, &pubkey, &valid, &rsig, msg, 0) == 0);
+    CHECK(valid == 0xaa);
+    CHECK(ecount == 0);
+    memset(&rsig, 0, sizeof(rsig));
+    CHECK(secp256k1_ecdsa_recover_batch(sign, &pubkey, &valid, &rsig, msg, 1) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_ecdsa_recover_batch(ctx, &pubkey, &valid, NULL, msg, 1) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_ecdsa_recover_batch(ctx, &pubkey, &valid, &rsig, NULL, 1) == 0);
+    CHECK(ecount == 3);
+    /* An all-zero signature is invalid, but not an illegal argument. */
+    valid = 0xaa;
+    CHECK(secp256k1_ecdsa_recover_batch(ctx, &pubkey, &valid, &rsig, msg, 1) == 0);
+    CHECK(valid == 0);
+    CHECK(ecount == 3);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+    secp256k1_context_destroy(sign);
+}
+
+/* Reference OP_CHECKMULTISIG semantics, using one verification per attempt. */
+static int test_ecdsa_verify_multisig_ref(size_t *matches, const secp256k1_ecdsa_signature *sigs, const unsigned char *msg32s, size_t nsigs, const secp256k1_pubkey *pubkeys, size_t npubkeys) {
+    size_t i;
+    size_t pos = 0;
+    for (i = 0; i < nsigs; i++) {
+        while (pos < npubkeys && !secp256k1_ecdsa_verify(ctx, &sigs[i], &msg32s[i * 32], &pubkeys[pos])) {
+            pos++;
+        }
+        if (pos == npubkeys) {
+            return 0;
+        }
+        matches[i] = pos++;
+    }
+    return 1;
+}
+
+void test_ecdsa_verify_multisig(void) {
+    unsigned char privkeys[8][32];
+    secp256k1_pubkey pubkeys[8];
+    secp256k1_ecdsa_signature sigs[8];
+    unsigned char msgs[8 * 32];
+    size_t matches[8], refmatches[8];
+    size_t npubkeys = 1 + secp256k1_rand_int(8);
+    size_t nsigs = secp256k1_rand_int(npubkeys + 1);
+    size_t i, j;
+    int ret;
+
+    for (i = 0; i < npubkeys; i++) {
+        secp256k1_scalar key;
+        if (i > 0 && secp256k1_rand_bits(3) == 0) {
+            /* Duplicate keys are allowed. */
+            memcpy(privkeys[i], privkeys[secp256k1_rand_int(i)], 32);
+        } else {
+            random_scalar_order_test(&key);
+            secp256k1_scalar_get_b32(privkeys[i], &key);
+        }
+        CHECK(secp256k1_ec_pubkey_create(ctx, &pubkeys[i], privkeys[i]) == 1);
+    }
+    /* Sign with an ordered random subset of the keys. */
+    j = 0;
+    for (i = 0; i < nsigs; i++) {
+        j += secp256k1_rand_int(npubkeys - j - (nsigs - i) + 1);
+        secp256k1_rand256_test(&msgs[i * 32]);
+        CHECK(secp256k1_ecdsa_sign(ctx, &sigs[i], &msgs[i * 32], privkeys[j], NULL, NULL) == 1);
+        j++;
+    }
+    CHECK(secp256k1_ecdsa_verify_multisig(ctx, matches, sigs, msgs, nsigs, pubkeys, npubkeys) == 1);
+    CHECK(test_ecdsa_verify_multisig_ref(refmatches, sigs, msgs, nsigs, pubkeys, npubkeys) == 1);
+    CHECK(memcmp(matches, refmatches, nsigs * sizeof(size_t)) == 0);
+
+    if (nsigs > 0) {
+        switch (secp256k1_rand_bits(2)) {
+        case 0: {
+            /* Swap two signatures, which breaks the order unless they use equal keys. */
+            secp256k1_ecdsa_signature sig;
+            unsigned char msg[32];
+            i = secp256k1_rand_int(nsigs);
+            j = secp256k1_rand_int(nsigs);
+            sig = sigs[i];
+            sigs[i] = sigs[j];
+            sigs[j] = sig;
+            memcpy(msg, &msgs[i * 32], 32);
+            memcpy(&msgs[i * 32], &msgs[j * 32], 32);
+            memcpy(&msgs[j * 32], msg, 32);
+            break;
+        }
+        case 1:
+            /* Change a message. */
+            msgs[secp256k1_rand_int(nsigs * 32)] ^= 1 + secp256k1_rand_int(255);
+            break;
+        case 2: {
+            /* Make a signature high-S, which secp256k1_ecdsa_verify rejects. */
+            secp256k1_scalar r, s;
+            i = secp256k1_rand_int(nsigs);
+            secp256k1_ecdsa_signature_load(ctx, &r, &s, &sigs[i]);
+            secp256k1_scalar_negate(&s, &s);
+            secp256k1_ecdsa_signature_save(&sigs[i], &r, &s);
+            break;
+        }
+        default:
+            /* Drop a public key. */
+            i = secp256k1_rand_int(npubkeys);
+            memmove(&pubkeys[i], &pubkeys[i + 1], (npubkeys - i - 1) * sizeof(pubkeys[0]));
+            npubkeys--;
+        }
+        ret = secp256k1_ecdsa_verify_multisig(ctx, matches, sigs, msgs, nsigs, pubkeys, npubkeys);
+        CHECK(ret == test_ecdsa_verify_multisig_ref(refmatches, sigs, msgs, nsigs, pubkeys, npubkeys));
+        if (ret) {
+            CHECK(memcmp(matches, refmatches, nsigs * sizeof(size_t)) == 0);
+        }
+    }
+}
+
 void run_recovery_tests(void) {
     int i;
     for (i = 0; i < 64*count; i++) {
         test_ecdsa_recovery_end_to_end();
     }
     test_ecdsa_recovery_edge_cases();
+    test_ecdsa_recovery_batch_api();
+    for (i = 0; i < count; i++) {
+        test_ecdsa_recovery_batch(1 + secp256k1_rand_int(32));
+    }
+    /* Spans several internal batches, also when processed out of order. */
+    test_ecdsa_recovery_batch(600);
+    secp256k1_context_set_executor(ctx, &test_executor);
+    test_ecdsa_recovery_batch(600);
+    secp256k1_context_set_executor(ctx, NULL);
+    for (i = 0; i < 16*count; i++) {
+        test_ecdsa_verify_multisig();
+    }
 }
 
 #endif
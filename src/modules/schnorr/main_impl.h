@@ -88,6 +88,100 @@ int secp256k1_schnorr_recover(const secp256k1_context* ctx, secp256k1_pubkey *pu
     }
 }
 
+/* Number of signatures whose h values and results share one inversion. */
+#define SCHNORR_RECOVER_BATCH 256
+
+typedef struct {
+    const secp256k1_context *ctx;
+    secp256k1_pubkey *pubkeys;
+    unsigned char *valid;
+    const unsigned char *sig64s;
+    const unsigned char *msg32s;
+} secp256k1_schnorr_recover_batch_job;
+
+/* Recover the keys of the signatures begin..end-1, and return how many were recovered. */
+static size_t secp256k1_schnorr_recover_batch_fn(void *arg, size_t begin, size_t end) {
+    const secp256k1_schnorr_recover_batch_job *job = (const secp256k1_schnorr_recover_batch_job *)arg;
+    const secp256k1_context *ctx = job->ctx;
+    secp256k1_scalar *hs;
+    secp256k1_scalar *his;
+    secp256k1_scalar *ss;
+    secp256k1_ge *ps;
+    secp256k1_gej *qjs;
+    size_t *idx;
+    size_t batch = end - begin;
+    size_t count = 0;
+    size_t i, k;
+
+    hs = (secp256k1_scalar *)checked_malloc(&ctx->error_callback, batch * sizeof(secp256k1_scalar));
+    his = (secp256k1_scalar *)checked_malloc(&ctx->error_callback, batch * sizeof(secp256k1_scalar));
+    ss = (secp256k1_scalar *)checked_malloc(&ctx->error_callback, batch * sizeof(secp256k1_scalar));
+    ps = (secp256k1_ge *)checked_malloc(&ctx->error_callback, batch * sizeof(secp256k1_ge));
+    qjs = (secp256k1_gej *)checked_malloc(&ctx->error_callback, batch * sizeof(secp256k1_gej));
+    idx = (size_t *)checked_malloc(&ctx->error_callback, batch * sizeof(size_t));
+
+    k = 0;
+    for (i = begin; i < end; i++) {
+        if (secp256k1_schnorr_sig_recover_prepare(&job->sig64s[i * 64], &ps[k], &hs[k], &ss[k], secp256k1_schnorr_msghash_sha256, &job->msg32s[i * 32])) {
+            idx[k] = i;
+            k++;
+        }
+    }
+    if (k > 0) {
+        secp256k1_scalar_inverse_all_var(k, his, hs);
+
+        for (i = 0; i < k; i++) {
+            secp256k1_gej Rj;
+            secp256k1_gej_set_ge(&Rj, &ps[i]);
+            secp256k1_scalar_negate(&ss[i], &ss[i]);
+            secp256k1_scalar_mul(&ss[i], &ss[i], &his[i]);
+            secp256k1_ecmult(&ctx->ecmult_ctx, &qjs[i], &Rj, &his[i], &ss[i]);
+        }
+
+        /* Only public data is involved, so all results can be converted to
+         * affine coordinates with a single variable-time inversion. */
+        secp256k1_ge_set_all_gej_var(k, ps, qjs, &ctx->error_callback);
+        for (i = 0; i < k; i++) {
+            if (!ps[i].infinity) {
+                secp256k1_pubkey_save(&job->pubkeys[idx[i]], &ps[i]);
+                if (job->valid != NULL) {
+                    job->valid[idx[i]] = 1;
+                }
+                count++;
+            }
+        }
+    }
+
+    free(idx);
+    free(qjs);
+    free(ps);
+    free(ss);
+    free(his);
+    free(hs);
+    return count;
+}
+
+size_t secp256k1_schnorr_recover_batch(const secp256k1_context* ctx, secp256k1_pubkey *pubkeys, unsigned char *valid, const unsigned char *sig64s, const unsigned char *msg32s, size_t n) {
+    secp256k1_schnorr_recover_batch_job job;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(pubkeys != NULL);
+    memset(pubkeys, 0, n * sizeof(*pubkeys));
+    if (valid != NULL) {
+        memset(valid, 0, n);
+    }
+    ARG_CHECK(sig64s != NULL);
+    ARG_CHECK(msg32s != NULL);
+
+    job.ctx = ctx;
+    job.pubkeys = pubkeys;
+    job.valid = valid;
+    job.sig64s = sig64s;
+    job.msg32s = msg32s;
+    return secp256k1_batch_run(ctx, n, SCHNORR_RECOVER_BATCH, secp256k1_schnorr_recover_batch_fn, &job);
+}
+
 int secp256k1_schnorr_generate_nonce_pair(const secp256k1_context* ctx, secp256k1_pubkey *pubnonce, unsigned char *privnonce32, const unsigned char *sec32, const unsigned char *msg32, secp256k1_nonce_function noncefp, const void* noncedata) {
     int count = 0;
     int ret = 1;
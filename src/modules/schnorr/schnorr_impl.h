@@ -141,29 +141,34 @@ static int secp256k1_schnorr_sig_verify(const secp256k1_ecmult_context* ctx, con
     return secp256k1_fe_equal_var(&Rx, &Ra.x);
 }
 
-static int secp256k1_schnorr_sig_recover(const secp256k1_ecmult_context* ctx, const unsigned char *sig64, secp256k1_ge *pubkey, secp256k1_schnorr_msghash hash, const unsigned char *msg32) {
-    secp256k1_gej Qj, Rj;
-    secp256k1_ge Ra;
+static int secp256k1_schnorr_sig_recover_prepare(const unsigned char *sig64, secp256k1_ge *Ra, secp256k1_scalar *h, secp256k1_scalar *s, secp256k1_schnorr_msghash hash, const unsigned char *msg32) {
     secp256k1_fe Rx;
-    secp256k1_scalar h, s;
     unsigned char hh[32];
     int overflow;
 
     hash(hh, sig64, msg32);
     overflow = 0;
-    secp256k1_scalar_set_b32(&h, hh, &overflow);
-    if (overflow || secp256k1_scalar_is_zero(&h)) {
+    secp256k1_scalar_set_b32(h, hh, &overflow);
+    if (overflow || secp256k1_scalar_is_zero(h)) {
         return 0;
     }
     overflow = 0;
-    secp256k1_scalar_set_b32(&s, sig64 + 32, &overflow);
+    secp256k1_scalar_set_b32(s, sig64 + 32, &overflow);
     if (overflow) {
         return 0;
     }
     if (!secp256k1_fe_set_b32(&Rx, sig64)) {
         return 0;
     }
-    if (!secp256k1_ge_set_xo_var(&Ra, &Rx, 0)) {
+    return secp256k1_ge_set_xo_var(Ra, &Rx, 0);
+}
+
+static int secp256k1_schnorr_sig_recover(const secp256k1_ecmult_context* ctx, const unsigned char *sig64, secp256k1_ge *pubkey, secp256k1_schnorr_msghash hash, const unsigned char *msg32) {
+    secp256k1_gej Qj, Rj;
+    secp256k1_ge Ra;
+    secp256k1_scalar h, s;
+
+    if (!secp256k1_schnorr_sig_recover_prepare(sig64, &Ra, &h, &s, hash, msg32)) {
         return 0;
     }
     secp256k1_gej_set_ge(&Rj, &Ra);
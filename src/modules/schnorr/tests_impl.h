@@ -156,6 +156,56 @@ void test_schnorr_recovery(void) {
     }
 }
 
+void test_schnorr_recovery_batch(size_t n) {
+    unsigned char *sig64s;
+    unsigned char *msg32s;
+    unsigned char *valid;
+    secp256k1_pubkey *pubkeys;
+    size_t nvalid;
+    size_t i;
+
+    sig64s = (unsigned char *)malloc(n * 64);
+    msg32s = (unsigned char *)malloc(n * 32);
+    valid = (unsigned char *)malloc(n);
+    pubkeys = (secp256k1_pubkey *)malloc(n * sizeof(*pubkeys));
+    memset(sig64s, 0, n * 64);
+    memset(msg32s, 0, n * 32);
+    for (i = 0; i < n; i++) {
+        secp256k1_rand256_test(&msg32s[i * 32]);
+        if (secp256k1_rand_bits(1)) {
+            unsigned char privkey[32];
+            secp256k1_scalar key;
+            do {
+                random_scalar_order_test(&key);
+            } while (secp256k1_scalar_is_zero(&key));
+            secp256k1_scalar_get_b32(privkey, &key);
+            CHECK(secp256k1_schnorr_sign(ctx, &sig64s[i * 64], &msg32s[i * 32], privkey, NULL, NULL) == 1);
+        } else {
+            /* Random signatures recover to some key about half of the time. */
+            secp256k1_rand256_test(&sig64s[i * 64]);
+            secp256k1_rand256_test(&sig64s[i * 64 + 32]);
+        }
+    }
+
+    nvalid = secp256k1_schnorr_recover_batch(ctx, pubkeys, valid, sig64s, msg32s, n);
+    for (i = 0; i < n; i++) {
+        secp256k1_pubkey pubkey;
+        int ret = secp256k1_schnorr_recover(ctx, &pubkey, &sig64s[i * 64], &msg32s[i * 32]);
+        CHECK(valid[i] == ret);
+        CHECK(memcmp(&pubkey, &pubkeys[i], sizeof(pubkey)) == 0);
+        if (ret) {
+            CHECK(secp256k1_schnorr_verify(ctx, &sig64s[i * 64], &msg32s[i * 32], &pubkeys[i]) == 1);
+        }
+        nvalid -= ret;
+    }
+    CHECK(nvalid == 0);
+
+    free(pubkeys);
+    free(valid);
+    free(msg32s);
+    free(sig64s);
+}
+
 void run_schnorr_tests(void) {
     int i;
     for (i = 0; i < 32*count; i++) {
@@ -170,6 +220,14 @@ void run_schnorr_tests(void) {
     for (i = 0; i < 10 * count; i++) {
          test_schnorr_threshold();
     }
+    for (i = 0; i < count; i++) {
+        test_schnorr_recovery_batch(1 + secp256k1_rand_int(32));
+    }
+    /* Spans several internal batches, also when processed out of order. */
+    test_schnorr_recovery_batch(600);
+    secp256k1_context_set_executor(ctx, &test_executor);
+    test_schnorr_recovery_batch(600);
+    secp256k1_context_set_executor(ctx, NULL);
 }
 
 #endif
@@ -0,0 +1,164 @@
+/**********************************************************************
+ * Copyright (c) 2016 libsecp256k1 contributors                       *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_MODULE_VERIFYQUEUE_MAIN_
+#define _SECP256K1_MODULE_VERIFYQUEUE_MAIN_
+
+#include "include/secp256k1_verifyqueue.h"
+
+/* The queue is a bounded multi-producer multi-consumer ring buffer, in which
+ * every cell carries a sequence number (as described by Dmitry Vyukov):
+ * - seq == pos: the cell is free for the producer that claims position pos.
+ * - seq == pos + 1: the cell holds the job for position pos.
+ * - After the job is taken, seq becomes pos + capacity, which frees the cell
+ *   for the producer one lap later.
+ * Producers and consumers claim positions with a compare-and-swap on their
+ * respective counters, so no locks are involved. */
+typedef struct {
+    volatile size_t seq;
+    secp256k1_ecdsa_signature sig;
+    unsigned char msg32[32];
+    secp256k1_pubkey pubkey;
+    int *status;
+    void *data;
+} secp256k1_verify_queue_cell;
+
+struct secp256k1_verify_queue_struct {
+    const secp256k1_context *ctx;
+    secp256k1_verify_queue_callback callback;
+    secp256k1_verify_queue_cell *cells;
+    size_t mask;
+    /* Keep the producer and consumer positions on separate cache lines. */
+    unsigned char pad0[64];
+    volatile size_t enqueue_pos;
+    unsigned char pad1[64];
+    volatile size_t dequeue_pos;
+    unsigned char pad2[64];
+};
+
+secp256k1_verify_queue* secp256k1_verify_queue_create(const secp256k1_context* ctx, size_t capacity, secp256k1_verify_queue_callback callback) {
+    secp256k1_verify_queue* ret;
+    size_t i;
+
+    VERIFY_CHECK(ctx != NULL);
+    if (EXPECT(!secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx), 0)) {
+        secp256k1_callback_call(&ctx->illegal_callback, "secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx)");
+        return NULL;
+    }
+    if (EXPECT(capacity < 2 || (capacity & (capacity - 1)) != 0, 0)) {
+        secp256k1_callback_call(&ctx->illegal_callback, "capacity is a power of two");
+        return NULL;
+    }
+    ret = (secp256k1_verify_queue*)checked_malloc(&ctx->error_callback, sizeof(secp256k1_verify_queue));
+    ret->cells = (secp256k1_verify_queue_cell*)checked_malloc(&ctx->error_callback, capacity * sizeof(secp256k1_verify_queue_cell));
+    ret->ctx = ctx;
+    ret->callback = callback;
+    ret->mask = capacity - 1;
+    for (i = 0; i < capacity; i++) {
+        ret->cells[i].seq = i;
+    }
+    ret->enqueue_pos = 0;
+    ret->dequeue_pos = 0;
+    __sync_synchronize();
+    return ret;
+}
+
+void secp256k1_verify_queue_destroy(secp256k1_verify_queue* queue) {
+    if (queue != NULL) {
+        free(queue->cells);
+        free(queue);
+    }
+}
+
+int secp256k1_verify_queue_push(secp256k1_verify_queue* queue, const secp256k1_ecdsa_signature *sig, const unsigned char *msg32, const secp256k1_pubkey *pubkey, int *status, void *data) {
+    const secp256k1_context *ctx;
+    secp256k1_verify_queue_cell *cell;
+    size_t pos;
+
+    VERIFY_CHECK(queue != NULL);
+    ctx = queue->ctx;
+    ARG_CHECK(sig != NULL);
+    ARG_CHECK(msg32 != NULL);
+    ARG_CHECK(pubkey != NULL);
+
+    pos = queue->enqueue_pos;
+    while (1) {
+        ptrdiff_t dif;
+        cell = &queue->cells[pos & queue->mask];
+        dif = (ptrdiff_t)(cell->seq - pos);
+        if (dif == 0) {
+            if (__sync_bool_compare_and_swap(&queue->enqueue_pos, pos, pos + 1)) {
+                break;
+            }
+        } else if (dif < 0) {
+            /* The cell still holds the job from one lap earlier. */
+            return 0;
+        }
+        pos = queue->enqueue_pos;
+    }
+    __sync_synchronize();
+    cell->sig = *sig;
+    memcpy(cell->msg32, msg32, 32);
+    cell->pubkey = *pubkey;
+    cell->status = status;
+    cell->data = data;
+    if (status != NULL) {
+        *(volatile int *)status = SECP256K1_VERIFY_QUEUE_PENDING;
+    }
+    __sync_synchronize();
+    cell->seq = pos + 1;
+    return 1;
+}
+
+size_t secp256k1_verify_queue_work(secp256k1_verify_queue* queue, size_t max_jobs) {
+    size_t done = 0;
+
+    VERIFY_CHECK(queue != NULL);
+    while (done < max_jobs) {
+        secp256k1_verify_queue_cell *cell;
+        secp256k1_verify_queue_cell job;
+        size_t pos;
+        int result;
+
+        pos = queue->dequeue_pos;
+        while (1) {
+            ptrdiff_t dif;
+            cell = &queue->cells[pos & queue->mask];
+            dif = (ptrdiff_t)(cell->seq - (pos + 1));
+            if (dif == 0) {
+                if (__sync_bool_compare_and_swap(&queue->dequeue_pos, pos, pos + 1)) {
+                    break;
+                }
+            } else if (dif < 0) {
+                /* No job has been published at this position yet. */
+                return done;
+            }
+            pos = queue->dequeue_pos;
+        }
+        __sync_synchronize();
+        job.sig = cell->sig;
+        memcpy(job.msg32, cell->msg32, 32);
+        job.pubkey = cell->pubkey;
+        job.status = cell->status;
+        job.data = cell->data;
+        __sync_synchronize();
+        /* Release the cell before verifying, so producers are not held up. */
+        cell->seq = pos + queue->mask + 1;
+
+        result = secp256k1_ecdsa_verify(queue->ctx, &job.sig, job.msg32, &job.pubkey);
+        if (job.status != NULL) {
+            __sync_synchronize();
+            *(volatile int *)job.status = result;
+        }
+        if (queue->callback != NULL) {
+            queue->callback(job.data, result);
+        }
+        done++;
+    }
+    return done;
+}
+
+#endif
@@ -0,0 +1,343 @@
+/**********************************************************************
+ * Copyright (c) 2016 libsecp256k1 contributors                       *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_MODULE_VERIFYQUEUE_TESTS_
+#define _SECP256K1_MODULE_VERIFYQUEUE_TESTS_
+
+#include "include/secp256k1_verifyqueue.h"
+
+typedef struct {
+    int calls;
+    int valid;
+    int last;
+} verifyqueue_test_data;
+
+static void verifyqueue_test_callback(void *data, int result) {
+    verifyqueue_test_data *d = (verifyqueue_test_data*)data;
+    d->calls++;
+    d->valid += result;
+}
+
+static void verifyqueue_test_order_callback(void *data, int result) {
+    verifyqueue_test_data *d = (verifyqueue_test_data*)data;
+    (void)result;
+    d->calls++;
+    d->last = d->calls;
+}
+
+void test_verifyqueue_api(void) {
+    secp256k1_context *none = secp256k1_context_create(SECP256K1_CONTEXT_NONE);
+    secp256k1_context *sign = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
+    secp256k1_verify_queue *queue;
+    secp256k1_ecdsa_signature sig;
+    secp256k1_pubkey pubkey;
+    unsigned char msg32[32] = {0};
+    int32_t ecount = 0;
+
+    secp256k1_context_set_illegal_callback(none, counting_illegal_callback_fn, &ecount);
+    secp256k1_context_set_illegal_callback(sign, counting_illegal_callback_fn, &ecount);
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+
+    /* The context must be able to verify. */
+    CHECK(secp256k1_verify_queue_create(none, 4, NULL) == NULL);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_verify_queue_create(sign, 4, NULL) == NULL);
+    CHECK(ecount == 2);
+    /* The capacity must be a power of two, and at least 2. */
+    CHECK(secp256k1_verify_queue_create(ctx, 0, NULL) == NULL);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_verify_queue_create(ctx, 1, NULL) == NULL);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_verify_queue_create(ctx, 6, NULL) == NULL);
+    CHECK(ecount == 5);
+    queue = secp256k1_verify_queue_create(ctx, 2, NULL);
+    CHECK(queue != NULL);
+    CHECK(ecount == 5);
+
+    memset(&sig, 0, sizeof(sig));
+    memset(&pubkey, 0, sizeof(pubkey));
+    CHECK(secp256k1_verify_queue_push(queue, NULL, msg32, &pubkey, NULL, NULL) == 0);
+    CHECK(ecount == 6);
+    CHECK(secp256k1_verify_queue_push(queue, &sig, NULL, &pubkey, NULL, NULL) == 0);
+    CHECK(ecount == 7);
+    CHECK(secp256k1_verify_queue_push(queue, &sig, msg32, NULL, NULL, NULL) == 0);
+    CHECK(ecount == 8);
+    /* Nothing was queued by the failed calls. */
+    CHECK(secp256k1_verify_queue_work(queue, 10) == 0);
+    /* A job with an invalid public key is queued, and fails verification. */
+    CHECK(secp256k1_verify_queue_push(queue, &sig, msg32, &pubkey, NULL, NULL) == 1);
+    CHECK(secp256k1_verify_queue_work(queue, 10) == 1);
+    CHECK(ecount == 9);
+
+    secp256k1_verify_queue_destroy(queue);
+    secp256k1_verify_queue_destroy(NULL);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+    secp256k1_context_destroy(none);
+    secp256k1_context_destroy(sign);
+}
+
+void test_verifyqueue(void) {
+    const size_t capacity = 8;
+    secp256k1_verify_queue *queue;
+    secp256k1_ecdsa_signature sigs[8];
+    unsigned char msgs[8][32];
+    secp256k1_pubkey pubkeys[8];
+    int status[8];
+    verifyqueue_test_data data = {0, 0, 0};
+    size_t expected = 0;
+    size_t i;
+    int lap;
+
+    for (i = 0; i < capacity; i++) {
+        secp256k1_scalar key, msg;
+        unsigned char seckey[32];
+        random_scalar_order_test(&key);
+        random_scalar_order_test(&msg);
+        secp256k1_scalar_get_b32(seckey, &key);
+        secp256k1_scalar_get_b32(msgs[i], &msg);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &pubkeys[i], seckey) == 1);
+        CHECK(secp256k1_ecdsa_sign(ctx, &sigs[i], msgs[i], seckey, NULL, NULL) == 1);
+    }
+
+    queue = secp256k1_verify_queue_create(ctx, capacity, verifyqueue_test_callback);
+    CHECK(queue != NULL);
+    CHECK(secp256k1_verify_queue_work(queue, capacity) == 0);
+
+    /* Go around the ring several times, with a varying number of jobs in flight. */
+    for (lap = 0; lap < 4; lap++) {
+        size_t todo = capacity - (lap & 1) * (capacity / 2 - 1);
+        size_t done = 0;
+        for (i = 0; i < todo; i++) {
+            size_t j = (i + lap) % capacity;
+            /* Corrupt one message in every lap. */
+            unsigned char msg32[32];
+            memcpy(msg32, msgs[j], 32);
+            if (i == (size_t)lap) {
+                msg32[lap] ^= 1;
+            } else {
+                expected++;
+            }
+            CHECK(secp256k1_verify_queue_push(queue, &sigs[j], msg32, &pubkeys[j], &status[i], &data) == 1);
+            CHECK(status[i] == SECP256K1_VERIFY_QUEUE_PENDING);
+        }
+        if (todo == capacity) {
+            /* The queue is full: pushing more is refused. */
+            CHECK(secp256k1_verify_queue_push(queue, &sigs[0], msgs[0], &pubkeys[0], NULL, &data) == 0);
+        }
+        /* Process the jobs in two rounds. */
+        done += secp256k1_verify_queue_work(queue, 3);
+        CHECK(done == 3);
+        CHECK(status[0] != SECP256K1_VERIFY_QUEUE_PENDING);
+        CHECK(status[3] == SECP256K1_VERIFY_QUEUE_PENDING);
+        done += secp256k1_verify_queue_work(queue, capacity);
+        CHECK(done == todo);
+        for (i = 0; i < todo; i++) {
+            CHECK(status[i] == (i != (size_t)lap));
+        }
+        CHECK(secp256k1_verify_queue_work(queue, capacity) == 0);
+    }
+    CHECK(data.valid == (int)expected);
+    secp256k1_verify_queue_destroy(queue);
+
+    /* Jobs are processed in the order they were queued. */
+    queue = secp256k1_verify_queue_create(ctx, 4, verifyqueue_test_order_callback);
+    CHECK(queue != NULL);
+    for (i = 0; i < 4; i++) {
+        CHECK(secp256k1_verify_queue_push(queue, &sigs[i], msgs[i], &pubkeys[i], NULL, &data) == 1);
+    }
+    data.calls = 0;
+    CHECK(secp256k1_verify_queue_work(queue, 2) == 2);
+    CHECK(data.last == 2);
+    /* Freed cells are reused while older jobs are still waiting. */
+    for (i = 4; i < 6; i++) {
+        CHECK(secp256k1_verify_queue_push(queue, &sigs[i], msgs[i], &pubkeys[i], &status[i], &data) == 1);
+    }
+    CHECK(secp256k1_verify_queue_push(queue, &sigs[6], msgs[6], &pubkeys[6], NULL, &data) == 0);
+    CHECK(secp256k1_verify_queue_work(queue, 10) == 4);
+    CHECK(data.last == 6);
+    CHECK(status[4] == 1 && status[5] == 1);
+    /* Waiting jobs are dropped on destruction. */
+    CHECK(secp256k1_verify_queue_push(queue, &sigs[6], msgs[6], &pubkeys[6], NULL, &data) == 1);
+    secp256k1_verify_queue_destroy(queue);
+    CHECK(data.calls == 6);
+}
+
+#ifdef ENABLE_PTHREAD_TESTS
+#define VERIFYQUEUE_THREADS 3
+#define VERIFYQUEUE_THREAD_JOBS 500
+
+typedef struct {
+    secp256k1_ecdsa_signature sig;
+    unsigned char msg32[32];
+    secp256k1_pubkey pubkey;
+    int expected;
+    int status;
+    int result;
+    volatile int calls;
+} verifyqueue_threads_job;
+
+typedef struct {
+    secp256k1_verify_queue *queue;
+    verifyqueue_threads_job *jobs;
+    size_t njobs;
+    /* Producer i pushes the jobs i, i + VERIFYQUEUE_THREADS, ... */
+    size_t producer;
+    volatile size_t *processed;
+    volatile size_t *full;
+    volatile int *pushed;
+    pthread_mutex_t *lock;
+    pthread_cond_t *start;
+} verifyqueue_threads_arg;
+
+static void verifyqueue_threads_callback(void *data, int result) {
+    verifyqueue_threads_job *job = (verifyqueue_threads_job*)data;
+    job->result = result;
+    __sync_fetch_and_add(&job->calls, 1);
+}
+
+static void *verifyqueue_threads_producer(void *data) {
+    verifyqueue_threads_arg *arg = (verifyqueue_threads_arg*)data;
+    size_t i;
+    for (i = arg->producer; i < arg->njobs; i += VERIFYQUEUE_THREADS) {
+        verifyqueue_threads_job *job = &arg->jobs[i];
+        while (!secp256k1_verify_queue_push(arg->queue, &job->sig, job->msg32, &job->pubkey, &job->status, job)) {
+            /* The queue is full: let the workers start, and help them. */
+            pthread_mutex_lock(arg->lock);
+            (*arg->full)++;
+            pthread_cond_broadcast(arg->start);
+            pthread_mutex_unlock(arg->lock);
+            __sync_fetch_and_add(arg->processed, secp256k1_verify_queue_work(arg->queue, 1));
+        }
+    }
+    return NULL;
+}
+
+static void *verifyqueue_threads_worker(void *data) {
+    verifyqueue_threads_arg *arg = (verifyqueue_threads_arg*)data;
+    /* Wait until the queue has been full, so that the producers are
+     * guaranteed to run into it, or until everything has been pushed. */
+    pthread_mutex_lock(arg->lock);
+    while (*arg->full == 0 && !*arg->pushed) {
+        pthread_cond_wait(arg->start, arg->lock);
+    }
+    pthread_mutex_unlock(arg->lock);
+    while (*arg->processed < arg->njobs) {
+        size_t done = secp256k1_verify_queue_work(arg->queue, 4);
+        if (done == 0) {
+            sched_yield();
+        }
+        __sync_fetch_and_add(arg->processed, done);
+    }
+    return NULL;
+}
+
+void test_verifyqueue_threads(size_t capacity) {
+    const size_t njobs = VERIFYQUEUE_THREADS * VERIFYQUEUE_THREAD_JOBS;
+    secp256k1_verify_queue *queue;
+    verifyqueue_threads_job *jobs;
+    verifyqueue_threads_arg producers[VERIFYQUEUE_THREADS], workers[VERIFYQUEUE_THREADS];
+    pthread_t producer_threads[VERIFYQUEUE_THREADS], worker_threads[VERIFYQUEUE_THREADS];
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    volatile size_t processed = 0;
+    volatile size_t full = 0;
+    volatile int pushed = 0;
+    size_t i;
+
+    /* A few signed messages, combined into valid and invalid jobs. */
+    jobs = (verifyqueue_threads_job*)malloc(njobs * sizeof(verifyqueue_threads_job));
+    for (i = 0; i < njobs; i++) {
+        if (i < 8) {
+            secp256k1_scalar key, msg;
+            unsigned char seckey[32];
+            random_scalar_order_test(&key);
+            random_scalar_order_test(&msg);
+            secp256k1_scalar_get_b32(seckey, &key);
+            secp256k1_scalar_get_b32(jobs[i].msg32, &msg);
+            CHECK(secp256k1_ec_pubkey_create(ctx, &jobs[i].pubkey, seckey) == 1);
+            CHECK(secp256k1_ecdsa_sign(ctx, &jobs[i].sig, jobs[i].msg32, seckey, NULL, NULL) == 1);
+        } else {
+            jobs[i] = jobs[i % 8];
+            switch (secp256k1_rand_int(4)) {
+            case 0:
+                jobs[i].msg32[secp256k1_rand_int(32)] ^= 1 + secp256k1_rand_int(255);
+                break;
+            case 1:
+                jobs[i].pubkey = jobs[(i + 1) % 8].pubkey;
+                break;
+            }
+        }
+    }
+    for (i = 0; i < njobs; i++) {
+        jobs[i].expected = secp256k1_ecdsa_verify(ctx, &jobs[i].sig, jobs[i].msg32, &jobs[i].pubkey);
+        jobs[i].status = 2;
+        jobs[i].result = 2;
+        jobs[i].calls = 0;
+    }
+
+    queue = secp256k1_verify_queue_create(ctx, capacity, verifyqueue_threads_callback);
+    CHECK(queue != NULL);
+    CHECK(pthread_mutex_init(&lock, NULL) == 0);
+    CHECK(pthread_cond_init(&start, NULL) == 0);
+    for (i = 0; i < VERIFYQUEUE_THREADS; i++) {
+        producers[i].queue = queue;
+        producers[i].jobs = jobs;
+        producers[i].njobs = njobs;
+        producers[i].producer = i;
+        producers[i].processed = &processed;
+        producers[i].full = &full;
+        producers[i].pushed = &pushed;
+        producers[i].lock = &lock;
+        producers[i].start = &start;
+        workers[i] = producers[i];
+    }
+    for (i = 0; i < VERIFYQUEUE_THREADS; i++) {
+        CHECK(pthread_create(&producer_threads[i], NULL, verifyqueue_threads_producer, &producers[i]) == 0);
+        CHECK(pthread_create(&worker_threads[i], NULL, verifyqueue_threads_worker, &workers[i]) == 0);
+    }
+    for (i = 0; i < VERIFYQUEUE_THREADS; i++) {
+        CHECK(pthread_join(producer_threads[i], NULL) == 0);
+    }
+    /* Wake the workers in case the queue was never full. */
+    pthread_mutex_lock(&lock);
+    pushed = 1;
+    pthread_cond_broadcast(&start);
+    pthread_mutex_unlock(&lock);
+    for (i = 0; i < VERIFYQUEUE_THREADS; i++) {
+        CHECK(pthread_join(worker_threads[i], NULL) == 0);
+    }
+
+    /* The producers cannot push all their jobs into the queue without
+     * running into its capacity, as no worker starts before that. */
+    CHECK(full > 0);
+    CHECK(processed == njobs);
+    CHECK(secp256k1_verify_queue_work(queue, capacity) == 0);
+    for (i = 0; i < njobs; i++) {
+        CHECK(jobs[i].calls == 1);
+        CHECK(jobs[i].result == jobs[i].expected);
+        CHECK(jobs[i].status == jobs[i].expected);
+    }
+
+    pthread_cond_destroy(&start);
+    pthread_mutex_destroy(&lock);
+    secp256k1_verify_queue_destroy(queue);
+    free(jobs);
+}
+#endif
+
+void run_verifyqueue_tests(void) {
+    int i;
+    test_verifyqueue_api();
+    for (i = 0; i < count; i++) {
+        test_verifyqueue();
+    }
+#ifdef ENABLE_PTHREAD_TESTS
+    test_verifyqueue_threads(2);
+    test_verifyqueue_threads(64);
+#endif
+}
+
+#endif
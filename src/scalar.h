@@ -61,6 +61,10 @@ static void secp256k1_scalar_inverse(secp256k1_scalar *r, const secp256k1_scalar
 /** Compute the inverse of a scalar (modulo the group order), without constant-time guarantee. */
 static void secp256k1_scalar_inverse_var(secp256k1_scalar *r, const secp256k1_scalar *a);
 
+/** Calculate the (modular) inverses of a batch of scalars, without constant-time guarantee.
+ *  None of the inputs may be zero. The inputs and outputs must not overlap. */
+static void secp256k1_scalar_inverse_all_var(size_t len, secp256k1_scalar *r, const secp256k1_scalar *a);
+
 /** Compute the complement of a scalar (modulo the group order). */
 static void secp256k1_scalar_negate(secp256k1_scalar *r, const secp256k1_scalar *a);
 
@@ -7,6 +7,12 @@
 #ifndef _SECP256K1_SCALAR_REPR_IMPL_H_
 #define _SECP256K1_SCALAR_REPR_IMPL_H_
 
+#include "modinv64_impl.h"
+
+#ifdef USE_ASM_X86_64
+#include "cpu_impl.h"
+#endif
+
 /* Limbs of the secp256k1 order. */
 #define SECP256K1_N_0 ((uint64_t)0xBFD25E8CD0364141ULL)
 #define SECP256K1_N_1 ((uint64_t)0xBAAEDCE6AF48A03BULL)
@@ -274,110 +280,167 @@ static void secp256k1_scalar_reduce_512(secp256k1_scalar *r, const uint64_t *l)
     uint64_t p0, p1, p2, p3, p4;
     uint64_t c;
 
-    __asm__ __volatile__(
-    /* Preload. */
-    "movq 32(%%rsi), %%r11\n"
-    "movq 40(%%rsi), %%r12\n"
-    "movq 48(%%rsi), %%r13\n"
-    "movq 56(%%rsi), %%r14\n"
-    /* Initialize r8,r9,r10 */
-    "movq 0(%%rsi), %%r8\n"
-    "movq $0, %%r9\n"
-    "movq $0, %%r10\n"
-    /* (r8,r9) += n0 * c0 */
-    "movq %8, %%rax\n"
-    "mulq %%r11\n"
-    "addq %%rax, %%r8\n"
-    "adcq %%rdx, %%r9\n"
-    /* extract m0 */
-    "movq %%r8, %q0\n"
-    "movq $0, %%r8\n"
-    /* (r9,r10) += l1 */
-    "addq 8(%%rsi), %%r9\n"
-    "adcq $0, %%r10\n"
-    /* (r9,r10,r8) += n1 * c0 */
-    "movq %8, %%rax\n"
-    "mulq %%r12\n"
-    "addq %%rax, %%r9\n"
-    "adcq %%rdx, %%r10\n"
-    "adcq $0, %%r8\n"
-    /* (r9,r10,r8) += n0 * c1 */
-    "movq %9, %%rax\n"
-    "mulq %%r11\n"
-    "addq %%rax, %%r9\n"
-    "adcq %%rdx, %%r10\n"
-    "adcq $0, %%r8\n"
-    /* extract m1 */
-    "movq %%r9, %q1\n"
-    "movq $0, %%r9\n"
-    /* (r10,r8,r9) += l2 */
-    "addq 16(%%rsi), %%r10\n"
-    "adcq $0, %%r8\n"
-    "adcq $0, %%r9\n"
-    /* (r10,r8,r9) += n2 * c0 */
-    "movq %8, %%rax\n"
-    "mulq %%r13\n"
-    "addq %%rax, %%r10\n"
-    "adcq %%rdx, %%r8\n"
-    "adcq $0, %%r9\n"
-    /* (r10,r8,r9) += n1 * c1 */
-    "movq %9, %%rax\n"
-    "mulq %%r12\n"
-    "addq %%rax, %%r10\n"
-    "adcq %%rdx, %%r8\n"
-    "adcq $0, %%r9\n"
-    /* (r10,r8,r9) += n0 */
-    "addq %%r11, %%r10\n"
-    "adcq $0, %%r8\n"
-    "adcq $0, %%r9\n"
-    /* extract m2 */
-    "movq %%r10, %q2\n"
-    "movq $0, %%r10\n"
-    /* (r8,r9,r10) += l3 */
-    "addq 24(%%rsi), %%r8\n"
-    "adcq $0, %%r9\n"
-    "adcq $0, %%r10\n"
-    /* (r8,r9,r10) += n3 * c0 */
-    "movq %8, %%rax\n"
-    "mulq %%r14\n"
-    "addq %%rax, %%r8\n"
-    "adcq %%rdx, %%r9\n"
-    "adcq $0, %%r10\n"
-    /* (r8,r9,r10) += n2 * c1 */
-    "movq %9, %%rax\n"
-    "mulq %%r13\n"
-    "addq %%rax, %%r8\n"
-    "adcq %%rdx, %%r9\n"
-    "adcq $0, %%r10\n"
-    /* (r8,r9,r10) += n1 */
-    "addq %%r12, %%r8\n"
-    "adcq $0, %%r9\n"
-    "adcq $0, %%r10\n"
-    /* extract m3 */
-    "movq %%r8, %q3\n"
-    "movq $0, %%r8\n"
-    /* (r9,r10,r8) += n3 * c1 */
-    "movq %9, %%rax\n"
-    "mulq %%r14\n"
-    "addq %%rax, %%r9\n"
-    "adcq %%rdx, %%r10\n"
-    "adcq $0, %%r8\n"
-    /* (r9,r10,r8) += n2 */
-    "addq %%r13, %%r9\n"
-    "adcq $0, %%r10\n"
-    "adcq $0, %%r8\n"
-    /* extract m4 */
-    "movq %%r9, %q4\n"
-    /* (r10,r8) += n3 */
-    "addq %%r14, %%r10\n"
-    "adcq $0, %%r8\n"
-    /* extract m5 */
-    "movq %%r10, %q5\n"
-    /* extract m6 */
-    "movq %%r8, %q6\n"
-    : "=g"(m0), "=g"(m1), "=g"(m2), "=g"(m3), "=g"(m4), "=g"(m5), "=g"(m6)
-    : "S"(l), "n"(SECP256K1_N_C_0), "n"(SECP256K1_N_C_1)
-    : "rax", "rdx", "r8", "r9", "r10", "r11", "r12", "r13", "r14", "cc");
+    if (secp256k1_cpu_has(SECP256K1_CPU_BMI2 | SECP256K1_CPU_ADX)) {
+        /* Reduce 512 bits into 385, summing the rows of n[0..3] * c with two carry chains. */
+        __asm__ __volatile__(
+        /* (r8,r9,r10,r11,r12) = n[0..3] * c0 */
+        "movq %8, %%rdx\n"
+        "mulxq 32(%%rsi), %%r8, %%r9\n"
+        "mulxq 40(%%rsi), %%rax, %%r10\n"
+        "addq %%rax, %%r9\n"
+        "mulxq 48(%%rsi), %%rax, %%r11\n"
+        "adcq %%rax, %%r10\n"
+        "mulxq 56(%%rsi), %%rax, %%r12\n"
+        "adcq %%rax, %%r11\n"
+        "adcq $0, %%r12\n"
+        /* (r9,r10,r11,r12,r13) += n[0..3] * c1 (xorl clears CF and OF) */
+        "movq %9, %%rdx\n"
+        "xorl %%r13d, %%r13d\n"
+        "mulxq 32(%%rsi), %%rax, %%rbx\n"
+        "adcxq %%rax, %%r9\n"
+        "adoxq %%rbx, %%r10\n"
+        "mulxq 40(%%rsi), %%rax, %%rbx\n"
+        "adcxq %%rax, %%r10\n"
+        "adoxq %%rbx, %%r11\n"
+        "mulxq 48(%%rsi), %%rax, %%rbx\n"
+        "adcxq %%rax, %%r11\n"
+        "adoxq %%rbx, %%r12\n"
+        "mulxq 56(%%rsi), %%rax, %%rbx\n"
+        "adcxq %%rax, %%r12\n"
+        "adoxq %%rbx, %%r13\n"
+        "movl $0, %%eax\n"
+        "adcxq %%rax, %%r13\n"
+        /* (r8,r9,r10,r11,r12,r13,r14) += l[0..3] + (n[0..3] << 128) */
+        "xorl %%r14d, %%r14d\n"
+        "adcxq 0(%%rsi), %%r8\n"
+        "adcxq 8(%%rsi), %%r9\n"
+        "adoxq 32(%%rsi), %%r10\n"
+        "adcxq 16(%%rsi), %%r10\n"
+        "adoxq 40(%%rsi), %%r11\n"
+        "adcxq 24(%%rsi), %%r11\n"
+        "adoxq 48(%%rsi), %%r12\n"
+        "adcxq %%rax, %%r12\n"
+        "adoxq 56(%%rsi), %%r13\n"
+        "adcxq %%rax, %%r13\n"
+        "adoxq %%rax, %%r14\n"
+        "adcxq %%rax, %%r14\n"
+        /* extract m0..m6 */
+        "movq %%r8, %q0\n"
+        "movq %%r9, %q1\n"
+        "movq %%r10, %q2\n"
+        "movq %%r11, %q3\n"
+        "movq %%r12, %q4\n"
+        "movq %%r13, %q5\n"
+        "movq %%r14, %q6\n"
+        : "=g"(m0), "=g"(m1), "=g"(m2), "=g"(m3), "=g"(m4), "=g"(m5), "=g"(m6)
+        : "S"(l), "n"(SECP256K1_N_C_0), "n"(SECP256K1_N_C_1)
+        : "rax", "rbx", "rdx", "r8", "r9", "r10", "r11", "r12", "r13", "r14", "cc");
+    } else {
+        __asm__ __volatile__(
+        /* Preload. */
+        "movq 32(%%rsi), %%r11\n"
+        "movq 40(%%rsi), %%r12\n"
+        "movq 48(%%rsi), %%r13\n"
+        "movq 56(%%rsi), %%r14\n"
+        /* Initialize r8,r9,r10 */
+        "movq 0(%%rsi), %%r8\n"
+        "movq $0, %%r9\n"
+        "movq $0, %%r10\n"
+        /* (r8,r9) += n0 * c0 */
+        "movq %8, %%rax\n"
+        "mulq %%r11\n"
+        "addq %%rax, %%r8\n"
+        "adcq %%rdx, %%r9\n"
+        /* extract m0 */
+        "movq %%r8, %q0\n"
+        "movq $0, %%r8\n"
+        /* (r9,r10) += l1 */
+        "addq 8(%%rsi), %%r9\n"
+        "adcq $0, %%r10\n"
+        /* (r9,r10,r8) += n1 * c0 */
+        "movq %8, %%rax\n"
+        "mulq %%r12\n"
+        "addq %%rax, %%r9\n"
+        "adcq %%rdx, %%r10\n"
+        "adcq $0, %%r8\n"
+        /* (r9,r10,r8) += n0 * c1 */
+        "movq %9, %%rax\n"
+        "mulq %%r11\n"
+        "addq %%rax, %%r9\n"
+        "adcq %%rdx, %%r10\n"
+        "adcq $0, %%r8\n"
+        /* extract m1 */
+        "movq %%r9, %q1\n"
+        "movq $0, %%r9\n"
+        /* (r10,r8,r9) += l2 */
+        "addq 16(%%rsi), %%r10\n"
+        "adcq $0, %%r8\n"
+        "adcq $0, %%r9\n"
+        /* (r10,r8,r9) += n2 * c0 */
+        "movq %8, %%rax\n"
+        "mulq %%r13\n"
+        "addq %%rax, %%r10\n"
+        "adcq %%rdx, %%r8\n"
+        "adcq $0, %%r9\n"
+        /* (r10,r8,r9) += n1 * c1 */
+        "movq %9, %%rax\n"
+        "mulq %%r12\n"
+        "addq %%rax, %%r10\n"
+        "adcq %%rdx, %%r8\n"
+        "adcq $0, %%r9\n"
+        /* (r10,r8,r9) += n0 */
+        "addq %%r11, %%r10\n"
+        "adcq $0, %%r8\n"
+        "adcq $0, %%r9\n"
+        /* extract m2 */
+        "movq %%r10, %q2\n"
+        "movq $0, %%r10\n"
+        /* (r8,r9,r10) += l3 */
+        "addq 24(%%rsi), %%r8\n"
+        "adcq $0, %%r9\n"
+        "adcq $0, %%r10\n"
+        /* (r8,r9,r10) += n3 * c0 */
+        "movq %8, %%rax\n"
+        "mulq %%r14\n"
+        "addq %%rax, %%r8\n"
+        "adcq %%rdx, %%r9\n"
+        "adcq $0, %%r10\n"
+        /* (r8,r9,r10) += n2 * c1 */
+        "movq %9, %%rax\n"
+        "mulq %%r13\n"
+        "addq %%rax, %%r8\n"
+        "adcq %%rdx, %%r9\n"
+        "adcq $0, %%r10\n"
+        /* (r8,r9,r10) += n1 */
+        "addq %%r12, %%r8\n"
+        "adcq $0, %%r9\n"
+        "adcq $0, %%r10\n"
+        /* extract m3 */
+        "movq %%r8, %q3\n"
+        "movq $0, %%r8\n"
+        /* (r9,r10,r8) += n3 * c1 */
+        "movq %9, %%rax\n"
+        "mulq %%r14\n"
+        "addq %%rax, %%r9\n"
+        "adcq %%rdx, %%r10\n"
+        "adcq $0, %%r8\n"
+        /* (r9,r10,r8) += n2 */
+        "addq %%r13, %%r9\n"
+        "adcq $0, %%r10\n"
+        "adcq $0, %%r8\n"
+        /* extract m4 */
+        "movq %%r9, %q4\n"
+        /* (r10,r8) += n3 */
+        "addq %%r14, %%r10\n"
+        "adcq $0, %%r8\n"
+        /* extract m5 */
+        "movq %%r10, %q5\n"
+        /* extract m6 */
+        "movq %%r8, %q6\n"
+        : "=g"(m0), "=g"(m1), "=g"(m2), "=g"(m3), "=g"(m4), "=g"(m5), "=g"(m6)
+        : "S"(l), "n"(SECP256K1_N_C_0), "n"(SECP256K1_N_C_1)
+        : "rax", "rdx", "r8", "r9", "r10", "r11", "r12", "r13", "r14", "cc");
+    }
 
     /* Reduce 385 bits into 258. */
     __asm__ __volatile__(
@@ -576,9 +639,98 @@ static void secp256k1_scalar_reduce_512(secp256k1_scalar *r, const uint64_t *l)
     secp256k1_scalar_reduce(r, c + secp256k1_scalar_check_overflow(r));
 }
 
+#ifdef USE_ASM_X86_64
+/* Variant of the assembly in secp256k1_scalar_mul_512 for CPUs with BMI2 and ADX. Each row
+ * a[i] * b[0..3] is added to the accumulator with two independent carry chains: adcx for the low
+ * halves of the products and adox for the high halves. */
+static void secp256k1_scalar_mul_512_mulx(uint64_t l[8], const secp256k1_scalar *a, const secp256k1_scalar *b) {
+    __asm__ __volatile__(
+    /* (r8,r9,r10,r11,r12) = a0 * b[0..3] */
+    "movq 0(%%rdi), %%rdx\n"
+    "mulxq 0(%%rcx), %%r8, %%r9\n"
+    "mulxq 8(%%rcx), %%rax, %%r10\n"
+    "addq %%rax, %%r9\n"
+    "mulxq 16(%%rcx), %%rax, %%r11\n"
+    "adcq %%rax, %%r10\n"
+    "mulxq 24(%%rcx), %%rax, %%r12\n"
+    "adcq %%rax, %%r11\n"
+    "adcq $0, %%r12\n"
+    /* Extract l0 */
+    "movq %%r8, 0(%%rsi)\n"
+    /* (r9,r10,r11,r12,r13) += a1 * b[0..3] (xorl clears CF and OF) */
+    "movq 8(%%rdi), %%rdx\n"
+    "xorl %%r13d, %%r13d\n"
+    "mulxq 0(%%rcx), %%rax, %%rbx\n"
+    "adcxq %%rax, %%r9\n"
+    "adoxq %%rbx, %%r10\n"
+    "mulxq 8(%%rcx), %%rax, %%rbx\n"
+    "adcxq %%rax, %%r10\n"
+    "adoxq %%rbx, %%r11\n"
+    "mulxq 16(%%rcx), %%rax, %%rbx\n"
+    "adcxq %%rax, %%r11\n"
+    "adoxq %%rbx, %%r12\n"
+    "mulxq 24(%%rcx), %%rax, %%rbx\n"
+    "adcxq %%rax, %%r12\n"
+    "adoxq %%rbx, %%r13\n"
+    "movl $0, %%eax\n"
+    "adcxq %%rax, %%r13\n"
+    /* Extract l1 */
+    "movq %%r9, 8(%%rsi)\n"
+    /* (r10,r11,r12,r13,r8) += a2 * b[0..3] */
+    "movq 16(%%rdi), %%rdx\n"
+    "xorl %%r8d, %%r8d\n"
+    "mulxq 0(%%rcx), %%rax, %%rbx\n"
+    "adcxq %%rax, %%r10\n"
+    "adoxq %%rbx, %%r11\n"
+    "mulxq 8(%%rcx), %%rax, %%rbx\n"
+    "adcxq %%rax, %%r11\n"
+    "adoxq %%rbx, %%r12\n"
+    "mulxq 16(%%rcx), %%rax, %%rbx\n"
+    "adcxq %%rax, %%r12\n"
+    "adoxq %%rbx, %%r13\n"
+    "mulxq 24(%%rcx), %%rax, %%rbx\n"
+    "adcxq %%rax, %%r13\n"
+    "adoxq %%rbx, %%r8\n"
+    "movl $0, %%eax\n"
+    "adcxq %%rax, %%r8\n"
+    /* Extract l2 */
+    "movq %%r10, 16(%%rsi)\n"
+    /* (r11,r12,r13,r8,r9) += a3 * b[0..3] */
+    "movq 24(%%rdi), %%rdx\n"
+    "xorl %%r9d, %%r9d\n"
+    "mulxq 0(%%rcx), %%rax, %%rbx\n"
+    "adcxq %%rax, %%r11\n"
+    "adoxq %%rbx, %%r12\n"
+    "mulxq 8(%%rcx), %%rax, %%rbx\n"
+    "adcxq %%rax, %%r12\n"
+    "adoxq %%rbx, %%r13\n"
+    "mulxq 16(%%rcx), %%rax, %%rbx\n"
+    "adcxq %%rax, %%r13\n"
+    "adoxq %%rbx, %%r8\n"
+    "mulxq 24(%%rcx), %%rax, %%rbx\n"
+    "adcxq %%rax, %%r8\n"
+    "adoxq %%rbx, %%r9\n"
+    "movl $0, %%eax\n"
+    "adcxq %%rax, %%r9\n"
+    /* Extract l3..l7 */
+    "movq %%r11, 24(%%rsi)\n"
+    "movq %%r12, 32(%%rsi)\n"
+    "movq %%r13, 40(%%rsi)\n"
+    "movq %%r8, 48(%%rsi)\n"
+    "movq %%r9, 56(%%rsi)\n"
+    :
+    : "S"(l), "D"(a->d), "c"(b->d)
+    : "rax", "rbx", "rdx", "r8", "r9", "r10", "r11", "r12", "r13", "cc", "memory");
+}
+#endif
+
 static void secp256k1_scalar_mul_512(uint64_t l[8], const secp256k1_scalar *a, const secp256k1_scalar *b) {
 #ifdef USE_ASM_X86_64
     const uint64_t *pb = b->d;
+    if (secp256k1_cpu_has(SECP256K1_CPU_BMI2 | SECP256K1_CPU_ADX)) {
+        secp256k1_scalar_mul_512_mulx(l, a, b);
+        return;
+    }
     __asm__ __volatile__(
     /* Preload */
     "movq 0(%%rdi), %%r15\n"
@@ -946,4 +1098,71 @@ SECP256K1_INLINE static void secp256k1_scalar_mul_shift_var(secp256k1_scalar *r,
     secp256k1_scalar_cadd_bit(r, 0, (l[(shift - 1) >> 6] >> ((shift - 1) & 0x3f)) & 1);
 }
 
+static void secp256k1_scalar_from_signed62(secp256k1_scalar *r, const secp256k1_modinv64_signed62 *a) {
+    const uint64_t a0 = a->v[0], a1 = a->v[1], a2 = a->v[2], a3 = a->v[3], a4 = a->v[4];
+
+    /* The output from secp256k1_modinv64{_var} should be normalized to range [0,modulus), and
+     * have limbs in [0,2^62). The modulus is < 2^256, so the top limb must be below 2^(256-62*4).
+     */
+    VERIFY_CHECK(a0 >> 62 == 0);
+    VERIFY_CHECK(a1 >> 62 == 0);
+    VERIFY_CHECK(a2 >> 62 == 0);
+    VERIFY_CHECK(a3 >> 62 == 0);
+    VERIFY_CHECK(a4 >> 8 == 0);
+
+    r->d[0] = a0      | a1 << 62;
+    r->d[1] = a1 >> 2 | a2 << 60;
+    r->d[2] = a2 >> 4 | a3 << 58;
+    r->d[3] = a3 >> 6 | a4 << 56;
+
+    VERIFY_CHECK(secp256k1_scalar_check_overflow(r) == 0);
+}
+
+static void secp256k1_scalar_to_signed62(secp256k1_modinv64_signed62 *r, const secp256k1_scalar *a) {
+    const uint64_t M62 = UINT64_MAX >> 2;
+    const uint64_t a0 = a->d[0], a1 = a->d[1], a2 = a->d[2], a3 = a->d[3];
+
+    VERIFY_CHECK(secp256k1_scalar_check_overflow(a) == 0);
+
+    r->v[0] =  a0                   & M62;
+    r->v[1] = (a0 >> 62 | a1 <<  2) & M62;
+    r->v[2] = (a1 >> 60 | a2 <<  4) & M62;
+    r->v[3] = (a2 >> 58 | a3 <<  6) & M62;
+    r->v[4] =  a3 >> 56;
+}
+
+/* The group order n, and n^-1 mod 2^62, for secp256k1_modinv64. */
+static const secp256k1_modinv64_modinfo secp256k1_const_modinfo_scalar = {
+    {{-0x2DA1732FC9BEBFLL, -0x15448C6542DD7F11LL, -0x14LL, 0, 256}},
+    0x34F20099AA774EC1LL
+};
+
+static void secp256k1_scalar_inverse(secp256k1_scalar *r, const secp256k1_scalar *x) {
+    secp256k1_modinv64_signed62 s;
+#ifdef VERIFY
+    int zero_in = secp256k1_scalar_is_zero(x);
+#endif
+    secp256k1_scalar_to_signed62(&s, x);
+    secp256k1_modinv64(&s, &secp256k1_const_modinfo_scalar);
+    secp256k1_scalar_from_signed62(r, &s);
+
+#ifdef VERIFY
+    VERIFY_CHECK(secp256k1_scalar_is_zero(r) == zero_in);
+#endif
+}
+
+static void secp256k1_scalar_inverse_var(secp256k1_scalar *r, const secp256k1_scalar *x) {
+    secp256k1_modinv64_signed62 s;
+#ifdef VERIFY
+    int zero_in = secp256k1_scalar_is_zero(x);
+#endif
+    secp256k1_scalar_to_signed62(&s, x);
+    secp256k1_modinv64_var(&s, &secp256k1_const_modinfo_scalar);
+    secp256k1_scalar_from_signed62(r, &s);
+
+#ifdef VERIFY
+    VERIFY_CHECK(secp256k1_scalar_is_zero(r) == zero_in);
+#endif
+}
+
 #endif
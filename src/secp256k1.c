@@ -7,6 +7,7 @@
 #include "include/secp256k1.h"
 
 #include "util.h"
+#include "cpu_impl.h"
 #include "num_impl.h"
 #include "field_impl.h"
 #include "scalar_impl.h"
@@ -47,18 +48,103 @@ static const secp256k1_callback default_error_callback = {
     NULL
 };
 
+static void default_executor_parallel_for(void *data, secp256k1_executor_task task, void *arg, size_t n) {
+    (void)data;
+    task(arg, 0, n);
+}
+
+static void default_executor_join(void *data) {
+    (void)data;
+}
+
+static const secp256k1_executor default_executor = {
+    default_executor_parallel_for,
+    default_executor_join,
+    NULL
+};
+
 
 struct secp256k1_context_struct {
     secp256k1_ecmult_context ecmult_ctx;
     secp256k1_ecmult_gen_context ecmult_gen_ctx;
     secp256k1_callback illegal_callback;
     secp256k1_callback error_callback;
+    secp256k1_executor executor;
 };
 
+/* Process the items 0..n-1 of a batch operation through the context's executor,
+ * and wait for all of them. A single item is processed on the calling thread. */
+static void secp256k1_executor_run(const secp256k1_context* ctx, secp256k1_executor_task task, void *arg, size_t n) {
+    if (n == 0) {
+        return;
+    }
+    if (n == 1) {
+        task(arg, 0, 1);
+        return;
+    }
+    ctx->executor.parallel_for(ctx->executor.data, task, arg, n);
+    ctx->executor.join(ctx->executor.data);
+}
+
+/* Process the items begin..end-1 of a batch operation, and return how many
+ * of them succeeded. */
+typedef size_t (*secp256k1_batch_fn)(void *arg, size_t begin, size_t end);
+
+typedef struct {
+    secp256k1_batch_fn fn;
+    void *arg;
+    size_t n;
+    size_t chunk;
+    size_t *counts;
+} secp256k1_batch_job;
+
+static void secp256k1_batch_task(void *arg, size_t begin, size_t end) {
+    const secp256k1_batch_job *job = (const secp256k1_batch_job *)arg;
+    size_t c;
+
+    for (c = begin; c < end; c++) {
+        size_t stop = (c + 1) * job->chunk;
+        if (stop > job->n) {
+            stop = job->n;
+        }
+        job->counts[c] = job->fn(job->arg, c * job->chunk, stop);
+    }
+}
+
+/* Run fn over the items 0..n-1 in chunks of chunk items (the last one may be
+ * shorter), which are spread over the context's executor. Every chunk starts
+ * at a multiple of chunk. Returns the sum of the counts fn returned. */
+static size_t secp256k1_batch_run(const secp256k1_context* ctx, size_t n, size_t chunk, secp256k1_batch_fn fn, void *arg) {
+    secp256k1_batch_job job;
+    size_t nchunks;
+    size_t c;
+    size_t count = 0;
+
+    if (n == 0) {
+        return 0;
+    }
+    nchunks = (n + chunk - 1) / chunk;
+    if (nchunks == 1) {
+        return fn(arg, 0, n);
+    }
+    job.fn = fn;
+    job.arg = arg;
+    job.n = n;
+    job.chunk = chunk;
+    job.counts = (size_t *)checked_malloc(&ctx->error_callback, nchunks * sizeof(size_t));
+    secp256k1_executor_run(ctx, secp256k1_batch_task, &job, nchunks);
+    for (c = 0; c < nchunks; c++) {
+        count += job.counts[c];
+    }
+    free(job.counts);
+    return count;
+}
+
 secp256k1_context* secp256k1_context_create(unsigned int flags) {
     secp256k1_context* ret = (secp256k1_context*)checked_malloc(&default_error_callback, sizeof(secp256k1_context));
     ret->illegal_callback = default_illegal_callback;
     ret->error_callback = default_error_callback;
+    ret->executor = default_executor;
 
     if (EXPECT((flags & SECP256K1_FLAGS_TYPE_MASK) != SECP256K1_FLAGS_TYPE_CONTEXT, 0)) {
             secp256k1_callback_call(&ret->illegal_callback,
@@ -67,6 +153,7 @@ secp256k1_context* secp256k1_context_create(unsigned int flags) {
             return NULL;
     }
 
+    secp256k1_cpu_detect();
     secp256k1_ecmult_context_init(&ret->ecmult_ctx);
     secp256k1_ecmult_gen_context_init(&ret->ecmult_gen_ctx);
 
@@ -84,6 +171,7 @@ secp256k1_context* secp256k1_context_clone(const secp256k1_context* ctx) {
     secp256k1_context* ret = (secp256k1_context*)checked_malloc(&ctx->error_callback, sizeof(secp256k1_context));
     ret->illegal_callback = ctx->illegal_callback;
     ret->error_callback = ctx->error_callback;
+    ret->executor = ctx->executor;
     secp256k1_ecmult_context_clone(&ret->ecmult_ctx, &ctx->ecmult_ctx, &ctx->error_callback);
     secp256k1_ecmult_gen_context_clone(&ret->ecmult_gen_ctx, &ctx->ecmult_gen_ctx, &ctx->error_callback);
     return ret;
@@ -114,6 +202,13 @@ void secp256k1_context_set_error_callback(secp256k1_context* ctx, void (*fun)(co
     ctx->error_callback.data = data;
 }
 
+void secp256k1_context_set_executor(secp256k1_context* ctx, const secp256k1_executor* executor) {
+    if (executor == NULL) {
+        executor = &default_executor;
+    }
+    ctx->executor = *executor;
+}
+
 static int secp256k1_pubkey_load(const secp256k1_context* ctx, secp256k1_ge* ge, const secp256k1_pubkey* pubkey) {
     if (sizeof(secp256k1_ge_storage) == 64) {
         /* When the secp256k1_ge_storage type is exactly 64 byte, use its
@@ -187,6 +282,101 @@ int secp256k1_ec_pubkey_serialize(const secp256k1_context* ctx, unsigned char *o
     return ret;
 }
 
+/* Number of public keys parsed or serialized per executor item. */
+#define EC_PUBKEY_BATCH_CHUNK 256
+
+typedef struct {
+    secp256k1_pubkey *pubkeys;
+    unsigned char *valid;
+    const unsigned char *input;
+    size_t inputlen;
+} secp256k1_ec_pubkey_parse_batch_job;
+
+static size_t secp256k1_ec_pubkey_parse_batch_fn(void *arg, size_t begin, size_t end) {
+    const secp256k1_ec_pubkey_parse_batch_job *job = (const secp256k1_ec_pubkey_parse_batch_job *)arg;
+    secp256k1_ge Q;
+    size_t i;
+    size_t count = 0;
+
+    for (i = begin; i < end; i++) {
+        /* Public keys carry no secrets, so there is no need to clear Q
+         * between items. */
+        if (secp256k1_eckey_pubkey_parse(&Q, &job->input[i * job->inputlen], job->inputlen)) {
+            secp256k1_pubkey_save(&job->pubkeys[i], &Q);
+            if (job->valid != NULL) {
+                job->valid[i] = 1;
+            }
+            count++;
+        }
+    }
+    return count;
+}
+
+size_t secp256k1_ec_pubkey_parse_batch(const secp256k1_context* ctx, secp256k1_pubkey *pubkeys, unsigned char *valid, const unsigned char *input, size_t inputlen, size_t n) {
+    secp256k1_ec_pubkey_parse_batch_job job;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(pubkeys != NULL);
+    memset(pubkeys, 0, n * sizeof(*pubkeys));
+    if (valid != NULL) {
+        memset(valid, 0, n);
+    }
+    ARG_CHECK(input != NULL);
+
+    job.pubkeys = pubkeys;
+    job.valid = valid;
+    job.input = input;
+    job.inputlen = inputlen;
+    return secp256k1_batch_run(ctx, n, EC_PUBKEY_BATCH_CHUNK, secp256k1_ec_pubkey_parse_batch_fn, &job);
+}
+
+typedef struct {
+    const secp256k1_context *ctx;
+    unsigned char *output;
+    const secp256k1_pubkey *pubkeys;
+    unsigned int flags;
+} secp256k1_ec_pubkey_serialize_batch_job;
+
+/* Returns the number of keys serialized, stopping at the first one that fails to load. */
+static size_t secp256k1_ec_pubkey_serialize_batch_fn(void *arg, size_t begin, size_t end) {
+    const secp256k1_ec_pubkey_serialize_batch_job *job = (const secp256k1_ec_pubkey_serialize_batch_job *)arg;
+    size_t outlen = (job->flags & SECP256K1_FLAGS_BIT_COMPRESSION) ? 33 : 65;
+    secp256k1_ge Q;
+    size_t i;
+    size_t len;
+
+    for (i = begin; i < end; i++) {
+        if (!secp256k1_pubkey_load(job->ctx, &Q, &job->pubkeys[i])) {
+            break;
+        }
+        secp256k1_eckey_pubkey_serialize(&Q, &job->output[i * outlen], &len, job->flags & SECP256K1_FLAGS_BIT_COMPRESSION);
+    }
+    return i - begin;
+}
+
+int secp256k1_ec_pubkey_serialize_batch(const secp256k1_context* ctx, unsigned char *output, const secp256k1_pubkey *pubkeys, size_t n, unsigned int flags) {
+    secp256k1_ec_pubkey_serialize_batch_job job;
+    size_t outlen;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(output != NULL);
+    ARG_CHECK(pubkeys != NULL);
+    ARG_CHECK((flags & SECP256K1_FLAGS_TYPE_MASK) == SECP256K1_FLAGS_TYPE_COMPRESSION);
+    outlen = (flags & SECP256K1_FLAGS_BIT_COMPRESSION) ? 33 : 65;
+    memset(output, 0, n * outlen);
+
+    job.ctx = ctx;
+    job.output = output;
+    job.pubkeys = pubkeys;
+    job.flags = flags;
+    if (secp256k1_batch_run(ctx, n, EC_PUBKEY_BATCH_CHUNK, secp256k1_ec_pubkey_serialize_batch_fn, &job) != n) {
+        /* Do not leave a partial result behind. */
+        memset(output, 0, n * outlen);
+        return 0;
+    }
+    return 1;
+}
+
 static void secp256k1_ecdsa_signature_load(const secp256k1_context* ctx, secp256k1_scalar* r, secp256k1_scalar* s, const secp256k1_ecdsa_signature* sig) {
     (void)ctx;
     if (sizeof(secp256k1_scalar) == 32) {
@@ -248,6 +438,62 @@ int secp256k1_ecdsa_signature_parse_compact(const secp256k1_context* ctx, secp25
     return ret;
 }
 
+size_t secp256k1_ecdsa_signature_parse_compact_batch(const secp256k1_context* ctx, secp256k1_ecdsa_signature* sigs, unsigned char *valid, const unsigned char *input64s, size_t n) {
+    secp256k1_scalar r, s;
+    size_t i;
+    size_t count = 0;
+    int overflow;
+
+    (void)ctx;
+    ARG_CHECK(sigs != NULL);
+    memset(sigs, 0, n * sizeof(*sigs));
+    if (valid != NULL) {
+        memset(valid, 0, n);
+    }
+    ARG_CHECK(input64s != NULL);
+    for (i = 0; i < n; i++) {
+        int ret = 1;
+        secp256k1_scalar_set_b32(&r, &input64s[i * 64], &overflow);
+        ret &= !overflow;
+        secp256k1_scalar_set_b32(&s, &input64s[i * 64 + 32], &overflow);
+        ret &= !overflow;
+        if (ret) {
+            secp256k1_ecdsa_signature_save(&sigs[i], &r, &s);
+            if (valid != NULL) {
+                valid[i] = 1;
+            }
+            count++;
+        }
+    }
+    return count;
+}
+
+size_t secp256k1_ecdsa_signature_parse_der_batch(const secp256k1_context* ctx, secp256k1_ecdsa_signature* sigs, unsigned char *valid, const unsigned char *input, const size_t *offsets, const size_t *lengths, size_t n) {
+    secp256k1_scalar r, s;
+    size_t i;
+    size_t count = 0;
+
+    (void)ctx;
+    ARG_CHECK(sigs != NULL);
+    memset(sigs, 0, n * sizeof(*sigs));
+    if (valid != NULL) {
+        memset(valid, 0, n);
+    }
+    ARG_CHECK(input != NULL);
+    ARG_CHECK(offsets != NULL);
+    ARG_CHECK(lengths != NULL);
+    for (i = 0; i < n; i++) {
+        if (secp256k1_ecdsa_sig_parse(&r, &s, &input[offsets[i]], lengths[i])) {
+            secp256k1_ecdsa_signature_save(&sigs[i], &r, &s);
+            if (valid != NULL) {
+                valid[i] = 1;
+            }
+            count++;
+        }
+    }
+    return count;
+}
+
 int secp256k1_ecdsa_signature_serialize_der(const secp256k1_context* ctx, unsigned char *output, size_t *outputlen, const secp256k1_ecdsa_signature* sig) {
     secp256k1_scalar r, s;
 
@@ -309,6 +555,196 @@ int secp256k1_ecdsa_verify(const secp256k1_context* ctx, const secp256k1_ecdsa_s
             secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &r, &s, &q, &m));
 }
 
+static int secp256k1_ecdsa_verify_der_one(const secp256k1_context* ctx, const unsigned char *sig, size_t siglen, const unsigned char *msg32, const unsigned char *pubkey, size_t pubkeylen, int normalize) {
+    secp256k1_ge q;
+    secp256k1_scalar r, s;
+    secp256k1_scalar m;
+
+    if (!secp256k1_ecdsa_sig_parse(&r, &s, sig, siglen)) {
+        return 0;
+    }
+    if (secp256k1_scalar_is_high(&s)) {
+        if (!normalize) {
+            return 0;
+        }
+        secp256k1_scalar_negate(&s, &s);
+    }
+    if (!secp256k1_eckey_pubkey_parse(&q, pubkey, pubkeylen)) {
+        return 0;
+    }
+    secp256k1_scalar_set_b32(&m, msg32, NULL);
+    return secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &r, &s, &q, &m);
+}
+
+int secp256k1_ecdsa_verify_der(const secp256k1_context* ctx, const unsigned char *sig, size_t siglen, const unsigned char *msg32, const unsigned char *pubkey, size_t pubkeylen, int normalize) {
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(sig != NULL);
+    ARG_CHECK(msg32 != NULL);
+    ARG_CHECK(pubkey != NULL);
+
+    return secp256k1_ecdsa_verify_der_one(ctx, sig, siglen, msg32, pubkey, pubkeylen, normalize);
+}
+
+/* Number of signatures verified per item handed to the executor. */
+#define ECDSA_VERIFY_DER_BATCH 64
+
+typedef struct {
+    const secp256k1_context *ctx;
+    unsigned char *valid;
+    const unsigned char *input;
+    const size_t *sig_offsets;
+    const size_t *sig_lengths;
+    const size_t *pubkey_offsets;
+    const size_t *pubkey_lengths;
+    const unsigned char *msg32s;
+    int normalize;
+} secp256k1_ecdsa_verify_der_batch_job;
+
+static size_t secp256k1_ecdsa_verify_der_batch_fn(void *arg, size_t begin, size_t end) {
+    const secp256k1_ecdsa_verify_der_batch_job *job = (const secp256k1_ecdsa_verify_der_batch_job *)arg;
+    size_t i;
+    size_t count = 0;
+
+    for (i = begin; i < end; i++) {
+        if (secp256k1_ecdsa_verify_der_one(job->ctx, &job->input[job->sig_offsets[i]], job->sig_lengths[i], &job->msg32s[i * 32],
+                                           &job->input[job->pubkey_offsets[i]], job->pubkey_lengths[i], job->normalize)) {
+            if (job->valid != NULL) {
+                job->valid[i] = 1;
+            }
+            count++;
+        }
+    }
+    return count;
+}
+
+size_t secp256k1_ecdsa_verify_der_batch(const secp256k1_context* ctx, unsigned char *valid, const unsigned char *input, const size_t *sig_offsets, const size_t *sig_lengths, const size_t *pubkey_offsets, const size_t *pubkey_lengths, const unsigned char *msg32s, size_t n, int normalize) {
+    secp256k1_ecdsa_verify_der_batch_job job;
+
+    VERIFY_CHECK(ctx != NULL);
+    if (valid != NULL) {
+        memset(valid, 0, n);
+    }
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(input != NULL);
+    ARG_CHECK(sig_offsets != NULL);
+    ARG_CHECK(sig_lengths != NULL);
+    ARG_CHECK(pubkey_offsets != NULL);
+    ARG_CHECK(pubkey_lengths != NULL);
+    ARG_CHECK(msg32s != NULL);
+
+    job.ctx = ctx;
+    job.valid = valid;
+    job.input = input;
+    job.sig_offsets = sig_offsets;
+    job.sig_lengths = sig_lengths;
+    job.pubkey_offsets = pubkey_offsets;
+    job.pubkey_lengths = pubkey_lengths;
+    job.msg32s = msg32s;
+    job.normalize = normalize;
+    return secp256k1_batch_run(ctx, n, ECDSA_VERIFY_DER_BATCH, secp256k1_ecdsa_verify_der_batch_fn, &job);
+}
+
+/* The steps of a verification, in order. */
+#define ECDSA_VERIFY_STEP_LOAD 0
+#define ECDSA_VERIFY_STEP_WNAF 1
+#define ECDSA_VERIFY_STEP_TABLE 2
+#define ECDSA_VERIFY_STEP_LOOP 3
+#define ECDSA_VERIFY_STEP_CHECK 4
+#define ECDSA_VERIFY_STEP_DONE 5
+
+struct secp256k1_ecdsa_verify_state_struct {
+    int step;
+    int result;
+    secp256k1_ecdsa_signature sig;
+    unsigned char msg32[32];
+    secp256k1_pubkey pubkey;
+    /* Filled in by the load step. */
+    secp256k1_scalar r, u1, u2;
+    secp256k1_gej pubkeyj;
+    secp256k1_ecmult_state ecmult;
+};
+
+secp256k1_ecdsa_verify_state* secp256k1_ecdsa_verify_state_create(const secp256k1_context* ctx) {
+    secp256k1_ecdsa_verify_state* ret;
+    VERIFY_CHECK(ctx != NULL);
+    ret = (secp256k1_ecdsa_verify_state*)checked_malloc(&ctx->error_callback, sizeof(secp256k1_ecdsa_verify_state));
+    ret->step = ECDSA_VERIFY_STEP_DONE;
+    ret->result = 0;
+    return ret;
+}
+
+void secp256k1_ecdsa_verify_state_destroy(secp256k1_ecdsa_verify_state* state) {
+    free(state);
+}
+
+int secp256k1_ecdsa_verify_start(const secp256k1_context* ctx, secp256k1_ecdsa_verify_state* state, const secp256k1_ecdsa_signature *sig, const unsigned char *msg32, const secp256k1_pubkey *pubkey) {
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(state != NULL);
+    ARG_CHECK(sig != NULL);
+    ARG_CHECK(msg32 != NULL);
+    ARG_CHECK(pubkey != NULL);
+
+    state->sig = *sig;
+    memcpy(state->msg32, msg32, 32);
+    state->pubkey = *pubkey;
+    state->step = ECDSA_VERIFY_STEP_LOAD;
+    state->result = 0;
+    return 1;
+}
+
+int secp256k1_ecdsa_verify_continue(const secp256k1_context* ctx, secp256k1_ecdsa_verify_state* state, int *result, unsigned int iterations) {
+    secp256k1_gej pr;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(state != NULL);
+    ARG_CHECK(result != NULL);
+    ARG_CHECK(iterations >= 1);
+
+    switch (state->step) {
+    case ECDSA_VERIFY_STEP_LOAD: {
+        /* The same checks as secp256k1_ecdsa_verify and secp256k1_ecdsa_sig_verify. */
+        secp256k1_scalar s, m, sn;
+        secp256k1_ge q;
+        secp256k1_scalar_set_b32(&m, state->msg32, NULL);
+        secp256k1_ecdsa_signature_load(ctx, &state->r, &s, &state->sig);
+        if (secp256k1_scalar_is_high(&s) || !secp256k1_pubkey_load(ctx, &q, &state->pubkey) ||
+            secp256k1_scalar_is_zero(&state->r) || secp256k1_scalar_is_zero(&s)) {
+            state->step = ECDSA_VERIFY_STEP_DONE;
+            break;
+        }
+        secp256k1_scalar_inverse_var(&sn, &s);
+        secp256k1_scalar_mul(&state->u1, &sn, &m);
+        secp256k1_scalar_mul(&state->u2, &sn, &state->r);
+        secp256k1_gej_set_ge(&state->pubkeyj, &q);
+        state->step = ECDSA_VERIFY_STEP_WNAF;
+        break;
+    }
+    case ECDSA_VERIFY_STEP_WNAF:
+        secp256k1_ecmult_state_init(&state->ecmult, &state->u2, &state->u1);
+        state->step = ECDSA_VERIFY_STEP_TABLE;
+        break;
+    case ECDSA_VERIFY_STEP_TABLE:
+        secp256k1_ecmult_state_table(&state->ecmult, &state->pubkeyj);
+        state->step = ECDSA_VERIFY_STEP_LOOP;
+        break;
+    case ECDSA_VERIFY_STEP_LOOP:
+        if (secp256k1_ecmult_state_run(&ctx->ecmult_ctx, &state->ecmult, iterations > 256 ? 256 : (int)iterations)) {
+            state->step = ECDSA_VERIFY_STEP_CHECK;
+        }
+        break;
+    case ECDSA_VERIFY_STEP_CHECK:
+        secp256k1_ecmult_state_finish(&state->ecmult, &pr);
+        state->result = secp256k1_ecdsa_sig_verify_r(&state->r, &pr);
+        state->step = ECDSA_VERIFY_STEP_DONE;
+        break;
+    }
+
+    *result = state->result;
+    return state->step == ECDSA_VERIFY_STEP_DONE;
+}
+
 static int nonce_function_rfc6979(unsigned char *nonce32, const unsigned char *msg32, const unsigned char *key32, const unsigned char *algo16, void *data, unsigned int counter) {
    unsigned char keydata[112];
    int keylen = 64;
@@ -427,6 +863,109 @@ int secp256k1_ec_pubkey_create(const secp256k1_context* ctx, secp256k1_pubkey *p
     return ret;
 }
 
+/* Number of consecutive range points brought to affine coordinates with a single inversion. */
+#define EC_PUBKEY_RANGE_BATCH 1024
+
+/* Number of range points per executor item, each of which starts with a full multiplication. */
+#define EC_PUBKEY_RANGE_CHUNK (4 * EC_PUBKEY_RANGE_BATCH)
+
+typedef struct {
+    const secp256k1_context *ctx;
+    unsigned char *output;
+    const secp256k1_scalar *sec;
+    unsigned int flags;
+} secp256k1_ec_pubkey_create_range_job;
+
+/* Compute the public keys begin..end-1 of the range. Only the first one is
+ * computed with a full multiplication. */
+static size_t secp256k1_ec_pubkey_create_range_fn(void *arg, size_t begin, size_t end) {
+    const secp256k1_ec_pubkey_create_range_job *job = (const secp256k1_ec_pubkey_create_range_job *)arg;
+    const secp256k1_context *ctx = job->ctx;
+    secp256k1_gej *pj;
+    secp256k1_ge *p;
+    secp256k1_fe *zr;
+    secp256k1_gej next;
+    secp256k1_scalar sec;
+    unsigned char offset32[32] = {0};
+    size_t outlen = (job->flags & SECP256K1_FLAGS_BIT_COMPRESSION) ? 33 : 65;
+    size_t batch = end - begin < EC_PUBKEY_RANGE_BATCH ? end - begin : EC_PUBKEY_RANGE_BATCH;
+    size_t done;
+    size_t i;
+    int ret;
+
+    pj = (secp256k1_gej *)checked_malloc(&ctx->error_callback, sizeof(secp256k1_gej) * batch);
+    p = (secp256k1_ge *)checked_malloc(&ctx->error_callback, sizeof(secp256k1_ge) * batch);
+    zr = (secp256k1_fe *)checked_malloc(&ctx->error_callback, sizeof(secp256k1_fe) * batch);
+
+    for (i = 0; i < sizeof(size_t); i++) {
+        offset32[31 - i] = (begin >> (8 * i)) & 0xFF;
+    }
+    secp256k1_scalar_set_b32(&sec, offset32, NULL);
+    secp256k1_scalar_add(&sec, &sec, job->sec);
+    secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &next, &sec);
+    secp256k1_scalar_clear(&sec);
+    for (done = begin; done < end; done += batch) {
+        if (batch > end - done) {
+            batch = end - done;
+        }
+        /* Walk the range in Jacobian coordinates, remembering the z-ratios between neighbours. */
+        pj[0] = next;
+        for (i = 1; i < batch; i++) {
+            secp256k1_gej_add_ge_var(&pj[i], &pj[i - 1], &secp256k1_ge_const_g, &zr[i]);
+        }
+        secp256k1_gej_add_ge_var(&next, &pj[batch - 1], &secp256k1_ge_const_g, NULL);
+        /* A single inversion converts the whole batch to affine coordinates. */
+        secp256k1_ge_set_table_gej_var(batch, p, pj, zr);
+        for (i = 0; i < batch; i++) {
+            size_t len;
+            ret = secp256k1_eckey_pubkey_serialize(&p[i], &job->output[(done + i) * outlen], &len, job->flags & SECP256K1_FLAGS_BIT_COMPRESSION);
+            (void)ret;
+            VERIFY_CHECK(ret && len == outlen);
+        }
+    }
+
+    free(zr);
+    free(p);
+    free(pj);
+    return end - begin;
+}
+
+int secp256k1_ec_pubkey_create_range(const secp256k1_context* ctx, unsigned char *output, const unsigned char *seckey, size_t n, unsigned int flags) {
+    secp256k1_ec_pubkey_create_range_job job;
+    secp256k1_scalar sec, last;
+    unsigned char span32[32] = {0};
+    size_t i;
+    int overflow;
+    int ret;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx));
+    ARG_CHECK(output != NULL);
+    ARG_CHECK(seckey != NULL);
+    ARG_CHECK(n >= 1);
+    ARG_CHECK((flags & SECP256K1_FLAGS_TYPE_MASK) == SECP256K1_FLAGS_TYPE_COMPRESSION);
+
+    secp256k1_scalar_set_b32(&sec, seckey, &overflow);
+    ret = (!overflow) & (!secp256k1_scalar_is_zero(&sec));
+    /* The last secret key seckey+n-1 must not reach the order, as the range would wrap through zero. */
+    for (i = 0; i < sizeof(size_t); i++) {
+        span32[31 - i] = ((n - 1) >> (8 * i)) & 0xFF;
+    }
+    secp256k1_scalar_set_b32(&last, span32, NULL);
+    ret &= !secp256k1_scalar_add(&last, &last, &sec);
+    if (!ret) {
+        secp256k1_scalar_clear(&sec);
+        return 0;
+    }
+
+    job.ctx = ctx;
+    job.output = output;
+    job.sec = &sec;
+    job.flags = flags;
+    secp256k1_batch_run(ctx, n, EC_PUBKEY_RANGE_CHUNK, secp256k1_ec_pubkey_create_range_fn, &job);
+    secp256k1_scalar_clear(&sec);
+    return 1;
+}
+
 int secp256k1_ec_privkey_tweak_add(const secp256k1_context* ctx, unsigned char *seckey, const unsigned char *tweak) {
     secp256k1_scalar term;
     secp256k1_scalar sec;
@@ -522,6 +1061,101 @@ int secp256k1_ec_pubkey_tweak_mul(const secp256k1_context* ctx, secp256k1_pubkey
     return ret;
 }
 
+struct secp256k1_point_table_struct {
+    /* A comb table for the point instead of G, with its own blinding. */
+    secp256k1_ecmult_gen_context gen;
+};
+
+secp256k1_point_table* secp256k1_point_table_create(const secp256k1_context* ctx, const secp256k1_pubkey *point, const unsigned char *seed32) {
+    secp256k1_point_table* ret;
+    secp256k1_ge p;
+
+    VERIFY_CHECK(ctx != NULL);
+    if (EXPECT(point == NULL, 0)) {
+        secp256k1_callback_call(&ctx->illegal_callback, "point != NULL");
+        return NULL;
+    }
+    if (!secp256k1_pubkey_load(ctx, &p, point)) {
+        return NULL;
+    }
+    ret = (secp256k1_point_table*)checked_malloc(&ctx->error_callback, sizeof(secp256k1_point_table));
+    ret->gen.prec = (secp256k1_ge_storage (*)[64][16])checked_malloc(&ctx->error_callback, sizeof(*ret->gen.prec));
+    secp256k1_ecmult_gen_prec_table_build(ret->gen.prec, &p, &ctx->error_callback);
+    secp256k1_ecmult_gen_blind_base(&ret->gen, &p, NULL);
+    if (seed32 != NULL) {
+        secp256k1_ecmult_gen_blind_base(&ret->gen, &p, seed32);
+    }
+    return ret;
+}
+
+void secp256k1_point_table_destroy(secp256k1_point_table* table) {
+    if (table != NULL) {
+        /* Not secp256k1_ecmult_gen_context_clear, as the table is always
+         * allocated, even with static precomputation. */
+        free(table->gen.prec);
+        secp256k1_scalar_clear(&table->gen.blind);
+        secp256k1_gej_clear(&table->gen.initial);
+        free(table);
+    }
+}
+
+size_t secp256k1_point_table_memory(const secp256k1_point_table* table) {
+    return sizeof(*table) + sizeof(*table->gen.prec);
+}
+
+int secp256k1_point_table_mul(const secp256k1_context* ctx, const secp256k1_point_table* table, secp256k1_pubkey *pubkey, const unsigned char *scalar) {
+    secp256k1_gej rj;
+    secp256k1_ge r;
+    secp256k1_scalar factor;
+    int overflow = 0;
+    int ret;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(table != NULL);
+    ARG_CHECK(pubkey != NULL);
+    memset(pubkey, 0, sizeof(*pubkey));
+    ARG_CHECK(scalar != NULL);
+
+    secp256k1_scalar_set_b32(&factor, scalar, &overflow);
+    ret = !overflow && !secp256k1_scalar_is_zero(&factor);
+    if (ret) {
+        secp256k1_ecmult_gen(&table->gen, &rj, &factor);
+        secp256k1_ge_set_gej(&r, &rj);
+        secp256k1_pubkey_save(pubkey, &r);
+        secp256k1_gej_clear(&rj);
+        secp256k1_ge_clear(&r);
+    }
+    secp256k1_scalar_clear(&factor);
+    return ret;
+}
+
+int secp256k1_point_table_mul_var(const secp256k1_context* ctx, const secp256k1_point_table* table, secp256k1_pubkey *pubkey, const unsigned char *scalar) {
+    secp256k1_gej rj;
+    secp256k1_ge r;
+    secp256k1_scalar factor;
+    int overflow = 0;
+    int j;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(table != NULL);
+    ARG_CHECK(pubkey != NULL);
+    memset(pubkey, 0, sizeof(*pubkey));
+    ARG_CHECK(scalar != NULL);
+
+    secp256k1_scalar_set_b32(&factor, scalar, &overflow);
+    if (overflow || secp256k1_scalar_is_zero(&factor)) {
+        return 0;
+    }
+    /* The nothing-up-my-sleeve offsets in the table sum to zero, so neither
+     * the blinding nor the constant-time lookups are needed here. */
+    secp256k1_gej_set_infinity(&rj);
+    for (j = 0; j < 64; j++) {
+        secp256k1_ge_from_storage(&r, &(*table->gen.prec)[j][secp256k1_scalar_get_bits(&factor, j * 4, 4)]);
+        secp256k1_gej_add_ge_var(&rj, &rj, &r, NULL);
+    }
+    secp256k1_ge_set_gej_var(&r, &rj);
+    secp256k1_pubkey_save(pubkey, &r);
+    return 1;
+}
+
 int secp256k1_context_randomize(secp256k1_context* ctx, const unsigned char *seed32) {
     VERIFY_CHECK(ctx != NULL);
     ARG_CHECK(secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx));
@@ -553,6 +1187,74 @@ int secp256k1_ec_pubkey_combine(const secp256k1_context* ctx, secp256k1_pubkey *
     return 1;
 }
 
+/* Number of public keys added up per partial sum of secp256k1_ec_pubkey_combine_var. */
+#define EC_PUBKEY_COMBINE_BATCH 4096
+
+typedef struct {
+    const secp256k1_context *ctx;
+    const secp256k1_pubkey *ins;
+    secp256k1_gej *sums;
+} secp256k1_ec_pubkey_combine_var_job;
+
+/* Add up the public keys begin..end-1 into the partial sum of their chunk.
+ * Returns the number of keys added, stopping at the first one that fails to load. */
+static size_t secp256k1_ec_pubkey_combine_var_fn(void *arg, size_t begin, size_t end) {
+    const secp256k1_ec_pubkey_combine_var_job *job = (const secp256k1_ec_pubkey_combine_var_job *)arg;
+    secp256k1_gej *sum = &job->sums[begin / EC_PUBKEY_COMBINE_BATCH];
+    secp256k1_ge Q;
+    size_t i;
+
+    secp256k1_gej_set_infinity(sum);
+    for (i = begin; i < end; i++) {
+        if (!secp256k1_pubkey_load(job->ctx, &Q, &job->ins[i])) {
+            break;
+        }
+        secp256k1_gej_add_ge_var(sum, sum, &Q, NULL);
+    }
+    return i - begin;
+}
+
+int secp256k1_ec_pubkey_combine_var(const secp256k1_context* ctx, secp256k1_pubkey *pubnonce, const secp256k1_pubkey *pubnonces, size_t n) {
+    secp256k1_ec_pubkey_combine_var_job job;
+    secp256k1_gej sum;
+    size_t nchunks;
+    size_t i;
+    secp256k1_gej Qj;
+    secp256k1_ge Q;
+    int ret;
+
+    ARG_CHECK(pubnonce != NULL);
+    memset(pubnonce, 0, sizeof(*pubnonce));
+    ARG_CHECK(n >= 1);
+    ARG_CHECK(pubnonces != NULL);
+
+    /* The inputs are public, so the variable-time addition (which handles
+     * doubling and cancellation itself) can be used, and the only field
+     * inversion happens once at the end. Partial sums of separate chunks
+     * are computed through the executor. */
+    nchunks = (n + EC_PUBKEY_COMBINE_BATCH - 1) / EC_PUBKEY_COMBINE_BATCH;
+    job.ctx = ctx;
+    job.ins = pubnonces;
+    job.sums = &sum;
+    if (nchunks > 1) {
+        job.sums = (secp256k1_gej *)checked_malloc(&ctx->error_callback, nchunks * sizeof(secp256k1_gej));
+    }
+    ret = secp256k1_batch_run(ctx, n, EC_PUBKEY_COMBINE_BATCH, secp256k1_ec_pubkey_combine_var_fn, &job) == n;
+    secp256k1_gej_set_infinity(&Qj);
+    for (i = 0; i < nchunks; i++) {
+        secp256k1_gej_add_var(&Qj, &Qj, &job.sums[i], NULL);
+    }
+    if (nchunks > 1) {
+        free(job.sums);
+    }
+    if (!ret || secp256k1_gej_is_infinity(&Qj)) {
+        return 0;
+    }
+    secp256k1_ge_set_gej_var(&Q, &Qj);
+    secp256k1_pubkey_save(pubnonce, &Q);
+    return 1;
+}
+
 #ifdef ENABLE_MODULE_ECDH
 # include "modules/ecdh/main_impl.h"
 #endif
@@ -564,3 +1266,11 @@ int secp256k1_ec_pubkey_combine(const secp256k1_context* ctx, secp256k1_pubkey *
 #ifdef ENABLE_MODULE_RECOVERY
 # include "modules/recovery/main_impl.h"
 #endif
+
+#ifdef ENABLE_MODULE_VERIFYQUEUE
+# include "modules/verifyqueue/main_impl.h"
+#endif
+
+#ifdef ENABLE_MODULE_HASH
+# include "modules/hash/main_impl.h"
+#endif
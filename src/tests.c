@@ -24,8 +24,15 @@
 #include "openssl/obj_mac.h"
 #endif
 
+#ifdef ENABLE_PTHREAD_TESTS
+#include <pthread.h>
+#endif
+
 #include "contrib/lax_der_parsing.c"
 #include "contrib/lax_der_privatekey_parsing.c"
+#ifdef ENABLE_PTHREAD_TESTS
+#include "contrib/executor_pthreads.c"
+#endif
 
 #if !defined(VG_CHECK)
 # if defined(VALGRIND)
@@ -57,6 +64,44 @@ static void uncounting_illegal_callback_fn(const char* str, void* data) {
     (*p)--;
 }
 
+/* An executor that defers all work until join, and then processes the items
+ * in randomly sized ranges, from the last range to the first. */
+typedef struct {
+    secp256k1_executor_task task;
+    void *arg;
+    size_t n;
+    int calls;
+} test_executor_data;
+
+static void test_executor_parallel_for(void *data, secp256k1_executor_task task, void *arg, size_t n) {
+    test_executor_data *d = (test_executor_data*)data;
+    CHECK(d->task == NULL);
+    CHECK(n >= 1);
+    d->task = task;
+    d->arg = arg;
+    d->n = n;
+    d->calls++;
+}
+
+static void test_executor_join(void *data) {
+    test_executor_data *d = (test_executor_data*)data;
+    size_t end = d->n;
+    CHECK(d->task != NULL);
+    while (end > 0) {
+        size_t len = 1 + secp256k1_rand_int(end < 3 ? end : 3);
+        d->task(d->arg, end - len, end);
+        end -= len;
+    }
+    d->task = NULL;
+}
+
+static test_executor_data test_executor_state = {NULL, NULL, 0, 0};
+static const secp256k1_executor test_executor = {
+    test_executor_parallel_for,
+    test_executor_join,
+    &test_executor_state
+};
+
 void random_field_element_test(secp256k1_fe *fe) {
     do {
         unsigned char b32[32];
@@ -67,9 +112,10 @@ void random_field_element_test(secp256k1_fe *fe) {
     } while(1);
 }
 
-void random_field_element_magnitude(secp256k1_fe *fe) {
+/* Raise the magnitude of a normalized field element to a random value of at most m. */
+void random_fe_magnitude(secp256k1_fe *fe, int m) {
     secp256k1_fe zero;
-    int n = secp256k1_rand_int(9);
+    int n = secp256k1_rand_int(m + 1);
     secp256k1_fe_normalize(fe);
     if (n == 0) {
         return;
@@ -81,6 +127,10 @@ void random_field_element_magnitude(secp256k1_fe *fe) {
     VERIFY_CHECK(fe->magnitude == n);
 }
 
+void random_field_element_magnitude(secp256k1_fe *fe) {
+    random_fe_magnitude(fe, 8);
+}
+
 void random_group_element_test(secp256k1_ge *ge) {
     secp256k1_fe fe;
     do {
@@ -255,23 +305,59 @@ void run_sha256_tests(void) {
         {0xf0, 0x8a, 0x78, 0xcb, 0xba, 0xee, 0x08, 0x2b, 0x05, 0x2a, 0xe0, 0x70, 0x8f, 0x32, 0xfa, 0x1e, 0x50, 0xc5, 0xc4, 0x21, 0xaa, 0x77, 0x2b, 0xa5, 0xdb, 0xb4, 0x06, 0xa2, 0xea, 0x6b, 0xe3, 0x42},
         {0xab, 0x64, 0xef, 0xf7, 0xe8, 0x8e, 0x2e, 0x46, 0x16, 0x5e, 0x29, 0xf2, 0xbc, 0xe4, 0x18, 0x26, 0xbd, 0x4c, 0x7b, 0x35, 0x52, 0xf6, 0xb3, 0x82, 0xa9, 0xe7, 0xd3, 0xaf, 0x47, 0xc2, 0x45, 0xf8}
     };
-    int i;
-    for (i = 0; i < 8; i++) {
-        unsigned char out[32];
-        secp256k1_sha256_t hasher;
-        secp256k1_sha256_initialize(&hasher);
-        secp256k1_sha256_write(&hasher, (const unsigned char*)(inputs[i]), strlen(inputs[i]));
-        secp256k1_sha256_finalize(&hasher, out);
-        CHECK(memcmp(out, outputs[i], 32) == 0);
-        if (strlen(inputs[i]) > 0) {
-            int split = secp256k1_rand_int(strlen(inputs[i]));
+    int features = secp256k1_cpu_features;
+    int i, j;
+    /* Both with the transform selected by secp256k1_cpu_detect and with the portable one. */
+    for (j = 0; j < 2; j++) {
+        secp256k1_cpu_features = j ? features : 0;
+        for (i = 0; i < 8; i++) {
+            unsigned char out[32];
+            secp256k1_sha256_t hasher;
             secp256k1_sha256_initialize(&hasher);
-            secp256k1_sha256_write(&hasher, (const unsigned char*)(inputs[i]), split);
-            secp256k1_sha256_write(&hasher, (const unsigned char*)(inputs[i] + split), strlen(inputs[i]) - split);
+            secp256k1_sha256_write(&hasher, (const unsigned char*)(inputs[i]), strlen(inputs[i]));
             secp256k1_sha256_finalize(&hasher, out);
             CHECK(memcmp(out, outputs[i], 32) == 0);
+            if (strlen(inputs[i]) > 0) {
+                int split = secp256k1_rand_int(strlen(inputs[i]));
+                secp256k1_sha256_initialize(&hasher);
+                secp256k1_sha256_write(&hasher, (const unsigned char*)(inputs[i]), split);
+                secp256k1_sha256_write(&hasher, (const unsigned char*)(inputs[i] + split), strlen(inputs[i]) - split);
+                secp256k1_sha256_finalize(&hasher, out);
+                CHECK(memcmp(out, outputs[i], 32) == 0);
+            }
+        }
+    }
+    secp256k1_cpu_features = features;
+}
+
+void run_sha256_batch_tests(void) {
+    /* Lengths around the padding boundaries, where the 0x80 byte and the bit length move to the next block. */
+    static const size_t lens[12] = {0, 1, 32, 33, 55, 56, 63, 64, 65, 119, 120, 200};
+    int features = secp256k1_cpu_features;
+    unsigned char in[17 * 200];
+    unsigned char out[2][17 * 32];
+    int i, j;
+
+    for (i = 0; i < 12 * count; i++) {
+        size_t len = lens[i % 12];
+        size_t n = secp256k1_rand_int(18);
+        size_t k;
+        secp256k1_rand_bytes_test(in, n * len);
+        for (j = 0; j < 2; j++) {
+            secp256k1_cpu_features = j ? features : 0;
+            secp256k1_sha256_batch(out[j], in, len, n);
+        }
+        CHECK(memcmp(out[0], out[1], 32 * n) == 0);
+        for (k = 0; k < n; k++) {
+            unsigned char ref[32];
+            secp256k1_sha256_t hasher;
+            secp256k1_sha256_initialize(&hasher);
+            secp256k1_sha256_write(&hasher, in + len * k, len);
+            secp256k1_sha256_finalize(&hasher, ref);
+            CHECK(memcmp(out[1] + 32 * k, ref, 32) == 0);
         }
     }
+    secp256k1_cpu_features = features;
 }
 
 void run_hmac_sha256_tests(void) {
@@ -802,6 +888,29 @@ void run_scalar_tests(void) {
         scalar_test();
     }
 
+    {
+        /* Batch inversion matches individual inversion. */
+        secp256k1_scalar x[16], xi[16], xii[16];
+        size_t j;
+        secp256k1_scalar_inverse_all_var(0, xi, x);
+        for (i = 0; i < count; i++) {
+            size_t len = secp256k1_rand_int(15) + 1;
+            for (j = 0; j < len; j++) {
+                do {
+                    random_scalar_order_test(&x[j]);
+                } while (secp256k1_scalar_is_zero(&x[j]));
+            }
+            secp256k1_scalar_inverse_all_var(len, xi, x);
+            secp256k1_scalar_inverse_all_var(len, xii, xi);
+            for (j = 0; j < len; j++) {
+                secp256k1_scalar t;
+                secp256k1_scalar_inverse_var(&t, &x[j]);
+                CHECK(secp256k1_scalar_eq(&t, &xi[j]));
+                CHECK(secp256k1_scalar_eq(&x[j], &xii[j]));
+            }
+        }
+    }
+
     {
         /* (-1)+1 should be zero. */
         secp256k1_scalar s, o;
@@ -851,9 +960,7 @@ void run_scalar_tests(void) {
         secp256k1_scalar one;
         secp256k1_scalar r1;
         secp256k1_scalar r2;
-#if defined(USE_SCALAR_INV_NUM)
         secp256k1_scalar zzv;
-#endif
         int overflow;
         unsigned char chal[32][2][32] = {
             {{0xff, 0xff, 0x03, 0x07, 0x00, 0x00, 0x00, 0x00,
@@ -1387,10 +1494,8 @@ void run_scalar_tests(void) {
             if (!secp256k1_scalar_is_zero(&y)) {
                 secp256k1_scalar_inverse(&zz, &y);
                 CHECK(!secp256k1_scalar_check_overflow(&zz));
-#if defined(USE_SCALAR_INV_NUM)
                 secp256k1_scalar_inverse_var(&zzv, &y);
                 CHECK(secp256k1_scalar_eq(&zzv, &zz));
-#endif
                 secp256k1_scalar_mul(&z, &z, &zz);
                 CHECK(!secp256k1_scalar_check_overflow(&z));
                 CHECK(secp256k1_scalar_eq(&x, &z));
@@ -1620,6 +1725,100 @@ void run_field_inv_all_var(void) {
         for (j = 0; j < len; j++) {
             CHECK(check_fe_equal(&x[j], &xii[j]));
         }
+        secp256k1_fe_inv_all(len, xii, x);
+        for (j = 0; j < len; j++) {
+            CHECK(check_fe_equal(&xi[j], &xii[j]));
+        }
+    }
+}
+
+void run_ctz_tests(void) {
+    static const uint32_t b32[] = {1, 0xffffffff, 0x5e56968f, 0xe0d63129};
+    static const uint64_t b64[] = {1, 0xffffffffffffffffULL, 0xbcd02462139b3fc3ULL, 0x98b5f80c769693efULL};
+    int shift;
+    unsigned i;
+    for (i = 0; i < sizeof(b32) / sizeof(b32[0]); ++i) {
+        for (shift = 0; shift < 32; ++shift) {
+            CHECK(secp256k1_ctz32_var_debruijn(b32[i] << shift) == shift);
+            CHECK(secp256k1_ctz32_var(b32[i] << shift) == shift);
+        }
+    }
+    for (i = 0; i < sizeof(b64) / sizeof(b64[0]); ++i) {
+        for (shift = 0; shift < 64; ++shift) {
+            CHECK(secp256k1_ctz64_var_debruijn(b64[i] << shift) == shift);
+            CHECK(secp256k1_ctz64_var(b64[i] << shift) == shift);
+        }
+    }
+}
+
+void test_inverse_fe(const secp256k1_fe *x) {
+    secp256k1_fe xi, xiv, xii;
+    secp256k1_fe_inv(&xi, x);
+    secp256k1_fe_inv_var(&xiv, x);
+    CHECK(check_fe_equal(&xi, &xiv));
+    if (secp256k1_fe_normalizes_to_zero_var(&xi)) {
+        /* Only zero has no inverse, and it is mapped to zero. */
+        secp256k1_fe t = *x;
+        CHECK(secp256k1_fe_normalizes_to_zero_var(&t));
+        return;
+    }
+    CHECK(check_fe_inverse(x, &xi));
+    secp256k1_fe_inv(&xii, &xi);
+    CHECK(check_fe_equal(x, &xii));
+}
+
+void test_inverse_scalar(const secp256k1_scalar *x) {
+    secp256k1_scalar xi, xiv, t;
+    secp256k1_scalar_inverse(&xi, x);
+    secp256k1_scalar_inverse_var(&xiv, x);
+    CHECK(secp256k1_scalar_eq(&xi, &xiv));
+    if (secp256k1_scalar_is_zero(x)) {
+        CHECK(secp256k1_scalar_is_zero(&xi));
+        return;
+    }
+    secp256k1_scalar_mul(&t, x, &xi);
+    CHECK(secp256k1_scalar_is_one(&t));
+    secp256k1_scalar_inverse(&t, &xi);
+    CHECK(secp256k1_scalar_eq(&t, x));
+}
+
+void run_inverse_tests(void) {
+    unsigned char b32[32];
+    secp256k1_fe fe;
+    secp256k1_scalar s;
+    int i, k;
+
+    /* 2^k, 2^k - 1 and their negations: values with long runs of zero or one bits, which take
+     * the longest and shortest paths through the divsteps. */
+    for (k = 0; k < 256; k++) {
+        memset(b32, 0, 32);
+        b32[31 - k / 8] = 1 << (k % 8);
+        for (i = 0; i < 2; i++) {
+            CHECK(secp256k1_fe_set_b32(&fe, b32));
+            test_inverse_fe(&fe);
+            secp256k1_fe_negate(&fe, &fe, 1);
+            test_inverse_fe(&fe);
+            secp256k1_scalar_set_b32(&s, b32, NULL);
+            test_inverse_scalar(&s);
+            secp256k1_scalar_negate(&s, &s);
+            test_inverse_scalar(&s);
+            /* Turn 2^k into 2^k - 1. */
+            memset(b32, 0, 32);
+            memset(b32 + 32 - k / 8, 0xFF, k / 8);
+            b32[31 - k / 8] = (1 << (k % 8)) - 1;
+        }
+    }
+    /* Zero, and random values of any magnitude. */
+    secp256k1_fe_clear(&fe);
+    test_inverse_fe(&fe);
+    secp256k1_scalar_clear(&s);
+    test_inverse_scalar(&s);
+    for (i = 0; i < 10 * count; i++) {
+        random_field_element_test(&fe);
+        random_field_element_magnitude(&fe);
+        test_inverse_fe(&fe);
+        random_scalar_order_test(&s);
+        test_inverse_scalar(&s);
     }
 }
 
@@ -1643,6 +1842,8 @@ void test_sqrt(const secp256k1_fe *a, const secp256k1_fe *k) {
     secp256k1_fe r1, r2;
     int v = secp256k1_fe_sqrt_var(&r1, a);
     CHECK((v == 0) == (k == NULL));
+    /* The Jacobi symbol agrees with the existence of a square root. */
+    CHECK(secp256k1_fe_is_quad_var(a) == v);
 
     if (k != NULL) {
         /* Check that the returned root is +/- the given known answer */
@@ -1687,6 +1888,201 @@ void run_sqrt(void) {
     }
 }
 
+/* Compare the results of the code paths selected by secp256k1_cpu_detect with those of the
+ * baseline code, which are always used when no features are detected. */
+void run_cpu_dispatch_tests(void) {
+    int features = secp256k1_cpu_features;
+    secp256k1_fe zero, big;
+    secp256k1_scalar one, max;
+    int i;
+
+    /* The largest limbs a magnitude 8 field element can have, and the largest scalar. */
+    secp256k1_fe_clear(&zero);
+    secp256k1_fe_negate(&big, &zero, 7);
+    secp256k1_scalar_set_int(&one, 1);
+    secp256k1_scalar_negate(&max, &one);
+
+    for (i = 0; i < 16 * count; i++) {
+        secp256k1_fe a, b, r[2], s[2];
+        secp256k1_scalar x, y, z[2], w[2];
+        int j;
+        if (i == 0) {
+            a = big;
+            b = big;
+            x = max;
+            y = max;
+        } else {
+            random_field_element_test(&a);
+            random_field_element_magnitude(&a);
+            random_field_element_test(&b);
+            random_field_element_magnitude(&b);
+            random_scalar_order_test(&x);
+            random_scalar_order_test(&y);
+        }
+        for (j = 0; j < 2; j++) {
+            secp256k1_cpu_features = j ? features : 0;
+            secp256k1_fe_mul(&r[j], &a, &b);
+            secp256k1_fe_sqr(&s[j], &a);
+            secp256k1_scalar_mul(&z[j], &x, &y);
+            secp256k1_scalar_sqr(&w[j], &x);
+        }
+        CHECK(memcmp(&r[0], &r[1], sizeof(r[0])) == 0);
+        CHECK(memcmp(&s[0], &s[1], sizeof(s[0])) == 0);
+        CHECK(secp256k1_scalar_eq(&z[0], &z[1]));
+        CHECK(secp256k1_scalar_eq(&w[0], &w[1]));
+    }
+    secp256k1_cpu_features = features;
+}
+
+#ifdef USE_AVX2
+/* Compare every lane of the four-lane field code with the field code it mirrors. */
+void run_field_x4_tests(void) {
+    secp256k1_fe zero;
+    int i, j;
+    if (!secp256k1_cpu_has(SECP256K1_CPU_AVX2)) {
+        return;
+    }
+    secp256k1_fe_clear(&zero);
+    for (i = 0; i < 16 * count; i++) {
+        secp256k1_fe a[4], b[4], c[4], r[4], s[4];
+        secp256k1_fe_x4 ax, bx, cx, rx, sx;
+        int flags = secp256k1_rand_bits(4);
+        int zeroes = 0;
+        for (j = 0; j < 4; j++) {
+            random_fe_test(&a[j]);
+            random_fe_test(&b[j]);
+            if (i == 0) {
+                /* Zero, and the largest limbs magnitude 8 allows, in some lanes. */
+                a[j] = zero;
+                secp256k1_fe_negate(&b[j], &zero, 7);
+            }
+        }
+        secp256k1_fe_x4_set_fe(&ax, a);
+        secp256k1_fe_x4_set_fe(&bx, b);
+        if (i == 0) {
+            secp256k1_fe_x4_negate(&bx, &ax, 7);
+        } else {
+            /* Raise the magnitude to 8 in both, with the same operations as in the lanes. */
+            for (j = 0; j < 4; j++) {
+                secp256k1_fe_negate(&c[j], &a[j], 1);
+                secp256k1_fe_mul_int(&c[j], 3);
+                secp256k1_fe_add(&b[j], &c[j]);
+            }
+            secp256k1_fe_x4_negate(&cx, &ax, 1);
+            secp256k1_fe_x4_mul_int(&cx, 3);
+            secp256k1_fe_x4_add(&bx, &cx);
+            secp256k1_fe_x4_add(&bx, &ax);
+            for (j = 0; j < 4; j++) {
+                secp256k1_fe_add(&b[j], &a[j]);
+            }
+        }
+
+        secp256k1_fe_x4_mul(&rx, &ax, &bx);
+        secp256k1_fe_x4_sqr(&sx, &bx);
+        secp256k1_fe_x4_get_fe(r, &rx);
+        secp256k1_fe_x4_get_fe(s, &sx);
+        secp256k1_fe_x4_get_fe(c, &bx);
+        for (j = 0; j < 4; j++) {
+            secp256k1_fe t;
+            CHECK(check_fe_equal(&c[j], &b[j]));
+            secp256k1_fe_mul(&t, &a[j], &b[j]);
+            CHECK(check_fe_equal(&r[j], &t));
+            secp256k1_fe_sqr(&t, &b[j]);
+            CHECK(check_fe_equal(&s[j], &t));
+        }
+
+        /* a - a normalizes to zero in the lanes selected by flags. */
+        secp256k1_fe_x4_negate(&cx, &ax, 1);
+        secp256k1_fe_x4_cmov(&cx, &bx, flags);
+        secp256k1_fe_x4_add(&cx, &ax);
+        secp256k1_fe_x4_normalize_weak(&cx);
+        secp256k1_fe_x4_get_fe(c, &cx);
+        for (j = 0; j < 4; j++) {
+            secp256k1_fe t = b[j];
+            if ((flags >> j) & 1) {
+                secp256k1_fe_add(&t, &a[j]);
+            } else {
+                secp256k1_fe_clear(&t);
+            }
+            CHECK(check_fe_equal(&c[j], &t));
+            zeroes |= secp256k1_fe_normalizes_to_zero_var(&t) << j;
+        }
+        CHECK(secp256k1_fe_x4_normalizes_to_zero(&cx) == zeroes);
+    }
+}
+#endif
+
+#ifdef USE_AVX512IFMA
+/* Compare every lane of the eight-lane field code with secp256k1_fe_mul, and the batch
+ * inversion built on it with the plain one. */
+void run_field_x8_tests(void) {
+    int features = secp256k1_cpu_features;
+    secp256k1_fe zero;
+    int i, j;
+    if (!secp256k1_cpu_has(SECP256K1_CPU_AVX512IFMA)) {
+        return;
+    }
+    secp256k1_fe_clear(&zero);
+    for (i = 0; i < 16 * count; i++) {
+        secp256k1_fe a[8], b[8], r[8];
+        secp256k1_fe_x8 ax, bx, rx;
+        for (j = 0; j < 8; j++) {
+            if (i == 0) {
+                /* Zero, and the largest limbs magnitude 8 allows. */
+                a[j] = zero;
+                secp256k1_fe_negate(&b[j], &zero, 7);
+            } else {
+                random_fe_test(&a[j]);
+                random_field_element_magnitude(&a[j]);
+                random_fe_test(&b[j]);
+                random_field_element_magnitude(&b[j]);
+            }
+        }
+        secp256k1_fe_x8_set_fe(&ax, a);
+        secp256k1_fe_x8_set_fe(&bx, b);
+        secp256k1_fe_x8_mul(&rx, &ax, &bx);
+        secp256k1_fe_x8_get_fe(r, &rx);
+        for (j = 0; j < 8; j++) {
+            secp256k1_fe t;
+            secp256k1_fe_mul(&t, &a[j], &b[j]);
+            CHECK(check_fe_equal(&r[j], &t));
+        }
+        /* Products of lanes that come straight out of a multiplication. */
+        secp256k1_fe_x8_mul(&ax, &rx, &rx);
+        secp256k1_fe_x8_mul(&ax, &ax, &bx);
+        secp256k1_fe_x8_get_fe(a, &ax);
+        for (j = 0; j < 8; j++) {
+            secp256k1_fe t;
+            secp256k1_fe_sqr(&t, &r[j]);
+            secp256k1_fe_mul(&t, &t, &b[j]);
+            CHECK(check_fe_equal(&a[j], &t));
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        secp256k1_fe x[71], xi[2][71];
+        size_t len = SECP256K1_FE_INV_ALL_X8_MIN + secp256k1_rand_int(71 - SECP256K1_FE_INV_ALL_X8_MIN + 1);
+        size_t k;
+        for (k = 0; k < len; k++) {
+            random_fe_non_zero(&x[k]);
+        }
+        for (j = 0; j < 2; j++) {
+            secp256k1_cpu_features = j ? features : 0;
+            if (i & 1) {
+                secp256k1_fe_inv_all(len, xi[j], x);
+            } else {
+                secp256k1_fe_inv_all_var(len, xi[j], x);
+            }
+        }
+        for (k = 0; k < len; k++) {
+            CHECK(check_fe_equal(&xi[0][k], &xi[1][k]));
+            CHECK(check_fe_inverse(&x[k], &xi[1][k]));
+        }
+    }
+    secp256k1_cpu_features = features;
+}
+#endif
+
 /***** GROUP TESTS *****/
 
 void ge_equals_ge(const secp256k1_ge *a, const secp256k1_ge *b) {
@@ -1781,11 +2177,11 @@ void test_ge(void) {
         secp256k1_gej_set_ge(&gej[3 + 4 * i], &ge[3 + 4 * i]);
         random_group_element_jacobian_test(&gej[4 + 4 * i], &ge[4 + 4 * i]);
         for (j = 0; j < 4; j++) {
-            random_field_element_magnitude(&ge[1 + j + 4 * i].x);
-            random_field_element_magnitude(&ge[1 + j + 4 * i].y);
-            random_field_element_magnitude(&gej[1 + j + 4 * i].x);
-            random_field_element_magnitude(&gej[1 + j + 4 * i].y);
-            random_field_element_magnitude(&gej[1 + j + 4 * i].z);
+            random_fe_magnitude(&ge[1 + j + 4 * i].x, SECP256K1_GEJ_X_MAGNITUDE_MAX);
+            random_fe_magnitude(&ge[1 + j + 4 * i].y, SECP256K1_GEJ_Y_MAGNITUDE_MAX);
+            random_fe_magnitude(&gej[1 + j + 4 * i].x, SECP256K1_GEJ_X_MAGNITUDE_MAX);
+            random_fe_magnitude(&gej[1 + j + 4 * i].y, SECP256K1_GEJ_Y_MAGNITUDE_MAX);
+            random_fe_magnitude(&gej[1 + j + 4 * i].z, SECP256K1_GEJ_Z_MAGNITUDE_MAX);
         }
     }
 
@@ -1856,6 +2252,40 @@ void test_ge(void) {
                 ge_equals_gej(&ref, &resj);
             }
 
+            /* Test gep + ge (complete). */
+            if (i2 != 0) {
+                secp256k1_gep resp;
+                secp256k1_ge b = ge[i2];
+                secp256k1_fe_normalize_weak(&b.x);
+                secp256k1_fe_normalize_weak(&b.y);
+                secp256k1_gep_set_gej(&resp, &gej[i1]);
+                secp256k1_gep_add_ge(&resp, &resp, &b);
+                secp256k1_gej_set_gep(&resj, &resp);
+                ge_equals_gej(&ref, &resj);
+            }
+
+            /* Test gej + co-Z gej. */
+            if (i1 != 0 && i2 != 0 && (i1 + 3)/4 != (i2 + 3)/4) {
+                /* ge[i2] over gej[i1]'s Z coordinate, and then over resj's. */
+                secp256k1_ge coz;
+                secp256k1_gej cozj;
+                secp256k1_fe zz;
+                secp256k1_fe_sqr(&zz, &gej[i1].z);
+                secp256k1_fe_mul(&coz.x, &ge[i2].x, &zz);
+                secp256k1_fe_mul(&zz, &zz, &gej[i1].z);
+                secp256k1_fe_mul(&coz.y, &ge[i2].y, &zz);
+                coz.infinity = 0;
+                secp256k1_gej_add_coz(&resj, &coz, &gej[i1], &zr);
+                ge_equals_gej(&ref, &resj);
+                secp256k1_fe_mul(&zz, &zr, &gej[i1].z);
+                CHECK(secp256k1_fe_equal_var(&zz, &resj.z));
+                cozj.x = coz.x;
+                cozj.y = coz.y;
+                cozj.z = resj.z;
+                cozj.infinity = 0;
+                ge_equals_gej(&ge[i2], &cozj);
+            }
+
             /* Test doubling (var). */
             if ((i1 == 0 && i2 == 0) || ((i1 + 3)/4 == (i2 + 3)/4 && ((i1 + 3)%4)/2 == ((i2 + 3)%4)/2)) {
                 secp256k1_fe zr2;
@@ -2038,14 +2468,168 @@ void test_ec_combine(void) {
         secp256k1_pubkey_save(&sd, &Q);
         CHECK(secp256k1_ec_pubkey_combine(ctx, &sd2, d, i) == 1);
         CHECK(memcmp(&sd, &sd2, sizeof(sd)) == 0);
+        CHECK(secp256k1_ec_pubkey_combine_var(ctx, &sd2, data, i) == 1);
+        CHECK(memcmp(&sd, &sd2, sizeof(sd)) == 0);
     }
 }
 
+void test_ec_combine_var_edge_cases(void) {
+    secp256k1_pubkey data[4];
+    secp256k1_pubkey sd;
+    secp256k1_pubkey sd2;
+    secp256k1_gej Qj;
+    secp256k1_ge Q;
+    secp256k1_scalar s;
+    int32_t ecount = 0;
+
+    random_scalar_order_test(&s);
+    secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &Qj, &s);
+    secp256k1_ge_set_gej(&Q, &Qj);
+    secp256k1_pubkey_save(&data[0], &Q);
+    /* P + P = 2P */
+    data[1] = data[0];
+    secp256k1_scalar_add(&s, &s, &s);
+    secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &Qj, &s);
+    secp256k1_ge_set_gej(&Q, &Qj);
+    secp256k1_pubkey_save(&sd, &Q);
+    CHECK(secp256k1_ec_pubkey_combine_var(ctx, &sd2, data, 2) == 1);
+    CHECK(memcmp(&sd, &sd2, sizeof(sd)) == 0);
+    /* P + P - 2P is infinity, and then adding P again gives P. */
+    secp256k1_ge_neg(&Q, &Q);
+    secp256k1_pubkey_save(&data[2], &Q);
+    CHECK(secp256k1_ec_pubkey_combine_var(ctx, &sd2, data, 3) == 0);
+    data[3] = data[0];
+    CHECK(secp256k1_ec_pubkey_combine_var(ctx, &sd2, data, 4) == 1);
+    CHECK(memcmp(&data[0], &sd2, sizeof(sd)) == 0);
+
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_ec_pubkey_combine_var(ctx, &sd2, data, 0) == 0);
+    CHECK(ecount == 1);
+    memset(&data[1], 0, sizeof(data[1]));
+    CHECK(secp256k1_ec_pubkey_combine_var(ctx, &sd2, data, 2) == 0);
+    CHECK(ecount == 2);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+}
+
+void test_ec_combine_var_chunks(void) {
+    size_t n = 2 * EC_PUBKEY_COMBINE_BATCH + 1 + secp256k1_rand_int(EC_PUBKEY_COMBINE_BATCH);
+    unsigned char *ser = (unsigned char *)malloc(n * 33);
+    secp256k1_pubkey *keys = (secp256k1_pubkey *)malloc(n * sizeof(secp256k1_pubkey));
+    secp256k1_context *clone;
+    unsigned char one[32] = {0};
+    secp256k1_pubkey sum, sum2, expected;
+    secp256k1_gej Qj;
+    secp256k1_ge Q;
+    secp256k1_scalar s;
+    int32_t ecount = 0;
+    int calls = test_executor_state.calls;
+
+    /* The keys are 1*G, 2*G, ..., n*G, adding up to n*(n+1)/2*G. */
+    one[31] = 1;
+    CHECK(secp256k1_ec_pubkey_create_range(ctx, ser, one, n, SECP256K1_EC_COMPRESSED) == 1);
+    CHECK(secp256k1_ec_pubkey_parse_batch(ctx, keys, NULL, ser, 33, n) == n);
+    secp256k1_scalar_set_int(&s, (unsigned int)(n * (n + 1) / 2));
+    secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &Qj, &s);
+    secp256k1_ge_set_gej(&Q, &Qj);
+    secp256k1_pubkey_save(&expected, &Q);
+    CHECK(secp256k1_ec_pubkey_combine_var(ctx, &sum, keys, n) == 1);
+    CHECK(memcmp(&sum, &expected, sizeof(sum)) == 0);
+
+    /* The partial sums may be computed in any order. */
+    secp256k1_context_set_executor(ctx, &test_executor);
+    CHECK(secp256k1_ec_pubkey_combine_var(ctx, &sum2, keys, n) == 1);
+    CHECK(memcmp(&sum2, &expected, sizeof(sum2)) == 0);
+    CHECK(test_executor_state.calls == calls + 1);
+    /* Clones use the same executor. */
+    clone = secp256k1_context_clone(ctx);
+    CHECK(secp256k1_ec_pubkey_combine_var(clone, &sum2, keys, n) == 1);
+    CHECK(memcmp(&sum2, &expected, sizeof(sum2)) == 0);
+    CHECK(test_executor_state.calls == calls + 2);
+    secp256k1_context_destroy(clone);
+    /* An invalid key in a later chunk fails the whole sum. */
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    memset(&keys[n - 1], 0, sizeof(keys[n - 1]));
+    CHECK(secp256k1_ec_pubkey_combine_var(ctx, &sum2, keys, n) == 0);
+    CHECK(ecount == 1);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+    secp256k1_context_set_executor(ctx, NULL);
+
+    free(keys);
+    free(ser);
+}
+
 void run_ec_combine(void) {
     int i;
     for (i = 0; i < count * 8; i++) {
          test_ec_combine();
     }
+    test_ec_combine_var_edge_cases();
+    test_ec_combine_var_chunks();
+}
+
+void test_ec_pubkey_create_range(const unsigned char *seckey, size_t n, int compressed) {
+    unsigned int flags = compressed ? SECP256K1_EC_COMPRESSED : SECP256K1_EC_UNCOMPRESSED;
+    size_t outlen = compressed ? 33 : 65;
+    unsigned char *out = (unsigned char *)malloc(n * outlen);
+    unsigned char key[32];
+    unsigned char one[32] = {0};
+    size_t i;
+    one[31] = 1;
+    memcpy(key, seckey, 32);
+    CHECK(secp256k1_ec_pubkey_create_range(ctx, out, seckey, n, flags) == 1);
+    for (i = 0; i < n; i++) {
+        secp256k1_pubkey pubkey;
+        unsigned char ser[65];
+        size_t len = 65;
+        CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey, key) == 1);
+        CHECK(secp256k1_ec_pubkey_serialize(ctx, ser, &len, &pubkey, flags) == 1);
+        CHECK(len == outlen);
+        CHECK(memcmp(ser, &out[i * outlen], outlen) == 0);
+        if (i + 1 < n) {
+            CHECK(secp256k1_ec_privkey_tweak_add(ctx, key, one) == 1);
+        }
+    }
+    free(out);
+}
+
+void run_ec_pubkey_create_range(void) {
+    /* order - 3 */
+    const unsigned char ordm3[32] = {
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe,
+        0xba, 0xae, 0xdc, 0xe6, 0xaf, 0x48, 0xa0, 0x3b,
+        0xbf, 0xd2, 0x5e, 0x8c, 0xd0, 0x36, 0x41, 0x3e
+    };
+    unsigned char key[32] = {0};
+    unsigned char out[4 * 65];
+    secp256k1_scalar s;
+    int i;
+
+    /* Starting at 1 makes the first addition a doubling. */
+    key[31] = 1;
+    test_ec_pubkey_create_range(key, 5, 1);
+    /* The range may end right below the order, but not reach it. */
+    test_ec_pubkey_create_range(ordm3, 3, 0);
+    CHECK(secp256k1_ec_pubkey_create_range(ctx, out, ordm3, 4, SECP256K1_EC_UNCOMPRESSED) == 0);
+    key[31] = 0;
+    CHECK(secp256k1_ec_pubkey_create_range(ctx, out, key, 1, SECP256K1_EC_COMPRESSED) == 0);
+    memset(key, 0xff, 32);
+    CHECK(secp256k1_ec_pubkey_create_range(ctx, out, key, 1, SECP256K1_EC_COMPRESSED) == 0);
+    /* Cross several affine conversion batches. */
+    random_scalar_order_test(&s);
+    secp256k1_scalar_get_b32(key, &s);
+    test_ec_pubkey_create_range(key, 2 * EC_PUBKEY_RANGE_BATCH + 1 + secp256k1_rand_int(EC_PUBKEY_RANGE_BATCH), secp256k1_rand_bits(1));
+    /* Cross several executor items, processed out of order. */
+    i = test_executor_state.calls;
+    secp256k1_context_set_executor(ctx, &test_executor);
+    test_ec_pubkey_create_range(key, EC_PUBKEY_RANGE_CHUNK + 1 + secp256k1_rand_int(EC_PUBKEY_RANGE_BATCH), secp256k1_rand_bits(1));
+    secp256k1_context_set_executor(ctx, NULL);
+    CHECK(test_executor_state.calls == i + 1);
+    for (i = 0; i < count; i++) {
+        random_scalar_order_test(&s);
+        secp256k1_scalar_get_b32(key, &s);
+        test_ec_pubkey_create_range(key, 1 + secp256k1_rand_int(64), secp256k1_rand_bits(1));
+    }
 }
 
 void test_group_decompress(const secp256k1_fe* x) {
@@ -2227,6 +2811,33 @@ void run_point_times_order(void) {
     CHECK(secp256k1_fe_equal_var(&x, &xr));
 }
 
+void test_ecmult_odd_multiples_table(void) {
+    /* The co-Z table must match a plain chain of additions of 2*a. */
+    secp256k1_gej prej[16];
+    secp256k1_fe zr[16];
+    secp256k1_ge pre[16];
+    secp256k1_ge a;
+    secp256k1_gej aj, twoa, ref;
+    int i;
+    random_group_element_test(&a);
+    random_group_element_jacobian_test(&aj, &a);
+    secp256k1_ecmult_odd_multiples_table(16, prej, zr, &aj);
+    secp256k1_ge_set_table_gej_var(16, pre, prej, zr);
+    secp256k1_gej_double_var(&twoa, &aj, NULL);
+    ref = aj;
+    for (i = 0; i < 16; i++) {
+        ge_equals_gej(&pre[i], &ref);
+        secp256k1_gej_add_var(&ref, &ref, &twoa, NULL);
+    }
+}
+
+void run_ecmult_odd_multiples_table(void) {
+    int i;
+    for (i = 0; i < count; i++) {
+        test_ecmult_odd_multiples_table();
+    }
+}
+
 void ecmult_const_random_mult(void) {
     /* random starting point A (on the curve) */
     secp256k1_ge a = SECP256K1_GE_CONST(
@@ -2323,47 +2934,120 @@ void ecmult_const_chain_multiply(void) {
     ge_equals_gej(&res, &expected_point);
 }
 
+#ifdef USE_AVX2
+void ecmult_const_x4_random_mult(void) {
+    static const secp256k1_scalar one = SECP256K1_SCALAR_CONST(0, 0, 0, 0, 0, 0, 0, 1);
+    secp256k1_ge a[4];
+    secp256k1_scalar q[4];
+    secp256k1_gej r[4];
+    int i, j;
+    if (!secp256k1_cpu_has(SECP256K1_CPU_AVX2)) {
+        return;
+    }
+    for (i = 0; i < count; i++) {
+        for (j = 0; j < 4; j++) {
+            random_group_element_test(&a[j]);
+            random_scalar_order_test(&q[j]);
+        }
+        if (i == 0) {
+            secp256k1_scalar_clear(&q[0]);
+            q[1] = one;
+            secp256k1_scalar_negate(&q[2], &one);
+        }
+        secp256k1_ecmult_const_x4(r, a, q);
+        for (j = 0; j < 4; j++) {
+            secp256k1_gej expj;
+            secp256k1_ge exp;
+            secp256k1_ecmult_const(&expj, &a[j], &q[j]);
+            secp256k1_ge_set_gej(&exp, &expj);
+            ge_equals_gej(&exp, &r[j]);
+        }
+    }
+}
+#endif
+
 void run_ecmult_const_tests(void) {
     ecmult_const_mult_zero_one();
     ecmult_const_random_mult();
     ecmult_const_commutativity();
     ecmult_const_chain_multiply();
+#ifdef USE_AVX2
+    ecmult_const_x4_random_mult();
+#endif
 }
 
 void test_wnaf(const secp256k1_scalar *number, int w) {
     secp256k1_scalar x, two, t;
-    int wnaf[256];
-    int zeroes = -1;
-    int i;
-    int bits;
+    secp256k1_ecmult_wnaf_digit wnaf[ECMULT_WNAF_MAX_DIGITS(256, 2)];
+    int i, k;
+    int n;
     secp256k1_scalar_set_int(&x, 0);
     secp256k1_scalar_set_int(&two, 2);
-    bits = secp256k1_ecmult_wnaf(wnaf, 256, number, w);
-    CHECK(bits <= 256);
-    for (i = bits-1; i >= 0; i--) {
-        int v = wnaf[i];
+    n = secp256k1_ecmult_wnaf(wnaf, 256, number, w);
+    CHECK(n <= ECMULT_WNAF_MAX_DIGITS(256, w));
+    k = n - 1;
+    for (i = 255; i >= 0; i--) {
         secp256k1_scalar_mul(&x, &x, &two);
-        if (v) {
-            CHECK(zeroes == -1 || zeroes >= w-1); /* check that distance between non-zero elements is at least w-1 */
-            zeroes=0;
-            CHECK((v & 1) == 1); /* check non-zero elements are odd */
+        if (k >= 0 && wnaf[k].pos == i) {
+            int v = wnaf[k].digit;
+            CHECK(k == 0 || wnaf[k].pos - wnaf[k - 1].pos >= w); /* check that distance between digits is at least w */
+            CHECK((v & 1) == 1); /* check digits are odd */
             CHECK(v <= (1 << (w-1)) - 1); /* check range below */
-            CHECK(v >= -(1 << (w-1)) - 1); /* check range above */
-        } else {
-            CHECK(zeroes != -1); /* check that no unnecessary zero padding exists */
-            zeroes++;
-        }
-        if (v >= 0) {
-            secp256k1_scalar_set_int(&t, v);
-        } else {
-            secp256k1_scalar_set_int(&t, -v);
-            secp256k1_scalar_negate(&t, &t);
+            CHECK(v >= -((1 << (w-1)) - 1)); /* check range above */
+            if (v >= 0) {
+                secp256k1_scalar_set_int(&t, v);
+            } else {
+                secp256k1_scalar_set_int(&t, -v);
+                secp256k1_scalar_negate(&t, &t);
+            }
+            secp256k1_scalar_add(&x, &x, &t);
+            k--;
         }
-        secp256k1_scalar_add(&x, &x, &t);
     }
+    CHECK(k == -1); /* check that the positions are increasing and below 256 */
     CHECK(secp256k1_scalar_eq(&x, number)); /* check that wnaf represents number */
 }
 
+#ifdef USE_ECMULT_JSF
+void test_jsf(const secp256k1_scalar *a0, const secp256k1_scalar *a1) {
+    static const int columns[4][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
+    secp256k1_scalar x[2], two, t;
+    secp256k1_ecmult_wnaf_digit jsf[131];
+    int i, j, k;
+    int n;
+    secp256k1_scalar_set_int(&x[0], 0);
+    secp256k1_scalar_set_int(&x[1], 0);
+    secp256k1_scalar_set_int(&two, 2);
+    n = secp256k1_ecmult_jsf(jsf, 130, a0, a1);
+    CHECK(n <= 131);
+    k = n - 1;
+    for (i = 130; i >= 0; i--) {
+        secp256k1_scalar_mul(&x[0], &x[0], &two);
+        secp256k1_scalar_mul(&x[1], &x[1], &two);
+        if (k >= 0 && jsf[k].pos == i) {
+            int v = jsf[k].digit;
+            int sign = v < 0 ? -1 : 1;
+            CHECK(v != 0 && v * sign <= 4); /* check the digit selects a column */
+            CHECK(k < 2 || jsf[k].pos - jsf[k - 2].pos >= 3); /* check no three consecutive columns are nonzero */
+            for (j = 0; j < 2; j++) {
+                int u = sign * columns[v * sign - 1][j];
+                if (u != 0) {
+                    secp256k1_scalar_set_int(&t, 1);
+                    if (u < 0) {
+                        secp256k1_scalar_negate(&t, &t);
+                    }
+                    secp256k1_scalar_add(&x[j], &x[j], &t);
+                }
+            }
+            k--;
+        }
+    }
+    CHECK(k == -1); /* check that the positions are increasing and at most 130 */
+    CHECK(secp256k1_scalar_eq(&x[0], a0)); /* check that the columns represent both numbers */
+    CHECK(secp256k1_scalar_eq(&x[1], a1));
+}
+#endif
+
 void test_constant_wnaf_negate(const secp256k1_scalar *number) {
     secp256k1_scalar neg1 = *number;
     secp256k1_scalar neg2 = *number;
@@ -2440,6 +3124,16 @@ void run_wnaf(void) {
         test_wnaf(&n, 4+(i%10));
         test_constant_wnaf_negate(&n);
         test_constant_wnaf(&n, 4 + (i % 10));
+#ifdef USE_ECMULT_JSF
+        {
+            secp256k1_scalar n1, nlam;
+            secp256k1_scalar_split_lambda(&n1, &nlam, &n);
+            test_jsf(&n1, &nlam);
+            secp256k1_scalar_set_int(&n1, 0);
+            test_jsf(&n1, &nlam);
+            test_jsf(&nlam, &n1);
+        }
+#endif
     }
     secp256k1_scalar_set_int(&n, 0);
     CHECK(secp256k1_scalar_cond_negate(&n, 1) == -1);
@@ -2960,6 +3654,258 @@ void run_ec_pubkey_parse_test(void) {
     }
 }
 
+void test_ec_pubkey_batch(int compressed) {
+    secp256k1_pubkey pubkeys[32];
+    unsigned char valid[32];
+    unsigned char input[32 * 65];
+    unsigned char output[32 * 65];
+    unsigned int flags = compressed ? SECP256K1_EC_COMPRESSED : SECP256K1_EC_UNCOMPRESSED;
+    size_t len = compressed ? 33 : 65;
+    size_t nvalid = 0;
+    size_t n = 1 + secp256k1_rand_int(32);
+    size_t i;
+
+    memset(input, 0, sizeof(input));
+    for (i = 0; i < n; i++) {
+        secp256k1_ge ge;
+        size_t outlen;
+        random_group_element_test(&ge);
+        CHECK(secp256k1_eckey_pubkey_serialize(&ge, &input[i * len], &outlen, compressed));
+        CHECK(outlen == len);
+        if (secp256k1_rand_bits(2) == 0) {
+            /* Corrupt the key; it may or may not remain valid. */
+            input[i * len + secp256k1_rand_int(len)] ^= 1 << secp256k1_rand_bits(3);
+        }
+    }
+    CHECK(secp256k1_ec_pubkey_parse_batch(ctx, pubkeys, NULL, input, len, n) <= n);
+    memset(valid, 0xaa, sizeof(valid));
+    nvalid = secp256k1_ec_pubkey_parse_batch(ctx, pubkeys, valid, input, len, n);
+    for (i = 0; i < n; i++) {
+        secp256k1_pubkey pubkey;
+        int ret = secp256k1_ec_pubkey_parse(ctx, &pubkey, &input[i * len], len);
+        CHECK(valid[i] == ret);
+        CHECK(memcmp(&pubkey, &pubkeys[i], sizeof(pubkey)) == 0);
+        nvalid -= ret;
+    }
+    CHECK(nvalid == 0);
+
+    /* Serialize the valid keys back and compare with the input. */
+    for (i = 0; i < n; i++) {
+        if (!valid[i]) {
+            memcpy(&pubkeys[i], &pubkeys[n - 1], sizeof(pubkeys[i]));
+            memcpy(&input[i * len], &input[(n - 1) * len], len);
+            valid[i] = valid[n - 1];
+            n--;
+            i--;
+        }
+    }
+    CHECK(secp256k1_ec_pubkey_serialize_batch(ctx, output, pubkeys, n, flags) == 1);
+    for (i = 0; i < n; i++) {
+        unsigned char ser[65];
+        size_t outlen = 65;
+        CHECK(secp256k1_ec_pubkey_serialize(ctx, ser, &outlen, &pubkeys[i], flags) == 1);
+        CHECK(outlen == len);
+        CHECK(memcmp(ser, &output[i * len], len) == 0);
+        if (compressed || input[i * len] == 0x04) {
+            CHECK(memcmp(&input[i * len], &output[i * len], len) == 0);
+        }
+    }
+}
+
+/* Parse and serialize over several chunks, with and without the test executor. */
+void test_ec_pubkey_batch_chunks(void) {
+    size_t n = 2 * EC_PUBKEY_BATCH_CHUNK + 1 + secp256k1_rand_int(EC_PUBKEY_BATCH_CHUNK);
+    unsigned char *ser = (unsigned char *)malloc(n * 33);
+    unsigned char *out = (unsigned char *)malloc(n * 33);
+    secp256k1_pubkey *keys = (secp256k1_pubkey *)malloc(n * sizeof(secp256k1_pubkey));
+    secp256k1_pubkey *keys2 = (secp256k1_pubkey *)malloc(n * sizeof(secp256k1_pubkey));
+    unsigned char *valid = (unsigned char *)malloc(n);
+    unsigned char *valid2 = (unsigned char *)malloc(n);
+    unsigned char key[32];
+    secp256k1_scalar s;
+    size_t nvalid;
+    size_t i;
+    int calls = test_executor_state.calls;
+    int32_t ecount = 0;
+
+    random_scalar_order_test(&s);
+    secp256k1_scalar_get_b32(key, &s);
+    CHECK(secp256k1_ec_pubkey_create_range(ctx, ser, key, n, SECP256K1_EC_COMPRESSED) == 1);
+    /* Invalidate a few keys, in different chunks. */
+    for (i = 0; i < 3; i++) {
+        ser[(1 + secp256k1_rand_int(n - 1)) * 33] = 0x05;
+    }
+    nvalid = secp256k1_ec_pubkey_parse_batch(ctx, keys, valid, ser, 33, n);
+    CHECK(nvalid < n);
+    secp256k1_context_set_executor(ctx, &test_executor);
+    CHECK(secp256k1_ec_pubkey_parse_batch(ctx, keys2, valid2, ser, 33, n) == nvalid);
+    CHECK(memcmp(keys, keys2, n * sizeof(secp256k1_pubkey)) == 0);
+    CHECK(memcmp(valid, valid2, n) == 0);
+    CHECK(test_executor_state.calls == calls + 1);
+
+    /* Replace the invalid keys, and serialize everything back. */
+    for (i = 0; i < n; i++) {
+        if (!valid[i]) {
+            keys[i] = keys[0];
+            memcpy(&ser[i * 33], &ser[0], 33);
+        }
+    }
+    CHECK(valid[0]);
+    CHECK(secp256k1_ec_pubkey_serialize_batch(ctx, out, keys, n, SECP256K1_EC_COMPRESSED) == 1);
+    CHECK(memcmp(out, ser, n * 33) == 0);
+    CHECK(test_executor_state.calls == calls + 2);
+    /* An invalid key in the last chunk clears the whole output. */
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    memset(&keys[n - 1], 0, sizeof(keys[n - 1]));
+    CHECK(secp256k1_ec_pubkey_serialize_batch(ctx, out, keys, n, SECP256K1_EC_COMPRESSED) == 0);
+    CHECK(ecount == 1);
+    for (i = 0; i < n * 33; i++) {
+        CHECK(out[i] == 0);
+    }
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+    secp256k1_context_set_executor(ctx, NULL);
+
+    free(valid2);
+    free(valid);
+    free(keys2);
+    free(keys);
+    free(out);
+    free(ser);
+}
+
+void run_ec_pubkey_batch_test(void) {
+    int i;
+    secp256k1_pubkey pubkey;
+    unsigned char valid = 0xaa;
+    unsigned char ser[33];
+    secp256k1_pubkey keys[3];
+    unsigned char out[3 * 33];
+    unsigned char one[32] = {0};
+    size_t nvalid;
+    int32_t ecount = 0;
+
+    one[31] = 1;
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    /* An empty batch parses nothing. */
+    CHECK(secp256k1_ec_pubkey_parse_batch(ctx, &pubkey, &valid, ser, 33, 0) == 0);
+    CHECK(valid == 0xaa);
+    CHECK(secp256k1_ec_pubkey_serialize_batch(ctx, ser, &pubkey, 0, SECP256K1_EC_COMPRESSED) == 1);
+    CHECK(ecount == 0);
+    /* Invalid lengths are reported per item. */
+    memset(ser, 0x02, sizeof(ser));
+    nvalid = secp256k1_ec_pubkey_parse_batch(ctx, &pubkey, &valid, ser, 32, 1);
+    CHECK(nvalid == 0);
+    CHECK(valid == 0);
+    CHECK(ecount == 0);
+    /* A cleared pubkey cannot be serialized, and no partial output is left. */
+    CHECK(secp256k1_ec_pubkey_serialize_batch(ctx, ser, &pubkey, 1, SECP256K1_EC_COMPRESSED) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &keys[0], one) == 1);
+    keys[2] = keys[0];
+    memset(&keys[1], 0, sizeof(keys[1]));
+    memset(out, 0xaa, sizeof(out));
+    CHECK(secp256k1_ec_pubkey_serialize_batch(ctx, out, keys, 3, SECP256K1_EC_COMPRESSED) == 0);
+    CHECK(ecount == 2);
+    for (i = 0; i < (int)sizeof(out); i++) {
+        CHECK(out[i] == 0);
+    }
+    CHECK(secp256k1_ec_pubkey_parse_batch(ctx, &pubkey, &valid, NULL, 33, 1) == 0);
+    CHECK(ecount == 3);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+
+    for (i = 0; i < count; i++) {
+        test_ec_pubkey_batch(1);
+        test_ec_pubkey_batch(0);
+    }
+    test_ec_pubkey_batch_chunks();
+}
+
+void test_point_table(void) {
+    unsigned char key[32];
+    unsigned char seed[32];
+    unsigned char factor[32];
+    secp256k1_pubkey point;
+    secp256k1_pubkey expected;
+    secp256k1_pubkey result;
+    secp256k1_point_table *table;
+    secp256k1_scalar s;
+    int i;
+
+    random_scalar_order_test(&s);
+    secp256k1_scalar_get_b32(key, &s);
+    secp256k1_rand256(seed);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &point, key) == 1);
+    table = secp256k1_point_table_create(ctx, &point, secp256k1_rand_bits(1) ? seed : NULL);
+    CHECK(table != NULL);
+    CHECK(secp256k1_point_table_memory(table) >= 64 * 16 * sizeof(secp256k1_ge_storage));
+    for (i = 0; i < 4; i++) {
+        do {
+            random_scalar_order_test(&s);
+        } while (secp256k1_scalar_is_zero(&s));
+        secp256k1_scalar_get_b32(factor, &s);
+        expected = point;
+        CHECK(secp256k1_ec_pubkey_tweak_mul(ctx, &expected, factor) == 1);
+        CHECK(secp256k1_point_table_mul(ctx, table, &result, factor) == 1);
+        CHECK(memcmp(&expected, &result, sizeof(result)) == 0);
+        CHECK(secp256k1_point_table_mul_var(ctx, table, &result, factor) == 1);
+        CHECK(memcmp(&expected, &result, sizeof(result)) == 0);
+    }
+    secp256k1_point_table_destroy(table);
+}
+
+void run_point_table_tests(void) {
+    /* order - 1, the largest valid scalar; 1; 0; and the order itself. */
+    unsigned char factor[32] = {
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe,
+        0xba, 0xae, 0xdc, 0xe6, 0xaf, 0x48, 0xa0, 0x3b,
+        0xbf, 0xd2, 0x5e, 0x8c, 0xd0, 0x36, 0x41, 0x40
+    };
+    unsigned char one[32] = {0};
+    secp256k1_pubkey point;
+    secp256k1_pubkey expected;
+    secp256k1_pubkey result;
+    secp256k1_point_table *table;
+    int32_t ecount = 0;
+    int i;
+
+    one[31] = 1;
+    CHECK(secp256k1_ec_pubkey_create(ctx, &point, one) == 1);
+    table = secp256k1_point_table_create(ctx, &point, NULL);
+    CHECK(table != NULL);
+    expected = point;
+    CHECK(secp256k1_ec_pubkey_tweak_mul(ctx, &expected, factor) == 1);
+    CHECK(secp256k1_point_table_mul(ctx, table, &result, factor) == 1);
+    CHECK(memcmp(&expected, &result, sizeof(result)) == 0);
+    CHECK(secp256k1_point_table_mul_var(ctx, table, &result, factor) == 1);
+    CHECK(memcmp(&expected, &result, sizeof(result)) == 0);
+    CHECK(secp256k1_point_table_mul(ctx, table, &result, one) == 1);
+    CHECK(memcmp(&point, &result, sizeof(result)) == 0);
+    CHECK(secp256k1_point_table_mul_var(ctx, table, &result, one) == 1);
+    CHECK(memcmp(&point, &result, sizeof(result)) == 0);
+    factor[31]++;
+    CHECK(secp256k1_point_table_mul(ctx, table, &result, factor) == 0);
+    CHECK(secp256k1_point_table_mul_var(ctx, table, &result, factor) == 0);
+    memset(factor, 0, sizeof(factor));
+    CHECK(secp256k1_point_table_mul(ctx, table, &result, factor) == 0);
+    CHECK(secp256k1_point_table_mul_var(ctx, table, &result, factor) == 0);
+    memset(&expected, 0, sizeof(expected));
+    CHECK(memcmp(&expected, &result, sizeof(result)) == 0);
+    secp256k1_point_table_destroy(table);
+
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_point_table_create(ctx, NULL, NULL) == NULL);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_point_table_create(ctx, &expected, NULL) == NULL);
+    CHECK(ecount == 2);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+    secp256k1_point_table_destroy(NULL);
+
+    for (i = 0; i < count; i++) {
+        test_point_table();
+    }
+}
+
 void run_eckey_edge_case_test(void) {
     const unsigned char orderc[32] = {
         0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
@@ -3475,6 +4421,99 @@ void run_random_pubkeys(void) {
     }
 }
 
+/* Verify in steps, and compare with secp256k1_ecdsa_verify. */
+int ecdsa_verify_in_steps(secp256k1_ecdsa_verify_state *state, const secp256k1_ecdsa_signature *sig, const unsigned char *msg32, const secp256k1_pubkey *pubkey, unsigned int iterations) {
+    int result = -1;
+    int steps = 0;
+    CHECK(secp256k1_ecdsa_verify_start(ctx, state, sig, msg32, pubkey) == 1);
+    while (!secp256k1_ecdsa_verify_continue(ctx, state, &result, iterations)) {
+        steps++;
+    }
+    /* Loading, two setup steps, the main loop, and the final check. */
+    CHECK(steps <= 4 + (256 + (int)iterations - 1) / (int)iterations);
+    CHECK(result == secp256k1_ecdsa_verify(ctx, sig, msg32, pubkey));
+    /* Further calls return the same result. */
+    result = -1;
+    CHECK(secp256k1_ecdsa_verify_continue(ctx, state, &result, iterations) == 1);
+    return result;
+}
+
+void test_ecdsa_verify_steps(void) {
+    secp256k1_ecdsa_verify_state *state = secp256k1_ecdsa_verify_state_create(ctx);
+    secp256k1_ecdsa_signature sig, highs;
+    secp256k1_pubkey pubkey, other;
+    secp256k1_scalar key, msg, r, s;
+    unsigned char seckey[32];
+    unsigned char msg32[32];
+    unsigned int iterations = 1 + secp256k1_rand_int(300);
+
+    random_scalar_order_test(&key);
+    random_scalar_order_test(&msg);
+    secp256k1_scalar_get_b32(seckey, &key);
+    secp256k1_scalar_get_b32(msg32, &msg);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey, seckey) == 1);
+    CHECK(secp256k1_ecdsa_sign(ctx, &sig, msg32, seckey, NULL, NULL) == 1);
+    CHECK(ecdsa_verify_in_steps(state, &sig, msg32, &pubkey, iterations) == 1);
+    /* Another message, and another key. */
+    msg32[secp256k1_rand_int(32)] ^= 1 << secp256k1_rand_int(8);
+    CHECK(ecdsa_verify_in_steps(state, &sig, msg32, &pubkey, iterations) == 0);
+    secp256k1_scalar_get_b32(msg32, &msg);
+    secp256k1_scalar_add(&key, &key, &key);
+    secp256k1_scalar_get_b32(seckey, &key);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &other, seckey) == 1);
+    CHECK(ecdsa_verify_in_steps(state, &sig, msg32, &other, iterations) == 0);
+    /* High S values are rejected. */
+    secp256k1_ecdsa_signature_load(ctx, &r, &s, &sig);
+    secp256k1_scalar_negate(&s, &s);
+    secp256k1_ecdsa_signature_save(&highs, &r, &s);
+    CHECK(ecdsa_verify_in_steps(state, &highs, msg32, &pubkey, iterations) == 0);
+    /* A verification can be abandoned by starting another one. */
+    CHECK(secp256k1_ecdsa_verify_start(ctx, state, &highs, msg32, &pubkey) == 1);
+    CHECK(ecdsa_verify_in_steps(state, &sig, msg32, &pubkey, 1) == 1);
+    secp256k1_ecdsa_verify_state_destroy(state);
+}
+
+void test_ecdsa_verify_steps_api(void) {
+    secp256k1_context *sign = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
+    secp256k1_ecdsa_verify_state *state = secp256k1_ecdsa_verify_state_create(ctx);
+    secp256k1_ecdsa_signature sig;
+    secp256k1_pubkey pubkey;
+    unsigned char msg32[32] = {0};
+    int result = -1;
+    int32_t ecount = 0;
+
+    memset(&sig, 0, sizeof(sig));
+    memset(&pubkey, 0, sizeof(pubkey));
+    secp256k1_context_set_illegal_callback(sign, counting_illegal_callback_fn, &ecount);
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    /* A fresh state holds no verification. */
+    CHECK(secp256k1_ecdsa_verify_continue(ctx, state, &result, 1) == 1);
+    CHECK(result == 0);
+    CHECK(secp256k1_ecdsa_verify_start(sign, state, &sig, msg32, &pubkey) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_ecdsa_verify_start(ctx, NULL, &sig, msg32, &pubkey) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_ecdsa_verify_start(ctx, state, NULL, msg32, &pubkey) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_ecdsa_verify_start(ctx, state, &sig, NULL, &pubkey) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_ecdsa_verify_start(ctx, state, &sig, msg32, NULL) == 0);
+    CHECK(ecount == 5);
+    CHECK(secp256k1_ecdsa_verify_start(ctx, state, &sig, msg32, &pubkey) == 1);
+    CHECK(secp256k1_ecdsa_verify_continue(ctx, state, &result, 0) == 0);
+    CHECK(ecount == 6);
+    CHECK(secp256k1_ecdsa_verify_continue(ctx, state, NULL, 1) == 0);
+    CHECK(ecount == 7);
+    /* The invalid public key is rejected in the first step. */
+    CHECK(secp256k1_ecdsa_verify_continue(ctx, state, &result, 1) == 1);
+    CHECK(ecount == 8);
+    CHECK(result == 0);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+    secp256k1_ecdsa_verify_state_destroy(state);
+    secp256k1_ecdsa_verify_state_destroy(NULL);
+    secp256k1_context_destroy(sign);
+}
+
 void run_ecdsa_end_to_end(void) {
     int i;
     for (i = 0; i < 64*count; i++) {
@@ -3482,6 +4521,14 @@ void run_ecdsa_end_to_end(void) {
     }
 }
 
+void run_ecdsa_verify_steps(void) {
+    int i;
+    test_ecdsa_verify_steps_api();
+    for (i = 0; i < count; i++) {
+        test_ecdsa_verify_steps();
+    }
+}
+
 int test_ecdsa_der_parse(const unsigned char *sig, size_t siglen, int certainly_der, int certainly_not_der) {
     static const unsigned char zeroes[32] = {0};
     static const unsigned char max_scalar[32] = {
@@ -3808,6 +4855,247 @@ void run_ecdsa_der_parse(void) {
     }
 }
 
+void test_ecdsa_parse_batch(void) {
+    unsigned char *buffer = (unsigned char *)malloc(32 * 2048);
+    unsigned char input64s[32 * 64];
+    size_t offsets[32] = {0}, lengths[32] = {0};
+    secp256k1_ecdsa_signature sigs[32], sigs_lax[32], sig;
+    unsigned char valid[33], valid_lax[33];
+    size_t n = secp256k1_rand_int(33);
+    size_t pos = 0;
+    size_t nvalid = 0, nvalid_lax = 0, nvalid_compact = 0;
+    size_t i;
+    int32_t ecount = 0;
+
+    /* Random signatures, some damaged, with random gaps between them. */
+    for (i = 0; i < n; i++) {
+        int certainly_der, certainly_not_der;
+        pos += secp256k1_rand_int(4);
+        offsets[i] = pos;
+        random_ber_signature(&buffer[pos], &lengths[i], &certainly_der, &certainly_not_der);
+        if (secp256k1_rand_bits(1)) {
+            damage_array(&buffer[pos], &lengths[i]);
+        }
+        pos += lengths[i];
+        CHECK(pos <= 32 * 2048);
+        secp256k1_rand256(&input64s[i * 64]);
+        secp256k1_rand256(&input64s[i * 64 + 32]);
+        if (secp256k1_rand_bits(1)) {
+            memset(&input64s[i * 64 + 32 * secp256k1_rand_bits(1)], 0, 1 + secp256k1_rand_int(32));
+        }
+    }
+    memset(valid, 0xff, sizeof(valid));
+    memset(valid_lax, 0xff, sizeof(valid_lax));
+    CHECK((size_t)secp256k1_ecdsa_signature_parse_der_batch(ctx, sigs, valid, buffer, offsets, lengths, n) <= n);
+    for (i = 0; i < n; i++) {
+        int ret = secp256k1_ecdsa_signature_parse_der(ctx, &sig, &buffer[offsets[i]], lengths[i]);
+        CHECK(valid[i] == ret);
+        CHECK(memcmp(&sig, &sigs[i], sizeof(sig)) == 0);
+        nvalid += ret;
+    }
+    CHECK(secp256k1_ecdsa_signature_parse_der_batch(ctx, sigs, NULL, buffer, offsets, lengths, n) == nvalid);
+    CHECK(ecdsa_signature_parse_der_lax_batch(ctx, sigs_lax, valid_lax, buffer, offsets, lengths, n) <= n);
+    for (i = 0; i < n; i++) {
+        int ret = ecdsa_signature_parse_der_lax(ctx, &sig, &buffer[offsets[i]], lengths[i]);
+        CHECK(valid_lax[i] == ret);
+        CHECK(memcmp(&sig, &sigs_lax[i], sizeof(sig)) == 0);
+        nvalid_lax += ret;
+    }
+    CHECK(ecdsa_signature_parse_der_lax_batch(ctx, sigs_lax, NULL, buffer, offsets, lengths, n) == nvalid_lax);
+    /* Nothing past the last signature is written. */
+    CHECK(valid[n] == 0xff);
+    CHECK(valid_lax[n] == 0xff);
+
+    memset(valid, 0xff, sizeof(valid));
+    CHECK(secp256k1_ecdsa_signature_parse_compact_batch(ctx, sigs, valid, input64s, n) <= n);
+    for (i = 0; i < n; i++) {
+        int ret = secp256k1_ecdsa_signature_parse_compact(ctx, &sig, &input64s[i * 64]);
+        CHECK(valid[i] == ret);
+        CHECK(memcmp(&sig, &sigs[i], sizeof(sig)) == 0);
+        nvalid_compact += ret;
+    }
+    CHECK(secp256k1_ecdsa_signature_parse_compact_batch(ctx, sigs, NULL, input64s, n) == nvalid_compact);
+
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_ecdsa_signature_parse_der_batch(ctx, NULL, valid, buffer, offsets, lengths, 1) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_ecdsa_signature_parse_der_batch(ctx, sigs, valid, NULL, offsets, lengths, 1) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_ecdsa_signature_parse_der_batch(ctx, sigs, valid, buffer, NULL, lengths, 1) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_ecdsa_signature_parse_der_batch(ctx, sigs, valid, buffer, offsets, NULL, 1) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_ecdsa_signature_parse_compact_batch(ctx, NULL, valid, input64s, 1) == 0);
+    CHECK(ecount == 5);
+    CHECK(secp256k1_ecdsa_signature_parse_compact_batch(ctx, sigs, valid, NULL, 1) == 0);
+    CHECK(ecount == 6);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+    free(buffer);
+}
+
+/* The reference for secp256k1_ecdsa_verify_der: four separate calls. */
+int ecdsa_verify_der_reference(const unsigned char *sig, size_t siglen, const unsigned char *msg32, const unsigned char *pubkey, size_t pubkeylen, int normalize) {
+    secp256k1_ecdsa_signature s;
+    secp256k1_pubkey p;
+    if (!secp256k1_ecdsa_signature_parse_der(ctx, &s, sig, siglen)) {
+        return 0;
+    }
+    if (normalize) {
+        secp256k1_ecdsa_signature_normalize(ctx, &s, &s);
+    }
+    if (!secp256k1_ec_pubkey_parse(ctx, &p, pubkey, pubkeylen)) {
+        return 0;
+    }
+    return secp256k1_ecdsa_verify(ctx, &s, msg32, &p);
+}
+
+/* Make a random signature to verify, which is correct about half of the time. */
+void random_verify_der_input(unsigned char *sig, size_t *siglen, unsigned char *msg32, unsigned char *pubkey, size_t *pubkeylen) {
+    secp256k1_scalar key, msg, r, s;
+    secp256k1_ecdsa_signature signature;
+    secp256k1_pubkey pk;
+    unsigned char seckey[32];
+
+    random_scalar_order_test(&key);
+    random_scalar_order_test(&msg);
+    secp256k1_scalar_get_b32(seckey, &key);
+    secp256k1_scalar_get_b32(msg32, &msg);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &pk, seckey) == 1);
+    CHECK(secp256k1_ecdsa_sign(ctx, &signature, msg32, seckey, NULL, NULL) == 1);
+    if (secp256k1_rand_bits(1)) {
+        /* Use the high-S form. */
+        secp256k1_ecdsa_signature_load(ctx, &r, &s, &signature);
+        secp256k1_scalar_negate(&s, &s);
+        secp256k1_ecdsa_signature_save(&signature, &r, &s);
+    }
+    *siglen = 72;
+    CHECK(secp256k1_ecdsa_signature_serialize_der(ctx, sig, siglen, &signature) == 1);
+    *pubkeylen = 65;
+    CHECK(secp256k1_ec_pubkey_serialize(ctx, pubkey, pubkeylen, &pk, secp256k1_rand_bits(1) ? SECP256K1_EC_COMPRESSED : SECP256K1_EC_UNCOMPRESSED) == 1);
+    switch (secp256k1_rand_int(8)) {
+    case 0:
+        damage_array(sig, siglen);
+        break;
+    case 1:
+        pubkey[secp256k1_rand_int(*pubkeylen)] ^= 1 << secp256k1_rand_int(8);
+        break;
+    case 2:
+        msg32[secp256k1_rand_int(32)] ^= 1 << secp256k1_rand_int(8);
+        break;
+    }
+}
+
+void test_ecdsa_verify_der(size_t n) {
+    unsigned char *input = (unsigned char *)malloc(n * (73 + 65 + 2));
+    unsigned char *msg32s = (unsigned char *)malloc(n * 32);
+    size_t *sig_offsets = (size_t *)malloc(n * sizeof(size_t));
+    size_t *sig_lengths = (size_t *)malloc(n * sizeof(size_t));
+    size_t *pubkey_offsets = (size_t *)malloc(n * sizeof(size_t));
+    size_t *pubkey_lengths = (size_t *)malloc(n * sizeof(size_t));
+    unsigned char *valid = (unsigned char *)malloc(n);
+    int *expected[2];
+    size_t nvalid[2] = {0, 0};
+    size_t pos = 0;
+    size_t i;
+    int normalize;
+
+    expected[0] = (int *)malloc(n * sizeof(int));
+    expected[1] = (int *)malloc(n * sizeof(int));
+    memset(input, 0, n * (73 + 65 + 2));
+    for (i = 0; i < n; i++) {
+        unsigned char sig[72 + 8];
+        unsigned char pubkey[65];
+        size_t siglen, pubkeylen;
+        random_verify_der_input(sig, &siglen, &msg32s[i * 32], pubkey, &pubkeylen);
+        for (normalize = 0; normalize < 2; normalize++) {
+            expected[normalize][i] = ecdsa_verify_der_reference(sig, siglen, &msg32s[i * 32], pubkey, pubkeylen, normalize);
+            CHECK(secp256k1_ecdsa_verify_der(ctx, sig, siglen, &msg32s[i * 32], pubkey, pubkeylen, normalize) == expected[normalize][i]);
+            nvalid[normalize] += expected[normalize][i];
+        }
+        /* Lay the public key and signature out in the buffer, with a gap. */
+        pos += secp256k1_rand_int(3);
+        pubkey_offsets[i] = pos;
+        pubkey_lengths[i] = pubkeylen;
+        memcpy(&input[pos], pubkey, pubkeylen);
+        pos += pubkeylen;
+        sig_offsets[i] = pos;
+        sig_lengths[i] = siglen;
+        memcpy(&input[pos], sig, siglen);
+        pos += siglen;
+    }
+
+    for (normalize = 0; normalize < 2; normalize++) {
+        memset(valid, 0xff, n);
+        if (secp256k1_rand_bits(1)) {
+            secp256k1_context_set_executor(ctx, &test_executor);
+        }
+        CHECK(secp256k1_ecdsa_verify_der_batch(ctx, valid, input, sig_offsets, sig_lengths, pubkey_offsets, pubkey_lengths, msg32s, n, normalize) == nvalid[normalize]);
+        secp256k1_context_set_executor(ctx, NULL);
+        for (i = 0; i < n; i++) {
+            CHECK(valid[i] == expected[normalize][i]);
+        }
+    }
+    free(expected[1]);
+    free(expected[0]);
+    free(valid);
+    free(pubkey_lengths);
+    free(pubkey_offsets);
+    free(sig_lengths);
+    free(sig_offsets);
+    free(msg32s);
+    free(input);
+}
+
+void test_ecdsa_verify_der_api(void) {
+    secp256k1_context *sign = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
+    unsigned char buf[72] = {0};
+    size_t zero = 0;
+    unsigned char valid = 0xff;
+    int32_t ecount = 0;
+
+    secp256k1_context_set_illegal_callback(sign, counting_illegal_callback_fn, &ecount);
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_ecdsa_verify_der(sign, buf, 8, buf, buf, 33, 0) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_ecdsa_verify_der(ctx, NULL, 8, buf, buf, 33, 0) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_ecdsa_verify_der(ctx, buf, 8, NULL, buf, 33, 0) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_ecdsa_verify_der(ctx, buf, 8, buf, NULL, 33, 0) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_ecdsa_verify_der(ctx, buf, 8, buf, buf, 33, 0) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_ecdsa_verify_der_batch(sign, &valid, buf, &zero, &zero, &zero, &zero, buf, 1, 0) == 0);
+    CHECK(ecount == 5);
+    CHECK(valid == 0);
+    CHECK(secp256k1_ecdsa_verify_der_batch(ctx, &valid, NULL, &zero, &zero, &zero, &zero, buf, 1, 0) == 0);
+    CHECK(ecount == 6);
+    CHECK(secp256k1_ecdsa_verify_der_batch(ctx, &valid, buf, &zero, &zero, &zero, &zero, NULL, 1, 0) == 0);
+    CHECK(ecount == 7);
+    CHECK(secp256k1_ecdsa_verify_der_batch(ctx, NULL, buf, &zero, &zero, &zero, &zero, buf, 1, 0) == 0);
+    CHECK(secp256k1_ecdsa_verify_der_batch(ctx, NULL, buf, &zero, &zero, &zero, &zero, buf, 0, 0) == 0);
+    CHECK(ecount == 7);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+    secp256k1_context_destroy(sign);
+}
+
+void run_ecdsa_verify_der(void) {
+    int i;
+    test_ecdsa_verify_der_api();
+    for (i = 0; i < count; i++) {
+        test_ecdsa_verify_der(1 + secp256k1_rand_int(32));
+    }
+    /* Spans several chunks. */
+    test_ecdsa_verify_der(2 * ECDSA_VERIFY_DER_BATCH + 1 + secp256k1_rand_int(ECDSA_VERIFY_DER_BATCH));
+}
+
+void run_ecdsa_parse_batch(void) {
+    int i;
+    for (i = 0; i < 10 * count; i++) {
+        test_ecdsa_parse_batch();
+    }
+}
+
 /* Tests several edge cases. */
 void test_ecdsa_edge_cases(void) {
     int t;
@@ -4250,6 +5538,176 @@ void run_ecdsa_openssl(void) {
 # include "modules/recovery/tests_impl.h"
 #endif
 
+#ifdef ENABLE_MODULE_VERIFYQUEUE
+# include "modules/verifyqueue/tests_impl.h"
+#endif
+
+#ifdef ENABLE_MODULE_HASH
+# include "modules/hash/tests_impl.h"
+#endif
+
+#ifdef ENABLE_PTHREAD_TESTS
+/* Run the batch operations with the reference pthreads executor, and compare
+ * the results with those of the default, serial, executor. Every batch spans
+ * several executor items: the signature batches use at most 256 items per
+ * chunk. */
+void run_executor_pthreads_tests(void) {
+    const size_t nkeys = 2 * EC_PUBKEY_COMBINE_BATCH + 1 + secp256k1_rand_int(EC_PUBKEY_RANGE_BATCH);
+    const size_t nsigs = 2 * 256 + 1 + secp256k1_rand_int(256);
+    secp256k1_executor executor;
+    secp256k1_context *pctx;
+    unsigned char *ser = (unsigned char *)malloc(nkeys * 65);
+    unsigned char *ser2 = (unsigned char *)malloc(nkeys * 65);
+    secp256k1_pubkey *keys = (secp256k1_pubkey *)malloc(nkeys * sizeof(secp256k1_pubkey));
+    secp256k1_pubkey *keys2 = (secp256k1_pubkey *)malloc(nkeys * sizeof(secp256k1_pubkey));
+    unsigned char *valid = (unsigned char *)malloc(nkeys);
+    unsigned char *valid2 = (unsigned char *)malloc(nkeys);
+    unsigned char *input = (unsigned char *)malloc(nsigs * (73 + 65));
+    unsigned char *msg32s = (unsigned char *)malloc(nsigs * 32);
+    size_t *sig_offsets = (size_t *)malloc(nsigs * sizeof(size_t));
+    size_t *sig_lengths = (size_t *)malloc(nsigs * sizeof(size_t));
+    size_t *pubkey_offsets = (size_t *)malloc(nsigs * sizeof(size_t));
+    size_t *pubkey_lengths = (size_t *)malloc(nsigs * sizeof(size_t));
+    secp256k1_pubkey sum, sum2;
+    unsigned char seckey[32];
+    secp256k1_scalar sc;
+    size_t n;
+    size_t i;
+    int compressed = secp256k1_rand_bits(1);
+    size_t len = compressed ? 33 : 65;
+    unsigned int flags = compressed ? SECP256K1_EC_COMPRESSED : SECP256K1_EC_UNCOMPRESSED;
+
+    CHECK(secp256k1_executor_pthreads_init(&executor, 3) == 1);
+    pctx = secp256k1_context_clone(ctx);
+    secp256k1_context_set_executor(pctx, &executor);
+
+    /* Key ranges, parsing, serialization and combination. */
+    random_scalar_order_test(&sc);
+    secp256k1_scalar_get_b32(seckey, &sc);
+    CHECK(secp256k1_ec_pubkey_create_range(ctx, ser, seckey, nkeys, flags) == 1);
+    CHECK(secp256k1_ec_pubkey_create_range(pctx, ser2, seckey, nkeys, flags) == 1);
+    CHECK(memcmp(ser, ser2, nkeys * len) == 0);
+    for (i = 0; i < 8; i++) {
+        ser[secp256k1_rand_int(nkeys) * len] = 0x05;
+    }
+    n = secp256k1_ec_pubkey_parse_batch(ctx, keys, valid, ser, len, nkeys);
+    CHECK(secp256k1_ec_pubkey_parse_batch(pctx, keys2, valid2, ser, len, nkeys) == n);
+    CHECK(n < nkeys);
+    CHECK(memcmp(keys, keys2, nkeys * sizeof(secp256k1_pubkey)) == 0);
+    CHECK(memcmp(valid, valid2, nkeys) == 0);
+    for (i = 0, n = 0; i < nkeys; i++) {
+        if (valid[i]) {
+            keys[n++] = keys[i];
+        }
+    }
+    CHECK(secp256k1_ec_pubkey_serialize_batch(ctx, ser, keys, n, flags) == 1);
+    CHECK(secp256k1_ec_pubkey_serialize_batch(pctx, ser2, keys, n, flags) == 1);
+    CHECK(memcmp(ser, ser2, n * len) == 0);
+    CHECK(secp256k1_ec_pubkey_combine_var(ctx, &sum, keys, n) == 1);
+    CHECK(secp256k1_ec_pubkey_combine_var(pctx, &sum2, keys, n) == 1);
+    CHECK(memcmp(&sum, &sum2, sizeof(sum)) == 0);
+
+#ifdef ENABLE_MODULE_ECDH
+    {
+        /* Scan nsigs of the keys, with some of their derived keys among the
+         * outputs. */
+        secp256k1_pubkey spendkey;
+        secp256k1_pubkey *outputs = (secp256k1_pubkey *)malloc(nsigs * sizeof(secp256k1_pubkey));
+        size_t *matches = (size_t *)malloc(nsigs * sizeof(size_t));
+        size_t *matches2 = (size_t *)malloc(nsigs * sizeof(size_t));
+        unsigned char scankey[32];
+        size_t noutputs = 0;
+        random_scalar_order_test(&sc);
+        secp256k1_scalar_get_b32(scankey, &sc);
+        random_scalar_order_test(&sc);
+        secp256k1_scalar_get_b32(seckey, &sc);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &spendkey, seckey) == 1);
+        for (i = 0; i < nsigs; i++) {
+            if (secp256k1_rand_bits(2) == 0) {
+                unsigned char tweak[32];
+                CHECK(secp256k1_ecdh(ctx, tweak, &keys[i], scankey) == 1);
+                outputs[noutputs] = spendkey;
+                CHECK(secp256k1_ec_pubkey_tweak_add(ctx, &outputs[noutputs], tweak) == 1);
+                noutputs++;
+            }
+        }
+        CHECK(secp256k1_ecdh_scan(ctx, matches, keys, nsigs, scankey, &spendkey, outputs, noutputs) == noutputs);
+        CHECK(secp256k1_ecdh_scan(pctx, matches2, keys, nsigs, scankey, &spendkey, outputs, noutputs) == noutputs);
+        CHECK(memcmp(matches, matches2, nsigs * sizeof(size_t)) == 0);
+        free(matches2);
+        free(matches);
+        free(outputs);
+    }
+#endif
+
+    /* DER signature verification, with and without normalization. */
+    for (i = 0; i < nsigs; i++) {
+        sig_offsets[i] = i * (73 + 65);
+        pubkey_offsets[i] = sig_offsets[i] + 73;
+        random_verify_der_input(&input[sig_offsets[i]], &sig_lengths[i], &msg32s[i * 32], &input[pubkey_offsets[i]], &pubkey_lengths[i]);
+    }
+    for (i = 0; i < 2; i++) {
+        n = secp256k1_ecdsa_verify_der_batch(ctx, valid, input, sig_offsets, sig_lengths, pubkey_offsets, pubkey_lengths, msg32s, nsigs, i);
+        CHECK(secp256k1_ecdsa_verify_der_batch(pctx, valid2, input, sig_offsets, sig_lengths, pubkey_offsets, pubkey_lengths, msg32s, nsigs, i) == n);
+        CHECK(memcmp(valid, valid2, nsigs) == 0);
+    }
+
+#ifdef ENABLE_MODULE_RECOVERY
+    {
+        secp256k1_ecdsa_recoverable_signature *rsigs = (secp256k1_ecdsa_recoverable_signature *)malloc(nsigs * sizeof(secp256k1_ecdsa_recoverable_signature));
+        for (i = 0; i < nsigs; i++) {
+            random_scalar_order_test(&sc);
+            secp256k1_scalar_get_b32(seckey, &sc);
+            secp256k1_rand256_test(&msg32s[i * 32]);
+            CHECK(secp256k1_ecdsa_sign_recoverable(ctx, &rsigs[i], &msg32s[i * 32], seckey, NULL, NULL) == 1);
+            if (secp256k1_rand_bits(2) == 0) {
+                /* Recovers to a different key, or to none at all. */
+                msg32s[i * 32] ^= 1;
+            }
+        }
+        n = secp256k1_ecdsa_recover_batch(ctx, keys, valid, rsigs, msg32s, nsigs);
+        CHECK(secp256k1_ecdsa_recover_batch(pctx, keys2, valid2, rsigs, msg32s, nsigs) == n);
+        CHECK(memcmp(keys, keys2, nsigs * sizeof(secp256k1_pubkey)) == 0);
+        CHECK(memcmp(valid, valid2, nsigs) == 0);
+        free(rsigs);
+    }
+#endif
+
+#ifdef ENABLE_MODULE_SCHNORR
+    for (i = 0; i < nsigs; i++) {
+        secp256k1_rand256_test(&msg32s[i * 32]);
+        if (secp256k1_rand_bits(1)) {
+            random_scalar_order_test(&sc);
+            secp256k1_scalar_get_b32(seckey, &sc);
+            CHECK(secp256k1_schnorr_sign(ctx, &input[i * 64], &msg32s[i * 32], seckey, NULL, NULL) == 1);
+        } else {
+            secp256k1_rand256_test(&input[i * 64]);
+            secp256k1_rand256_test(&input[i * 64 + 32]);
+        }
+    }
+    n = secp256k1_schnorr_recover_batch(ctx, keys, valid, input, msg32s, nsigs);
+    CHECK(secp256k1_schnorr_recover_batch(pctx, keys2, valid2, input, msg32s, nsigs) == n);
+    CHECK(memcmp(keys, keys2, nsigs * sizeof(secp256k1_pubkey)) == 0);
+    CHECK(memcmp(valid, valid2, nsigs) == 0);
+#endif
+
+    secp256k1_context_destroy(pctx);
+    secp256k1_executor_pthreads_clear(&executor);
+    free(pubkey_lengths);
+    free(pubkey_offsets);
+    free(sig_lengths);
+    free(sig_offsets);
+    free(msg32s);
+    free(input);
+    free(valid2);
+    free(valid);
+    free(keys2);
+    free(keys);
+    free(ser2);
+    free(ser);
+}
+#endif
+
 int main(int argc, char **argv) {
     unsigned char seed16[16] = {0};
     unsigned char run32[32] = {0};
@@ -4304,8 +5762,12 @@ int main(int argc, char **argv) {
     run_rand_int();
 
     run_sha256_tests();
+    run_sha256_batch_tests();
     run_hmac_sha256_tests();
     run_rfc6979_hmac_sha256_tests();
+#ifdef ENABLE_MODULE_HASH
+    run_hash_tests();
+#endif
 
 #ifndef USE_NUM_NONE
     /* num tests */
@@ -4319,10 +5781,19 @@ int main(int argc, char **argv) {
     run_field_inv();
     run_field_inv_var();
     run_field_inv_all_var();
+    run_ctz_tests();
+    run_inverse_tests();
     run_field_misc();
     run_field_convert();
     run_sqr();
     run_sqrt();
+    run_cpu_dispatch_tests();
+#ifdef USE_AVX2
+    run_field_x4_tests();
+#endif
+#ifdef USE_AVX512IFMA
+    run_field_x8_tests();
+#endif
 
     /* group tests */
     run_ge();
@@ -4331,11 +5802,13 @@ int main(int argc, char **argv) {
     /* ecmult tests */
     run_wnaf();
     run_point_times_order();
+    run_ecmult_odd_multiples_table();
     run_ecmult_chain();
     run_ecmult_constants();
     run_ecmult_gen_blind();
     run_ecmult_const_tests();
     run_ec_combine();
+    run_ec_pubkey_create_range();
 
     /* endomorphism tests */
 #ifdef USE_ENDOMORPHISM
@@ -4344,6 +5817,8 @@ int main(int argc, char **argv) {
 
     /* EC point parser test */
     run_ec_pubkey_parse_test();
+    run_ec_pubkey_batch_test();
+    run_point_table_tests();
 
     /* EC key edge cases */
     run_eckey_edge_case_test();
@@ -4356,8 +5831,11 @@ int main(int argc, char **argv) {
     /* ecdsa tests */
     run_random_pubkeys();
     run_ecdsa_der_parse();
+    run_ecdsa_parse_batch();
     run_ecdsa_sign_verify();
     run_ecdsa_end_to_end();
+    run_ecdsa_verify_steps();
+    run_ecdsa_verify_der();
     run_ecdsa_edge_cases();
 #ifdef ENABLE_OPENSSL_TESTS
     run_ecdsa_openssl();
@@ -4373,6 +5851,16 @@ int main(int argc, char **argv) {
     run_recovery_tests();
 #endif
 
+#ifdef ENABLE_MODULE_VERIFYQUEUE
+    /* verification queue tests */
+    run_verifyqueue_tests();
+#endif
+
+#ifdef ENABLE_PTHREAD_TESTS
+    /* batch operations on threads */
+    run_executor_pthreads_tests();
+#endif
+
     secp256k1_rand256(run32);
     printf("random run = %02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x\n", run32[0], run32[1], run32[2], run32[3], run32[4], run32[5], run32[6], run32[7], run32[8], run32[9], run32[10], run32[11], run32[12], run32[13], run32[14], run32[15]);
 
@@ -105,6 +105,61 @@ static SECP256K1_INLINE void *checked_malloc(const secp256k1_callback* cb, size_
 #  define SECP256K1_GNUC_EXT
 # endif
 SECP256K1_GNUC_EXT typedef unsigned __int128 uint128_t;
+SECP256K1_GNUC_EXT typedef __int128 int128_t;
 #endif
 
+/* Determine the number of trailing zero bits in a (non-zero) 32-bit x.
+ * This function is only intended to be used as fallback for
+ * secp256k1_ctz32_var, but permits it to be tested separately. */
+static SECP256K1_INLINE int secp256k1_ctz32_var_debruijn(uint32_t x) {
+    static const uint8_t debruijn[32] = {
+        0x00, 0x01, 0x10, 0x02, 0x1D, 0x11, 0x03, 0x16, 0x1E, 0x14, 0x12, 0x0B, 0x0D, 0x04, 0x07, 0x17,
+        0x1F, 0x0F, 0x1C, 0x15, 0x13, 0x0A, 0x0C, 0x06, 0x0E, 0x1B, 0x09, 0x05, 0x1A, 0x08, 0x19, 0x18
+    };
+    return debruijn[(uint32_t)((x & -x) * 0x06EB14F9U) >> 27];
+}
+
+/* Determine the number of trailing zero bits in a (non-zero) 64-bit x.
+ * This function is only intended to be used as fallback for
+ * secp256k1_ctz64_var, but permits it to be tested separately. */
+static SECP256K1_INLINE int secp256k1_ctz64_var_debruijn(uint64_t x) {
+    static const uint8_t debruijn[64] = {
+        0, 1, 2, 53, 3, 7, 54, 27, 4, 38, 41, 8, 34, 55, 48, 28,
+        62, 5, 39, 46, 44, 42, 22, 9, 24, 35, 59, 56, 49, 18, 29, 11,
+        63, 52, 6, 26, 37, 40, 33, 47, 61, 45, 43, 21, 23, 58, 17, 10,
+        51, 25, 36, 32, 60, 20, 57, 16, 50, 31, 19, 15, 30, 14, 13, 12
+    };
+    return debruijn[(uint64_t)((x & -x) * 0x022FDD63CC95386DULL) >> 58];
+}
+
+/* Determine the number of trailing zero bits in a (non-zero) 32-bit x. */
+static SECP256K1_INLINE int secp256k1_ctz32_var(uint32_t x) {
+    VERIFY_CHECK(x != 0);
+#if defined(__GNUC__)
+    /* If the unsigned type is sufficient to represent the largest uint32_t, consider __builtin_ctz. */
+    if (((unsigned)UINT32_MAX) == UINT32_MAX) {
+        return __builtin_ctz(x);
+    }
+    /* If the unsigned long type is sufficient to represent the largest uint32_t, consider __builtin_ctzl. */
+    return __builtin_ctzl(x);
+#else
+    return secp256k1_ctz32_var_debruijn(x);
+#endif
+}
+
+/* Determine the number of trailing zero bits in a (non-zero) 64-bit x. */
+static SECP256K1_INLINE int secp256k1_ctz64_var(uint64_t x) {
+    VERIFY_CHECK(x != 0);
+#if defined(__GNUC__)
+    /* If the unsigned long type is sufficient to represent the largest uint64_t, consider __builtin_ctzl. */
+    if (((unsigned long)UINT64_MAX) == UINT64_MAX) {
+        return __builtin_ctzl(x);
+    }
+    /* Otherwise use __builtin_ctzll, which is 64 bits wide wherever long is not. */
+    return __builtin_ctzll(x);
+#else
+    return secp256k1_ctz64_var_debruijn(x);
+#endif
+}
+
 #endif